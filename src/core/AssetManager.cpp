@@ -12,7 +12,7 @@
 
 namespace Kazia {
 
-AssetManager::AssetManager(filament::Engine* engine) : m_engine(engine) {
+AssetManager::AssetManager(filament::Engine* engine) : m_engine(engine), m_lodCache("cache/lod"), m_streamCache("cache/stream") {
 }
 
 AssetManager::~AssetManager() {
@@ -10,6 +10,9 @@
 #include <filament/Material.h>
 #include <filament/Texture.h>
 
+#include "MeshLod.h"
+#include "MeshStream.h"
+
 namespace Kazia {
 
 class Mesh;
@@ -39,6 +42,12 @@ private:
     std::unordered_map<std::string, TextureCacheItem> m_textureCache;
     std::unordered_map<std::string, MaterialCacheItem> m_materialCache;
     
+    // 导入网格生成的 LOD 链，按内容哈希存放在磁盘上
+    MeshLodCache m_lodCache;
+    
+    // 流式网格文件，与 LOD 链使用相同的内容键，供超出内存的场景按需分页载入
+    MeshStreamCache m_streamCache;
+    
 public:
     AssetManager(filament::Engine* engine);
     ~AssetManager();
@@ -55,6 +64,12 @@ public:
     filament::Material* loadMaterial(const std::string& path);
     void releaseMaterial(const std::string& path);
     
+    // LOD 链缓存
+    MeshLodCache* getLodCache() { return &m_lodCache; }
+    
+    // 流式网格缓存
+    MeshStreamCache* getStreamCache() { return &m_streamCache; }
+    
     // 清理相关
     void clearAllCaches();
     void clearUnusedAssets();
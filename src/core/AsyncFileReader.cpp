@@ -0,0 +1,713 @@
+#include "AsyncFileReader.h"
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define KAZIA_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+#endif
+
+namespace Kazia {
+
+struct AsyncFileReader::Request {
+    std::string path;
+    uint64_t offset = 0;
+    size_t size = 0;
+    Callback callback;
+
+    size_t done = 0;
+    std::vector<uint8_t> data;
+    int error = 0;
+    size_t syscalls = 0;            // pread 后备的读取调用次数
+
+    // io_uring 的处理阶段
+    enum class Stage {
+        Open,
+        Read,
+        Close
+    };
+    Stage stage = Stage::Open;
+    int fd = -1;
+    int bufferIndex = -1;           // 固定缓冲区下标，-1 表示数据在 data 中
+    bool sizeUnknown = false;       // 读取整个文件且大小未知，先按固定缓冲区大小读取
+    size_t lastLength = 0;          // 最近一次提交的读取长度
+};
+
+#ifdef KAZIA_HAS_IO_URING
+
+struct AsyncFileReader::Ring {
+    int fd = -1;
+
+    void* sqMap = MAP_FAILED;
+    size_t sqMapSize = 0;
+    void* cqMap = MAP_FAILED;
+    size_t cqMapSize = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqesSize = 0;
+
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqEntries = 0;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    // 注册的固定缓冲区，连续存放
+    uint8_t* buffers = nullptr;
+    size_t buffersSize = 0;
+    std::vector<int> freeBuffers;
+
+    // 等待提交的请求；已打开文件的请求放在前面，先完成它们再打开新的文件，打开的文件数不超过在途数的上限
+    std::deque<Request*> waiting;
+    unsigned inflight = 0;
+    unsigned pendingSubmit = 0;
+
+    std::thread reaper;
+
+    // 取得下一个空闲的提交项，填好后调用 commitSqe 发布；队列已满时返回空
+    io_uring_sqe* beginSqe() {
+        unsigned tail = *sqTail;
+        unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+        if (tail - head >= sqEntries) {
+            return nullptr;
+        }
+        unsigned index = tail & *sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqArray[index] = index;
+        return sqe;
+    }
+
+    // 提交项写完之后再发布尾指针
+    void commitSqe() {
+        __atomic_store_n(sqTail, *sqTail + 1, __ATOMIC_RELEASE);
+        pendingSubmit++;
+    }
+};
+
+namespace {
+
+int ringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int ringRegister(int fd, unsigned opcode, const void* arg, unsigned count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+} // namespace
+
+#else
+
+struct AsyncFileReader::Ring {
+};
+
+#endif
+
+AsyncFileReader::AsyncFileReader() : AsyncFileReader(Options()) {
+}
+
+AsyncFileReader::AsyncFileReader(const Options& options)
+    : m_options(options), m_backend(Backend::ThreadPool), m_outstanding(0) {
+    m_options.queueDepth = std::max(m_options.queueDepth, 1u);
+    if (m_options.useIoUring && initRing()) {
+        m_backend = Backend::IoUring;
+    } else {
+        m_fallbackPool = std::make_unique<ThreadPool>(std::max(m_options.fallbackThreads, 1u));
+    }
+}
+
+AsyncFileReader::~AsyncFileReader() {
+    wait();
+    destroyRing();
+    m_fallbackPool.reset();
+}
+
+void AsyncFileReader::read(const std::string& path, uint64_t offset, size_t size, Callback callback) {
+    Request* request = new Request();
+    request->path = path;
+    request->offset = offset;
+    request->size = size;
+    request->callback = std::move(callback);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_batch.push_back(request);
+    m_outstanding++;
+    m_stats.requests++;
+}
+
+void AsyncFileReader::submit() {
+    std::vector<Request*> batch;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        batch.swap(m_batch);
+    }
+    if (batch.empty()) {
+        return;
+    }
+
+    if (m_backend == Backend::ThreadPool) {
+        for (Request* request : batch) {
+            m_fallbackPool->submit([this, request]() {
+                readBlocking(request);
+                finish(request);
+            });
+        }
+        return;
+    }
+
+#ifdef KAZIA_HAS_IO_URING
+    // 打开文件也是异步操作，提交线程上没有逐个文件的系统调用
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Request* request : batch) {
+        m_ring->waiting.push_back(request);
+    }
+    dispatchRing();
+    flushRing();
+#endif
+}
+
+size_t AsyncFileReader::poll() {
+    std::vector<Request*> completions;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        completions.swap(m_completions);
+    }
+    for (Request* request : completions) {
+        deliver(request);
+    }
+    return completions.size();
+}
+
+void AsyncFileReader::wait() {
+    while (true) {
+        // 回调中加入的请求同样提交并等待
+        submit();
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() {
+                return m_outstanding == 0 || !m_completions.empty() || !m_batch.empty();
+            });
+            if (m_outstanding == 0) {
+                return;
+            }
+        }
+        poll();
+    }
+}
+
+AsyncFileReader::Stats AsyncFileReader::getStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void AsyncFileReader::finish(Request* request) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.completed++;
+        m_stats.bytesRead += request->done;
+        m_stats.submitCalls += request->syscalls;
+        if (request->error != 0) {
+            m_stats.failed++;
+        }
+        if (request->bufferIndex >= 0) {
+            m_stats.fixedBufferReads++;
+        }
+        if (!m_options.callbackPool) {
+            m_completions.push_back(request);
+            m_condition.notify_all();
+            return;
+        }
+    }
+    m_options.callbackPool->submit([this, request]() {
+        deliver(request);
+    });
+}
+
+void AsyncFileReader::deliver(Request* request) {
+    Result result;
+    result.path = &request->path;
+    result.offset = request->offset;
+    result.data = request->data.data();
+    result.size = request->done;
+    result.error = request->error;
+#ifdef KAZIA_HAS_IO_URING
+    if (request->bufferIndex >= 0) {
+        result.data = m_ring->buffers + static_cast<size_t>(request->bufferIndex) * m_options.fixedBufferSize;
+    }
+#endif
+
+    if (request->callback) {
+        request->callback(result);
+    }
+
+    // 回调返回后固定缓冲区才能复用
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+#ifdef KAZIA_HAS_IO_URING
+        if (request->bufferIndex >= 0) {
+            m_ring->freeBuffers.push_back(request->bufferIndex);
+        }
+#endif
+        m_outstanding--;
+        m_condition.notify_all();
+    }
+    delete request;
+}
+
+#ifdef _WIN32
+
+void AsyncFileReader::readBlocking(Request* request) {
+    HANDLE file = CreateFileA(request->path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        DWORD error = GetLastError();
+        request->error = error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND ? ENOENT : EIO;
+        return;
+    }
+
+    if (request->size == 0) {
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            request->error = EIO;
+            CloseHandle(file);
+            return;
+        }
+        uint64_t total = static_cast<uint64_t>(fileSize.QuadPart);
+        request->size = total > request->offset ? static_cast<size_t>(total - request->offset) : 0;
+    }
+
+    // 带偏移的同步读取，与 pread 相同，不依赖文件指针
+    request->data.resize(request->size);
+    while (request->done < request->size) {
+        uint64_t position = request->offset + request->done;
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>(position);
+        overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(request->size - request->done, size_t(1) << 30));
+        DWORD bytesRead = 0;
+        request->syscalls++;
+        if (!ReadFile(file, request->data.data() + request->done, chunk, &bytesRead, &overlapped)) {
+            if (GetLastError() != ERROR_HANDLE_EOF) {
+                request->error = EIO;
+            }
+            break;
+        }
+        if (bytesRead == 0) {
+            break;
+        }
+        request->done += bytesRead;
+    }
+    CloseHandle(file);
+}
+
+#else
+
+void AsyncFileReader::readBlocking(Request* request) {
+    int fd = ::open(request->path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        request->error = errno;
+        return;
+    }
+
+    if (request->size == 0) {
+        struct stat status;
+        if (fstat(fd, &status) != 0) {
+            request->error = errno;
+            ::close(fd);
+            return;
+        }
+        uint64_t total = static_cast<uint64_t>(status.st_size);
+        request->size = total > request->offset ? static_cast<size_t>(total - request->offset) : 0;
+    }
+
+    request->data.resize(request->size);
+    while (request->done < request->size) {
+        request->syscalls++;
+        ssize_t bytesRead = ::pread(fd, request->data.data() + request->done, request->size - request->done,
+                                    static_cast<off_t>(request->offset + request->done));
+        if (bytesRead < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            request->error = errno;
+            break;
+        }
+        if (bytesRead == 0) {
+            break;
+        }
+        request->done += static_cast<size_t>(bytesRead);
+    }
+    ::close(fd);
+}
+
+#endif
+
+#ifdef KAZIA_HAS_IO_URING
+
+bool AsyncFileReader::initRing() {
+    m_ring = std::make_unique<Ring>();
+    Ring& ring = *m_ring;
+
+    // 完成队列为提交队列的两倍，在途数不超过提交队列长度，完成队列不会溢出
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = m_options.queueDepth * 2;
+    ring.fd = ringSetup(m_options.queueDepth, &params);
+    if (ring.fd < 0) {
+        m_ring.reset();
+        return false;
+    }
+
+    ring.sqEntries = params.sq_entries;
+    ring.sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring.cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap) {
+        ring.sqMapSize = ring.cqMapSize = std::max(ring.sqMapSize, ring.cqMapSize);
+    }
+
+    ring.sqMap = mmap(nullptr, ring.sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING);
+    if (ring.sqMap != MAP_FAILED) {
+        ring.cqMap = singleMap ? ring.sqMap
+                               : mmap(nullptr, ring.cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING);
+    }
+    ring.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    if (ring.cqMap != MAP_FAILED) {
+        ring.sqes = static_cast<io_uring_sqe*>(mmap(nullptr, ring.sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                                    ring.fd, IORING_OFF_SQES));
+    }
+    if (ring.sqes == MAP_FAILED) {
+        destroyRing();
+        return false;
+    }
+
+    uint8_t* sq = static_cast<uint8_t*>(ring.sqMap);
+    uint8_t* cq = static_cast<uint8_t*>(ring.cqMap);
+    ring.sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    ring.sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    ring.sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    ring.sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    ring.cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    ring.cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    ring.cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    ring.cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    // 打开、读取和关闭文件的操作需要 5.6 以上的内核，缺少任何一个都使用后备
+    std::vector<uint8_t> probeMemory(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probeMemory.data());
+    bool supported = ringRegister(ring.fd, IORING_REGISTER_PROBE, probe, 256) == 0;
+    for (unsigned opcode : {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_READ_FIXED, IORING_OP_CLOSE}) {
+        supported = supported && opcode < probe->ops_len && (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) != 0;
+    }
+    if (!supported) {
+        destroyRing();
+        return false;
+    }
+
+    // 注册固定缓冲区；受锁定内存上限等限制注册失败时所有读取使用堆内存
+    if (m_options.fixedBufferCount > 0 && m_options.fixedBufferSize > 0) {
+        ring.buffersSize = static_cast<size_t>(m_options.fixedBufferCount) * m_options.fixedBufferSize;
+        void* buffers = mmap(nullptr, ring.buffersSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buffers != MAP_FAILED) {
+            ring.buffers = static_cast<uint8_t*>(buffers);
+            std::vector<iovec> vectors(m_options.fixedBufferCount);
+            for (uint32_t i = 0; i < m_options.fixedBufferCount; ++i) {
+                vectors[i].iov_base = ring.buffers + static_cast<size_t>(i) * m_options.fixedBufferSize;
+                vectors[i].iov_len = m_options.fixedBufferSize;
+            }
+            if (ringRegister(ring.fd, IORING_REGISTER_BUFFERS, vectors.data(), m_options.fixedBufferCount) == 0) {
+                for (int i = static_cast<int>(m_options.fixedBufferCount) - 1; i >= 0; --i) {
+                    ring.freeBuffers.push_back(i);
+                }
+            } else {
+                munmap(ring.buffers, ring.buffersSize);
+                ring.buffers = nullptr;
+                ring.buffersSize = 0;
+            }
+        }
+    }
+
+    ring.reaper = std::thread([this]() {
+        reapThread();
+    });
+    return true;
+}
+
+void AsyncFileReader::destroyRing() {
+    if (!m_ring) {
+        return;
+    }
+    Ring& ring = *m_ring;
+
+    // user_data 为 0 的空操作通知收取线程退出
+    if (ring.reaper.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            io_uring_sqe* sqe = ring.beginSqe();
+            if (!sqe) {
+                flushRing();
+                sqe = ring.beginSqe();
+            }
+            sqe->opcode = IORING_OP_NOP;
+            sqe->user_data = 0;
+            ring.commitSqe();
+            flushRing();
+        }
+        ring.reaper.join();
+    }
+
+    if (ring.buffers) {
+        munmap(ring.buffers, ring.buffersSize);
+    }
+    if (ring.sqes != MAP_FAILED) {
+        munmap(ring.sqes, ring.sqesSize);
+    }
+    if (ring.cqMap != MAP_FAILED && ring.cqMap != ring.sqMap) {
+        munmap(ring.cqMap, ring.cqMapSize);
+    }
+    if (ring.sqMap != MAP_FAILED) {
+        munmap(ring.sqMap, ring.sqMapSize);
+    }
+    if (ring.fd >= 0) {
+        ::close(ring.fd);
+    }
+    m_ring.reset();
+}
+
+void AsyncFileReader::dispatchRing() {
+    Ring& ring = *m_ring;
+    while (!ring.waiting.empty() && ring.inflight < ring.sqEntries) {
+        io_uring_sqe* sqe = ring.beginSqe();
+        if (!sqe) {
+            flushRing();
+            sqe = ring.beginSqe();
+            if (!sqe) {
+                break;
+            }
+        }
+
+        Request* request = ring.waiting.front();
+        ring.waiting.pop_front();
+        switch (request->stage) {
+            case Request::Stage::Open:
+                sqe->opcode = IORING_OP_OPENAT;
+                sqe->fd = AT_FDCWD;
+                sqe->addr = reinterpret_cast<uint64_t>(request->path.c_str());
+                sqe->open_flags = O_RDONLY | O_CLOEXEC;
+                break;
+            case Request::Stage::Read: {
+                request->lastLength = std::min<size_t>(request->size - request->done, size_t(1) << 30);
+                if (request->bufferIndex >= 0) {
+                    uint8_t* buffer = ring.buffers + static_cast<size_t>(request->bufferIndex) * m_options.fixedBufferSize;
+                    sqe->opcode = IORING_OP_READ_FIXED;
+                    sqe->addr = reinterpret_cast<uint64_t>(buffer + request->done);
+                    sqe->buf_index = static_cast<uint16_t>(request->bufferIndex);
+                } else {
+                    sqe->opcode = IORING_OP_READ;
+                    sqe->addr = reinterpret_cast<uint64_t>(request->data.data() + request->done);
+                }
+                sqe->fd = request->fd;
+                sqe->len = static_cast<uint32_t>(request->lastLength);
+                sqe->off = request->offset + request->done;
+                break;
+            }
+            case Request::Stage::Close:
+                sqe->opcode = IORING_OP_CLOSE;
+                sqe->fd = request->fd;
+                break;
+        }
+        sqe->user_data = reinterpret_cast<uint64_t>(request);
+        ring.commitSqe();
+        ring.inflight++;
+    }
+}
+
+void AsyncFileReader::completeRing(Request* request, int result, std::vector<Request*>& finished) {
+    Ring& ring = *m_ring;
+    if (result == -EINTR || result == -EAGAIN) {
+        ring.waiting.push_front(request);
+        return;
+    }
+
+    switch (request->stage) {
+        case Request::Stage::Open: {
+            if (result < 0) {
+                request->error = -result;
+                finished.push_back(request);
+                return;
+            }
+            request->fd = result;
+            request->stage = Request::Stage::Read;
+
+            // 读取整个文件时有空闲固定缓冲区就先按缓冲区大小读取，读满时才需要文件大小；否则用 fstat 取得大小
+            if (request->size == 0 && !ring.freeBuffers.empty()) {
+                request->sizeUnknown = true;
+                request->size = m_options.fixedBufferSize;
+            } else if (request->size == 0) {
+                struct stat status;
+                if (fstat(request->fd, &status) != 0) {
+                    request->error = errno;
+                } else if (static_cast<uint64_t>(status.st_size) > request->offset) {
+                    request->size = static_cast<size_t>(static_cast<uint64_t>(status.st_size) - request->offset);
+                }
+            }
+
+            if (request->error != 0 || request->size == 0) {
+                request->stage = Request::Stage::Close;
+            } else if (request->size <= m_options.fixedBufferSize && !ring.freeBuffers.empty()) {
+                request->bufferIndex = ring.freeBuffers.back();
+                ring.freeBuffers.pop_back();
+            } else {
+                request->data.resize(request->size);
+            }
+            ring.waiting.push_front(request);
+            return;
+        }
+
+        case Request::Stage::Read: {
+            if (result < 0) {
+                request->error = -result;
+                request->stage = Request::Stage::Close;
+                ring.waiting.push_front(request);
+                return;
+            }
+
+            // 大小未知时读不满表示到达文件末尾；读满缓冲区时取得文件大小，已读的数据移到堆内存继续读取
+            request->done += static_cast<size_t>(result);
+            bool endOfFile = result == 0 || (request->sizeUnknown && static_cast<size_t>(result) < request->lastLength);
+            if (!endOfFile && request->sizeUnknown && request->done == request->size) {
+                request->sizeUnknown = false;
+                struct stat status;
+                uint64_t total = fstat(request->fd, &status) == 0 ? static_cast<uint64_t>(status.st_size) : 0;
+                if (total > request->offset + request->done) {
+                    const uint8_t* buffer = ring.buffers + static_cast<size_t>(request->bufferIndex) * m_options.fixedBufferSize;
+                    request->size = static_cast<size_t>(total - request->offset);
+                    request->data.resize(request->size);
+                    std::memcpy(request->data.data(), buffer, request->done);
+                    ring.freeBuffers.push_back(request->bufferIndex);
+                    request->bufferIndex = -1;
+                }
+            }
+
+            if (endOfFile || request->done >= request->size) {
+                request->stage = Request::Stage::Close;
+            }
+            ring.waiting.push_front(request);
+            return;
+        }
+
+        case Request::Stage::Close:
+            request->fd = -1;
+            finished.push_back(request);
+            return;
+    }
+}
+
+void AsyncFileReader::flushRing() {
+    // 一次系统调用提交所有已发布的提交项
+    Ring& ring = *m_ring;
+    while (ring.pendingSubmit > 0) {
+        int submitted = ringEnter(ring.fd, ring.pendingSubmit, 0, 0);
+        m_stats.submitCalls++;
+        if (submitted < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                continue;
+            }
+            break;
+        }
+        ring.pendingSubmit -= static_cast<unsigned>(submitted);
+    }
+}
+
+void AsyncFileReader::reapThread() {
+    Ring& ring = *m_ring;
+    while (true) {
+        ringEnter(ring.fd, 0, 1, IORING_ENTER_GETEVENTS);
+
+        std::vector<Request*> finished;
+        bool stop = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            unsigned head = *ring.cqHead;
+            unsigned tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head) {
+                const io_uring_cqe& cqe = ring.cqes[head & *ring.cqMask];
+                if (cqe.user_data == 0) {
+                    stop = true;
+                    continue;
+                }
+
+                ring.inflight--;
+                completeRing(reinterpret_cast<Request*>(cqe.user_data), cqe.res, finished);
+            }
+            __atomic_store_n(ring.cqHead, head, __ATOMIC_RELEASE);
+
+            // 提交各请求的下一步和等待中的请求
+            dispatchRing();
+            flushRing();
+        }
+
+        for (Request* request : finished) {
+            finish(request);
+        }
+        if (stop) {
+            return;
+        }
+    }
+}
+
+#else
+
+bool AsyncFileReader::initRing() {
+    return false;
+}
+
+void AsyncFileReader::destroyRing() {
+}
+
+void AsyncFileReader::dispatchRing() {
+}
+
+void AsyncFileReader::completeRing(Request*, int, std::vector<Request*>&) {
+}
+
+void AsyncFileReader::flushRing() {
+}
+
+void AsyncFileReader::reapThread() {
+}
+
+#endif
+
+} // namespace Kazia
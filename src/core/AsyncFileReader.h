@@ -0,0 +1,120 @@
+#ifndef ASYNCFILEREADER_H
+#define ASYNCFILEREADER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Kazia {
+
+class ThreadPool;
+
+// 异步文件读取
+// 请求先放入批次，submit 时整批提交。Linux 上使用 io_uring：打开、读取和关闭文件都作为异步操作批量提交，
+// 每次 io_uring_enter 提交一批，完成由后台线程收取并接着提交下一步；不超过固定缓冲区大小的读取
+// 直接读入预先注册的缓冲区（省去每次读取时固定页面的开销），大小未知的小文件不需要 fstat。
+// io_uring 不可用（非 Linux、内核不支持所需操作或被禁止）时退回线程池上的阻塞 pread。
+// 完成回调在 poll / wait 的调用线程上执行，指定 callbackPool 时投递到该线程池执行；回调收到的数据只在回调期间有效
+class AsyncFileReader {
+public:
+    enum class Backend {
+        IoUring,
+        ThreadPool
+    };
+
+    struct Options {
+        uint32_t queueDepth = 256;                  // 同时在途的读取数
+        uint32_t fixedBufferCount = 64;             // io_uring 注册的固定缓冲区数量，0 表示不使用
+        size_t fixedBufferSize = size_t(64) << 10;  // 不超过该大小的读取使用固定缓冲区（用完时读入堆内存）
+        uint32_t fallbackThreads = 4;               // pread 后备的线程数
+        bool useIoUring = true;                     // false 时始终使用 pread 后备
+        ThreadPool* callbackPool = nullptr;         // 非空时回调在该线程池上执行
+    };
+
+    struct Result {
+        const std::string* path = nullptr;
+        uint64_t offset = 0;
+        const uint8_t* data = nullptr;  // 只在回调期间有效
+        size_t size = 0;                // 实际读到的字节数，读到文件末尾时可能小于请求的大小
+        int error = 0;                  // 0 表示成功，否则为 errno
+    };
+
+    using Callback = std::function<void(const Result& result)>;
+
+    struct Stats {
+        size_t requests = 0;
+        size_t completed = 0;
+        size_t failed = 0;
+        size_t bytesRead = 0;
+        size_t submitCalls = 0;         // 提交读取的系统调用次数（io_uring_enter，后备为 pread）
+        size_t fixedBufferReads = 0;    // 读入固定缓冲区的请求数
+    };
+
+private:
+    struct Request;
+    struct Ring;
+
+    Options m_options;
+    Backend m_backend;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::vector<Request*> m_batch;          // 尚未提交
+    std::vector<Request*> m_completions;    // 已完成，等待 poll 执行回调
+    size_t m_outstanding;                   // 已加入但回调尚未返回的请求
+    Stats m_stats;
+
+    std::unique_ptr<Ring> m_ring;
+    std::unique_ptr<ThreadPool> m_fallbackPool;
+
+public:
+    AsyncFileReader();
+    explicit AsyncFileReader(const Options& options);
+
+    // 析构时等待所有请求完成并执行回调
+    ~AsyncFileReader();
+
+    AsyncFileReader(const AsyncFileReader&) = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+    // 读取 [offset, offset + size)，size 为 0 时读到文件末尾；请求在 submit 之前不会开始
+    void read(const std::string& path, uint64_t offset, size_t size, Callback callback);
+
+    // 读取整个文件
+    void readFile(const std::string& path, Callback callback) { read(path, 0, 0, std::move(callback)); }
+
+    // 提交批次中的所有请求
+    void submit();
+
+    // 在调用线程上执行已完成请求的回调，返回执行的数量（不等待）
+    size_t poll();
+
+    // 提交并等待所有请求完成（回调执行完毕）；不能在回调中调用
+    void wait();
+
+    Backend getBackend() const { return m_backend; }
+    const Options& getOptions() const { return m_options; }
+    Stats getStats();
+
+private:
+    void finish(Request* request);
+    void deliver(Request* request);
+    void readBlocking(Request* request);
+
+    // io_uring
+    bool initRing();
+    void destroyRing();
+    void dispatchRing();
+    void completeRing(Request* request, int result, std::vector<Request*>& finished);
+    void flushRing();
+    void reapThread();
+};
+
+} // namespace Kazia
+
+#endif // ASYNCFILEREADER_H
@@ -0,0 +1,432 @@
+#include "DynamicBVH.h"
+
+#include <algorithm>
+
+namespace Kazia {
+
+DynamicBVH::DynamicBVH(float margin)
+    : m_root(NULL_NODE),
+      m_freeList(NULL_NODE),
+      m_proxyCount(0),
+      m_margin(margin) {
+}
+
+void DynamicBVH::clear() {
+    m_nodes.clear();
+    m_root = NULL_NODE;
+    m_freeList = NULL_NODE;
+    m_proxyCount = 0;
+}
+
+void DynamicBVH::rebuild() {
+    if (m_root == NULL_NODE) {
+        return;
+    }
+    
+    // 收集叶子，内部节点全部回收
+    std::vector<int32_t> leaves;
+    leaves.reserve(m_proxyCount);
+    for (int32_t i = 0; i < static_cast<int32_t>(m_nodes.size()); ++i) {
+        if (m_nodes[i].height < 0) {
+            continue;
+        }
+        if (m_nodes[i].isLeaf()) {
+            leaves.push_back(i);
+        } else {
+            freeNode(i);
+        }
+    }
+    
+    std::vector<math::float3> centroids(m_nodes.size());
+    for (int32_t leaf : leaves) {
+        centroids[leaf] = m_nodes[leaf].box.center();
+    }
+    
+    m_root = buildRange(leaves, centroids, 0, leaves.size(), 0);
+    m_nodes[m_root].parent = NULL_NODE;
+}
+
+int32_t DynamicBVH::buildRange(std::vector<int32_t>& leaves, std::vector<math::float3>& centroids, size_t begin, size_t end, int depth) {
+    if (end - begin == 1) {
+        return leaves[begin];
+    }
+    
+    // 质心包围盒决定划分轴
+    math::aabb centroidBounds;
+    for (size_t i = begin; i < end; ++i) {
+        centroidBounds.merge(centroids[leaves[i]]);
+    }
+    
+    math::float3 size = centroidBounds.max - centroidBounds.min;
+    int axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+    auto axisValue = [](const math::float3& v, int a) { return a == 0 ? v.x : (a == 1 ? v.y : v.z); };
+    float axisMin = axisValue(centroidBounds.min, axis);
+    float axisExtent = axisValue(size, axis);
+    
+    size_t mid = begin + (end - begin) / 2;
+    
+    // 深度过大或质心重合时退化为中位数划分，保证查询栈深度有界
+    if (axisExtent > 0.0f && depth < 64) {
+        constexpr int BIN_COUNT = 12;
+        math::aabb binBounds[BIN_COUNT];
+        int binCounts[BIN_COUNT] = {};
+        float scale = BIN_COUNT / axisExtent;
+        
+        auto binIndex = [&](int32_t leaf) {
+            int bin = static_cast<int>((axisValue(centroids[leaf], axis) - axisMin) * scale);
+            return bin < BIN_COUNT - 1 ? bin : BIN_COUNT - 1;
+        };
+        
+        for (size_t i = begin; i < end; ++i) {
+            int bin = binIndex(leaves[i]);
+            binCounts[bin]++;
+            binBounds[bin].merge(m_nodes[leaves[i]].box);
+        }
+        
+        // 从右向左累计，得到每个划分位置右侧的面积和数量
+        float rightArea[BIN_COUNT];
+        int rightCount[BIN_COUNT];
+        math::aabb accumulated;
+        int count = 0;
+        for (int i = BIN_COUNT - 1; i > 0; --i) {
+            accumulated.merge(binBounds[i]);
+            count += binCounts[i];
+            rightArea[i] = accumulated.isEmpty() ? 0.0f : accumulated.surfaceArea();
+            rightCount[i] = count;
+        }
+        
+        // 从左向右扫描，寻找代价最小的划分位置
+        float bestCost = std::numeric_limits<float>::max();
+        int bestSplit = -1;
+        accumulated = math::aabb();
+        count = 0;
+        for (int i = 0; i < BIN_COUNT - 1; ++i) {
+            accumulated.merge(binBounds[i]);
+            count += binCounts[i];
+            if (count == 0 || rightCount[i + 1] == 0) {
+                continue;
+            }
+            float cost = count * accumulated.surfaceArea() + rightCount[i + 1] * rightArea[i + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestSplit = i;
+            }
+        }
+        
+        if (bestSplit >= 0) {
+            auto it = std::partition(leaves.begin() + begin, leaves.begin() + end,
+                [&](int32_t leaf) { return binIndex(leaf) <= bestSplit; });
+            mid = static_cast<size_t>(it - leaves.begin());
+        }
+    } else {
+        std::nth_element(leaves.begin() + begin, leaves.begin() + mid, leaves.begin() + end,
+            [&](int32_t a, int32_t b) { return axisValue(centroids[a], axis) < axisValue(centroids[b], axis); });
+    }
+    
+    int32_t child1 = buildRange(leaves, centroids, begin, mid, depth + 1);
+    int32_t child2 = buildRange(leaves, centroids, mid, end, depth + 1);
+    
+    int32_t nodeId = allocateNode();
+    TreeNode& node = m_nodes[nodeId];
+    node.child1 = child1;
+    node.child2 = child2;
+    node.box = math::aabb::unionOf(m_nodes[child1].box, m_nodes[child2].box);
+    node.height = 1 + std::max(m_nodes[child1].height, m_nodes[child2].height);
+    m_nodes[child1].parent = nodeId;
+    m_nodes[child2].parent = nodeId;
+    return nodeId;
+}
+
+int32_t DynamicBVH::allocateNode() {
+    // 空闲链表为空时扩展节点池
+    if (m_freeList == NULL_NODE) {
+        TreeNode node;
+        node.userData = nullptr;
+        node.parent = NULL_NODE;
+        node.child1 = NULL_NODE;
+        node.child2 = NULL_NODE;
+        node.height = -1;
+        m_nodes.push_back(node);
+        return static_cast<int32_t>(m_nodes.size() - 1);
+    }
+
+    int32_t nodeId = m_freeList;
+    m_freeList = m_nodes[nodeId].parent;
+
+    TreeNode& node = m_nodes[nodeId];
+    node.box = math::aabb();
+    node.userData = nullptr;
+    node.parent = NULL_NODE;
+    node.child1 = NULL_NODE;
+    node.child2 = NULL_NODE;
+    node.height = 0;
+    return nodeId;
+}
+
+void DynamicBVH::freeNode(int32_t nodeId) {
+    m_nodes[nodeId].parent = m_freeList;
+    m_nodes[nodeId].height = -1;
+    m_freeList = nodeId;
+}
+
+int32_t DynamicBVH::createProxy(const math::aabb& box, void* userData) {
+    int32_t proxyId = allocateNode();
+
+    // 放大包围盒
+    math::float3 margin(m_margin, m_margin, m_margin);
+    TreeNode& node = m_nodes[proxyId];
+    node.box = math::aabb(box.min - margin, box.max + margin);
+    node.userData = userData;
+    node.height = 0;
+
+    insertLeaf(proxyId);
+    m_proxyCount++;
+    return proxyId;
+}
+
+void DynamicBVH::destroyProxy(int32_t proxyId) {
+    if (proxyId < 0 || proxyId >= static_cast<int32_t>(m_nodes.size()) || !m_nodes[proxyId].isLeaf()) {
+        return;
+    }
+
+    removeLeaf(proxyId);
+    freeNode(proxyId);
+    m_proxyCount--;
+}
+
+bool DynamicBVH::moveProxy(int32_t proxyId, const math::aabb& box) {
+    if (m_nodes[proxyId].box.contains(box)) {
+        return false;
+    }
+
+    removeLeaf(proxyId);
+
+    math::float3 margin(m_margin, m_margin, m_margin);
+    m_nodes[proxyId].box = math::aabb(box.min - margin, box.max + margin);
+
+    insertLeaf(proxyId);
+    return true;
+}
+
+void DynamicBVH::insertLeaf(int32_t leaf) {
+    if (m_root == NULL_NODE) {
+        m_root = leaf;
+        m_nodes[m_root].parent = NULL_NODE;
+        return;
+    }
+
+    // 按表面积启发式寻找最佳兄弟节点
+    math::aabb leafBox = m_nodes[leaf].box;
+    int32_t index = m_root;
+    while (!m_nodes[index].isLeaf()) {
+        int32_t child1 = m_nodes[index].child1;
+        int32_t child2 = m_nodes[index].child2;
+
+        float area = m_nodes[index].box.surfaceArea();
+        float combinedArea = math::aabb::unionOf(m_nodes[index].box, leafBox).surfaceArea();
+
+        // 在当前节点处创建新父节点的代价
+        float cost = 2.0f * combinedArea;
+
+        // 继续向下的继承代价
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto descendCost = [&](int32_t child) {
+            math::aabb merged = math::aabb::unionOf(leafBox, m_nodes[child].box);
+            if (m_nodes[child].isLeaf()) {
+                return merged.surfaceArea() + inheritanceCost;
+            }
+            return merged.surfaceArea() - m_nodes[child].box.surfaceArea() + inheritanceCost;
+        };
+
+        float cost1 = descendCost(child1);
+        float cost2 = descendCost(child2);
+
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+
+        index = cost1 < cost2 ? child1 : child2;
+    }
+
+    int32_t sibling = index;
+
+    // 创建新的父节点
+    int32_t oldParent = m_nodes[sibling].parent;
+    int32_t newParent = allocateNode();
+    m_nodes[newParent].parent = oldParent;
+    m_nodes[newParent].userData = nullptr;
+    m_nodes[newParent].box = math::aabb::unionOf(leafBox, m_nodes[sibling].box);
+    m_nodes[newParent].height = m_nodes[sibling].height + 1;
+
+    if (oldParent != NULL_NODE) {
+        if (m_nodes[oldParent].child1 == sibling) {
+            m_nodes[oldParent].child1 = newParent;
+        } else {
+            m_nodes[oldParent].child2 = newParent;
+        }
+    } else {
+        m_root = newParent;
+    }
+
+    m_nodes[newParent].child1 = sibling;
+    m_nodes[newParent].child2 = leaf;
+    m_nodes[sibling].parent = newParent;
+    m_nodes[leaf].parent = newParent;
+
+    // 向上修正包围盒和高度
+    index = m_nodes[leaf].parent;
+    while (index != NULL_NODE) {
+        index = balance(index);
+
+        int32_t child1 = m_nodes[index].child1;
+        int32_t child2 = m_nodes[index].child2;
+
+        m_nodes[index].height = 1 + std::max(m_nodes[child1].height, m_nodes[child2].height);
+        m_nodes[index].box = math::aabb::unionOf(m_nodes[child1].box, m_nodes[child2].box);
+
+        index = m_nodes[index].parent;
+    }
+}
+
+void DynamicBVH::removeLeaf(int32_t leaf) {
+    if (leaf == m_root) {
+        m_root = NULL_NODE;
+        return;
+    }
+
+    int32_t parent = m_nodes[leaf].parent;
+    int32_t grandParent = m_nodes[parent].parent;
+    int32_t sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+    if (grandParent != NULL_NODE) {
+        // 用兄弟节点替换父节点
+        if (m_nodes[grandParent].child1 == parent) {
+            m_nodes[grandParent].child1 = sibling;
+        } else {
+            m_nodes[grandParent].child2 = sibling;
+        }
+        m_nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        // 向上修正包围盒和高度
+        int32_t index = grandParent;
+        while (index != NULL_NODE) {
+            index = balance(index);
+
+            int32_t child1 = m_nodes[index].child1;
+            int32_t child2 = m_nodes[index].child2;
+
+            m_nodes[index].box = math::aabb::unionOf(m_nodes[child1].box, m_nodes[child2].box);
+            m_nodes[index].height = 1 + std::max(m_nodes[child1].height, m_nodes[child2].height);
+
+            index = m_nodes[index].parent;
+        }
+    } else {
+        m_root = sibling;
+        m_nodes[sibling].parent = NULL_NODE;
+        freeNode(parent);
+    }
+}
+
+int32_t DynamicBVH::balance(int32_t iA) {
+    TreeNode* A = &m_nodes[iA];
+    if (A->isLeaf() || A->height < 2) {
+        return iA;
+    }
+
+    int32_t iB = A->child1;
+    int32_t iC = A->child2;
+    TreeNode* B = &m_nodes[iB];
+    TreeNode* C = &m_nodes[iC];
+
+    int32_t heightDiff = C->height - B->height;
+
+    // C 较高时将 C 提升
+    if (heightDiff > 1) {
+        int32_t iF = C->child1;
+        int32_t iG = C->child2;
+        TreeNode* F = &m_nodes[iF];
+        TreeNode* G = &m_nodes[iG];
+
+        C->child1 = iA;
+        C->parent = A->parent;
+        A->parent = iC;
+
+        if (C->parent != NULL_NODE) {
+            if (m_nodes[C->parent].child1 == iA) {
+                m_nodes[C->parent].child1 = iC;
+            } else {
+                m_nodes[C->parent].child2 = iC;
+            }
+        } else {
+            m_root = iC;
+        }
+
+        if (F->height > G->height) {
+            C->child2 = iF;
+            A->child2 = iG;
+            G->parent = iA;
+            A->box = math::aabb::unionOf(B->box, G->box);
+            C->box = math::aabb::unionOf(A->box, F->box);
+            A->height = 1 + std::max(B->height, G->height);
+            C->height = 1 + std::max(A->height, F->height);
+        } else {
+            C->child2 = iG;
+            A->child2 = iF;
+            F->parent = iA;
+            A->box = math::aabb::unionOf(B->box, F->box);
+            C->box = math::aabb::unionOf(A->box, G->box);
+            A->height = 1 + std::max(B->height, F->height);
+            C->height = 1 + std::max(A->height, G->height);
+        }
+
+        return iC;
+    }
+
+    // B 较高时将 B 提升
+    if (heightDiff < -1) {
+        int32_t iD = B->child1;
+        int32_t iE = B->child2;
+        TreeNode* D = &m_nodes[iD];
+        TreeNode* E = &m_nodes[iE];
+
+        B->child1 = iA;
+        B->parent = A->parent;
+        A->parent = iB;
+
+        if (B->parent != NULL_NODE) {
+            if (m_nodes[B->parent].child1 == iA) {
+                m_nodes[B->parent].child1 = iB;
+            } else {
+                m_nodes[B->parent].child2 = iB;
+            }
+        } else {
+            m_root = iB;
+        }
+
+        if (D->height > E->height) {
+            B->child2 = iD;
+            A->child1 = iE;
+            E->parent = iA;
+            A->box = math::aabb::unionOf(C->box, E->box);
+            B->box = math::aabb::unionOf(A->box, D->box);
+            A->height = 1 + std::max(C->height, E->height);
+            B->height = 1 + std::max(A->height, D->height);
+        } else {
+            B->child2 = iE;
+            A->child1 = iD;
+            D->parent = iA;
+            A->box = math::aabb::unionOf(C->box, D->box);
+            B->box = math::aabb::unionOf(A->box, E->box);
+            A->height = 1 + std::max(C->height, D->height);
+            B->height = 1 + std::max(A->height, E->height);
+        }
+
+        return iB;
+    }
+
+    return iA;
+}
+
+} // namespace Kazia
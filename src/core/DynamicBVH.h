@@ -0,0 +1,254 @@
+#ifndef DYNAMICBVH_H
+#define DYNAMICBVH_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Math.h"
+
+namespace Kazia {
+
+// 动态层次包围盒树
+// 叶子存储放大后的包围盒（fat AABB），物体在放大范围内移动时无需修改树结构，
+// 移出范围时才重新插入，适合大量物体每帧少量移动的增量维护
+class DynamicBVH {
+public:
+    static constexpr int32_t NULL_NODE = -1;
+
+private:
+    struct TreeNode {
+        math::aabb box;
+        void* userData;
+
+        // 空闲时 parent 作为空闲链表的 next
+        int32_t parent;
+        int32_t child1;
+        int32_t child2;
+
+        // 叶子为 0，空闲节点为 -1
+        int32_t height;
+
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    std::vector<TreeNode> m_nodes;
+    int32_t m_root;
+    int32_t m_freeList;
+    int32_t m_proxyCount;
+
+    // 叶子包围盒的放大量
+    float m_margin;
+
+public:
+    DynamicBVH(float margin = 0.1f);
+    ~DynamicBVH() = default;
+
+    // 代理管理，返回的代理 ID 在销毁前保持不变
+    int32_t createProxy(const math::aabb& box, void* userData);
+    void destroyProxy(int32_t proxyId);
+
+    // 移动代理，新包围盒仍在放大包围盒内时直接返回 false
+    bool moveProxy(int32_t proxyId, const math::aabb& box);
+
+    void* getUserData(int32_t proxyId) const { return m_nodes[proxyId].userData; }
+    const math::aabb& getFatAabb(int32_t proxyId) const { return m_nodes[proxyId].box; }
+
+    // 统计
+    int32_t getProxyCount() const { return m_proxyCount; }
+    int32_t getHeight() const { return m_root == NULL_NODE ? 0 : m_nodes[m_root].height; }
+    int32_t getNodeCapacity() const { return static_cast<int32_t>(m_nodes.size()); }
+
+    // 放大量
+    float getMargin() const { return m_margin; }
+    void setMargin(float margin) { m_margin = margin; }
+
+    // 清空
+    void clear();
+    
+    // 按分箱表面积启发式（binned SAH）自顶向下重建整棵树
+    // 大批量插入后调用，得到比逐个插入质量更高的树，代理 ID 保持不变
+    void rebuild();
+
+    // 视锥体查询
+    // callback(proxyId, fullyInside)，完全在视锥体内的子树不再做平面检测
+    // 返回访问的节点数
+    template <typename Callback>
+    uint32_t queryFrustum(const math::frustum& frustum, Callback&& callback) const {
+        if (m_root == NULL_NODE) {
+            return 0;
+        }
+
+        struct StackEntry {
+            int32_t node;
+            uint32_t planeMask;
+        };
+
+        StackEntry stack[128];
+        int stackSize = 0;
+        stack[stackSize++] = {m_root, math::frustum::ALL_PLANES};
+        uint32_t visited = 0;
+
+        while (stackSize > 0) {
+            StackEntry entry = stack[--stackSize];
+            const TreeNode& node = m_nodes[entry.node];
+            visited++;
+
+            uint32_t planeMask = entry.planeMask;
+            math::frustum::Result result = math::frustum::Result::INSIDE;
+            if (planeMask != 0) {
+                result = frustum.classify(node.box, planeMask);
+                if (result == math::frustum::Result::OUTSIDE) {
+                    continue;
+                }
+            }
+
+            // 整个子树都在视锥体内，直接收集叶子
+            if (planeMask == 0) {
+                visited += collectLeaves(entry.node, callback);
+                continue;
+            }
+
+            if (node.isLeaf()) {
+                callback(entry.node, false);
+            } else if (stackSize + 2 <= 128) {
+                stack[stackSize++] = {node.child1, planeMask};
+                stack[stackSize++] = {node.child2, planeMask};
+            }
+        }
+
+        return visited;
+    }
+
+    // 包围盒查询，callback(proxyId)
+    template <typename Callback>
+    void queryAabb(const math::aabb& box, Callback&& callback) const {
+        if (m_root == NULL_NODE) {
+            return;
+        }
+
+        int32_t stack[128];
+        int stackSize = 0;
+        stack[stackSize++] = m_root;
+
+        while (stackSize > 0) {
+            const TreeNode& node = m_nodes[stack[--stackSize]];
+            if (!node.box.intersects(box)) {
+                continue;
+            }
+
+            if (node.isLeaf()) {
+                callback(static_cast<int32_t>(&node - m_nodes.data()));
+            } else if (stackSize + 2 <= 128) {
+                stack[stackSize++] = node.child1;
+                stack[stackSize++] = node.child2;
+            }
+        }
+    }
+
+    // 射线查询，按由近到远的顺序访问子节点
+    // callback(proxyId, tMax) 返回新的 tMax，命中后缩短射线以剪掉更远的子树
+    // 返回访问的节点数
+    template <typename Callback>
+    uint32_t queryRay(const math::ray& ray, float tMax, Callback&& callback) const {
+        if (m_root == NULL_NODE) {
+            return 0;
+        }
+        
+        struct StackEntry {
+            int32_t node;
+            float tNear;
+        };
+        
+        StackEntry stack[128];
+        int stackSize = 0;
+        uint32_t visited = 1;
+        
+        float tNear;
+        if (!ray.intersects(m_nodes[m_root].box, tMax, tNear)) {
+            return visited;
+        }
+        stack[stackSize++] = {m_root, tNear};
+        
+        while (stackSize > 0) {
+            StackEntry entry = stack[--stackSize];
+            
+            // 入栈后 tMax 可能已被缩短
+            if (entry.tNear > tMax) {
+                continue;
+            }
+            
+            const TreeNode& node = m_nodes[entry.node];
+            if (node.isLeaf()) {
+                tMax = callback(entry.node, tMax);
+                continue;
+            }
+            
+            float t1, t2;
+            bool hit1 = ray.intersects(m_nodes[node.child1].box, tMax, t1);
+            bool hit2 = ray.intersects(m_nodes[node.child2].box, tMax, t2);
+            visited += 2;
+            
+            if (stackSize + 2 > 128) {
+                continue;
+            }
+            
+            // 较远的子节点先入栈，较近的先出栈
+            if (hit1 && hit2) {
+                if (t1 <= t2) {
+                    stack[stackSize++] = {node.child2, t2};
+                    stack[stackSize++] = {node.child1, t1};
+                } else {
+                    stack[stackSize++] = {node.child1, t1};
+                    stack[stackSize++] = {node.child2, t2};
+                }
+            } else if (hit1) {
+                stack[stackSize++] = {node.child1, t1};
+            } else if (hit2) {
+                stack[stackSize++] = {node.child2, t2};
+            }
+        }
+        
+        return visited;
+    }
+    
+private:
+    // 收集子树中的所有叶子，返回访问的节点数
+    template <typename Callback>
+    uint32_t collectLeaves(int32_t root, Callback& callback) const {
+        int32_t stack[128];
+        int stackSize = 0;
+        stack[stackSize++] = root;
+        uint32_t visited = 0;
+
+        while (stackSize > 0) {
+            int32_t index = stack[--stackSize];
+            const TreeNode& node = m_nodes[index];
+
+            if (node.isLeaf()) {
+                callback(index, true);
+            } else if (stackSize + 2 <= 128) {
+                visited += 2;
+                stack[stackSize++] = node.child1;
+                stack[stackSize++] = node.child2;
+            }
+        }
+
+        return visited;
+    }
+
+    int32_t allocateNode();
+    void freeNode(int32_t nodeId);
+
+    void insertLeaf(int32_t leaf);
+    void removeLeaf(int32_t leaf);
+
+    // AVL 式旋转，保持树平衡
+    int32_t balance(int32_t nodeId);
+    
+    // 对 leaves[begin, end) 递归构建子树，返回子树根节点
+    int32_t buildRange(std::vector<int32_t>& leaves, std::vector<math::float3>& centroids, size_t begin, size_t end, int depth);
+};
+
+} // namespace Kazia
+
+#endif // DYNAMICBVH_H
@@ -10,6 +10,11 @@ FilamentEngine::FilamentEngine()
     , m_camera(nullptr)
     , m_swapChain(nullptr)
     , m_nativeWindow(nullptr)
+    , m_width(0)
+    , m_height(0)
+    , m_fov(45.0f)
+    , m_near(0.1f)
+    , m_far(1000.0f)
 {}
 
 FilamentEngine::~FilamentEngine()
@@ -54,6 +59,8 @@ void FilamentEngine::initialize(void* nativeWindow, int width, int height)
     // 调整视图大小
     filament::Viewport viewport(0, 0, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
     m_view->setViewport(viewport);
+    m_width = width;
+    m_height = height;
     
     // 设置清除选项
     filament::Renderer::ClearOptions clearOptions;
@@ -147,24 +154,23 @@ void FilamentEngine::render()
 
 void FilamentEngine::resize(int width, int height)
 {
+    if (width <= 0 || height <= 0 || (width == m_width && height == m_height)) {
+        return;
+    }
+    m_width = width;
+    m_height = height;
+
     if (m_view) {
         filament::Viewport viewport(0, 0, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
         m_view->setViewport(viewport);
     }
 
+    // 保持当前的视野和裁剪面，只更新宽高比
     if (m_camera) {
-        setCameraProjection(45.0f, static_cast<float>(width) / static_cast<float>(height), 0.1f, 1000.0f);
+        setCameraProjection(m_fov, static_cast<float>(width) / static_cast<float>(height), m_near, m_far);
     }
     
-    // 在窗口大小变化较大时（如最大化），重新创建交换链
-    if (m_engine && m_nativeWindow && m_swapChain) {
-        // 销毁旧的交换链
-        m_engine->destroy(m_swapChain);
-        m_swapChain = nullptr;
-        
-        // 创建新的交换链
-        m_swapChain = m_engine->createSwapChain(m_nativeWindow);
-    }
+    // 基于原生窗口的交换链由后端跟随窗口大小，不需要重新创建
 }
 
 void FilamentEngine::setCameraPosition(const filament::math::float3& position)
@@ -184,8 +190,18 @@ void FilamentEngine::setCameraTarget(const filament::math::float3& target)
     }
 }
 
+void FilamentEngine::setCameraLookAt(const filament::math::float3& position, const filament::math::float3& target, const filament::math::float3& up)
+{
+    if (m_camera) {
+        m_camera->lookAt(position, target, up);
+    }
+}
+
 void FilamentEngine::setCameraProjection(float fov, float aspect, float near, float far)
 {
+    m_fov = fov;
+    m_near = near;
+    m_far = far;
     if (m_camera) {
         m_camera->setProjection(fov, aspect, near, far, filament::Camera::Fov::VERTICAL);
     }
@@ -18,7 +18,14 @@ private:
     filament::View* m_view;
     filament::Camera* m_camera;
     filament::SwapChain* m_swapChain;
-    void* m_nativeWindow; // 存储原生窗口句柄，用于重新创建交换链
+    void* m_nativeWindow; // 原生窗口句柄
+
+    // 当前视口大小和投影参数，调整大小时只更新宽高比
+    int m_width;
+    int m_height;
+    float m_fov;
+    float m_near;
+    float m_far;
 
 public:
     FilamentEngine();
@@ -38,6 +45,7 @@ public:
 
     void setCameraPosition(const filament::math::float3& position);
     void setCameraTarget(const filament::math::float3& target);
+    void setCameraLookAt(const filament::math::float3& position, const filament::math::float3& target, const filament::math::float3& up);
     void setCameraProjection(float fov, float aspect, float near, float far);
 };
 
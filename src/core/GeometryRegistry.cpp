@@ -0,0 +1,244 @@
+#include "GeometryRegistry.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace Kazia {
+
+namespace {
+
+// FNV-1a 64 位哈希
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+} // namespace
+
+bool GeometryRegistry::Geometry::isQuantized() const {
+    return dequantizeScale != 1.0f || dequantizeOffset.x != 0.0f || dequantizeOffset.y != 0.0f || dequantizeOffset.z != 0.0f;
+}
+
+math::mat4f GeometryRegistry::Geometry::getDequantizeMatrix() const {
+    math::mat4f dequantize = math::scaling({dequantizeScale, dequantizeScale, dequantizeScale});
+    dequantize.m[12] = dequantizeOffset.x;
+    dequantize.m[13] = dequantizeOffset.y;
+    dequantize.m[14] = dequantizeOffset.z;
+    return dequantize;
+}
+
+filament::Box GeometryRegistry::Geometry::getQuantizedBox() const {
+    if (!isQuantized()) {
+        return boundingBox;
+    }
+    float inverseScale = 1.0f / dequantizeScale;
+    filament::Box box;
+    box.center = {(boundingBox.center.x - dequantizeOffset.x) * inverseScale,
+                  (boundingBox.center.y - dequantizeOffset.y) * inverseScale,
+                  (boundingBox.center.z - dequantizeOffset.z) * inverseScale};
+    box.halfExtent = boundingBox.halfExtent * inverseScale;
+    return box;
+}
+
+GeometryRegistry::GeometryRegistry(filament::Engine* engine) : m_engine(engine) {
+}
+
+GeometryRegistry::~GeometryRegistry() {
+    clear();
+}
+
+const GeometryRegistry::Geometry* GeometryRegistry::acquire(Key key, const std::function<Geometry()>& builder) {
+    // 检查是否已存在
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        // 增加引用计数
+        it->second.refCount++;
+        m_stats.reuses++;
+        m_stats.savedBytes += it->second.geometry.byteSize;
+        return &it->second.geometry;
+    }
+
+    if (!builder) {
+        return nullptr;
+    }
+
+    // 创建并上传新几何体
+    Geometry geometry = builder();
+    if (!geometry.vertexBuffer || !geometry.indexBuffer) {
+        destroyGeometry(geometry);
+        return nullptr;
+    }
+
+    m_stats.uploads++;
+    m_stats.uploadedBytes += geometry.byteSize;
+    m_stats.liveGeometries++;
+
+    auto result = m_entries.emplace(key, Entry{geometry, 1});
+    return &result.first->second.geometry;
+}
+
+void GeometryRegistry::release(Key key) {
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    // 减少引用计数
+    it->second.refCount--;
+
+    // 如果引用计数为 0，销毁缓冲区并从注册表中移除
+    if (it->second.refCount <= 0) {
+        destroyGeometry(it->second.geometry);
+        m_entries.erase(it);
+        m_stats.liveGeometries--;
+    }
+}
+
+const GeometryRegistry::Geometry* GeometryRegistry::find(Key key) const {
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        return &it->second.geometry;
+    }
+    return nullptr;
+}
+
+int GeometryRegistry::getRefCount(Key key) const {
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        return it->second.refCount;
+    }
+    return 0;
+}
+
+void GeometryRegistry::resetStats() {
+    size_t liveGeometries = m_stats.liveGeometries;
+    m_stats = Stats();
+    m_stats.liveGeometries = liveGeometries;
+}
+
+void GeometryRegistry::clear() {
+    for (auto& item : m_entries) {
+        destroyGeometry(item.second.geometry);
+    }
+    m_entries.clear();
+    m_stats.liveGeometries = 0;
+}
+
+GeometryRegistry::Key GeometryRegistry::makeProceduralKey(const std::string& kind, std::initializer_list<float> params) {
+    uint64_t hash = hashBytes(FNV_OFFSET_BASIS, kind.data(), kind.size());
+
+    // 类型名与参数之间加入分隔符，避免不同类型的键拼接后相同
+    const char separator = '\0';
+    hash = hashBytes(hash, &separator, 1);
+
+    for (float param : params) {
+        // +0.0 与 -0.0 视为相同参数
+        if (param == 0.0f) {
+            param = 0.0f;
+        }
+        hash = hashBytes(hash, &param, sizeof(param));
+    }
+    return hash;
+}
+
+GeometryRegistry::Key GeometryRegistry::makePrimitiveKey(const PrimitiveDesc& desc, uint32_t variant) {
+    PrimitiveDesc normalized = PrimitiveGenerator::normalize(desc);
+    return makeProceduralKey(PrimitiveGenerator::getName(normalized.type), {
+        normalized.size, normalized.height, normalized.minorRadius,
+        static_cast<float>(normalized.segments), static_cast<float>(normalized.rings),
+        static_cast<float>(normalized.subdivisions), static_cast<float>(variant)});
+}
+
+GeometryRegistry::Key GeometryRegistry::makeContentKey(const void* vertexData, size_t vertexBytes, const void* indexData, size_t indexBytes,
+                                                       uint32_t variant) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+    hash = hashBytes(hash, &variant, sizeof(variant));
+    hash = hashBytes(hash, &vertexBytes, sizeof(vertexBytes));
+    hash = hashBytes(hash, vertexData, vertexBytes);
+    hash = hashBytes(hash, &indexBytes, sizeof(indexBytes));
+    hash = hashBytes(hash, indexData, indexBytes);
+    return hash;
+}
+
+filament::backend::BufferDescriptor GeometryRegistry::makeBufferDescriptor(const void* data, size_t size) {
+    void* copy = std::malloc(size);
+    std::memcpy(copy, data, size);
+    return adoptBufferDescriptor(copy, size);
+}
+
+filament::backend::BufferDescriptor GeometryRegistry::adoptBufferDescriptor(void* data, size_t size) {
+    return filament::backend::BufferDescriptor(data, size,
+        [](void* buffer, size_t, void*) { std::free(buffer); });
+}
+
+filament::VertexBuffer* GeometryRegistry::buildVertexBuffer(filament::Engine* engine, const PackedVertices& packed) {
+    using AttributeType = filament::VertexBuffer::AttributeType;
+    bool compact = packed.format != VertexFormat::Float;
+    AttributeType positionType = packed.format == VertexFormat::Float ? AttributeType::FLOAT3
+                               : packed.format == VertexFormat::CompactHalf ? AttributeType::HALF4
+                               : AttributeType::SHORT4;
+
+    filament::VertexBuffer::Builder builder;
+    builder.vertexCount(packed.vertexCount)
+        .bufferCount(1)
+        .attribute(filament::VertexAttribute::POSITION, 0, positionType, packed.positionOffset, packed.stride);
+    if (packed.format == VertexFormat::CompactSnorm) {
+        builder.normalized(filament::VertexAttribute::POSITION);
+    }
+    if (packed.hasTangents) {
+        builder.attribute(filament::VertexAttribute::TANGENTS, 0, compact ? AttributeType::BYTE4 : AttributeType::FLOAT4,
+                          packed.tangentOffset, packed.stride);
+        if (compact) {
+            builder.normalized(filament::VertexAttribute::TANGENTS);
+        }
+    }
+    if (packed.hasUvs) {
+        builder.attribute(filament::VertexAttribute::UV0, 0, compact ? AttributeType::HALF2 : AttributeType::FLOAT2,
+                          packed.uvOffset, packed.stride);
+    }
+
+    filament::VertexBuffer* vertexBuffer = builder.build(*engine);
+    vertexBuffer->setBufferAt(*engine, 0, makeBufferDescriptor(packed.data.data(), packed.data.size()));
+    return vertexBuffer;
+}
+
+filament::IndexBuffer* GeometryRegistry::buildIndexBuffer(filament::Engine* engine, const uint32_t* indices, size_t indexCount, bool shortIndices) {
+    filament::IndexBuffer* indexBuffer = filament::IndexBuffer::Builder()
+        .indexCount(static_cast<uint32_t>(indexCount))
+        .bufferType(shortIndices ? filament::IndexBuffer::IndexType::USHORT : filament::IndexBuffer::IndexType::UINT)
+        .build(*engine);
+
+    // 16 位索引直接转换到待上传的内存中
+    if (shortIndices) {
+        uint16_t* data = static_cast<uint16_t*>(std::malloc(indexCount * sizeof(uint16_t)));
+        for (size_t i = 0; i < indexCount; ++i) {
+            data[i] = static_cast<uint16_t>(indices[i]);
+        }
+        indexBuffer->setBuffer(*engine, adoptBufferDescriptor(data, indexCount * sizeof(uint16_t)));
+    } else {
+        indexBuffer->setBuffer(*engine, makeBufferDescriptor(indices, indexCount * sizeof(uint32_t)));
+    }
+    return indexBuffer;
+}
+
+void GeometryRegistry::destroyGeometry(Geometry& geometry) {
+    if (m_engine) {
+        if (geometry.vertexBuffer) {
+            m_engine->destroy(geometry.vertexBuffer);
+        }
+        if (geometry.indexBuffer) {
+            m_engine->destroy(geometry.indexBuffer);
+        }
+    }
+    geometry.vertexBuffer = nullptr;
+    geometry.indexBuffer = nullptr;
+}
+
+} // namespace Kazia
@@ -0,0 +1,134 @@
+#ifndef GEOMETRYREGISTRY_H
+#define GEOMETRYREGISTRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <filament/Engine.h>
+#include <filament/Box.h>
+#include <filament/VertexBuffer.h>
+#include <filament/IndexBuffer.h>
+
+#include "MeshLod.h"
+#include "Meshlet.h"
+#include "MeshOptimizer.h"
+#include "PrimitiveGenerator.h"
+#include "VertexFormat.h"
+
+namespace Kazia {
+
+// 共享几何体注册表
+// 相同内容（或相同程序化参数）的几何体只上传一次，多个 Mesh / 可渲染对象共享同一对
+// VertexBuffer / IndexBuffer，最后一个使用者释放时才真正销毁
+class GeometryRegistry {
+public:
+    using Key = uint64_t;
+
+    // 共享的 GPU 几何体
+    struct Geometry {
+        filament::VertexBuffer* vertexBuffer = nullptr;
+        filament::IndexBuffer* indexBuffer = nullptr;
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        filament::Box boundingBox;
+
+        // 量化顶点的反量化参数：解码后的位置 * scale + offset 为网格局部坐标，boundingBox 在网格局部空间
+        float dequantizeScale = 1.0f;
+        math::float3 dequantizeOffset;
+
+        // 索引缓冲区中各级 LOD 的范围，为空表示只有一级（整个索引缓冲区）
+        std::vector<MeshLodLevel> lodLevels;
+
+        // 第 0 级的分簇（只有大型网格才划分），索引在 GPU 缓冲区中按相同顺序存放
+        MeshletSet clusters;
+
+        // 导入时优化的统计（程序化几何体为空）
+        MeshOptimizer::Report optimization;
+
+        // 上传到 GPU 的字节数（顶点 + 索引），用于统计
+        size_t byteSize = 0;
+
+        // 量化顶点需要在世界变换之前乘以反量化变换，Filament 的包围盒也在量化空间中
+        bool isQuantized() const;
+        math::mat4f getDequantizeMatrix() const;
+        filament::Box getQuantizedBox() const;
+    };
+
+    // 统计信息
+    struct Stats {
+        size_t uploads = 0;         // 实际上传次数
+        size_t reuses = 0;          // 命中缓存次数
+        size_t uploadedBytes = 0;   // 实际上传的字节数
+        size_t savedBytes = 0;      // 因复用而避免的上传字节数
+        size_t liveGeometries = 0;  // 当前存活的几何体数量
+    };
+
+private:
+    struct Entry {
+        Geometry geometry;
+        int refCount;
+    };
+
+    filament::Engine* m_engine;
+    std::unordered_map<Key, Entry> m_entries;
+    Stats m_stats;
+
+public:
+    GeometryRegistry(filament::Engine* engine);
+    ~GeometryRegistry();
+
+    GeometryRegistry(const GeometryRegistry&) = delete;
+    GeometryRegistry& operator=(const GeometryRegistry&) = delete;
+
+    // 获取几何体：命中则增加引用计数，否则调用 builder 创建并上传
+    // builder 返回的缓冲区所有权转移给注册表
+    const Geometry* acquire(Key key, const std::function<Geometry()>& builder);
+
+    // 释放几何体，引用计数归零时销毁缓冲区
+    void release(Key key);
+
+    // 查询
+    const Geometry* find(Key key) const;
+    int getRefCount(Key key) const;
+
+    // 统计
+    const Stats& getStats() const { return m_stats; }
+    void resetStats();
+
+    // 销毁所有几何体（不论引用计数）
+    void clear();
+
+    // 键生成：程序化几何体按类型名和参数，导入几何体按内容哈希
+    static Key makeProceduralKey(const std::string& kind, std::initializer_list<float> params);
+    // 按规范化后的参数元组生成，variant 区分不同的顶点布局
+    static Key makePrimitiveKey(const PrimitiveDesc& desc, uint32_t variant = 0);
+    // variant 区分同一内容的不同上传方式（例如顶点格式）
+    static Key makeContentKey(const void* vertexData, size_t vertexBytes, const void* indexData, size_t indexBytes,
+                              uint32_t variant = 0);
+
+    // 复制数据到堆内存，由 Filament 上传完成后回调释放
+    // 调用方的数据因此不需要在异步上传期间保持有效
+    static filament::backend::BufferDescriptor makeBufferDescriptor(const void* data, size_t size);
+
+    // 接管 std::malloc 分配的内存，不复制，上传完成后由回调释放
+    // 适合把数据直接生成到待上传的内存中
+    static filament::backend::BufferDescriptor adoptBufferDescriptor(void* data, size_t size);
+
+    // 按打包格式创建顶点缓冲区，紧凑格式使用归一化属性，由硬件在读取时解码
+    static filament::VertexBuffer* buildVertexBuffer(filament::Engine* engine, const PackedVertices& packed);
+
+    // 创建索引缓冲区，shortIndices 时转换为 16 位索引
+    static filament::IndexBuffer* buildIndexBuffer(filament::Engine* engine, const uint32_t* indices, size_t indexCount, bool shortIndices);
+
+private:
+    void destroyGeometry(Geometry& geometry);
+};
+
+} // namespace Kazia
+
+#endif // GEOMETRYREGISTRY_H
@@ -1,10 +1,13 @@
 #include "GltfLoader.h"
 
 #include "AssetManager.h"
+#include "AsyncFileReader.h"
 #include "Mesh.h"
 
 #include <tiny_gltf.h>
 
+#include <cstring>
+#include <limits>
 #include <fstream>
 #include <sstream>
 #include <filesystem>
@@ -16,11 +19,39 @@ GltfLoader::GltfLoader(filament::Engine* engine, AssetManager* assetManager)
       m_assetManager(assetManager) {
 }
 
+GltfLoader::~GltfLoader() = default;
+
 bool GltfLoader::loadFromFile(const std::string& path, std::vector<std::shared_ptr<Mesh>>& meshes) {
-    return parseGltfFile(path, meshes);
+    std::vector<std::vector<std::shared_ptr<Mesh>>> loaded;
+    bool ret = loadFromFiles({path}, loaded);
+    meshes.insert(meshes.end(), loaded[0].begin(), loaded[0].end());
+    return ret;
 }
 
-bool GltfLoader::parseGltfFile(const std::string& path, std::vector<std::shared_ptr<Mesh>>& meshes) {
+bool GltfLoader::loadFromFiles(const std::vector<std::string>& paths, std::vector<std::vector<std::shared_ptr<Mesh>>>& meshes) {
+    if (!m_reader) {
+        m_reader = std::make_unique<AsyncFileReader>();
+    }
+    
+    // 回调在 wait 的调用线程上执行，解析先读完的文件时其余文件的读取仍在进行
+    meshes.assign(paths.size(), {});
+    bool allLoaded = true;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        m_reader->readFile(paths[i], [this, &meshes, &allLoaded, i](const AsyncFileReader::Result& result) {
+            if (result.error != 0 || result.size == 0) {
+                std::cout << "GLTF Loader Error: " << *result.path << ": "
+                          << (result.error != 0 ? std::strerror(result.error) : "empty file") << std::endl;
+                allLoaded = false;
+                return;
+            }
+            allLoaded &= parseGltfFile(*result.path, result.data, result.size, meshes[i]);
+        });
+    }
+    m_reader->wait();
+    return allLoaded;
+}
+
+bool GltfLoader::parseGltfFile(const std::string& path, const uint8_t* data, size_t size, std::vector<std::shared_ptr<Mesh>>& meshes) {
     tinygltf::Model model;
     tinygltf::TinyGLTF loader;
     std::string err;
@@ -29,12 +60,20 @@ bool GltfLoader::parseGltfFile(const std::string& path, std::vector<std::shared_
     // 解析 glTF 文件
     std::filesystem::path filePath(path);
     std::string extension = filePath.extension().string();
+    std::string baseDir = filePath.parent_path().string();
+    
+    // tinygltf 的长度参数是 unsigned int，超过 4 GB 的文件会被截断，直接拒绝
+    if (size > std::numeric_limits<unsigned int>::max()) {
+        std::cout << "GLTF Loader Error: " << path << " is larger than 4 GB (" << size << " bytes)" << std::endl;
+        return false;
+    }
+    unsigned int length = static_cast<unsigned int>(size);
     
     bool ret = false;
     if (extension == ".gltf") {
-        ret = loader.LoadASCIIFromFile(&model, &err, &warn, path.c_str());
+        ret = loader.LoadASCIIFromString(&model, &err, &warn, reinterpret_cast<const char*>(data), length, baseDir);
     } else if (extension == ".glb") {
-        ret = loader.LoadBinaryFromFile(&model, &err, &warn, path.c_str());
+        ret = loader.LoadBinaryFromMemory(&model, &err, &warn, data, length, baseDir);
     }
     
     if (!warn.empty()) {
@@ -49,8 +88,7 @@ bool GltfLoader::parseGltfFile(const std::string& path, std::vector<std::shared_
     }
     
     // 加载纹理
-    std::string basePath = filePath.parent_path().string();
-    loadTextures(basePath, nullptr, 0);
+    loadTextures(baseDir, nullptr, 0);
     
     // 加载材质
     loadMaterials(nullptr, 0);
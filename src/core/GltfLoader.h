@@ -1,6 +1,7 @@
 #ifndef GLTFLOADER_H
 #define GLTFLOADER_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
@@ -11,22 +12,28 @@ namespace Kazia {
 
 class Mesh;
 class AssetManager;
+class AsyncFileReader;
 
 class GltfLoader {
 private:
     filament::Engine* m_engine;
     AssetManager* m_assetManager;
+    std::unique_ptr<AsyncFileReader> m_reader;  // 首次批量加载时创建
     
 public:
     GltfLoader(filament::Engine* engine, AssetManager* assetManager);
-    ~GltfLoader() = default;
+    ~GltfLoader();
     
     // 加载 glTF 文件
     bool loadFromFile(const std::string& path, std::vector<std::shared_ptr<Mesh>>& meshes);
     
+    // 批量加载 glTF 文件：主文件一次性提交异步读取，每个文件读完即在调用线程上解析；
+    // meshes[i] 对应 paths[i]，全部成功时返回 true
+    bool loadFromFiles(const std::vector<std::string>& paths, std::vector<std::vector<std::shared_ptr<Mesh>>>& meshes);
+    
 private:
-    // 解析 glTF 文件
-    bool parseGltfFile(const std::string& path, std::vector<std::shared_ptr<Mesh>>& meshes);
+    // 解析内存中的 glTF 文件，外部 buffer 和图片按 path 所在目录由 tinygltf 读取
+    bool parseGltfFile(const std::string& path, const uint8_t* data, size_t size, std::vector<std::shared_ptr<Mesh>>& meshes);
     
     // 加载纹理
     bool loadTextures(const std::string& basePath, const void* gltfData, size_t gltfSize);
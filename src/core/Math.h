@@ -1,6 +1,10 @@
 #ifndef MATH_H
 #define MATH_H
 
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
 namespace Kazia {
 
 namespace math {
@@ -47,7 +51,14 @@ struct float3 {
     }
 };
 
-// 4x4 矩阵
+// 4D 向量
+struct float4 {
+    float x, y, z, w;
+    
+    float4(float x = 0.0f, float y = 0.0f, float z = 0.0f, float w = 0.0f) : x(x), y(y), z(z), w(w) {}
+};
+
+// 4x4 矩阵（列主序，平移位于 m[12]、m[13]、m[14]）
 struct mat4f {
     float m[16];
     
@@ -59,6 +70,420 @@ struct mat4f {
     }
 };
 
+// 向量辅助函数
+inline float dot(const float3& a, const float3& b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+inline float3 cross(const float3& a, const float3& b) {
+    return float3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+inline float length(const float3& v) {
+    return std::sqrt(dot(v, v));
+}
+
+inline float3 normalize(const float3& v) {
+    float len = length(v);
+    return len > 0.0f ? v / len : v;
+}
+
+inline float3 componentMin(const float3& a, const float3& b) {
+    return float3(a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y, a.z < b.z ? a.z : b.z);
+}
+
+inline float3 componentMax(const float3& a, const float3& b) {
+    return float3(a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y, a.z > b.z ? a.z : b.z);
+}
+
+// 轴对齐包围盒，默认构造为空盒
+struct aabb {
+    float3 min;
+    float3 max;
+    
+    aabb()
+        : min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()),
+          max(-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()) {}
+    
+    aabb(const float3& minPoint, const float3& maxPoint) : min(minPoint), max(maxPoint) {}
+    
+    bool isEmpty() const {
+        return min.x > max.x || min.y > max.y || min.z > max.z;
+    }
+    
+    float3 center() const {
+        return (min + max) * 0.5f;
+    }
+    
+    // 半尺寸
+    float3 extent() const {
+        return (max - min) * 0.5f;
+    }
+    
+    float surfaceArea() const {
+        float3 d = max - min;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+    
+    void merge(const float3& point) {
+        min = componentMin(min, point);
+        max = componentMax(max, point);
+    }
+    
+    void merge(const aabb& other) {
+        min = componentMin(min, other.min);
+        max = componentMax(max, other.max);
+    }
+    
+    bool contains(const aabb& other) const {
+        return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+               other.max.x <= max.x && other.max.y <= max.y && other.max.z <= max.z;
+    }
+    
+    bool intersects(const aabb& other) const {
+        return min.x <= other.max.x && other.min.x <= max.x &&
+               min.y <= other.max.y && other.min.y <= max.y &&
+               min.z <= other.max.z && other.min.z <= max.z;
+    }
+    
+    static aabb unionOf(const aabb& a, const aabb& b) {
+        return aabb(componentMin(a.min, b.min), componentMax(a.max, b.max));
+    }
+};
+
+// 包围球
+struct sphere {
+    float3 center;
+    float radius;
+    
+    sphere(const float3& c = float3(), float r = 0.0f) : center(c), radius(r) {}
+    
+    // 包围盒的外接球
+    static sphere fromAabb(const aabb& box) {
+        return sphere(box.center(), length(box.extent()));
+    }
+};
+
+// 矩阵乘法 a * b（列主序）
+inline mat4f multiply(const mat4f& a, const mat4f& b) {
+    mat4f result;
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            result.m[col * 4 + row] =
+                a.m[0 * 4 + row] * b.m[col * 4 + 0] +
+                a.m[1 * 4 + row] * b.m[col * 4 + 1] +
+                a.m[2 * 4 + row] * b.m[col * 4 + 2] +
+                a.m[3 * 4 + row] * b.m[col * 4 + 3];
+        }
+    }
+    return result;
+}
+
+// 平移矩阵
+inline mat4f translation(const float3& t) {
+    mat4f result;
+    result.m[12] = t.x;
+    result.m[13] = t.y;
+    result.m[14] = t.z;
+    return result;
+}
+
+// 缩放矩阵
+inline mat4f scaling(const float3& s) {
+    mat4f result;
+    result.m[0] = s.x;
+    result.m[5] = s.y;
+    result.m[10] = s.z;
+    return result;
+}
+
+// 欧拉角旋转矩阵（角度制，依次绕 X、Y、Z 轴旋转，即 Rz * Ry * Rx）
+inline mat4f rotationEulerDegrees(const float3& degrees) {
+    const float toRadians = 3.14159265358979323846f / 180.0f;
+    float cx = std::cos(degrees.x * toRadians), sx = std::sin(degrees.x * toRadians);
+    float cy = std::cos(degrees.y * toRadians), sy = std::sin(degrees.y * toRadians);
+    float cz = std::cos(degrees.z * toRadians), sz = std::sin(degrees.z * toRadians);
+    
+    mat4f result;
+    result.m[0] = cy * cz;
+    result.m[1] = cy * sz;
+    result.m[2] = -sy;
+    result.m[4] = sx * sy * cz - cx * sz;
+    result.m[5] = sx * sy * sz + cx * cz;
+    result.m[6] = sx * cy;
+    result.m[8] = cx * sy * cz + sx * sz;
+    result.m[9] = cx * sy * sz - sx * cz;
+    result.m[10] = cx * cy;
+    return result;
+}
+
+// 由平移、旋转（角度制欧拉角）、缩放组合变换矩阵 T * R * S
+inline mat4f composeTRS(const float3& t, const float3& rotationDegrees, const float3& s) {
+    mat4f result = rotationEulerDegrees(rotationDegrees);
+    for (int i = 0; i < 3; i++) {
+        result.m[i] *= s.x;
+        result.m[4 + i] *= s.y;
+        result.m[8 + i] *= s.z;
+    }
+    result.m[12] = t.x;
+    result.m[13] = t.y;
+    result.m[14] = t.z;
+    return result;
+}
+
+// 观察矩阵（右手坐标系，相机朝向 -Z）
+inline mat4f lookAt(const float3& eye, const float3& target, const float3& up) {
+    float3 forward = normalize(target - eye);
+    float3 side = normalize(cross(forward, up));
+    float3 upAxis = cross(side, forward);
+    
+    mat4f result;
+    result.m[0] = side.x;
+    result.m[4] = side.y;
+    result.m[8] = side.z;
+    result.m[1] = upAxis.x;
+    result.m[5] = upAxis.y;
+    result.m[9] = upAxis.z;
+    result.m[2] = -forward.x;
+    result.m[6] = -forward.y;
+    result.m[10] = -forward.z;
+    result.m[12] = -dot(side, eye);
+    result.m[13] = -dot(upAxis, eye);
+    result.m[14] = dot(forward, eye);
+    return result;
+}
+
+// 透视投影矩阵（垂直视场角，角度制，OpenGL 裁剪空间约定）
+inline mat4f perspective(float fovDegrees, float aspect, float nearPlane, float farPlane) {
+    float f = 1.0f / std::tan(fovDegrees * 3.14159265358979323846f / 360.0f);
+    
+    mat4f result;
+    result.m[0] = f / aspect;
+    result.m[5] = f;
+    result.m[10] = (farPlane + nearPlane) / (nearPlane - farPlane);
+    result.m[11] = -1.0f;
+    result.m[14] = 2.0f * farPlane * nearPlane / (nearPlane - farPlane);
+    result.m[15] = 0.0f;
+    return result;
+}
+
+// 通用 4x4 矩阵求逆，矩阵奇异时返回 false
+inline bool inverse(const mat4f& mat, mat4f& result) {
+    const float* m = mat.m;
+    float inv[16];
+    
+    inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+    inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+    inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+    inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+    inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+    inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+    inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+    inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+    inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+    inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+    inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+    inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+    inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+    inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+    inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+    inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+    
+    float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+    if (det == 0.0f) {
+        return false;
+    }
+    
+    float invDet = 1.0f / det;
+    for (int i = 0; i < 16; i++) {
+        result.m[i] = inv[i] * invDet;
+    }
+    return true;
+}
+
+// 变换齐次坐标点并做透视除法
+inline float3 transformProject(const mat4f& mat, const float3& p) {
+    float w = mat.m[3] * p.x + mat.m[7] * p.y + mat.m[11] * p.z + mat.m[15];
+    float invW = w != 0.0f ? 1.0f / w : 0.0f;
+    return float3(
+        (mat.m[0] * p.x + mat.m[4] * p.y + mat.m[8] * p.z + mat.m[12]) * invW,
+        (mat.m[1] * p.x + mat.m[5] * p.y + mat.m[9] * p.z + mat.m[13]) * invW,
+        (mat.m[2] * p.x + mat.m[6] * p.y + mat.m[10] * p.z + mat.m[14]) * invW);
+}
+
+// 变换点（w = 1）
+inline float3 transformPoint(const mat4f& mat, const float3& p) {
+    return float3(
+        mat.m[0] * p.x + mat.m[4] * p.y + mat.m[8] * p.z + mat.m[12],
+        mat.m[1] * p.x + mat.m[5] * p.y + mat.m[9] * p.z + mat.m[13],
+        mat.m[2] * p.x + mat.m[6] * p.y + mat.m[10] * p.z + mat.m[14]);
+}
+
+// 变换方向（w = 0）
+inline float3 transformDirection(const mat4f& mat, const float3& d) {
+    return float3(
+        mat.m[0] * d.x + mat.m[4] * d.y + mat.m[8] * d.z,
+        mat.m[1] * d.x + mat.m[5] * d.y + mat.m[9] * d.z,
+        mat.m[2] * d.x + mat.m[6] * d.y + mat.m[10] * d.z);
+}
+
+// 变换包围盒（Arvo 方法，结果为变换后 8 个角点的包围盒）
+inline aabb transformAabb(const mat4f& mat, const aabb& box) {
+    if (box.isEmpty()) {
+        return box;
+    }
+    
+    float3 center = transformPoint(mat, box.center());
+    float3 e = box.extent();
+    float3 extent(
+        std::fabs(mat.m[0]) * e.x + std::fabs(mat.m[4]) * e.y + std::fabs(mat.m[8]) * e.z,
+        std::fabs(mat.m[1]) * e.x + std::fabs(mat.m[5]) * e.y + std::fabs(mat.m[9]) * e.z,
+        std::fabs(mat.m[2]) * e.x + std::fabs(mat.m[6]) * e.y + std::fabs(mat.m[10]) * e.z);
+    return aabb(center - extent, center + extent);
+}
+
+// 最大的轴缩放（列主序，前三列的长度为各轴缩放）
+inline float maxAxisScale(const mat4f& mat) {
+    float scale = 0.0f;
+    for (int column = 0; column < 3; ++column) {
+        const float* axis = &mat.m[column * 4];
+        float axisScale = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        scale = axisScale > scale ? axisScale : scale;
+    }
+    return scale;
+}
+
+// 变换包围球：半径乘以最大的轴缩放，非均匀缩放时偏大；scale 非空时输出该缩放
+inline sphere transformSphere(const mat4f& mat, const sphere& s, float* scale = nullptr) {
+    float axisScale = maxAxisScale(mat);
+    if (scale) {
+        *scale = axisScale;
+    }
+    return sphere(transformPoint(mat, s.center), s.radius * axisScale);
+}
+
+// 射线，预先计算方向倒数供 slab 检测使用
+struct ray {
+    float3 origin;
+    float3 direction;
+    float3 invDirection;
+    
+    ray() {}
+    
+    ray(const float3& o, const float3& d)
+        : origin(o), direction(d), invDirection(1.0f / d.x, 1.0f / d.y, 1.0f / d.z) {}
+    
+    float3 at(float t) const {
+        return origin + direction * t;
+    }
+    
+    // slab 检测，命中区间与 [0, tMax] 相交时返回 true，tNear 为进入参数
+    bool intersects(const aabb& box, float tMax, float& tNear) const {
+        float tx1 = (box.min.x - origin.x) * invDirection.x;
+        float tx2 = (box.max.x - origin.x) * invDirection.x;
+        float t0 = tx1 < tx2 ? tx1 : tx2;
+        float t1 = tx1 < tx2 ? tx2 : tx1;
+        
+        float ty1 = (box.min.y - origin.y) * invDirection.y;
+        float ty2 = (box.max.y - origin.y) * invDirection.y;
+        t0 = std::fmax(t0, ty1 < ty2 ? ty1 : ty2);
+        t1 = std::fmin(t1, ty1 < ty2 ? ty2 : ty1);
+        
+        float tz1 = (box.min.z - origin.z) * invDirection.z;
+        float tz2 = (box.max.z - origin.z) * invDirection.z;
+        t0 = std::fmax(t0, tz1 < tz2 ? tz1 : tz2);
+        t1 = std::fmin(t1, tz1 < tz2 ? tz2 : tz1);
+        
+        t0 = std::fmax(t0, 0.0f);
+        t1 = std::fmin(t1, tMax);
+        tNear = t0;
+        return t0 <= t1;
+    }
+};
+
+// 视锥体（6 个平面，法线指向内侧，已归一化）
+struct frustum {
+    enum Plane { LEFT = 0, RIGHT, BOTTOM, TOP, NEAR_PLANE, FAR_PLANE, PLANE_COUNT };
+    
+    // 包围盒与视锥体的关系
+    enum class Result { OUTSIDE, INTERSECTS, INSIDE };
+    
+    static constexpr uint32_t ALL_PLANES = (1u << PLANE_COUNT) - 1;
+    
+    float4 planes[PLANE_COUNT];
+    
+    // 从视图投影矩阵提取平面（Gribb-Hartmann，OpenGL 裁剪空间约定）
+    static frustum fromMatrix(const mat4f& viewProjection) {
+        const float* m = viewProjection.m;
+        
+        // 矩阵的第 i 行
+        auto row = [m](int i) { return float4(m[i], m[4 + i], m[8 + i], m[12 + i]); };
+        float4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+        
+        frustum result;
+        result.planes[LEFT] = float4(r3.x + r0.x, r3.y + r0.y, r3.z + r0.z, r3.w + r0.w);
+        result.planes[RIGHT] = float4(r3.x - r0.x, r3.y - r0.y, r3.z - r0.z, r3.w - r0.w);
+        result.planes[BOTTOM] = float4(r3.x + r1.x, r3.y + r1.y, r3.z + r1.z, r3.w + r1.w);
+        result.planes[TOP] = float4(r3.x - r1.x, r3.y - r1.y, r3.z - r1.z, r3.w - r1.w);
+        result.planes[NEAR_PLANE] = float4(r3.x + r2.x, r3.y + r2.y, r3.z + r2.z, r3.w + r2.w);
+        result.planes[FAR_PLANE] = float4(r3.x - r2.x, r3.y - r2.y, r3.z - r2.z, r3.w - r2.w);
+        
+        for (int i = 0; i < PLANE_COUNT; i++) {
+            float4& p = result.planes[i];
+            float length = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+            if (length > 0.0f) {
+                p = float4(p.x / length, p.y / length, p.z / length, p.w / length);
+            }
+        }
+        return result;
+    }
+    
+    // 检测包围盒与视锥体的关系
+    // planeMask 为仍需检测的平面，完全位于某平面内侧时清除对应位，子节点可跳过该平面
+    Result classify(const aabb& box, uint32_t& planeMask) const {
+        float3 c = box.center();
+        float3 e = box.extent();
+        Result result = Result::INSIDE;
+        
+        for (int i = 0; i < PLANE_COUNT; i++) {
+            uint32_t bit = 1u << i;
+            if (!(planeMask & bit)) {
+                continue;
+            }
+            
+            const float4& p = planes[i];
+            float d = p.x * c.x + p.y * c.y + p.z * c.z + p.w;
+            float r = std::fabs(p.x) * e.x + std::fabs(p.y) * e.y + std::fabs(p.z) * e.z;
+            
+            if (d + r < 0.0f) {
+                return Result::OUTSIDE;
+            }
+            if (d - r < 0.0f) {
+                result = Result::INTERSECTS;
+            } else {
+                planeMask &= ~bit;
+            }
+        }
+        return result;
+    }
+    
+    Result classify(const aabb& box) const {
+        uint32_t planeMask = ALL_PLANES;
+        return classify(box, planeMask);
+    }
+
+    // 球体是否与视锥体相交（保守判断，位于视锥体角外侧的球体也可能返回 true）
+    bool intersectsSphere(const float3& center, float radius) const {
+        for (int i = 0; i < PLANE_COUNT; i++) {
+            const float4& p = planes[i];
+            if (p.x * center.x + p.y * center.y + p.z * center.z + p.w < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
 } // namespace math
 
 } // namespace Kazia
@@ -4,11 +4,17 @@
 #include <filament/Material.h>
 #include <filament/MaterialInstance.h>
 
-Mesh::Mesh(filament::Engine* engine)
+#include <algorithm>
+#include <cstdlib>
+
+Mesh::Mesh(filament::Engine* engine, Kazia::GeometryRegistry* geometryRegistry)
     : m_engine(engine)
     , m_mesh(nullptr)
     , m_material(nullptr)
     , m_materialInstance(nullptr)
+    , m_geometryRegistry(geometryRegistry)
+    , m_geometryKey(0)
+    , m_hasGeometryKey(false)
 {
 }
 
@@ -28,109 +34,138 @@ void Mesh::cleanup()
         m_engine->destroy(m_mesh);
         m_mesh = nullptr;
     }
+
+    // 归还共享几何体
+    if (m_hasGeometryKey && m_geometryRegistry) {
+        m_geometryRegistry->release(m_geometryKey);
+        m_hasGeometryKey = false;
+    }
 }
 
-void Mesh::createCube(float size)
+namespace {
+
+// 上传程序化几何体：顶点（位置、法线、UV 交错）和索引直接生成到交给 Filament 的内存中，不经过中间拷贝
+Kazia::GeometryRegistry::Geometry uploadPrimitive(filament::Engine* engine, const Kazia::PrimitiveDesc& desc)
 {
-    cleanup();
+    Kazia::PrimitiveGenerator::Counts counts = Kazia::PrimitiveGenerator::count(desc);
+    bool shortIndices = counts.vertexCount <= 65536;
+    size_t vertexBytes = counts.vertexCount * sizeof(Kazia::PrimitiveVertex);
+    size_t indexBytes = counts.indexCount * (shortIndices ? sizeof(uint16_t) : sizeof(uint32_t));
+
+    auto* vertices = static_cast<Kazia::PrimitiveVertex*>(std::malloc(vertexBytes));
+    void* indices = std::malloc(indexBytes);
+    if (shortIndices) {
+        Kazia::PrimitiveGenerator::generate(desc, vertices, static_cast<uint16_t*>(indices));
+    } else {
+        Kazia::PrimitiveGenerator::generate(desc, vertices, static_cast<uint32_t*>(indices));
+    }
+
+    Kazia::math::aabb bounds = Kazia::PrimitiveGenerator::getBounds(desc);
+    Kazia::math::float3 center = bounds.center();
+    Kazia::math::float3 halfExtent = bounds.extent();
 
-    // 立方体顶点数据
-    struct Vertex {
-        filament::math::float3 position;
-        filament::math::float3 normal;
-        filament::math::float2 uv;
-    };
-
-    float halfSize = size * 0.5f;
-    Vertex vertices[] = {
-        // 前
-        {{-halfSize, -halfSize,  halfSize}, {0, 0, 1}, {0, 0}},
-        {{ halfSize, -halfSize,  halfSize}, {0, 0, 1}, {1, 0}},
-        {{ halfSize,  halfSize,  halfSize}, {0, 0, 1}, {1, 1}},
-        {{-halfSize,  halfSize,  halfSize}, {0, 0, 1}, {0, 1}},
-        // 后
-        {{-halfSize, -halfSize, -halfSize}, {0, 0, -1}, {0, 0}},
-        {{-halfSize,  halfSize, -halfSize}, {0, 0, -1}, {0, 1}},
-        {{ halfSize,  halfSize, -halfSize}, {0, 0, -1}, {1, 1}},
-        {{ halfSize, -halfSize, -halfSize}, {0, 0, -1}, {1, 0}},
-        // 左
-        {{-halfSize, -halfSize, -halfSize}, {-1, 0, 0}, {0, 0}},
-        {{-halfSize,  halfSize, -halfSize}, {-1, 0, 0}, {0, 1}},
-        {{-halfSize,  halfSize,  halfSize}, {-1, 0, 0}, {1, 1}},
-        {{-halfSize, -halfSize,  halfSize}, {-1, 0, 0}, {1, 0}},
-        // 右
-        {{ halfSize, -halfSize,  halfSize}, {1, 0, 0}, {0, 0}},
-        {{ halfSize,  halfSize,  halfSize}, {1, 0, 0}, {0, 1}},
-        {{ halfSize,  halfSize, -halfSize}, {1, 0, 0}, {1, 1}},
-        {{ halfSize, -halfSize, -halfSize}, {1, 0, 0}, {1, 0}},
-        // 下
-        {{-halfSize, -halfSize, -halfSize}, {0, -1, 0}, {0, 0}},
-        {{ halfSize, -halfSize, -halfSize}, {0, -1, 0}, {1, 0}},
-        {{ halfSize, -halfSize,  halfSize}, {0, -1, 0}, {1, 1}},
-        {{-halfSize, -halfSize,  halfSize}, {0, -1, 0}, {0, 1}},
-        // 上
-        {{-halfSize,  halfSize,  halfSize}, {0, 1, 0}, {0, 0}},
-        {{ halfSize,  halfSize,  halfSize}, {0, 1, 0}, {1, 0}},
-        {{ halfSize,  halfSize, -halfSize}, {0, 1, 0}, {1, 1}},
-        {{-halfSize,  halfSize, -halfSize}, {0, 1, 0}, {0, 1}}
-    };
-
-    // 立方体索引数据
-    uint16_t indices[] = {
-        0, 1, 2, 0, 2, 3,
-        4, 5, 6, 4, 6, 7,
-        8, 9, 10, 8, 10, 11,
-        12, 13, 14, 12, 14, 15,
-        16, 17, 18, 16, 18, 19,
-        20, 21, 22, 20, 22, 23
-    };
+    Kazia::GeometryRegistry::Geometry geometry;
+    geometry.vertexCount = counts.vertexCount;
+    geometry.indexCount = counts.indexCount;
+    geometry.boundingBox = {{center.x, center.y, center.z}, {halfExtent.x, halfExtent.y, halfExtent.z}};
+    geometry.byteSize = vertexBytes + indexBytes;
 
     // 创建顶点缓冲区
     filament::VertexBuffer::Builder vbBuilder(1);
-    vbBuilder.vertexCount(sizeof(vertices) / sizeof(Vertex));
-    vbBuilder.buffer(0, filament::VertexBuffer::Attribute::POSITION, filament::VertexBuffer::AttributeType::FLOAT3, offsetof(Vertex, position), sizeof(Vertex));
-    vbBuilder.buffer(0, filament::VertexBuffer::Attribute::NORMAL, filament::VertexBuffer::AttributeType::FLOAT3, offsetof(Vertex, normal), sizeof(Vertex));
-    vbBuilder.buffer(0, filament::VertexBuffer::Attribute::UV0, filament::VertexBuffer::AttributeType::FLOAT2, offsetof(Vertex, uv), sizeof(Vertex));
+    vbBuilder.vertexCount(geometry.vertexCount);
+    vbBuilder.buffer(0, filament::VertexBuffer::Attribute::POSITION, filament::VertexBuffer::AttributeType::FLOAT3, offsetof(Kazia::PrimitiveVertex, position), sizeof(Kazia::PrimitiveVertex));
+    vbBuilder.buffer(0, filament::VertexBuffer::Attribute::NORMAL, filament::VertexBuffer::AttributeType::FLOAT3, offsetof(Kazia::PrimitiveVertex, normal), sizeof(Kazia::PrimitiveVertex));
+    vbBuilder.buffer(0, filament::VertexBuffer::Attribute::UV0, filament::VertexBuffer::AttributeType::FLOAT2, offsetof(Kazia::PrimitiveVertex, uv), sizeof(Kazia::PrimitiveVertex));
 
-    auto vertexBuffer = vbBuilder.build(*m_engine);
-    vertexBuffer->setBufferAt(*m_engine, 0, filament::VertexBuffer::BufferDescriptor(vertices, sizeof(vertices)));
+    geometry.vertexBuffer = vbBuilder.build(*engine);
+    geometry.vertexBuffer->setBufferAt(*engine, 0, Kazia::GeometryRegistry::adoptBufferDescriptor(vertices, vertexBytes));
 
     // 创建索引缓冲区
-    auto indexBuffer = filament::IndexBuffer::Builder()
-        .indexCount(sizeof(indices) / sizeof(uint16_t))
-        .bufferType(filament::IndexBuffer::IndexType::USHORT)
-        .build(*m_engine);
+    geometry.indexBuffer = filament::IndexBuffer::Builder()
+        .indexCount(geometry.indexCount)
+        .bufferType(shortIndices ? filament::IndexBuffer::IndexType::USHORT : filament::IndexBuffer::IndexType::UINT)
+        .build(*engine);
+
+    geometry.indexBuffer->setBuffer(*engine, Kazia::GeometryRegistry::adoptBufferDescriptor(indices, indexBytes));
+
+    return geometry;
+}
+
+} // namespace
+
+void Mesh::createPrimitive(const Kazia::PrimitiveDesc& desc)
+{
+    cleanup();
+
+    // 有注册表时按参数元组共享几何体，参数相同的几何体只生成和上传一次
+    if (m_geometryRegistry) {
+        Kazia::GeometryRegistry::Key key = Kazia::GeometryRegistry::makePrimitiveKey(desc);
+        const Kazia::GeometryRegistry::Geometry* geometry = m_geometryRegistry->acquire(key, [this, &desc]() {
+            return uploadPrimitive(m_engine, desc);
+        });
+
+        if (geometry) {
+            m_geometryKey = key;
+            m_hasGeometryKey = true;
+            buildMesh(*geometry);
+        }
+        return;
+    }
+
+    Kazia::GeometryRegistry::Geometry geometry = uploadPrimitive(m_engine, desc);
+    buildMesh(geometry);
+
+    // 清理缓冲区引用
+    geometry.vertexBuffer->destroy();
+    geometry.indexBuffer->destroy();
+}
 
-    indexBuffer->setBuffer(*m_engine, filament::IndexBuffer::BufferDescriptor(indices, sizeof(indices)));
+void Mesh::createCube(float size)
+{
+    createPrimitive(Kazia::PrimitiveDesc::cube(size));
+}
 
+void Mesh::buildMesh(const Kazia::GeometryRegistry::Geometry& geometry)
+{
     // 创建网格
     m_mesh = filament::Mesh::Builder()
-        .vertexBuffer(0, vertexBuffer)
-        .indexBuffer(indexBuffer)
-        .boundingBox({{-halfSize, -halfSize, -halfSize}, {halfSize, halfSize, halfSize}})
+        .vertexBuffer(0, geometry.vertexBuffer)
+        .indexBuffer(geometry.indexBuffer)
+        .boundingBox(geometry.boundingBox)
         .build(*m_engine);
-
-    // 清理缓冲区引用
-    vertexBuffer->destroy();
-    indexBuffer->destroy();
 }
 
 void Mesh::createSphere(float radius, int segments)
 {
-    cleanup();
+    // 纬线分段数取经线的一半，四边形接近正方形
+    uint32_t count = static_cast<uint32_t>(std::max(segments, 3));
+    createPrimitive(Kazia::PrimitiveDesc::uvSphere(radius, count, std::max(count / 2, 2u)));
+}
 
-    // 简化实现，实际项目中可能需要更复杂的球体生成算法
-    // 这里使用立方体并细分
-    createCube(radius * 2.0f);
+void Mesh::createIcoSphere(float radius, int subdivisions)
+{
+    createPrimitive(Kazia::PrimitiveDesc::icoSphere(radius, static_cast<uint32_t>(std::max(subdivisions, 0))));
 }
 
 void Mesh::createCylinder(float radius, float height, int segments)
 {
-    cleanup();
+    createPrimitive(Kazia::PrimitiveDesc::cylinder(radius, height, static_cast<uint32_t>(std::max(segments, 3))));
+}
+
+void Mesh::createCone(float radius, float height, int segments)
+{
+    createPrimitive(Kazia::PrimitiveDesc::cone(radius, height, static_cast<uint32_t>(std::max(segments, 3))));
+}
 
-    // 简化实现，实际项目中可能需要更复杂的圆柱体生成算法
-    // 这里使用立方体并缩放
-    createCube(radius * 2.0f);
+void Mesh::createTorus(float majorRadius, float minorRadius, int segments, int rings)
+{
+    createPrimitive(Kazia::PrimitiveDesc::torus(majorRadius, minorRadius, static_cast<uint32_t>(std::max(segments, 3)),
+                                                static_cast<uint32_t>(std::max(rings, 3))));
+}
+
+void Mesh::createPlane(float size, int subdivisions)
+{
+    createPrimitive(Kazia::PrimitiveDesc::plane(size, static_cast<uint32_t>(std::max(subdivisions, 1))));
 }
 
 void Mesh::setMaterial(filament::Material* material)
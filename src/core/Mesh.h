@@ -5,6 +5,9 @@
 #include <filament/Material.h>
 #include <filament/Mesh.h>
 
+#include "GeometryRegistry.h"
+#include "PrimitiveGenerator.h"
+
 class Mesh
 {
 private:
@@ -13,13 +16,24 @@ private:
     filament::Material* m_material;
     filament::MaterialInstance* m_materialInstance;
 
+    // 共享几何体（注册表为空时 Mesh 独占自己的缓冲区）
+    Kazia::GeometryRegistry* m_geometryRegistry;
+    Kazia::GeometryRegistry::Key m_geometryKey;
+    bool m_hasGeometryKey;
+
 public:
-    Mesh(filament::Engine* engine);
+    Mesh(filament::Engine* engine, Kazia::GeometryRegistry* geometryRegistry = nullptr);
     ~Mesh();
 
+    // 程序化几何体，参数相同的几何体通过注册表共享
+    void createPrimitive(const Kazia::PrimitiveDesc& desc);
     void createCube(float size = 1.0f);
     void createSphere(float radius = 1.0f, int segments = 32);
+    void createIcoSphere(float radius = 1.0f, int subdivisions = 3);
     void createCylinder(float radius = 1.0f, float height = 2.0f, int segments = 32);
+    void createCone(float radius = 1.0f, float height = 2.0f, int segments = 32);
+    void createTorus(float majorRadius = 1.0f, float minorRadius = 0.25f, int segments = 48, int rings = 24);
+    void createPlane(float size = 1.0f, int subdivisions = 1);
 
     filament::Mesh* getMesh() const { return m_mesh; }
     filament::MaterialInstance* getMaterialInstance() const { return m_materialInstance; }
@@ -29,6 +43,7 @@ public:
 
 private:
     void cleanup();
+    void buildMesh(const Kazia::GeometryRegistry::Geometry& geometry);
 };
 
 #endif // MESH_H
@@ -0,0 +1,33 @@
+#ifndef MESHDATA_H
+#define MESHDATA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Math.h"
+
+namespace Kazia {
+
+// CPU 端的索引三角形网格，资产管线各阶段（简化、优化、上传）之间传递的数据
+struct MeshData {
+    std::vector<math::float3> positions;
+    std::vector<math::float3> normals;    // 为空或与 positions 等长
+    std::vector<math::float2> uvs;        // 为空或与 positions 等长
+    std::vector<uint32_t> indices;
+
+    size_t getVertexCount() const { return positions.size(); }
+    size_t getTriangleCount() const { return indices.size() / 3; }
+
+    math::aabb computeBounds() const {
+        math::aabb bounds;
+        for (const math::float3& position : positions) {
+            bounds.merge(position);
+        }
+        return bounds;
+    }
+};
+
+} // namespace Kazia
+
+#endif // MESHDATA_H
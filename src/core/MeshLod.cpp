@@ -0,0 +1,241 @@
+#include "MeshLod.h"
+
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace Kazia {
+
+namespace {
+
+// 缓存文件格式：头部、级别表、拼接后的索引
+constexpr uint32_t CACHE_MAGIC = 0x444F4C4B; // "KLOD"
+constexpr uint32_t CACHE_VERSION = 1;
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t vertexCount;
+    uint32_t levelCount;
+    uint32_t indexCount;
+};
+
+// 简化后三角形减少不到该比例时视为无法继续简化
+constexpr float MIN_LEVEL_REDUCTION = 0.9f;
+
+// FNV-1a 64 位哈希
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+} // namespace
+
+MeshLodChain MeshLodChain::build(const MeshData& mesh, const Options& options) {
+    MeshLodChain chain;
+    chain.indices = mesh.indices;
+    chain.indices.resize(mesh.getTriangleCount() * 3);
+
+    MeshLodLevel base;
+    base.indexCount = static_cast<uint32_t>(chain.indices.size());
+    chain.levels.push_back(base);
+
+    if (mesh.positions.empty() || chain.indices.empty()) {
+        return chain;
+    }
+
+    float scale = MeshSimplifier::computeScale(mesh.positions.data(), mesh.positions.size());
+    MeshSimplifier::Options simplifyOptions;
+
+    std::vector<uint32_t> source = chain.indices;
+    float relativeError = 0.0f;
+    while (chain.levels.size() < options.maxLevels) {
+        size_t sourceTriangles = source.size() / 3;
+        if (sourceTriangles <= options.minTriangles) {
+            break;
+        }
+
+        // 每一级只允许剩余的误差预算
+        simplifyOptions.targetError = options.maxError - relativeError;
+        if (simplifyOptions.targetError <= 0.0f) {
+            break;
+        }
+
+        size_t targetTriangles = std::max<size_t>(options.minTriangles, static_cast<size_t>(sourceTriangles * options.reduction));
+        float levelError = 0.0f;
+        std::vector<uint32_t> simplified = MeshSimplifier::simplify(mesh.positions.data(), mesh.positions.size(),
+                                                                    source.data(), source.size(),
+                                                                    targetTriangles * 3, simplifyOptions, &levelError);
+        if (simplified.empty() || simplified.size() > source.size() * MIN_LEVEL_REDUCTION) {
+            break;
+        }
+
+        relativeError += levelError;
+
+        MeshLodLevel level;
+        level.indexOffset = static_cast<uint32_t>(chain.indices.size());
+        level.indexCount = static_cast<uint32_t>(simplified.size());
+        level.error = relativeError * scale;
+        chain.levels.push_back(level);
+        chain.indices.insert(chain.indices.end(), simplified.begin(), simplified.end());
+
+        source.swap(simplified);
+    }
+    return chain;
+}
+
+MeshLodCache::MeshLodCache(const std::string& directory) : m_directory(directory) {
+}
+
+std::string MeshLodCache::getPath(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.lod", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(m_directory) / name).string();
+}
+
+uint64_t MeshLodCache::makeKey(const MeshData& mesh, const MeshLodChain::Options& options) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+    size_t vertexCount = mesh.positions.size();
+    size_t indexCount = mesh.indices.size();
+    hash = hashBytes(hash, &vertexCount, sizeof(vertexCount));
+    hash = hashBytes(hash, mesh.positions.data(), vertexCount * sizeof(math::float3));
+    hash = hashBytes(hash, &indexCount, sizeof(indexCount));
+    hash = hashBytes(hash, mesh.indices.data(), indexCount * sizeof(uint32_t));
+
+    hash = hashBytes(hash, &options.maxLevels, sizeof(options.maxLevels));
+    hash = hashBytes(hash, &options.reduction, sizeof(options.reduction));
+    hash = hashBytes(hash, &options.maxError, sizeof(options.maxError));
+    hash = hashBytes(hash, &options.minTriangles, sizeof(options.minTriangles));
+    hash = hashBytes(hash, &CACHE_VERSION, sizeof(CACHE_VERSION));
+    return hash;
+}
+
+bool MeshLodCache::load(uint64_t key, size_t vertexCount, MeshLodChain& chain) const {
+    std::ifstream file(getPath(key), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    CacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != CACHE_MAGIC || header.version != CACHE_VERSION ||
+        header.vertexCount != vertexCount || header.levelCount == 0) {
+        return false;
+    }
+
+    MeshLodChain result;
+    result.levels.resize(header.levelCount);
+    result.indices.resize(header.indexCount);
+    if (!file.read(reinterpret_cast<char*>(result.levels.data()), header.levelCount * sizeof(MeshLodLevel)) ||
+        !file.read(reinterpret_cast<char*>(result.indices.data()), static_cast<std::streamsize>(header.indexCount) * sizeof(uint32_t))) {
+        return false;
+    }
+
+    // 文件可能被截断或来自其他版本，越界的数据一律视为未命中
+    for (const MeshLodLevel& level : result.levels) {
+        if (static_cast<uint64_t>(level.indexOffset) + level.indexCount > header.indexCount || level.indexCount % 3 != 0) {
+            return false;
+        }
+    }
+    for (uint32_t index : result.indices) {
+        if (index >= vertexCount) {
+            return false;
+        }
+    }
+
+    chain = std::move(result);
+    return true;
+}
+
+bool MeshLodCache::store(uint64_t key, size_t vertexCount, const MeshLodChain& chain) const {
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    if (error) {
+        return false;
+    }
+
+    // 先写临时文件再改名，中途失败不会留下不完整的缓存
+    std::string path = getPath(key);
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+
+        CacheHeader header;
+        header.magic = CACHE_MAGIC;
+        header.version = CACHE_VERSION;
+        header.vertexCount = vertexCount;
+        header.levelCount = static_cast<uint32_t>(chain.levels.size());
+        header.indexCount = static_cast<uint32_t>(chain.indices.size());
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(chain.levels.data()), chain.levels.size() * sizeof(MeshLodLevel));
+        file.write(reinterpret_cast<const char*>(chain.indices.data()), chain.indices.size() * sizeof(uint32_t));
+        if (!file) {
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, error);
+    return !error;
+}
+
+MeshLodChain MeshLodCache::getOrBuild(const MeshData& mesh, const MeshLodChain::Options& options, bool* cacheHit) {
+    uint64_t key = makeKey(mesh, options);
+    MeshLodChain chain;
+    if (load(key, mesh.positions.size(), chain)) {
+        m_stats.hits++;
+        if (cacheHit) {
+            *cacheHit = true;
+        }
+        return chain;
+    }
+
+    m_stats.misses++;
+    if (cacheHit) {
+        *cacheHit = false;
+    }
+    chain = MeshLodChain::build(mesh, options);
+    if (store(key, mesh.positions.size(), chain)) {
+        m_stats.writes++;
+    }
+    return chain;
+}
+
+LodSelector::LodSelector() : m_pixelThreshold(1.0f), m_hysteresis(0.25f) {
+}
+
+void LodSelector::setHysteresis(float hysteresis) {
+    m_hysteresis = std::clamp(hysteresis, 0.0f, 0.9f);
+}
+
+uint32_t LodSelector::select(const MeshLodLevel* levels, size_t levelCount, float pixelsPerUnit, uint32_t currentLevel) const {
+    // 从最粗的级别开始，第一个投影误差在阈值内的级别即为结果
+    for (size_t i = levelCount; i-- > 1;) {
+        float limit = m_pixelThreshold * (i > currentLevel ? 1.0f - m_hysteresis : 1.0f + m_hysteresis);
+        if (levels[i].error * pixelsPerUnit <= limit) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+    return 0;
+}
+
+float LodSelector::pixelsPerUnit(float distance, float fovYDegrees, float viewportHeight) {
+    const float minDistance = 1e-4f;
+    float halfFov = fovYDegrees * 0.5f * 3.14159265358979323846f / 180.0f;
+    return viewportHeight / (2.0f * std::tan(halfFov) * std::max(distance, minDistance));
+}
+
+} // namespace Kazia
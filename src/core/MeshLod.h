@@ -0,0 +1,109 @@
+#ifndef MESHLOD_H
+#define MESHLOD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MeshData.h"
+
+namespace Kazia {
+
+// 一级 LOD：在拼接后的索引数组中的范围，以及相对原网格的误差（网格局部空间中的距离）
+struct MeshLodLevel {
+    uint32_t indexOffset = 0;
+    uint32_t indexCount = 0;
+    float error = 0.0f;
+};
+
+// 一个网格的 LOD 链
+// 所有级别共享原顶点数组，索引依次拼接（第 0 级为原网格），上传后只需一个顶点缓冲区和一个索引缓冲区，
+// 切换级别只改变绘制的索引范围
+struct MeshLodChain {
+    struct Options {
+        // 级别总数上限（包含第 0 级）
+        uint32_t maxLevels = 4;
+
+        // 每一级相对上一级的三角形比例
+        float reduction = 0.5f;
+
+        // 允许的最大相对误差（相对包围盒最大边长），超过后不再生成更粗的级别
+        float maxError = 0.05f;
+
+        // 三角形数低于该值时不再继续简化
+        uint32_t minTriangles = 64;
+    };
+
+    std::vector<uint32_t> indices;
+    std::vector<MeshLodLevel> levels;
+
+    size_t getLevelCount() const { return levels.size(); }
+    size_t getTriangleCount(size_t level) const { return levels[level].indexCount / 3; }
+
+    // 逐级简化：每一级从上一级的结果继续折叠，误差累加
+    static MeshLodChain build(const MeshData& mesh, const Options& options);
+};
+
+// LOD 链的磁盘缓存
+// 以网格内容和生成参数的哈希为键，每个网格一个文件，再次导入同一网格时直接读取，跳过简化
+class MeshLodCache {
+public:
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t writes = 0;
+    };
+
+private:
+    std::string m_directory;
+    Stats m_stats;
+
+public:
+    explicit MeshLodCache(const std::string& directory);
+
+    // 读取缓存，文件不存在、格式不符或索引越界时返回 false
+    bool load(uint64_t key, size_t vertexCount, MeshLodChain& chain) const;
+    bool store(uint64_t key, size_t vertexCount, const MeshLodChain& chain) const;
+
+    // 命中则读取，否则生成并写入缓存
+    MeshLodChain getOrBuild(const MeshData& mesh, const MeshLodChain::Options& options, bool* cacheHit = nullptr);
+
+    const std::string& getDirectory() const { return m_directory; }
+    const Stats& getStats() const { return m_stats; }
+
+    static uint64_t makeKey(const MeshData& mesh, const MeshLodChain::Options& options);
+
+private:
+    std::string getPath(uint64_t key) const;
+};
+
+// LOD 级别选择
+// 级别误差乘以每单位长度在屏幕上的像素数得到投影误差，选择投影误差不超过阈值的最粗级别。
+// 变粗时要求误差低于阈值的 (1 - hysteresis) 倍，保持当前级别时允许超过到 (1 + hysteresis) 倍，
+// 相机在切换距离附近小幅移动时级别不会来回跳变
+class LodSelector {
+private:
+    float m_pixelThreshold;
+    float m_hysteresis;
+
+public:
+    LodSelector();
+
+    // 允许的投影误差（像素）
+    void setPixelThreshold(float pixels) { m_pixelThreshold = pixels > 0.0f ? pixels : 0.0f; }
+    float getPixelThreshold() const { return m_pixelThreshold; }
+
+    void setHysteresis(float hysteresis);
+    float getHysteresis() const { return m_hysteresis; }
+
+    // pixelsPerUnit 为网格局部空间中单位长度投影到屏幕上的像素数（已乘以世界缩放）
+    uint32_t select(const MeshLodLevel* levels, size_t levelCount, float pixelsPerUnit, uint32_t currentLevel) const;
+
+    // 透视投影下距离 distance 处单位长度在屏幕上的像素数
+    static float pixelsPerUnit(float distance, float fovYDegrees, float viewportHeight);
+};
+
+} // namespace Kazia
+
+#endif // MESHLOD_H
@@ -0,0 +1,457 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace Kazia {
+
+namespace {
+
+constexpr uint32_t INVALID_VERTEX = 0xFFFFFFFFu;
+
+// 焊接用的顶点键：位置、法线和 UV 的位模式
+struct VertexKey {
+    uint32_t bits[8];
+    bool operator==(const VertexKey& other) const {
+        return std::memcmp(bits, other.bits, sizeof(bits)) == 0;
+    }
+};
+
+struct VertexKeyHash {
+    size_t operator()(const VertexKey& key) const {
+        uint64_t h = 0;
+        for (uint32_t value : key.bits) {
+            h = (h ^ value) * 0x9E3779B97F4A7C15ull;
+        }
+        return static_cast<size_t>(h ^ (h >> 31));
+    }
+};
+
+VertexKey makeVertexKey(const math::float3& position, const math::float3* normal, const math::float2* uv) {
+    // +0.0 与 -0.0 视为相同
+    float values[8] = {position.x + 0.0f, position.y + 0.0f, position.z + 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    if (normal) {
+        values[3] = normal->x + 0.0f;
+        values[4] = normal->y + 0.0f;
+        values[5] = normal->z + 0.0f;
+    }
+    if (uv) {
+        values[6] = uv->x + 0.0f;
+        values[7] = uv->y + 0.0f;
+    }
+    VertexKey key;
+    std::memcpy(key.bits, values, sizeof(values));
+    return key;
+}
+
+// FIFO 顶点缓存模拟：时间戳相差超过缓存大小的顶点已被挤出
+class CacheSimulator {
+private:
+    std::vector<uint32_t> m_cacheTime;
+    uint32_t m_timestamp;
+    uint32_t m_cacheSize;
+
+public:
+    CacheSimulator(size_t vertexCount, uint32_t cacheSize)
+        : m_cacheTime(vertexCount, 0), m_timestamp(cacheSize + 1), m_cacheSize(cacheSize) {
+    }
+
+    // 访问一个顶点，未命中时返回 true
+    bool access(uint32_t vertex) {
+        if (m_timestamp - m_cacheTime[vertex] > m_cacheSize) {
+            m_cacheTime[vertex] = m_timestamp++;
+            return true;
+        }
+        return false;
+    }
+
+    uint32_t accessTriangle(const uint32_t* triangle) {
+        return access(triangle[0]) + access(triangle[1]) + access(triangle[2]);
+    }
+
+    // 清空缓存：推进时间戳使所有顶点过期
+    void reset() { m_timestamp += m_cacheSize + 1; }
+};
+
+// 按首次使用顺序生成顶点重映射表，未使用的顶点为 INVALID_VERTEX
+std::vector<uint32_t> buildFetchRemap(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t& usedCount) {
+    std::vector<uint32_t> remap(vertexCount, INVALID_VERTEX);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; ++i) {
+        if (remap[indices[i]] == INVALID_VERTEX) {
+            remap[indices[i]] = next++;
+        }
+    }
+    usedCount = next;
+    return remap;
+}
+
+// 按重映射表压缩顶点属性
+void remapVertices(MeshData& mesh, const std::vector<uint32_t>& remap, size_t newCount) {
+    std::vector<math::float3> positions(newCount);
+    std::vector<math::float3> normals(mesh.normals.empty() ? 0 : newCount);
+    std::vector<math::float2> uvs(mesh.uvs.empty() ? 0 : newCount);
+    for (size_t i = 0; i < remap.size(); ++i) {
+        if (remap[i] == INVALID_VERTEX) {
+            continue;
+        }
+        positions[remap[i]] = mesh.positions[i];
+        if (!normals.empty()) {
+            normals[remap[i]] = mesh.normals[i];
+        }
+        if (!uvs.empty()) {
+            uvs[remap[i]] = mesh.uvs[i];
+        }
+    }
+    mesh.positions.swap(positions);
+    mesh.normals.swap(normals);
+    mesh.uvs.swap(uvs);
+}
+
+} // namespace
+
+MeshOptimizer::Report MeshOptimizer::optimize(MeshData& mesh, const Options& options) {
+    // 统计基于导入时的原始顶点和三角形顺序
+    size_t vertexCountBefore = mesh.positions.size();
+    float atvrBefore = 0.0f;
+    float acmrBefore = analyzeVertexCache(mesh.indices.data(), mesh.getTriangleCount() * 3, vertexCountBefore,
+                                          options.cacheSize, &atvrBefore);
+    if (options.weldVertices) {
+        weldVertices(mesh);
+    }
+
+    MeshLodChain chain;
+    chain.indices = mesh.indices;
+    chain.indices.resize(mesh.getTriangleCount() * 3);
+    MeshLodLevel level;
+    level.indexCount = static_cast<uint32_t>(chain.indices.size());
+    chain.levels.push_back(level);
+
+    Report report = optimize(mesh, chain, options);
+    report.vertexCountBefore = vertexCountBefore;
+    report.acmrBefore = acmrBefore;
+    report.atvrBefore = atvrBefore;
+    return report;
+}
+
+MeshOptimizer::Report MeshOptimizer::optimize(MeshData& mesh, MeshLodChain& chain, const Options& options) {
+    Report report;
+    report.vertexCountBefore = mesh.positions.size();
+    if (chain.levels.empty() || mesh.positions.empty()) {
+        report.vertexCountAfter = mesh.positions.size();
+        report.shortIndices = fitsShortIndices(mesh.positions.size());
+        return report;
+    }
+
+    const MeshLodLevel& base = chain.levels[0];
+    report.acmrBefore = analyzeVertexCache(chain.indices.data() + base.indexOffset, base.indexCount, mesh.positions.size(),
+                                           options.cacheSize, &report.atvrBefore);
+
+    // 各级独立重排三角形
+    std::vector<uint32_t> clusters;
+    for (const MeshLodLevel& level : chain.levels) {
+        uint32_t* indices = chain.indices.data() + level.indexOffset;
+        if (options.optimizeVertexCache) {
+            optimizeVertexCache(indices, level.indexCount, mesh.positions.size(), options.cacheSize,
+                                options.optimizeOverdraw ? &clusters : nullptr);
+            if (options.optimizeOverdraw) {
+                optimizeOverdraw(indices, level.indexCount, mesh.positions.data(), mesh.positions.size(), clusters,
+                                 options.cacheSize, options.overdrawThreshold);
+            }
+        }
+    }
+
+    // 顶点按第 0 级到最粗一级的首次使用顺序排列
+    if (options.optimizeVertexFetch) {
+        optimizeVertexFetch(mesh, chain.indices.data(), chain.indices.size());
+    }
+    mesh.indices.assign(chain.indices.begin() + base.indexOffset, chain.indices.begin() + base.indexOffset + base.indexCount);
+
+    report.vertexCountAfter = mesh.positions.size();
+    report.acmrAfter = analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.positions.size(),
+                                          options.cacheSize, &report.atvrAfter);
+    report.shortIndices = fitsShortIndices(mesh.positions.size());
+    return report;
+}
+
+size_t MeshOptimizer::weldVertices(MeshData& mesh) {
+    size_t vertexCount = mesh.positions.size();
+    bool hasNormals = mesh.normals.size() == vertexCount;
+    bool hasUvs = mesh.uvs.size() == vertexCount;
+
+    std::unordered_map<VertexKey, uint32_t, VertexKeyHash> uniqueVertices;
+    uniqueVertices.reserve(vertexCount);
+    std::vector<uint32_t> remap(vertexCount);
+    uint32_t next = 0;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        VertexKey key = makeVertexKey(mesh.positions[i], hasNormals ? &mesh.normals[i] : nullptr, hasUvs ? &mesh.uvs[i] : nullptr);
+        auto result = uniqueVertices.emplace(key, next);
+        if (result.second) {
+            next++;
+        }
+        remap[i] = result.first->second;
+    }
+
+    if (next == vertexCount) {
+        return 0;
+    }
+
+    for (uint32_t& index : mesh.indices) {
+        index = remap[index];
+    }
+
+    // 重复顶点映射到同一个新编号，压缩时后写入的值与先写入的相同
+    remapVertices(mesh, remap, next);
+    return vertexCount - next;
+}
+
+void MeshOptimizer::optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize,
+                                        std::vector<uint32_t>* clusters) {
+    size_t triangleCount = indexCount / 3;
+    if (clusters) {
+        clusters->clear();
+    }
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // 顶点到三角形的邻接表（CSR），liveTriangles 为尚未输出的相邻三角形数
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        offsets[indices[i] + 1]++;
+    }
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        liveTriangles[i] = offsets[i + 1];
+        offsets[i + 1] += offsets[i];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; ++i) {
+            adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+    deadEnd.reserve(triangleCount * 3);
+
+    uint32_t timestamp = cacheSize + 1;
+    size_t scanCursor = 0;
+    bool clusterStart = true;
+
+    // 从第一个有三角形的顶点开始扇形展开
+    while (scanCursor < vertexCount && liveTriangles[scanCursor] == 0) {
+        scanCursor++;
+    }
+    int64_t fanning = scanCursor < vertexCount ? static_cast<int64_t>(scanCursor) : -1;
+
+    while (fanning >= 0) {
+        // 输出扇形顶点的所有剩余三角形
+        candidates.clear();
+        for (uint32_t k = offsets[fanning]; k < offsets[fanning + 1]; ++k) {
+            uint32_t triangle = adjacency[k];
+            if (emitted[triangle]) {
+                continue;
+            }
+            if (clusters && clusterStart) {
+                clusters->push_back(static_cast<uint32_t>(output.size() / 3));
+                clusterStart = false;
+            }
+
+            const uint32_t* corners = indices + static_cast<size_t>(triangle) * 3;
+            for (int c = 0; c < 3; ++c) {
+                uint32_t vertex = corners[c];
+                output.push_back(vertex);
+                deadEnd.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                if (timestamp - cacheTime[vertex] > cacheSize) {
+                    cacheTime[vertex] = timestamp++;
+                }
+            }
+            emitted[triangle] = 1;
+        }
+
+        // 下一个扇形顶点：优先选择在剩余三角形输出完之前仍会留在缓存中、且在缓存中最久的候选顶点
+        int64_t best = -1;
+        int64_t bestPriority = -1;
+        for (uint32_t vertex : candidates) {
+            if (liveTriangles[vertex] == 0) {
+                continue;
+            }
+            int64_t priority = 0;
+            int64_t age = static_cast<int64_t>(timestamp - cacheTime[vertex]);
+            if (age + 2 * static_cast<int64_t>(liveTriangles[vertex]) <= cacheSize) {
+                priority = age;
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                best = vertex;
+            }
+        }
+
+        if (best < 0) {
+            // 走入死角：从最近输出的顶点中回溯，再不行就按编号顺序查找，此处开始新的分段
+            clusterStart = true;
+            while (!deadEnd.empty()) {
+                uint32_t vertex = deadEnd.back();
+                deadEnd.pop_back();
+                if (liveTriangles[vertex] > 0) {
+                    best = vertex;
+                    break;
+                }
+            }
+            if (best < 0) {
+                while (scanCursor < vertexCount && liveTriangles[scanCursor] == 0) {
+                    scanCursor++;
+                }
+                best = scanCursor < vertexCount ? static_cast<int64_t>(scanCursor) : -1;
+            }
+        }
+        fanning = best;
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+void MeshOptimizer::optimizeOverdraw(uint32_t* indices, size_t indexCount, const math::float3* positions, size_t vertexCount,
+                                     const std::vector<uint32_t>& hardClusters, uint32_t cacheSize, float threshold) {
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    std::vector<uint32_t> hard = hardClusters;
+    if (hard.empty() || hard[0] != 0) {
+        hard.insert(hard.begin(), 0);
+    }
+
+    // 在硬边界内再切分：分段内累计的 ACMR 降到整段 ACMR 的 threshold 倍以内时切开，
+    // 切开后缓存从空开始，因此切分越细缓存未命中越多
+    std::vector<uint32_t> clusters;
+    CacheSimulator cache(vertexCount, cacheSize);
+    for (size_t h = 0; h < hard.size(); ++h) {
+        size_t start = hard[h];
+        size_t end = h + 1 < hard.size() ? hard[h + 1] : triangleCount;
+
+        cache.reset();
+        uint32_t clusterMisses = 0;
+        for (size_t t = start; t < end; ++t) {
+            clusterMisses += cache.accessTriangle(indices + t * 3);
+        }
+        float limit = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+        cache.reset();
+        clusters.push_back(static_cast<uint32_t>(start));
+        size_t subStart = start;
+        uint32_t subMisses = 0;
+        for (size_t t = start; t + 1 < end; ++t) {
+            subMisses += cache.accessTriangle(indices + t * 3);
+            if (static_cast<float>(subMisses) / static_cast<float>(t + 1 - subStart) <= limit) {
+                clusters.push_back(static_cast<uint32_t>(t + 1));
+                subStart = t + 1;
+                subMisses = 0;
+                cache.reset();
+            }
+        }
+    }
+
+    // 每个分段的面积加权中心和法线
+    struct ClusterInfo {
+        math::float3 centroid;
+        math::float3 normal;
+        float area = 0.0f;
+        float sortKey = 0.0f;
+        uint32_t start = 0;
+        uint32_t end = 0;
+    };
+    std::vector<ClusterInfo> infos(clusters.size());
+    math::float3 meshCentroid;
+    float meshArea = 0.0f;
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        ClusterInfo& info = infos[c];
+        info.start = clusters[c];
+        info.end = c + 1 < clusters.size() ? clusters[c + 1] : static_cast<uint32_t>(triangleCount);
+        for (uint32_t t = info.start; t < info.end; ++t) {
+            const math::float3& a = positions[indices[t * 3]];
+            const math::float3& b = positions[indices[t * 3 + 1]];
+            const math::float3& d = positions[indices[t * 3 + 2]];
+            math::float3 normal = math::cross(b - a, d - a);
+            float area = math::length(normal);
+            info.centroid = info.centroid + (a + b + d) * (area / 3.0f);
+            info.normal = info.normal + normal;
+            info.area += area;
+        }
+        meshCentroid = meshCentroid + info.centroid;
+        meshArea += info.area;
+        if (info.area > 0.0f) {
+            info.centroid = info.centroid / info.area;
+        }
+    }
+    if (meshArea > 0.0f) {
+        meshCentroid = meshCentroid / meshArea;
+    }
+
+    // 越朝外的分段越先绘制，从任意方向看时先绘制的更可能遮挡后绘制的
+    for (ClusterInfo& info : infos) {
+        float normalLength = math::length(info.normal);
+        info.sortKey = normalLength > 0.0f ? math::dot(info.centroid - meshCentroid, info.normal / normalLength) : 0.0f;
+    }
+    std::stable_sort(infos.begin(), infos.end(), [](const ClusterInfo& lhs, const ClusterInfo& rhs) {
+        return lhs.sortKey > rhs.sortKey;
+    });
+
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+    for (const ClusterInfo& info : infos) {
+        output.insert(output.end(), indices + static_cast<size_t>(info.start) * 3, indices + static_cast<size_t>(info.end) * 3);
+    }
+    std::copy(output.begin(), output.end(), indices);
+}
+
+size_t MeshOptimizer::optimizeVertexFetch(MeshData& mesh, uint32_t* indices, size_t indexCount) {
+    size_t usedCount = 0;
+    std::vector<uint32_t> remap = buildFetchRemap(indices, indexCount, mesh.positions.size(), usedCount);
+    for (size_t i = 0; i < indexCount; ++i) {
+        indices[i] = remap[indices[i]];
+    }
+    remapVertices(mesh, remap, usedCount);
+    return usedCount;
+}
+
+float MeshOptimizer::analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize,
+                                        float* atvr) {
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) {
+        if (atvr) {
+            *atvr = 0.0f;
+        }
+        return 0.0f;
+    }
+
+    CacheSimulator cache(vertexCount, cacheSize);
+    std::vector<uint8_t> referenced(vertexCount, 0);
+    size_t misses = 0;
+    size_t uniqueVertices = 0;
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        misses += cache.access(indices[i]);
+        if (!referenced[indices[i]]) {
+            referenced[indices[i]] = 1;
+            uniqueVertices++;
+        }
+    }
+
+    if (atvr) {
+        *atvr = static_cast<float>(misses) / static_cast<float>(uniqueVertices);
+    }
+    return static_cast<float>(misses) / static_cast<float>(triangleCount);
+}
+
+} // namespace Kazia
@@ -0,0 +1,75 @@
+#ifndef MESHOPTIMIZER_H
+#define MESHOPTIMIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MeshData.h"
+#include "MeshLod.h"
+
+namespace Kazia {
+
+// 导入时的网格优化
+// 1. 焊接位置、法线和 UV 完全相同的重复顶点
+// 2. 按顶点缓存重排三角形（Tipsify），同时记录缓存未命中较多的分段边界
+// 3. 按分段朝外的程度排序（由外向内绘制），减少过度绘制，只在不明显增加缓存未命中时切分
+// 4. 按索引中首次出现的顺序重排顶点，去掉未使用的顶点，顶点读取基本顺序进行
+// 顶点数不超过 65536 时可以使用 16 位索引
+class MeshOptimizer {
+public:
+    struct Options {
+        bool weldVertices = true;
+        bool optimizeVertexCache = true;
+        bool optimizeOverdraw = true;
+        bool optimizeVertexFetch = true;
+
+        // 模拟的后变换缓存大小（FIFO）
+        uint32_t cacheSize = 16;
+
+        // 为减少过度绘制允许的 ACMR 增幅，1.05 表示最多比纯缓存优化差 5%
+        float overdrawThreshold = 1.05f;
+    };
+
+    // 优化前后的统计，ACMR 为每个三角形的平均缓存未命中数，ATVR 为未命中数与引用顶点数之比（1 为最优）
+    struct Report {
+        size_t vertexCountBefore = 0;
+        size_t vertexCountAfter = 0;
+        float acmrBefore = 0.0f;
+        float acmrAfter = 0.0f;
+        float atvrBefore = 0.0f;
+        float atvrAfter = 0.0f;
+        bool shortIndices = false;
+    };
+
+    // 优化单级网格，按选项依次执行全部步骤
+    static Report optimize(MeshData& mesh, const Options& options);
+
+    // 优化 LOD 链：各级分别重排三角形，顶点按所有级别的首次使用顺序重排（同时改写 mesh.indices）
+    // 焊接会改变顶点编号，应在生成 LOD 链之前调用 weldVertices；统计基于第 0 级
+    static Report optimize(MeshData& mesh, MeshLodChain& chain, const Options& options);
+
+    // 焊接重复顶点，返回移除的顶点数
+    static size_t weldVertices(MeshData& mesh);
+
+    // 原地重排三角形；clusters 不为空时输出分段的起始三角形（升序，首个为 0）
+    static void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize,
+                                    std::vector<uint32_t>* clusters = nullptr);
+
+    // 在顶点缓存优化的结果上按分段重排以减少过度绘制
+    static void optimizeOverdraw(uint32_t* indices, size_t indexCount, const math::float3* positions, size_t vertexCount,
+                                 const std::vector<uint32_t>& hardClusters, uint32_t cacheSize, float threshold);
+
+    // 按首次使用顺序重排顶点并改写索引，返回保留的顶点数
+    static size_t optimizeVertexFetch(MeshData& mesh, uint32_t* indices, size_t indexCount);
+
+    // 模拟 FIFO 顶点缓存，返回 ACMR，atvr 不为空时同时输出 ATVR
+    static float analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize,
+                                    float* atvr = nullptr);
+
+    static bool fitsShortIndices(size_t vertexCount) { return vertexCount <= 65536; }
+};
+
+} // namespace Kazia
+
+#endif // MESHOPTIMIZER_H
@@ -0,0 +1,377 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace Kazia {
+
+namespace {
+
+// 边界约束平面的权重，使边界顶点偏离边界的代价远大于在曲面上移动
+constexpr float BORDER_WEIGHT = 10.0f;
+
+// 对称 4x4 二次误差矩阵，只存上三角，w 为累积的面积权重
+struct Quadric {
+    double a2 = 0, b2 = 0, c2 = 0, d2 = 0;
+    double ab = 0, ac = 0, ad = 0;
+    double bc = 0, bd = 0, cd = 0;
+    double w = 0;
+
+    void addPlane(const math::float3& n, float d, float weight) {
+        a2 += weight * n.x * n.x;
+        b2 += weight * n.y * n.y;
+        c2 += weight * n.z * n.z;
+        d2 += weight * d * d;
+        ab += weight * n.x * n.y;
+        ac += weight * n.x * n.z;
+        ad += weight * n.x * d;
+        bc += weight * n.y * n.z;
+        bd += weight * n.y * d;
+        cd += weight * n.z * d;
+        w += weight;
+    }
+
+    void add(const Quadric& q) {
+        a2 += q.a2; b2 += q.b2; c2 += q.c2; d2 += q.d2;
+        ab += q.ab; ac += q.ac; ad += q.ad;
+        bc += q.bc; bd += q.bd; cd += q.cd;
+        w += q.w;
+    }
+
+    // v^T Q v，即到各平面距离平方的加权和
+    double evaluate(const math::float3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        double result = a2 * x * x + b2 * y * y + c2 * z * z + d2
+                      + 2.0 * (ab * x * y + ac * x * z + bc * y * z)
+                      + 2.0 * (ad * x + bd * y + cd * z);
+        return result > 0.0 ? result : 0.0;
+    }
+};
+
+enum VertexKind : uint8_t {
+    KIND_MANIFOLD,  // 内部顶点，可以折叠到任意相邻顶点
+    KIND_BORDER,    // 边界顶点，只能沿边界折叠
+    KIND_LOCKED     // 接缝、非流形或被锁定的边界顶点，不能移动
+};
+
+struct Collapse {
+    uint32_t source;
+    uint32_t target;
+    float cost;
+};
+
+inline uint64_t edgeKey(uint32_t a, uint32_t b) {
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+// 按位置焊接顶点：相同位置的顶点映射到第一个出现的顶点
+std::vector<uint32_t> buildPositionRemap(const math::float3* positions, size_t vertexCount) {
+    struct PositionKey {
+        uint32_t bits[3];
+        bool operator==(const PositionKey& other) const {
+            return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+        }
+    };
+    struct PositionHash {
+        size_t operator()(const PositionKey& key) const {
+            uint64_t h = key.bits[0];
+            h = h * 0x9E3779B97F4A7C15ull ^ key.bits[1];
+            h = h * 0x9E3779B97F4A7C15ull ^ key.bits[2];
+            return static_cast<size_t>(h ^ (h >> 29));
+        }
+    };
+
+    std::unordered_map<PositionKey, uint32_t, PositionHash> firstVertex;
+    firstVertex.reserve(vertexCount);
+    std::vector<uint32_t> remap(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        PositionKey key;
+        // +0.0 与 -0.0 视为同一位置
+        float coords[3] = {positions[i].x + 0.0f, positions[i].y + 0.0f, positions[i].z + 0.0f};
+        std::memcpy(key.bits, coords, sizeof(coords));
+        auto result = firstVertex.emplace(key, static_cast<uint32_t>(i));
+        remap[i] = result.first->second;
+    }
+    return remap;
+}
+
+// 翻转检测：把 source 移到 target 后，相邻三角形的法线不能反向
+bool hasTriangleFlip(const math::float3& a, const math::float3& b, const math::float3& c, const math::float3& moved) {
+    math::float3 before = math::cross(b - a, c - a);
+    math::float3 after = math::cross(b - moved, c - moved);
+    return math::dot(before, after) <= 0.0f;
+}
+
+} // namespace
+
+float MeshSimplifier::computeScale(const math::float3* positions, size_t vertexCount) {
+    math::aabb bounds;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        bounds.merge(positions[i]);
+    }
+    if (bounds.isEmpty()) {
+        return 1.0f;
+    }
+    math::float3 size = bounds.max - bounds.min;
+    float scale = std::max(size.x, std::max(size.y, size.z));
+    return scale > 0.0f ? scale : 1.0f;
+}
+
+std::vector<uint32_t> MeshSimplifier::simplify(const math::float3* positions, size_t vertexCount,
+                                               const uint32_t* indices, size_t indexCount,
+                                               size_t targetIndexCount, const Options& options,
+                                               float* resultError) {
+    std::vector<uint32_t> result(indices, indices + (indexCount / 3) * 3);
+    float maxError = 0.0f;
+    if (resultError) {
+        *resultError = 0.0f;
+    }
+    if (result.size() <= targetIndexCount || vertexCount == 0) {
+        return result;
+    }
+
+    // 在归一化坐标中计算误差，结果与网格尺寸无关
+    float scale = computeScale(positions, vertexCount);
+    math::aabb bounds;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        bounds.merge(positions[i]);
+    }
+    std::vector<math::float3> scaled(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        scaled[i] = (positions[i] - bounds.min) / scale;
+    }
+
+    // 同一位置的多个顶点共享误差矩阵和拓扑分类
+    std::vector<uint32_t> canonical = buildPositionRemap(positions, vertexCount);
+    std::vector<uint32_t> wedgeCount(vertexCount, 0);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        wedgeCount[canonical[i]]++;
+    }
+
+    std::vector<uint8_t> kinds(vertexCount);
+    std::unordered_map<uint64_t, uint32_t> edgeCounts;
+    std::vector<Quadric> quadrics(vertexCount);
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<uint8_t> touched(vertexCount);
+
+    // 拓扑分类，每轮折叠后重新计算
+    auto classifyVertices = [&]() {
+        edgeCounts.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int e = 0; e < 3; ++e) {
+                uint32_t a = canonical[result[i + e]];
+                uint32_t b = canonical[result[i + (e + 1) % 3]];
+                edgeCounts[edgeKey(a, b)]++;
+            }
+        }
+
+        for (size_t i = 0; i < vertexCount; ++i) {
+            kinds[i] = wedgeCount[i] > 1 ? KIND_LOCKED : KIND_MANIFOLD;
+        }
+        for (const auto& item : edgeCounts) {
+            uint32_t a = static_cast<uint32_t>(item.first >> 32);
+            uint32_t b = static_cast<uint32_t>(item.first & 0xFFFFFFFFu);
+            auto opposite = edgeCounts.find(edgeKey(b, a));
+            uint32_t oppositeCount = opposite == edgeCounts.end() ? 0 : opposite->second;
+
+            if (item.second > 1 || oppositeCount > 1) {
+                // 非流形边，两端固定
+                kinds[a] = kinds[b] = KIND_LOCKED;
+            } else if (oppositeCount == 0) {
+                uint8_t kind = options.lockBorder ? KIND_LOCKED : KIND_BORDER;
+                kinds[a] = std::max(kinds[a], kind);
+                kinds[b] = std::max(kinds[b], kind);
+            }
+        }
+    };
+
+    auto isBorderEdge = [&](uint32_t a, uint32_t b) {
+        return edgeCounts.find(edgeKey(b, a)) == edgeCounts.end() ||
+               edgeCounts.find(edgeKey(a, b)) == edgeCounts.end();
+    };
+
+    // 初始误差矩阵：三角形平面按面积加权，边界边额外加入垂直于三角形的约束平面
+    classifyVertices();
+    for (size_t i = 0; i < result.size(); i += 3) {
+        uint32_t v[3] = {result[i], result[i + 1], result[i + 2]};
+        const math::float3& p0 = scaled[v[0]];
+        math::float3 normal = math::cross(scaled[v[1]] - p0, scaled[v[2]] - p0);
+        float area = math::length(normal);
+        if (area <= 0.0f) {
+            continue;
+        }
+        normal = normal / area;
+        float d = -math::dot(normal, p0);
+        for (uint32_t vertex : v) {
+            quadrics[canonical[vertex]].addPlane(normal, d, area);
+        }
+
+        for (int e = 0; e < 3; ++e) {
+            uint32_t a = canonical[v[e]];
+            uint32_t b = canonical[v[(e + 1) % 3]];
+            if (edgeCounts.find(edgeKey(b, a)) != edgeCounts.end()) {
+                continue;
+            }
+            math::float3 edge = scaled[b] - scaled[a];
+            float edgeLength = math::length(edge);
+            if (edgeLength <= 0.0f) {
+                continue;
+            }
+            math::float3 borderNormal = math::normalize(math::cross(edge, normal));
+            float borderD = -math::dot(borderNormal, scaled[a]);
+            float weight = edgeLength * edgeLength * BORDER_WEIGHT;
+            quadrics[a].addPlane(borderNormal, borderD, weight);
+            quadrics[b].addPlane(borderNormal, borderD, weight);
+        }
+    }
+
+    float errorLimit = options.targetError * options.targetError;
+
+    auto collapseCost = [&](uint32_t source, uint32_t target) {
+        const Quadric& qs = quadrics[canonical[source]];
+        const Quadric& qt = quadrics[canonical[target]];
+        double weight = qs.w + qt.w;
+        double error = qs.evaluate(scaled[target]) + qt.evaluate(scaled[target]);
+        return static_cast<float>(weight > 0.0 ? error / weight : error);
+    };
+
+    auto canCollapse = [&](uint32_t source, uint32_t target) {
+        uint32_t cs = canonical[source];
+        uint32_t ct = canonical[target];
+        if (cs == ct || kinds[cs] == KIND_LOCKED) {
+            return false;
+        }
+        if (kinds[cs] == KIND_BORDER) {
+            return kinds[ct] != KIND_MANIFOLD && isBorderEdge(cs, ct);
+        }
+        return true;
+    };
+
+    while (result.size() > targetIndexCount) {
+        // 当前三角形的顶点邻接表（CSR）
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for (uint32_t vertex : result) {
+            adjacencyOffsets[vertex + 1]++;
+        }
+        for (size_t i = 0; i < vertexCount; ++i) {
+            adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+        }
+        adjacency.resize(result.size());
+        {
+            std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < result.size(); ++i) {
+                adjacency[cursor[result[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        // 候选折叠：每条边取代价较小的方向
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int e = 0; e < 3; ++e) {
+                uint32_t a = result[i + e];
+                uint32_t b = result[i + (e + 1) % 3];
+                bool forward = canCollapse(a, b);
+                bool backward = canCollapse(b, a);
+                if (!forward && !backward) {
+                    continue;
+                }
+                float forwardCost = forward ? collapseCost(a, b) : 0.0f;
+                float backwardCost = backward ? collapseCost(b, a) : 0.0f;
+                if (forward && (!backward || forwardCost <= backwardCost)) {
+                    collapses.push_back({a, b, forwardCost});
+                } else {
+                    collapses.push_back({b, a, backwardCost});
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) {
+            return lhs.cost < rhs.cost;
+        });
+
+        // 按代价从小到大应用互不相邻的折叠，直到移除足够的三角形
+        for (size_t i = 0; i < vertexCount; ++i) {
+            remap[i] = static_cast<uint32_t>(i);
+        }
+        std::fill(touched.begin(), touched.end(), 0);
+
+        size_t trianglesToRemove = (result.size() - targetIndexCount + 2) / 3;
+        size_t removedTriangles = 0;
+        size_t appliedCollapses = 0;
+        for (const Collapse& collapse : collapses) {
+            if (collapse.cost > errorLimit || removedTriangles >= trianglesToRemove) {
+                break;
+            }
+            if (touched[collapse.source] || touched[collapse.target]) {
+                continue;
+            }
+
+            // 检查 source 周围的三角形：包含 target 的会被移除，其余的不能翻转
+            bool flipped = false;
+            size_t removed = 0;
+            for (uint32_t k = adjacencyOffsets[collapse.source]; k < adjacencyOffsets[collapse.source + 1]; ++k) {
+                size_t triangle = static_cast<size_t>(adjacency[k]) * 3;
+                uint32_t v[3] = {remap[result[triangle]], remap[result[triangle + 1]], remap[result[triangle + 2]]};
+                if (v[0] == v[1] || v[1] == v[2] || v[0] == v[2]) {
+                    continue;
+                }
+                if (v[0] == collapse.target || v[1] == collapse.target || v[2] == collapse.target) {
+                    removed++;
+                    continue;
+                }
+
+                int corner = v[0] == collapse.source ? 0 : (v[1] == collapse.source ? 1 : 2);
+                const math::float3& a = scaled[v[corner]];
+                const math::float3& b = scaled[v[(corner + 1) % 3]];
+                const math::float3& c = scaled[v[(corner + 2) % 3]];
+                if (hasTriangleFlip(a, b, c, scaled[collapse.target])) {
+                    flipped = true;
+                    break;
+                }
+            }
+            if (flipped) {
+                continue;
+            }
+
+            remap[collapse.source] = collapse.target;
+            quadrics[canonical[collapse.target]].add(quadrics[canonical[collapse.source]]);
+            touched[collapse.source] = 1;
+            touched[collapse.target] = 1;
+            removedTriangles += removed;
+            appliedCollapses++;
+            maxError = std::max(maxError, collapse.cost);
+        }
+
+        if (appliedCollapses == 0) {
+            break;
+        }
+
+        // 重写索引并去掉退化三角形
+        size_t writeIndex = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            uint32_t a = remap[result[i]];
+            uint32_t b = remap[result[i + 1]];
+            uint32_t c = remap[result[i + 2]];
+            if (a == b || b == c || a == c) {
+                continue;
+            }
+            result[writeIndex++] = a;
+            result[writeIndex++] = b;
+            result[writeIndex++] = c;
+        }
+        result.resize(writeIndex);
+
+        classifyVertices();
+    }
+
+    if (resultError) {
+        *resultError = std::sqrt(maxError);
+    }
+    return result;
+}
+
+} // namespace Kazia
@@ -0,0 +1,39 @@
+#ifndef MESHSIMPLIFIER_H
+#define MESHSIMPLIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Math.h"
+
+namespace Kazia {
+
+// 网格简化（二次误差度量的边折叠）
+// 每个顶点累积相邻三角形平面的二次误差，每轮按代价从小到大折叠互不相邻的边。
+// 顶点只折叠到已有的相邻顶点上，结果索引仍引用原顶点数组，各级 LOD 可以共享同一个顶点缓冲区；
+// 边界顶点只能沿边界折叠，同一位置有多个顶点（法线/UV 接缝）时这些顶点固定不动，接缝两侧的属性不会错位
+class MeshSimplifier {
+public:
+    struct Options {
+        // 允许的最大误差，相对网格包围盒的最大边长
+        float targetError = 0.01f;
+
+        // 边界顶点完全固定（网格被切分成多块时保证块之间不出现裂缝）
+        bool lockBorder = false;
+    };
+
+    // 简化到不超过 targetIndexCount 个索引，误差先达到上限时提前停止
+    // resultError 输出实际达到的相对误差
+    static std::vector<uint32_t> simplify(const math::float3* positions, size_t vertexCount,
+                                          const uint32_t* indices, size_t indexCount,
+                                          size_t targetIndexCount, const Options& options,
+                                          float* resultError = nullptr);
+
+    // 相对误差的基准长度（包围盒最大边长），相对误差乘以它得到网格局部空间中的距离
+    static float computeScale(const math::float3* positions, size_t vertexCount);
+};
+
+} // namespace Kazia
+
+#endif // MESHSIMPLIFIER_H
@@ -0,0 +1,279 @@
+#include "MeshStream.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+namespace Kazia {
+
+namespace {
+
+// 文件格式：头部、级别表，之后是按页对齐的各级数据块
+constexpr uint32_t STREAM_MAGIC = 0x4D54534B; // "KSTM"
+constexpr uint32_t STREAM_VERSION = 1;
+constexpr uint64_t BLOCK_ALIGNMENT = 4096;
+
+constexpr uint32_t FLAG_NORMALS = 1u << 0;
+constexpr uint32_t FLAG_UVS = 1u << 1;
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t levelCount;
+    uint32_t flags;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+struct LevelEntry {
+    float error;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t reserved;
+    uint64_t dataOffset;
+    uint64_t dataSize;
+};
+
+uint64_t getBlockSize(uint64_t vertexCount, uint64_t indexCount, bool hasNormals, bool hasUvs) {
+    uint64_t vertexSize = sizeof(math::float3) + (hasNormals ? sizeof(math::float3) : 0) + (hasUvs ? sizeof(math::float2) : 0);
+    return vertexCount * vertexSize + indexCount * sizeof(uint32_t);
+}
+
+uint64_t alignBlock(uint64_t offset) {
+    return (offset + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+}
+
+} // namespace
+
+MeshStreamFile::MeshStreamFile() : m_hasNormals(false), m_hasUvs(false) {
+}
+
+bool MeshStreamFile::open(const std::string& path) {
+    close();
+    if (!m_file.open(path)) {
+        return false;
+    }
+
+    // 文件可能被截断或来自其他版本，任何不一致都视为无法打开
+    FileHeader header;
+    if (m_file.size() < sizeof(header)) {
+        close();
+        return false;
+    }
+    std::memcpy(&header, m_file.data(), sizeof(header));
+    uint64_t tableEnd = sizeof(header) + static_cast<uint64_t>(header.levelCount) * sizeof(LevelEntry);
+    if (header.magic != STREAM_MAGIC || header.version != STREAM_VERSION || header.levelCount == 0 || tableEnd > m_file.size()) {
+        close();
+        return false;
+    }
+
+    m_hasNormals = (header.flags & FLAG_NORMALS) != 0;
+    m_hasUvs = (header.flags & FLAG_UVS) != 0;
+    m_bounds = math::aabb({header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]},
+                          {header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]});
+
+    m_levels.resize(header.levelCount);
+    for (uint32_t i = 0; i < header.levelCount; ++i) {
+        LevelEntry entry;
+        std::memcpy(&entry, m_file.data() + sizeof(header) + i * sizeof(LevelEntry), sizeof(entry));
+        if (entry.indexCount % 3 != 0 || entry.dataOffset % sizeof(uint32_t) != 0 ||
+            entry.dataSize != getBlockSize(entry.vertexCount, entry.indexCount, m_hasNormals, m_hasUvs) ||
+            entry.dataOffset < tableEnd || entry.dataOffset > m_file.size() || entry.dataSize > m_file.size() - entry.dataOffset) {
+            close();
+            return false;
+        }
+
+        Level& level = m_levels[i];
+        level.error = entry.error;
+        level.vertexCount = entry.vertexCount;
+        level.indexCount = entry.indexCount;
+        level.dataOffset = entry.dataOffset;
+        level.dataSize = entry.dataSize;
+    }
+
+    // 索引越界的级别上传后会让 GPU 读到缓冲区之外，打开时逐级检查，之后读取不再检查；
+    // 检查完把页移出工作集，级别数据仍按需读入
+    for (size_t i = 0; i < m_levels.size(); ++i) {
+        const Level& level = m_levels[i];
+        const uint8_t* indices = m_file.data() + level.dataOffset + level.dataSize - static_cast<uint64_t>(level.indexCount) * sizeof(uint32_t);
+        for (uint32_t k = 0; k < level.indexCount; ++k) {
+            uint32_t index;
+            std::memcpy(&index, indices + static_cast<size_t>(k) * sizeof(uint32_t), sizeof(index));
+            if (index >= level.vertexCount) {
+                close();
+                return false;
+            }
+        }
+        releaseLevel(i);
+    }
+    return true;
+}
+
+void MeshStreamFile::close() {
+    m_file.close();
+    m_levels.clear();
+    m_bounds = math::aabb();
+    m_hasNormals = false;
+    m_hasUvs = false;
+}
+
+bool MeshStreamFile::readLevel(size_t level, MeshData& mesh) const {
+    if (level >= m_levels.size()) {
+        return false;
+    }
+
+    const Level& entry = m_levels[level];
+    const uint8_t* data = m_file.data() + entry.dataOffset;
+    mesh.positions.resize(entry.vertexCount);
+    mesh.normals.resize(m_hasNormals ? entry.vertexCount : 0);
+    mesh.uvs.resize(m_hasUvs ? entry.vertexCount : 0);
+    mesh.indices.resize(entry.indexCount);
+
+    size_t offset = 0;
+    auto copy = [&](void* target, size_t size) {
+        std::memcpy(target, data + offset, size);
+        offset += size;
+    };
+    copy(mesh.positions.data(), mesh.positions.size() * sizeof(math::float3));
+    copy(mesh.normals.data(), mesh.normals.size() * sizeof(math::float3));
+    copy(mesh.uvs.data(), mesh.uvs.size() * sizeof(math::float2));
+    copy(mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+    return true;
+}
+
+void MeshStreamFile::prefetchLevel(size_t level) const {
+    if (level < m_levels.size()) {
+        m_file.advise(m_levels[level].dataOffset, m_levels[level].dataSize, MappedFile::Advice::WillNeed);
+    }
+}
+
+void MeshStreamFile::releaseLevel(size_t level) const {
+    if (level < m_levels.size()) {
+        m_file.advise(m_levels[level].dataOffset, m_levels[level].dataSize, MappedFile::Advice::DontNeed);
+    }
+}
+
+bool MeshStreamFile::write(const std::string& path, const MeshData& mesh, const MeshLodChain& chain) {
+    if (chain.levels.empty() || mesh.positions.empty()) {
+        return false;
+    }
+    bool hasNormals = mesh.normals.size() == mesh.positions.size();
+    bool hasUvs = mesh.uvs.size() == mesh.positions.size();
+
+    FileHeader header;
+    header.magic = STREAM_MAGIC;
+    header.version = STREAM_VERSION;
+    header.levelCount = static_cast<uint32_t>(chain.levels.size());
+    header.flags = (hasNormals ? FLAG_NORMALS : 0) | (hasUvs ? FLAG_UVS : 0);
+    math::aabb bounds = mesh.computeBounds();
+    header.boundsMin[0] = bounds.min.x;
+    header.boundsMin[1] = bounds.min.y;
+    header.boundsMin[2] = bounds.min.z;
+    header.boundsMax[0] = bounds.max.x;
+    header.boundsMax[1] = bounds.max.y;
+    header.boundsMax[2] = bounds.max.z;
+
+    // 各级按首次引用的顺序重新编号顶点
+    std::vector<MeshData> levels(chain.levels.size());
+    std::vector<LevelEntry> entries(chain.levels.size());
+    std::vector<uint32_t> remap(mesh.positions.size());
+    uint64_t offset = alignBlock(sizeof(header) + entries.size() * sizeof(LevelEntry));
+    for (size_t i = 0; i < chain.levels.size(); ++i) {
+        const MeshLodLevel& level = chain.levels[i];
+        MeshData& block = levels[i];
+        std::fill(remap.begin(), remap.end(), std::numeric_limits<uint32_t>::max());
+        block.indices.resize(level.indexCount);
+        for (uint32_t k = 0; k < level.indexCount; ++k) {
+            uint32_t index = chain.indices[level.indexOffset + k];
+            if (remap[index] == std::numeric_limits<uint32_t>::max()) {
+                remap[index] = static_cast<uint32_t>(block.positions.size());
+                block.positions.push_back(mesh.positions[index]);
+                if (hasNormals) {
+                    block.normals.push_back(mesh.normals[index]);
+                }
+                if (hasUvs) {
+                    block.uvs.push_back(mesh.uvs[index]);
+                }
+            }
+            block.indices[k] = remap[index];
+        }
+
+        LevelEntry& entry = entries[i];
+        entry.error = level.error;
+        entry.vertexCount = static_cast<uint32_t>(block.positions.size());
+        entry.indexCount = level.indexCount;
+        entry.reserved = 0;
+        entry.dataOffset = offset;
+        entry.dataSize = getBlockSize(entry.vertexCount, entry.indexCount, hasNormals, hasUvs);
+        offset = alignBlock(offset + entry.dataSize);
+    }
+
+    std::error_code error;
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, error);
+        if (error) {
+            return false;
+        }
+    }
+
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(LevelEntry));
+        for (size_t i = 0; i < levels.size(); ++i) {
+            const MeshData& block = levels[i];
+            uint64_t position = static_cast<uint64_t>(file.tellp());
+            std::vector<char> padding(static_cast<size_t>(entries[i].dataOffset - position), 0);
+            file.write(padding.data(), padding.size());
+            file.write(reinterpret_cast<const char*>(block.positions.data()), block.positions.size() * sizeof(math::float3));
+            file.write(reinterpret_cast<const char*>(block.normals.data()), block.normals.size() * sizeof(math::float3));
+            file.write(reinterpret_cast<const char*>(block.uvs.data()), block.uvs.size() * sizeof(math::float2));
+            file.write(reinterpret_cast<const char*>(block.indices.data()), block.indices.size() * sizeof(uint32_t));
+        }
+        if (!file) {
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, error);
+    return !error;
+}
+
+MeshStreamCache::MeshStreamCache(const std::string& directory) : m_directory(directory) {
+}
+
+std::string MeshStreamCache::getPath(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.kstm", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(m_directory) / name).string();
+}
+
+std::string MeshStreamCache::getOrBuild(const MeshData& mesh, const MeshLodChain::Options& options, MeshLodCache* lodCache) {
+    uint64_t key = MeshLodCache::makeKey(mesh, options);
+    std::string path = getPath(key);
+
+    // 已存在且能通过校验则直接使用
+    MeshStreamFile existing;
+    if (existing.open(path)) {
+        m_stats.hits++;
+        return path;
+    }
+
+    MeshLodChain chain = lodCache ? lodCache->getOrBuild(mesh, options) : MeshLodChain::build(mesh, options);
+    if (!MeshStreamFile::write(path, mesh, chain)) {
+        return std::string();
+    }
+    m_stats.writes++;
+    return path;
+}
+
+} // namespace Kazia
@@ -0,0 +1,86 @@
+#ifndef MESHSTREAM_H
+#define MESHSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MeshData.h"
+#include "MeshLod.h"
+#include "utils/MappedFile.h"
+
+namespace Kazia {
+
+// 可流式载入的网格文件
+// 每一级 LOD 是独立的数据块（只包含该级引用的顶点和重新编号的索引），按页对齐存放，
+// 可以单独从内存映射中读取和丢弃；文件头和级别表很小，打开时就全部读入
+class MeshStreamFile {
+public:
+    struct Level {
+        float error = 0.0f;         // 相对原网格的误差（网格局部空间中的距离）
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        uint64_t dataOffset = 0;    // 数据块在文件中的位置：位置、法线、UV、索引依次存放
+        uint64_t dataSize = 0;
+    };
+
+private:
+    MappedFile m_file;
+    std::vector<Level> m_levels;
+    math::aabb m_bounds;
+    bool m_hasNormals;
+    bool m_hasUvs;
+
+public:
+    MeshStreamFile();
+
+    // 映射文件并校验头部、级别表和每一级的索引（索引须小于该级的顶点数）
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    const std::vector<Level>& getLevels() const { return m_levels; }
+    size_t getLevelCount() const { return m_levels.size(); }
+    const math::aabb& getBounds() const { return m_bounds; }
+    bool hasNormals() const { return m_hasNormals; }
+    bool hasUvs() const { return m_hasUvs; }
+
+    // 从映射中复制一级的数据（首次访问时产生缺页 I/O），级别不存在时返回 false
+    bool readLevel(size_t level, MeshData& mesh) const;
+
+    // 预读一级的数据 / 读取完成后把对应的页移出工作集
+    void prefetchLevel(size_t level) const;
+    void releaseLevel(size_t level) const;
+
+    // 写入 LOD 链，每一级只保留引用到的顶点；先写临时文件再改名
+    static bool write(const std::string& path, const MeshData& mesh, const MeshLodChain& chain);
+};
+
+// 流式网格文件的磁盘缓存，与 LOD 缓存使用相同的键（网格内容和 LOD 参数的哈希）
+class MeshStreamCache {
+public:
+    struct Stats {
+        size_t hits = 0;
+        size_t writes = 0;
+    };
+
+private:
+    std::string m_directory;
+    Stats m_stats;
+
+public:
+    explicit MeshStreamCache(const std::string& directory);
+
+    // 返回网格对应的流式文件路径，不存在时生成 LOD 链（lodCache 不为空时经由 LOD 缓存）并写入；失败返回空字符串
+    std::string getOrBuild(const MeshData& mesh, const MeshLodChain::Options& options, MeshLodCache* lodCache = nullptr);
+
+    const std::string& getDirectory() const { return m_directory; }
+    const Stats& getStats() const { return m_stats; }
+
+    std::string getPath(uint64_t key) const;
+};
+
+} // namespace Kazia
+
+#endif // MESHSTREAM_H
@@ -0,0 +1,287 @@
+#include "MeshStreamer.h"
+
+#include <algorithm>
+
+namespace Kazia {
+
+MeshStreamer::MeshStreamer() : MeshStreamer(Options()) {
+}
+
+MeshStreamer::MeshStreamer(const Options& options) : m_options(options), m_frame(0), m_stop(false) {
+    uint32_t threadCount = std::max(options.ioThreads, 1u);
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        m_threads.emplace_back([this]() {
+            ioThread();
+        });
+    }
+}
+
+MeshStreamer::~MeshStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+MeshStreamer::MeshHandle MeshStreamer::addMesh(const std::string& path, MeshData& coarsestLevel) {
+    auto file = std::make_shared<MeshStreamFile>();
+    if (!file->open(path)) {
+        return MeshHandle();
+    }
+
+    // 最粗的一级同步读入并常驻，保证网格总有可以绘制的数据
+    uint32_t pinnedLevel = static_cast<uint32_t>(file->getLevelCount() - 1);
+    if (!file->readLevel(pinnedLevel, coarsestLevel)) {
+        return MeshHandle();
+    }
+    file->releaseLevel(pinnedLevel);
+
+    size_t size = static_cast<size_t>(file->getLevels()[pinnedLevel].dataSize);
+    m_stats.residentBytes += size;
+    m_stats.pinnedBytes += size;
+    m_stats.bytesRead += size;
+
+    MeshEntry entry;
+    entry.levels.resize(file->getLevelCount());
+    entry.levels[pinnedLevel].status = LevelStatus::Resident;
+    entry.pinnedLevel = pinnedLevel;
+    entry.file = std::move(file);
+    return m_meshes.insert(std::move(entry));
+}
+
+void MeshStreamer::removeMesh(MeshHandle mesh) {
+    MeshEntry* entry = m_meshes.get(mesh);
+    if (!entry) {
+        return;
+    }
+
+    // 排队中的级别在收回或读完时按句柄失效丢弃，届时再扣除 inflightBytes
+    for (uint32_t level = 0; level < entry->levels.size(); ++level) {
+        if (entry->levels[level].status == LevelStatus::Resident) {
+            size_t size = static_cast<size_t>(entry->file->getLevels()[level].dataSize);
+            m_stats.residentBytes -= size;
+            if (level == entry->pinnedLevel) {
+                m_stats.pinnedBytes -= size;
+            }
+        }
+    }
+    m_meshes.erase(mesh);
+}
+
+const MeshStreamFile* MeshStreamer::getFile(MeshHandle mesh) const {
+    const MeshEntry* entry = m_meshes.get(mesh);
+    return entry ? entry->file.get() : nullptr;
+}
+
+uint32_t MeshStreamer::getPinnedLevel(MeshHandle mesh) const {
+    const MeshEntry* entry = m_meshes.get(mesh);
+    return entry ? entry->pinnedLevel : 0;
+}
+
+bool MeshStreamer::isResident(MeshHandle mesh, uint32_t level) const {
+    const MeshEntry* entry = m_meshes.get(mesh);
+    return entry && level < entry->levels.size() && entry->levels[level].status == LevelStatus::Resident;
+}
+
+void MeshStreamer::request(MeshHandle mesh, uint32_t level, float priority) {
+    MeshEntry* entry = m_meshes.get(mesh);
+    if (!entry || level >= entry->levels.size()) {
+        return;
+    }
+
+    LevelState& state = entry->levels[level];
+    priority = std::max(priority, 0.0f);
+    if (!state.requested) {
+        state.requested = true;
+        state.priority = priority;
+        state.lastRequestFrame = m_frame;
+        m_requested.emplace_back(mesh, level);
+    } else {
+        state.priority = std::max(state.priority, priority);
+    }
+}
+
+void MeshStreamer::update(std::vector<Event>& events) {
+    std::vector<Completion> completions;
+    std::vector<Job> unstarted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        completions.swap(m_completions);
+        unstarted.swap(m_queue);
+    }
+
+    // 还没开始读取的请求收回，下面按本帧的优先级重新排队
+    for (const Job& job : unstarted) {
+        m_stats.inflightBytes -= job.size;
+        if (MeshEntry* entry = m_meshes.get(job.mesh)) {
+            entry->levels[job.level].status = LevelStatus::NotLoaded;
+        }
+    }
+
+    // 读完的级别交给调用方
+    for (Completion& completion : completions) {
+        const Job& job = completion.job;
+        m_stats.inflightBytes -= job.size;
+        MeshEntry* entry = m_meshes.get(job.mesh);
+        if (!entry) {
+            continue;
+        }
+
+        LevelState& state = entry->levels[job.level];
+        if (!completion.success) {
+            state.status = LevelStatus::Failed;
+            m_stats.failedReads++;
+            continue;
+        }
+        state.status = LevelStatus::Resident;
+        m_stats.residentBytes += job.size;
+        m_stats.bytesRead += job.size;
+        m_stats.loads++;
+
+        Event event;
+        event.type = Event::Type::Loaded;
+        event.mesh = job.mesh;
+        event.level = job.level;
+        event.data = std::move(completion.data);
+        events.push_back(std::move(event));
+    }
+
+    // 淘汰候选：本帧请求过的按优先级，其余为负值，越久没有请求越小；降序排列，从末尾淘汰
+    struct Candidate {
+        MeshHandle mesh;
+        uint32_t level;
+        float score;
+        size_t size;
+    };
+    std::vector<Candidate> candidates;
+    for (size_t i = 0; i < m_meshes.size(); ++i) {
+        const MeshEntry& entry = m_meshes.at(i);
+        for (uint32_t level = 0; level < entry.levels.size(); ++level) {
+            const LevelState& state = entry.levels[level];
+            if (level == entry.pinnedLevel || state.status != LevelStatus::Resident) {
+                continue;
+            }
+            float score = state.requested ? state.priority : -1.0f - static_cast<float>(m_frame - state.lastRequestFrame);
+            candidates.push_back({m_meshes.handleAt(i), level, score, static_cast<size_t>(entry.file->getLevels()[level].dataSize)});
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.score > b.score;
+    });
+
+    // 超出预算时先淘汰本帧没有请求的级别
+    size_t reserved = m_stats.residentBytes + m_stats.inflightBytes;
+    while (reserved > m_options.budgetBytes && !candidates.empty() && candidates.back().score < 0.0f) {
+        evict(candidates.back().mesh, candidates.back().level, events);
+        reserved -= candidates.back().size;
+        candidates.pop_back();
+    }
+
+    // 本帧请求且未驻留的级别按优先级从高到低排队，空间不足时只淘汰优先级更低的级别
+    std::vector<Job> jobs;
+    for (const auto& requested : m_requested) {
+        MeshEntry* entry = m_meshes.get(requested.first);
+        if (!entry || entry->levels[requested.second].status != LevelStatus::NotLoaded) {
+            continue;
+        }
+        Job job;
+        job.mesh = requested.first;
+        job.level = requested.second;
+        job.priority = entry->levels[requested.second].priority;
+        job.size = static_cast<size_t>(entry->file->getLevels()[requested.second].dataSize);
+        job.file = entry->file;
+        jobs.push_back(std::move(job));
+    }
+    std::sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) {
+        return a.priority > b.priority;
+    });
+
+    std::vector<Job> queue;
+    for (Job& job : jobs) {
+        // 淘汰所有优先级更低的级别仍放不下时不淘汰，避免为放不下的请求反复丢弃数据
+        size_t freeable = 0;
+        for (auto it = candidates.rbegin(); it != candidates.rend() && it->score < job.priority; ++it) {
+            freeable += it->size;
+        }
+        if (reserved - freeable + job.size > m_options.budgetBytes) {
+            continue;
+        }
+        while (reserved + job.size > m_options.budgetBytes && !candidates.empty() && candidates.back().score < job.priority) {
+            evict(candidates.back().mesh, candidates.back().level, events);
+            reserved -= candidates.back().size;
+            candidates.pop_back();
+        }
+
+        reserved += job.size;
+        m_stats.inflightBytes += job.size;
+        m_meshes.get(job.mesh)->levels[job.level].status = LevelStatus::Queued;
+        queue.push_back(std::move(job));
+    }
+    std::reverse(queue.begin(), queue.end());
+    m_stats.pendingRequests = queue.size();
+
+    if (!queue.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue = std::move(queue);
+        }
+        m_condition.notify_all();
+    }
+
+    // 请求只在一帧内有效
+    for (const auto& requested : m_requested) {
+        if (MeshEntry* entry = m_meshes.get(requested.first)) {
+            entry->levels[requested.second].requested = false;
+            entry->levels[requested.second].priority = 0.0f;
+        }
+    }
+    m_requested.clear();
+    m_frame++;
+}
+
+void MeshStreamer::evict(MeshHandle mesh, uint32_t level, std::vector<Event>& events) {
+    MeshEntry* entry = m_meshes.get(mesh);
+    entry->levels[level].status = LevelStatus::NotLoaded;
+    m_stats.residentBytes -= static_cast<size_t>(entry->file->getLevels()[level].dataSize);
+    m_stats.evictions++;
+
+    Event event;
+    event.type = Event::Type::Evicted;
+    event.mesh = mesh;
+    event.level = level;
+    events.push_back(std::move(event));
+}
+
+void MeshStreamer::ioThread() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() {
+                return m_stop || !m_queue.empty();
+            });
+            if (m_stop) {
+                return;
+            }
+            job = std::move(m_queue.back());
+            m_queue.pop_back();
+        }
+
+        // 缺页 I/O 发生在这里；复制完成后把映射的页移出工作集，驻留的只有交给调用方的数据
+        Completion completion;
+        job.file->prefetchLevel(job.level);
+        completion.success = job.file->readLevel(job.level, completion.data);
+        job.file->releaseLevel(job.level);
+        job.file.reset();
+        completion.job = std::move(job);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_completions.push_back(std::move(completion));
+    }
+}
+
+} // namespace Kazia
@@ -0,0 +1,145 @@
+#ifndef MESHSTREAMER_H
+#define MESHSTREAMER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MeshData.h"
+#include "MeshStream.h"
+#include "SlotMap.h"
+
+namespace Kazia {
+
+// 网格数据的驻留管理
+// 网格登记时同步读入最粗的一级并常驻；更精细的级别由调用方每帧按优先级请求，
+// 在 I/O 线程上从内存映射的流式文件中读取，读完后交给调用方（通常是上传到 GPU）。
+// 驻留字节数超过预算时按优先级淘汰：本帧没有请求的级别先淘汰（越久没有请求越先），
+// 被请求的级别只会为优先级更高的请求让出空间
+class MeshStreamer {
+public:
+    using MeshHandle = SlotHandle;
+
+    struct Options {
+        size_t budgetBytes = size_t(512) << 20;  // 驻留预算（含常驻的最粗级别和正在读取的级别）
+        uint32_t ioThreads = 1;
+    };
+
+    // update 产生的事件，Loaded 时 data 为该级的网格数据
+    struct Event {
+        enum class Type {
+            Loaded,
+            Evicted
+        };
+
+        Type type = Type::Loaded;
+        MeshHandle mesh;
+        uint32_t level = 0;
+        MeshData data;
+    };
+
+    struct Stats {
+        size_t residentBytes = 0;   // 已交给调用方且未淘汰的数据
+        size_t pinnedBytes = 0;     // 其中常驻的最粗级别
+        size_t inflightBytes = 0;   // 已排队或正在读取的数据
+        size_t pendingRequests = 0; // 排队等待读取的请求
+        size_t loads = 0;
+        size_t evictions = 0;
+        size_t failedReads = 0;
+        size_t bytesRead = 0;
+    };
+
+private:
+    enum class LevelStatus {
+        NotLoaded,
+        Queued,     // 已交给 I/O 线程（排队中或正在读取）
+        Resident,
+        Failed      // 读取失败，不再重试
+    };
+
+    struct LevelState {
+        LevelStatus status = LevelStatus::NotLoaded;
+        float priority = 0.0f;          // 本帧请求的最高优先级
+        bool requested = false;
+        uint64_t lastRequestFrame = 0;
+    };
+
+    struct MeshEntry {
+        std::shared_ptr<const MeshStreamFile> file;
+        std::vector<LevelState> levels;
+        uint32_t pinnedLevel = 0;
+    };
+
+    struct Job {
+        MeshHandle mesh;
+        uint32_t level = 0;
+        float priority = 0.0f;
+        size_t size = 0;
+        std::shared_ptr<const MeshStreamFile> file;
+    };
+
+    struct Completion {
+        Job job;
+        bool success = false;
+        MeshData data;
+    };
+
+    Options m_options;
+    SlotMap<MeshEntry> m_meshes;
+    Stats m_stats;
+    uint64_t m_frame;
+
+    // 本帧请求过的级别，update 时遍历
+    std::vector<std::pair<MeshHandle, uint32_t>> m_requested;
+
+    // I/O 队列按优先级升序存放，线程从末尾取；每次 update 整体替换，未开始的请求按新的优先级重新排序
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::vector<Job> m_queue;
+    std::vector<Completion> m_completions;
+    bool m_stop;
+    std::vector<std::thread> m_threads;
+
+public:
+    MeshStreamer();
+    explicit MeshStreamer(const Options& options);
+    ~MeshStreamer();
+
+    MeshStreamer(const MeshStreamer&) = delete;
+    MeshStreamer& operator=(const MeshStreamer&) = delete;
+
+    // 打开流式文件并同步读入最粗的一级，失败时返回无效句柄
+    MeshHandle addMesh(const std::string& path, MeshData& coarsestLevel);
+
+    // 移除网格，调用方负责释放已交出的数据；正在读取的级别完成后丢弃
+    void removeMesh(MeshHandle mesh);
+
+    const MeshStreamFile* getFile(MeshHandle mesh) const;
+    uint32_t getPinnedLevel(MeshHandle mesh) const;
+    bool isResident(MeshHandle mesh, uint32_t level) const;
+
+    // 请求一级数据，priority 越大越先读取（例如投影到屏幕上的半径）；同一帧内多次请求取最大值
+    void request(MeshHandle mesh, uint32_t level, float priority);
+
+    // 每帧调用一次：收取读完的级别，按预算淘汰，按本帧的请求重新排列 I/O 队列
+    void update(std::vector<Event>& events);
+
+    void setBudget(size_t bytes) { m_options.budgetBytes = bytes; }
+    size_t getBudget() const { return m_options.budgetBytes; }
+
+    size_t getMeshCount() const { return m_meshes.size(); }
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    void evict(MeshHandle mesh, uint32_t level, std::vector<Event>& events);
+    void ioThread();
+};
+
+} // namespace Kazia
+
+#endif // MESHSTREAMER_H
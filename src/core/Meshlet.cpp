@@ -0,0 +1,202 @@
+#include "Meshlet.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Kazia {
+
+namespace {
+
+const uint32_t NO_MESHLET = std::numeric_limits<uint32_t>::max();
+
+// 包围球和法线锥
+void computeBounds(Meshlet& meshlet, const math::float3* positions, const uint32_t* indices) {
+    const uint32_t* triangles = indices + meshlet.indexOffset;
+    size_t indexCount = static_cast<size_t>(meshlet.triangleCount) * 3;
+
+    math::aabb box;
+    for (size_t i = 0; i < indexCount; ++i) {
+        box.merge(positions[triangles[i]]);
+    }
+    meshlet.center = box.center();
+    float radiusSquared = 0.0f;
+    for (size_t i = 0; i < indexCount; ++i) {
+        math::float3 offset = positions[triangles[i]] - meshlet.center;
+        radiusSquared = std::max(radiusSquared, math::dot(offset, offset));
+    }
+    meshlet.radius = std::sqrt(radiusSquared);
+
+    // 法线锥轴取单位法线之和的方向，退化三角形不产生像素，不参与
+    math::float3 normals[256];
+    size_t normalCount = 0;
+    math::float3 axis;
+    for (size_t i = 0; i < indexCount; i += 3) {
+        const math::float3& a = positions[triangles[i]];
+        math::float3 normal = math::cross(positions[triangles[i + 1]] - a, positions[triangles[i + 2]] - a);
+        float length = math::length(normal);
+        if (length <= 0.0f) {
+            continue;
+        }
+        normals[normalCount++] = normal / length;
+        axis = axis + normal / length;
+    }
+
+    meshlet.coneAxis = math::float3();
+    meshlet.coneCutoff = 1.0f;
+    float axisLength = math::length(axis);
+    if (normalCount == 0 || axisLength <= 1e-6f) {
+        return;
+    }
+    axis = axis / axisLength;
+
+    float minDot = 1.0f;
+    for (size_t i = 0; i < normalCount; ++i) {
+        minDot = std::min(minDot, math::dot(axis, normals[i]));
+    }
+    meshlet.coneAxis = axis;
+    if (minDot > 0.0f) {
+        meshlet.coneCutoff = std::sqrt(std::max(0.0f, 1.0f - minDot * minDot));
+    }
+}
+
+} // namespace
+
+MeshletSet MeshletSet::build(const math::float3* positions, size_t vertexCount,
+                             const uint32_t* indices, size_t indexCount, const Options& options) {
+    MeshletSet result;
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0 || vertexCount == 0) {
+        return result;
+    }
+    // 计算法线锥时每个分簇最多 256 个三角形
+    uint32_t maxTriangles = std::clamp(options.maxTriangles, 1u, 256u);
+    uint32_t maxVertices = std::max(options.maxVertices, 3u);
+
+    // 顶点到三角形的邻接表（CSR）
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        adjacencyOffsets[indices[i] + 1]++;
+    }
+    for (size_t v = 0; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<math::float3> centroids(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        centroids[t] = (positions[indices[t * 3]] + positions[indices[t * 3 + 1]] + positions[indices[t * 3 + 2]]) / 3.0f;
+    }
+
+    std::vector<bool> assigned(triangleCount, false);
+    std::vector<uint32_t> vertexMeshlet(vertexCount, NO_MESHLET);     // 顶点最近一次被哪个分簇引用
+    std::vector<uint32_t> candidateMeshlet(triangleCount, NO_MESHLET); // 三角形最近一次成为哪个分簇的候选
+    std::vector<uint32_t> candidates;
+    result.indices.reserve(triangleCount * 3);
+
+    size_t seed = 0;
+    size_t assignedCount = 0;
+    while (assignedCount < triangleCount) {
+        while (assigned[seed]) {
+            seed++;
+        }
+
+        uint32_t meshletIndex = static_cast<uint32_t>(result.meshlets.size());
+        Meshlet meshlet;
+        meshlet.indexOffset = static_cast<uint32_t>(result.indices.size());
+        math::float3 centroidSum;
+
+        candidates.clear();
+        candidates.push_back(static_cast<uint32_t>(seed));
+        candidateMeshlet[seed] = meshletIndex;
+
+        while (meshlet.triangleCount < maxTriangles) {
+            // 选出新增顶点最少、离分簇中心最近的候选，同时移除已分配的候选
+            math::float3 center = meshlet.triangleCount > 0 ? centroidSum / static_cast<float>(meshlet.triangleCount) : centroids[seed];
+            size_t best = candidates.size();
+            uint32_t bestNewVertices = 4;
+            float bestDistance = 0.0f;
+            for (size_t c = 0; c < candidates.size();) {
+                uint32_t triangle = candidates[c];
+                if (assigned[triangle]) {
+                    candidates[c] = candidates.back();
+                    candidates.pop_back();
+                    continue;
+                }
+
+                uint32_t newVertices = 0;
+                for (int k = 0; k < 3; ++k) {
+                    newVertices += vertexMeshlet[indices[triangle * 3 + k]] != meshletIndex ? 1 : 0;
+                }
+                if (meshlet.vertexCount + newVertices <= maxVertices) {
+                    math::float3 offset = centroids[triangle] - center;
+                    float distance = math::dot(offset, offset);
+                    if (newVertices < bestNewVertices || (newVertices == bestNewVertices && distance < bestDistance)) {
+                        best = c;
+                        bestNewVertices = newVertices;
+                        bestDistance = distance;
+                    }
+                }
+                ++c;
+            }
+            if (best == candidates.size()) {
+                break;
+            }
+
+            uint32_t triangle = candidates[best];
+            candidates[best] = candidates.back();
+            candidates.pop_back();
+
+            assigned[triangle] = true;
+            assignedCount++;
+            meshlet.triangleCount++;
+            centroidSum = centroidSum + centroids[triangle];
+            for (int k = 0; k < 3; ++k) {
+                uint32_t vertex = indices[triangle * 3 + k];
+                result.indices.push_back(vertex);
+                if (vertexMeshlet[vertex] != meshletIndex) {
+                    vertexMeshlet[vertex] = meshletIndex;
+                    meshlet.vertexCount++;
+                }
+
+                // 共享该顶点的未分配三角形成为候选
+                for (uint32_t a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex + 1]; ++a) {
+                    uint32_t neighbor = adjacency[a];
+                    if (!assigned[neighbor] && candidateMeshlet[neighbor] != meshletIndex) {
+                        candidateMeshlet[neighbor] = meshletIndex;
+                        candidates.push_back(neighbor);
+                    }
+                }
+            }
+        }
+
+        computeBounds(meshlet, positions, result.indices.data());
+        result.meshlets.push_back(meshlet);
+    }
+    return result;
+}
+
+bool MeshletCuller::isBackfacing(const Meshlet& meshlet, const math::float3& localCameraPosition) {
+    if (meshlet.coneCutoff >= 1.0f) {
+        return false;
+    }
+
+    // 包围球内任意一点 p 都满足 dot(p - camera, axis) >= sin(α) * |p - camera| 时，所有三角形都背向相机
+    math::float3 view = meshlet.center - localCameraPosition;
+    float distance = math::length(view);
+    return math::dot(view, meshlet.coneAxis) >= meshlet.coneCutoff * distance + meshlet.radius * (1.0f + meshlet.coneCutoff);
+}
+
+bool MeshletCuller::isVisible(const Meshlet& meshlet, const math::frustum& localFrustum,
+                              const math::float3& localCameraPosition, bool backfaceCulling) {
+    if (!localFrustum.intersectsSphere(meshlet.center, meshlet.radius)) {
+        return false;
+    }
+    return !backfaceCulling || !isBackfacing(meshlet, localCameraPosition);
+}
+
+} // namespace Kazia
@@ -0,0 +1,61 @@
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Math.h"
+
+namespace Kazia {
+
+// 网格分簇（meshlet）：空间上相邻的一小组三角形，带包围球和法线锥，用于比整个网格更细粒度的剔除
+struct Meshlet {
+    uint32_t indexOffset = 0;   // 在 MeshletSet::indices 中的起始位置
+    uint32_t triangleCount = 0;
+    uint32_t vertexCount = 0;   // 引用的不同顶点数
+
+    // 网格局部空间的包围球
+    math::float3 center;
+    float radius = 0.0f;
+
+    // 法线锥：所有三角形法线与 coneAxis 的夹角都不超过 α，coneCutoff = sin(α)；
+    // 为 1 表示法线过于分散（α >= 90°），不能整体背面剔除
+    math::float3 coneAxis;
+    float coneCutoff = 1.0f;
+};
+
+struct MeshletSet {
+    struct Options {
+        uint32_t maxTriangles = 128;
+        uint32_t maxVertices = 128;
+    };
+
+    std::vector<Meshlet> meshlets;
+
+    // 按分簇重排后的索引，每个分簇的三角形连续存放，三角形集合与输入相同
+    std::vector<uint32_t> indices;
+
+    bool empty() const { return meshlets.empty(); }
+
+    // 贪心地从种子三角形沿共享顶点扩展：优先选择新增顶点最少的三角形，其次是离分簇中心最近的三角形，
+    // 达到三角形或顶点上限、或没有相邻三角形时结束当前分簇。种子按输入顺序选取，输入最好已按顶点缓存优化
+    static MeshletSet build(const math::float3* positions, size_t vertexCount,
+                            const uint32_t* indices, size_t indexCount, const Options& options);
+};
+
+// 分簇剔除，在网格局部空间中进行（视锥体由 viewProjection * world 提取，相机位置变换到局部空间）
+// 平面两侧的判断在仿射变换下不变，因此非均匀缩放时结果仍然正确
+class MeshletCuller {
+public:
+    // 包围球与视锥体相交，且（backfaceCulling 时）不是整体背向相机
+    static bool isVisible(const Meshlet& meshlet, const math::frustum& localFrustum,
+                          const math::float3& localCameraPosition, bool backfaceCulling);
+
+    // 整个分簇的三角形都背向相机（保守判断）
+    static bool isBackfacing(const Meshlet& meshlet, const math::float3& localCameraPosition);
+};
+
+} // namespace Kazia
+
+#endif // MESHLET_H
@@ -0,0 +1,82 @@
+#ifndef PAGEDBITSET_H
+#define PAGEDBITSET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Kazia {
+
+// 分页位图
+// 以单调递增的 ID（如 Node::getId()）为下标，按 PAGE_BITS 位一页按需分配，页中的位全部清除后立即释放。
+// 占用的内存由置位的 ID 分布决定，页目录每 PAGE_BITS 个 ID 只占一个指针，与创建过的 ID 总数基本无关
+class PagedBitset {
+public:
+    static constexpr uint32_t PAGE_SHIFT = 12;
+    static constexpr uint32_t PAGE_BITS = 1u << PAGE_SHIFT;
+
+private:
+    struct Page {
+        uint64_t words[PAGE_BITS / 64] = {};
+        uint32_t count = 0;     // 置位的数量，为 0 时释放
+    };
+
+    std::vector<std::unique_ptr<Page>> m_pages;
+    size_t m_pageCount = 0;
+
+public:
+    bool test(uint32_t id) const {
+        size_t page = id >> PAGE_SHIFT;
+        return page < m_pages.size() && m_pages[page] && (m_pages[page]->words[(id & (PAGE_BITS - 1)) >> 6] & (1ull << (id & 63))) != 0;
+    }
+
+    // 置位/清除，返回状态是否发生变化
+    bool set(uint32_t id) {
+        size_t page = id >> PAGE_SHIFT;
+        if (page >= m_pages.size()) {
+            m_pages.resize(page + 1);
+        }
+        if (!m_pages[page]) {
+            m_pages[page] = std::make_unique<Page>();
+            m_pageCount++;
+        }
+        Page& p = *m_pages[page];
+        uint64_t& word = p.words[(id & (PAGE_BITS - 1)) >> 6];
+        uint64_t mask = 1ull << (id & 63);
+        if (word & mask) {
+            return false;
+        }
+        word |= mask;
+        p.count++;
+        return true;
+    }
+
+    bool clear(uint32_t id) {
+        size_t page = id >> PAGE_SHIFT;
+        if (page >= m_pages.size() || !m_pages[page]) {
+            return false;
+        }
+        Page& p = *m_pages[page];
+        uint64_t& word = p.words[(id & (PAGE_BITS - 1)) >> 6];
+        uint64_t mask = 1ull << (id & 63);
+        if (!(word & mask)) {
+            return false;
+        }
+        word &= ~mask;
+        if (--p.count == 0) {
+            m_pages[page].reset();
+            m_pageCount--;
+        }
+        return true;
+    }
+
+    // 页目录和已分配的页占用的内存
+    size_t getMemorySize() const {
+        return m_pages.capacity() * sizeof(std::unique_ptr<Page>) + m_pageCount * sizeof(Page);
+    }
+};
+
+} // namespace Kazia
+
+#endif // PAGEDBITSET_H
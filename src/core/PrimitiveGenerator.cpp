@@ -0,0 +1,484 @@
+#include "PrimitiveGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+namespace Kazia {
+
+namespace {
+
+const float PI = 3.14159265358979323846f;
+
+// 顺序写入顶点和索引
+template<typename Index>
+struct Writer {
+    PrimitiveVertex* vertices;
+    Index* indices;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+
+    uint32_t vertex(const math::float3& position, const math::float3& normal, const math::float2& uv) {
+        PrimitiveVertex& v = vertices[vertexCount];
+        v.position = position;
+        v.normal = normal;
+        v.uv = uv;
+        return vertexCount++;
+    }
+
+    void triangle(uint32_t a, uint32_t b, uint32_t c) {
+        indices[indexCount++] = static_cast<Index>(a);
+        indices[indexCount++] = static_cast<Index>(b);
+        indices[indexCount++] = static_cast<Index>(c);
+    }
+};
+
+template<typename Index>
+void generateCube(const PrimitiveDesc& desc, Writer<Index>& writer) {
+    // 每个面的法线和两条边的方向，cross(u, v) == normal
+    struct Face {
+        math::float3 normal;
+        math::float3 u;
+        math::float3 v;
+    };
+    const Face faces[] = {
+        {{0, 0, 1}, {1, 0, 0}, {0, 1, 0}},
+        {{0, 0, -1}, {-1, 0, 0}, {0, 1, 0}},
+        {{1, 0, 0}, {0, 0, -1}, {0, 1, 0}},
+        {{-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
+        {{0, 1, 0}, {1, 0, 0}, {0, 0, -1}},
+        {{0, -1, 0}, {1, 0, 0}, {0, 0, 1}}
+    };
+
+    float halfSize = desc.size * 0.5f;
+    for (const Face& face : faces) {
+        math::float3 center = face.normal * halfSize;
+        math::float3 u = face.u * halfSize;
+        math::float3 v = face.v * halfSize;
+        uint32_t first = writer.vertex(center - u - v, face.normal, {0, 0});
+        writer.vertex(center + u - v, face.normal, {1, 0});
+        writer.vertex(center + u + v, face.normal, {1, 1});
+        writer.vertex(center - u + v, face.normal, {0, 1});
+        writer.triangle(first, first + 1, first + 2);
+        writer.triangle(first, first + 2, first + 3);
+    }
+}
+
+template<typename Index>
+void generateUvSphere(const PrimitiveDesc& desc, Writer<Index>& writer) {
+    uint32_t segments = desc.segments;
+    uint32_t rings = desc.rings;
+    for (uint32_t r = 0; r <= rings; ++r) {
+        float phi = PI * r / rings;
+        float sinPhi = std::sin(phi);
+        float cosPhi = std::cos(phi);
+        for (uint32_t s = 0; s <= segments; ++s) {
+            float theta = 2.0f * PI * s / segments;
+            math::float3 normal(sinPhi * std::cos(theta), cosPhi, sinPhi * std::sin(theta));
+            // 极点处的 u 取所在三角形的中点，减少纹理扭曲
+            float u = (r == 0 || r == rings) ? (s + 0.5f) / segments : static_cast<float>(s) / segments;
+            writer.vertex(normal * desc.size, normal, {u, 1.0f - static_cast<float>(r) / rings});
+        }
+    }
+
+    // 极点处的一行只有一个三角形
+    for (uint32_t r = 0; r < rings; ++r) {
+        for (uint32_t s = 0; s < segments; ++s) {
+            uint32_t a = r * (segments + 1) + s;
+            uint32_t b = a + segments + 1;
+            if (r != 0) {
+                writer.triangle(a, a + 1, b);
+            }
+            if (r != rings - 1) {
+                writer.triangle(a + 1, b + 1, b);
+            }
+        }
+    }
+}
+
+template<typename Index>
+void generateIcoSphere(const PrimitiveDesc& desc, Writer<Index>& writer) {
+    const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+    const math::float3 corners[12] = {
+        {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+        {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+        {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}
+    };
+    const uint32_t faces[60] = {
+        0, 11, 5,  0, 5, 1,  0, 1, 7,  0, 7, 10,  0, 10, 11,
+        1, 5, 9,  5, 11, 4,  11, 10, 2,  10, 7, 6,  7, 1, 8,
+        3, 9, 4,  3, 4, 2,  3, 2, 6,  3, 6, 8,  3, 8, 9,
+        4, 9, 5,  2, 4, 11,  6, 2, 10,  8, 6, 7,  9, 8, 1
+    };
+
+    // 球面坐标 UV；二十面体球不在接缝处重复顶点，跨越接缝的三角形 UV 会回绕，适合不依赖 UV 的用途
+    auto addVertex = [&writer, &desc](const math::float3& direction) {
+        math::float3 normal = math::normalize(direction);
+        float u = 0.5f + std::atan2(normal.z, normal.x) / (2.0f * PI);
+        float v = 0.5f + std::asin(std::clamp(normal.y, -1.0f, 1.0f)) / PI;
+        return writer.vertex(normal * desc.size, normal, {u, v});
+    };
+
+    for (const math::float3& corner : corners) {
+        addVertex(corner);
+    }
+    std::vector<uint32_t> triangles(faces, faces + 60);
+
+    // 每次细分把一个三角形分成四个，共享边的中点只生成一次
+    std::unordered_map<uint64_t, uint32_t> midpoints;
+    for (uint32_t level = 0; level < desc.subdivisions; ++level) {
+        midpoints.clear();
+        midpoints.reserve(triangles.size());
+        auto midpoint = [&](uint32_t a, uint32_t b) {
+            uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+            auto it = midpoints.find(key);
+            if (it != midpoints.end()) {
+                return it->second;
+            }
+            uint32_t index = addVertex(writer.vertices[a].normal + writer.vertices[b].normal);
+            midpoints.emplace(key, index);
+            return index;
+        };
+
+        std::vector<uint32_t> subdivided;
+        subdivided.reserve(triangles.size() * 4);
+        for (size_t i = 0; i < triangles.size(); i += 3) {
+            uint32_t a = triangles[i];
+            uint32_t b = triangles[i + 1];
+            uint32_t c = triangles[i + 2];
+            uint32_t ab = midpoint(a, b);
+            uint32_t bc = midpoint(b, c);
+            uint32_t ca = midpoint(c, a);
+            subdivided.insert(subdivided.end(), {a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca});
+        }
+        triangles.swap(subdivided);
+    }
+
+    for (size_t i = 0; i < triangles.size(); i += 3) {
+        writer.triangle(triangles[i], triangles[i + 1], triangles[i + 2]);
+    }
+}
+
+// 端面：中心加一圈顶点，up 为 true 时朝 +Y
+template<typename Index>
+void generateCap(Writer<Index>& writer, float radius, float y, uint32_t segments, bool up) {
+    math::float3 normal(0.0f, up ? 1.0f : -1.0f, 0.0f);
+    uint32_t center = writer.vertex({0.0f, y, 0.0f}, normal, {0.5f, 0.5f});
+    for (uint32_t s = 0; s <= segments; ++s) {
+        float theta = 2.0f * PI * s / segments;
+        float c = std::cos(theta);
+        float n = std::sin(theta);
+        writer.vertex({radius * c, y, radius * n}, normal, {0.5f + 0.5f * c, 0.5f + 0.5f * (up ? -n : n)});
+    }
+    for (uint32_t s = 0; s < segments; ++s) {
+        uint32_t rim = center + 1 + s;
+        if (up) {
+            writer.triangle(center, rim + 1, rim);
+        } else {
+            writer.triangle(center, rim, rim + 1);
+        }
+    }
+}
+
+template<typename Index>
+void generateCylinder(const PrimitiveDesc& desc, Writer<Index>& writer) {
+    uint32_t segments = desc.segments;
+    float halfHeight = desc.height * 0.5f;
+
+    // 侧面：底部一行和顶部一行，接缝处重复顶点
+    for (uint32_t row = 0; row < 2; ++row) {
+        float y = row == 0 ? -halfHeight : halfHeight;
+        for (uint32_t s = 0; s <= segments; ++s) {
+            float theta = 2.0f * PI * s / segments;
+            math::float3 normal(std::cos(theta), 0.0f, std::sin(theta));
+            writer.vertex({desc.size * normal.x, y, desc.size * normal.z}, normal, {static_cast<float>(s) / segments, static_cast<float>(row)});
+        }
+    }
+    for (uint32_t s = 0; s < segments; ++s) {
+        uint32_t bottom = s;
+        uint32_t top = s + segments + 1;
+        writer.triangle(bottom, top, bottom + 1);
+        writer.triangle(bottom + 1, top, top + 1);
+    }
+
+    generateCap(writer, desc.size, halfHeight, segments, true);
+    generateCap(writer, desc.size, -halfHeight, segments, false);
+}
+
+template<typename Index>
+void generateCone(const PrimitiveDesc& desc, Writer<Index>& writer) {
+    uint32_t segments = desc.segments;
+    float halfHeight = desc.height * 0.5f;
+
+    // 侧面法线垂直于母线
+    auto slantNormal = [&desc](float theta) {
+        return math::normalize(math::float3(desc.height * std::cos(theta), desc.size, desc.height * std::sin(theta)));
+    };
+
+    // 底部一圈顶点，顶点处每个分段一个顶点（法线取分段中间的方向）
+    for (uint32_t s = 0; s <= segments; ++s) {
+        float theta = 2.0f * PI * s / segments;
+        writer.vertex({desc.size * std::cos(theta), -halfHeight, desc.size * std::sin(theta)}, slantNormal(theta),
+                      {static_cast<float>(s) / segments, 0.0f});
+    }
+    for (uint32_t s = 0; s < segments; ++s) {
+        float theta = 2.0f * PI * (s + 0.5f) / segments;
+        writer.vertex({0.0f, halfHeight, 0.0f}, slantNormal(theta), {(s + 0.5f) / segments, 1.0f});
+    }
+    for (uint32_t s = 0; s < segments; ++s) {
+        writer.triangle(s, segments + 1 + s, s + 1);
+    }
+
+    generateCap(writer, desc.size, -halfHeight, segments, false);
+}
+
+template<typename Index>
+void generateTorus(const PrimitiveDesc& desc, Writer<Index>& writer) {
+    uint32_t segments = desc.segments;
+    uint32_t rings = desc.rings;
+    for (uint32_t i = 0; i <= segments; ++i) {
+        float theta = 2.0f * PI * i / segments;
+        float cosTheta = std::cos(theta);
+        float sinTheta = std::sin(theta);
+        math::float3 center(desc.size * cosTheta, 0.0f, desc.size * sinTheta);
+        for (uint32_t j = 0; j <= rings; ++j) {
+            float phi = 2.0f * PI * j / rings;
+            math::float3 normal(std::cos(phi) * cosTheta, std::sin(phi), std::cos(phi) * sinTheta);
+            writer.vertex(center + normal * desc.minorRadius, normal, {static_cast<float>(i) / segments, static_cast<float>(j) / rings});
+        }
+    }
+
+    for (uint32_t i = 0; i < segments; ++i) {
+        for (uint32_t j = 0; j < rings; ++j) {
+            uint32_t a = i * (rings + 1) + j;
+            uint32_t b = a + rings + 1;
+            writer.triangle(a, a + 1, b);
+            writer.triangle(b, a + 1, b + 1);
+        }
+    }
+}
+
+template<typename Index>
+void generatePlane(const PrimitiveDesc& desc, Writer<Index>& writer) {
+    uint32_t n = desc.subdivisions;
+    float halfSize = desc.size * 0.5f;
+    for (uint32_t z = 0; z <= n; ++z) {
+        for (uint32_t x = 0; x <= n; ++x) {
+            float u = static_cast<float>(x) / n;
+            float v = static_cast<float>(z) / n;
+            writer.vertex({-halfSize + desc.size * u, 0.0f, -halfSize + desc.size * v}, {0.0f, 1.0f, 0.0f}, {u, 1.0f - v});
+        }
+    }
+
+    for (uint32_t z = 0; z < n; ++z) {
+        for (uint32_t x = 0; x < n; ++x) {
+            uint32_t a = z * (n + 1) + x;
+            uint32_t c = a + n + 1;
+            writer.triangle(a, c, a + 1);
+            writer.triangle(a + 1, c, c + 1);
+        }
+    }
+}
+
+} // namespace
+
+PrimitiveDesc PrimitiveDesc::cube(float size) {
+    PrimitiveDesc desc;
+    desc.type = PrimitiveType::Cube;
+    desc.size = size;
+    return desc;
+}
+
+PrimitiveDesc PrimitiveDesc::uvSphere(float radius, uint32_t segments, uint32_t rings) {
+    PrimitiveDesc desc;
+    desc.type = PrimitiveType::UvSphere;
+    desc.size = radius;
+    desc.segments = segments;
+    desc.rings = rings;
+    return desc;
+}
+
+PrimitiveDesc PrimitiveDesc::icoSphere(float radius, uint32_t subdivisions) {
+    PrimitiveDesc desc;
+    desc.type = PrimitiveType::IcoSphere;
+    desc.size = radius;
+    desc.subdivisions = subdivisions;
+    return desc;
+}
+
+PrimitiveDesc PrimitiveDesc::cylinder(float radius, float height, uint32_t segments) {
+    PrimitiveDesc desc;
+    desc.type = PrimitiveType::Cylinder;
+    desc.size = radius;
+    desc.height = height;
+    desc.segments = segments;
+    return desc;
+}
+
+PrimitiveDesc PrimitiveDesc::cone(float radius, float height, uint32_t segments) {
+    PrimitiveDesc desc;
+    desc.type = PrimitiveType::Cone;
+    desc.size = radius;
+    desc.height = height;
+    desc.segments = segments;
+    return desc;
+}
+
+PrimitiveDesc PrimitiveDesc::torus(float majorRadius, float minorRadius, uint32_t segments, uint32_t rings) {
+    PrimitiveDesc desc;
+    desc.type = PrimitiveType::Torus;
+    desc.size = majorRadius;
+    desc.minorRadius = minorRadius;
+    desc.segments = segments;
+    desc.rings = rings;
+    return desc;
+}
+
+PrimitiveDesc PrimitiveDesc::plane(float size, uint32_t subdivisions) {
+    PrimitiveDesc desc;
+    desc.type = PrimitiveType::Plane;
+    desc.size = size;
+    desc.subdivisions = subdivisions;
+    return desc;
+}
+
+PrimitiveDesc PrimitiveGenerator::normalize(const PrimitiveDesc& desc) {
+    // 只保留该类型使用的字段，其余恢复默认值
+    PrimitiveDesc result;
+    result.type = desc.type;
+    result.size = desc.size;
+    switch (desc.type) {
+        case PrimitiveType::Cube:
+            break;
+        case PrimitiveType::UvSphere:
+            result.segments = std::max(desc.segments, 3u);
+            result.rings = std::max(desc.rings, 2u);
+            break;
+        case PrimitiveType::IcoSphere:
+            result.subdivisions = std::min(desc.subdivisions, MAX_ICOSPHERE_SUBDIVISIONS);
+            break;
+        case PrimitiveType::Cylinder:
+        case PrimitiveType::Cone:
+            result.height = desc.height;
+            result.segments = std::max(desc.segments, 3u);
+            break;
+        case PrimitiveType::Torus:
+            result.minorRadius = desc.minorRadius;
+            result.segments = std::max(desc.segments, 3u);
+            result.rings = std::max(desc.rings, 3u);
+            break;
+        case PrimitiveType::Plane:
+            result.subdivisions = std::max(desc.subdivisions, 1u);
+            break;
+    }
+    return result;
+}
+
+PrimitiveGenerator::Counts PrimitiveGenerator::count(const PrimitiveDesc& source) {
+    PrimitiveDesc desc = normalize(source);
+    Counts counts;
+    uint32_t segments = desc.segments;
+    switch (desc.type) {
+        case PrimitiveType::Cube:
+            counts.vertexCount = 24;
+            counts.indexCount = 36;
+            break;
+        case PrimitiveType::UvSphere:
+            counts.vertexCount = (desc.rings + 1) * (segments + 1);
+            counts.indexCount = segments * (desc.rings - 1) * 6;
+            break;
+        case PrimitiveType::IcoSphere: {
+            uint32_t scale = 1u << (2 * desc.subdivisions);
+            counts.vertexCount = 10 * scale + 2;
+            counts.indexCount = 60 * scale;
+            break;
+        }
+        case PrimitiveType::Cylinder:
+            counts.vertexCount = 2 * (segments + 1) + 2 * (segments + 2);
+            counts.indexCount = segments * 12;
+            break;
+        case PrimitiveType::Cone:
+            counts.vertexCount = (segments + 1) + segments + (segments + 2);
+            counts.indexCount = segments * 6;
+            break;
+        case PrimitiveType::Torus:
+            counts.vertexCount = (segments + 1) * (desc.rings + 1);
+            counts.indexCount = segments * desc.rings * 6;
+            break;
+        case PrimitiveType::Plane:
+            counts.vertexCount = (desc.subdivisions + 1) * (desc.subdivisions + 1);
+            counts.indexCount = desc.subdivisions * desc.subdivisions * 6;
+            break;
+    }
+    return counts;
+}
+
+template<typename Index>
+void PrimitiveGenerator::generate(const PrimitiveDesc& source, PrimitiveVertex* vertices, Index* indices) {
+    PrimitiveDesc desc = normalize(source);
+    Writer<Index> writer{vertices, indices};
+    switch (desc.type) {
+        case PrimitiveType::Cube:
+            generateCube(desc, writer);
+            break;
+        case PrimitiveType::UvSphere:
+            generateUvSphere(desc, writer);
+            break;
+        case PrimitiveType::IcoSphere:
+            generateIcoSphere(desc, writer);
+            break;
+        case PrimitiveType::Cylinder:
+            generateCylinder(desc, writer);
+            break;
+        case PrimitiveType::Cone:
+            generateCone(desc, writer);
+            break;
+        case PrimitiveType::Torus:
+            generateTorus(desc, writer);
+            break;
+        case PrimitiveType::Plane:
+            generatePlane(desc, writer);
+            break;
+    }
+}
+
+template void PrimitiveGenerator::generate<uint16_t>(const PrimitiveDesc&, PrimitiveVertex*, uint16_t*);
+template void PrimitiveGenerator::generate<uint32_t>(const PrimitiveDesc&, PrimitiveVertex*, uint32_t*);
+
+math::aabb PrimitiveGenerator::getBounds(const PrimitiveDesc& source) {
+    PrimitiveDesc desc = normalize(source);
+    float r = desc.size;
+    switch (desc.type) {
+        case PrimitiveType::Cube:
+            return math::aabb({-r * 0.5f, -r * 0.5f, -r * 0.5f}, {r * 0.5f, r * 0.5f, r * 0.5f});
+        case PrimitiveType::UvSphere:
+        case PrimitiveType::IcoSphere:
+            return math::aabb({-r, -r, -r}, {r, r, r});
+        case PrimitiveType::Cylinder:
+        case PrimitiveType::Cone:
+            return math::aabb({-r, -desc.height * 0.5f, -r}, {r, desc.height * 0.5f, r});
+        case PrimitiveType::Torus: {
+            float outer = r + desc.minorRadius;
+            return math::aabb({-outer, -desc.minorRadius, -outer}, {outer, desc.minorRadius, outer});
+        }
+        case PrimitiveType::Plane:
+            return math::aabb({-r * 0.5f, 0.0f, -r * 0.5f}, {r * 0.5f, 0.0f, r * 0.5f});
+    }
+    return math::aabb();
+}
+
+const char* PrimitiveGenerator::getName(PrimitiveType type) {
+    switch (type) {
+        case PrimitiveType::Cube: return "cube";
+        case PrimitiveType::UvSphere: return "uv_sphere";
+        case PrimitiveType::IcoSphere: return "ico_sphere";
+        case PrimitiveType::Cylinder: return "cylinder";
+        case PrimitiveType::Cone: return "cone";
+        case PrimitiveType::Torus: return "torus";
+        case PrimitiveType::Plane: return "plane";
+    }
+    return "unknown";
+}
+
+} // namespace Kazia
@@ -0,0 +1,77 @@
+#ifndef PRIMITIVEGENERATOR_H
+#define PRIMITIVEGENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Math.h"
+
+namespace Kazia {
+
+// 程序化几何体的交错顶点（32 字节）
+struct PrimitiveVertex {
+    math::float3 position;
+    math::float3 normal;
+    math::float2 uv;
+};
+
+enum class PrimitiveType {
+    Cube,
+    UvSphere,
+    IcoSphere,
+    Cylinder,
+    Cone,
+    Torus,
+    Plane
+};
+
+// 几何体参数，Y 轴向上，以原点为中心
+// 各类型只使用其中一部分字段，未使用的字段保持默认值，参数元组相同的几何体可以共享
+struct PrimitiveDesc {
+    PrimitiveType type = PrimitiveType::Cube;
+    float size = 1.0f;          // 立方体边长 / 平面边长 / 球体、圆柱、圆锥半径 / 圆环主半径
+    float height = 0.0f;        // 圆柱、圆锥高度
+    float minorRadius = 0.0f;   // 圆环截面半径
+    uint32_t segments = 0;      // 绕 Y 轴的分段数（圆环为绕主圆的分段数）
+    uint32_t rings = 0;         // UV 球体纬线分段数 / 圆环截面分段数
+    uint32_t subdivisions = 0;  // 二十面体细分次数 / 平面每边分段数
+
+    static PrimitiveDesc cube(float size);
+    static PrimitiveDesc uvSphere(float radius, uint32_t segments, uint32_t rings);
+    static PrimitiveDesc icoSphere(float radius, uint32_t subdivisions);
+    static PrimitiveDesc cylinder(float radius, float height, uint32_t segments);
+    static PrimitiveDesc cone(float radius, float height, uint32_t segments);
+    static PrimitiveDesc torus(float majorRadius, float minorRadius, uint32_t segments, uint32_t rings);
+    static PrimitiveDesc plane(float size, uint32_t subdivisions);
+};
+
+// 程序化几何体生成
+// 先用 count 得到顶点数和索引数，由调用方分配缓冲区（例如直接用于上传的内存），generate 原地写入，不做额外分配
+// （二十面体细分需要临时的边表）；三角形为逆时针朝外，各函数内部都会先规范化参数
+class PrimitiveGenerator {
+public:
+    struct Counts {
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+    };
+
+    // 二十面体细分次数上限（7 次为 163842 个顶点）
+    static constexpr uint32_t MAX_ICOSPHERE_SUBDIVISIONS = 7;
+
+    // 把分段数等钳制到有效范围，生成和缓存键都应使用规范化后的参数
+    static PrimitiveDesc normalize(const PrimitiveDesc& desc);
+
+    static Counts count(const PrimitiveDesc& desc);
+
+    // Index 为 uint16_t（顶点数不超过 65536）或 uint32_t
+    template<typename Index>
+    static void generate(const PrimitiveDesc& desc, PrimitiveVertex* vertices, Index* indices);
+
+    static math::aabb getBounds(const PrimitiveDesc& desc);
+
+    static const char* getName(PrimitiveType type);
+};
+
+} // namespace Kazia
+
+#endif // PRIMITIVEGENERATOR_H
@@ -1,4 +1,5 @@
 #include "Renderer.h"
+#include "render/RenderSnapshot.h"
 #include <filament/LightManager.h>
 #include <filament/RenderableManager.h>
 #include <filament/VertexBuffer.h>
@@ -12,6 +13,9 @@
 Renderer::Renderer()
     : m_filamentEngine(nullptr)
     , m_isInitialized(false)
+    , m_geometryRegistry(nullptr)
+    , m_viewportWidth(0)
+    , m_viewportHeight(0)
 {
     m_filamentEngine = new FilamentEngine();
 }
@@ -26,6 +30,11 @@ void Renderer::initialize(void* nativeWindow, int width, int height)
 {
     if (m_filamentEngine) {
         m_filamentEngine->initialize(nativeWindow, width, height);
+        m_viewportWidth = width;
+        m_viewportHeight = height;
+
+        // 创建共享几何体注册表
+        m_geometryRegistry = new Kazia::GeometryRegistry(m_filamentEngine->getEngine());
         
         // 先设置为已初始化，这样后续的添加操作才能执行
         m_isInitialized = true;
@@ -41,6 +50,26 @@ void Renderer::initialize(void* nativeWindow, int width, int height)
 void Renderer::shutdown()
 {
     if (m_filamentEngine) {
+        // 先销毁可渲染实体，再销毁它们引用的共享几何体
+        auto engine = m_filamentEngine->getEngine();
+        auto scene = m_filamentEngine->getScene();
+        for (const auto& renderable : m_renderables) {
+            if (scene) {
+                scene->removeEntity(renderable.entity);
+            }
+            if (engine) {
+                engine->destroy(renderable.entity);
+            }
+            utils::EntityManager::get().destroy(renderable.entity);
+            if (m_geometryRegistry) {
+                m_geometryRegistry->release(renderable.geometryKey);
+            }
+        }
+        m_renderables.clear();
+
+        delete m_geometryRegistry;
+        m_geometryRegistry = nullptr;
+
         m_filamentEngine->shutdown();
         m_isInitialized = false;
     }
@@ -57,9 +86,49 @@ void Renderer::resize(int width, int height)
 {
     if (m_filamentEngine && m_isInitialized) {
         m_filamentEngine->resize(width, height);
+        m_viewportWidth = width;
+        m_viewportHeight = height;
     }
 }
 
+void Renderer::setFramePacing(float refreshRate, uint32_t presentInterval)
+{
+    if (!m_filamentEngine || !m_isInitialized) return;
+
+    filament::Renderer* renderer = m_filamentEngine->getRenderer();
+    if (!renderer) return;
+
+    filament::Renderer::DisplayInfo displayInfo;
+    displayInfo.refreshRate = refreshRate;
+    renderer->setDisplayInfo(displayInfo);
+
+    filament::Renderer::FrameRateOptions frameRateOptions;
+    frameRateOptions.interval = static_cast<uint8_t>(presentInterval < 255 ? presentInterval : 255);
+    renderer->setFrameRateOptions(frameRateOptions);
+}
+
+void Renderer::applySnapshot(const Kazia::RenderSnapshot& snapshot)
+{
+    if (!m_filamentEngine || !m_isInitialized) return;
+
+    if (snapshot.width > 0 && snapshot.height > 0 &&
+        (snapshot.width != m_viewportWidth || snapshot.height != m_viewportHeight)) {
+        resize(snapshot.width, snapshot.height);
+    }
+
+    m_filamentEngine->setCameraLookAt(
+        {snapshot.cameraPosition.x, snapshot.cameraPosition.y, snapshot.cameraPosition.z},
+        {snapshot.cameraTarget.x, snapshot.cameraTarget.y, snapshot.cameraTarget.z},
+        {snapshot.cameraUp.x, snapshot.cameraUp.y, snapshot.cameraUp.z});
+
+    if (m_viewportWidth > 0 && m_viewportHeight > 0) {
+        float aspect = static_cast<float>(m_viewportWidth) / static_cast<float>(m_viewportHeight);
+        m_filamentEngine->setCameraProjection(snapshot.fov, aspect, snapshot.nearPlane, snapshot.farPlane);
+    }
+
+    // 旧渲染路径没有节点到实体的映射，snapshot.transforms 由 FilamentRenderer 处理
+}
+
 void Renderer::addDirectionalLight(const filament::math::float3& direction, const filament::math::float3& color, float intensity)
 {
     if (!m_filamentEngine || !m_isInitialized) return;
@@ -126,102 +195,112 @@ void Renderer::setCameraProjection(float fov, float aspect, float near, float fa
 
 void Renderer::addCube(const filament::math::float3& position, const filament::math::float3& size, const filament::math::float3& color)
 {
-    if (!m_filamentEngine || !m_isInitialized) return;
+    if (!m_filamentEngine || !m_isInitialized || !m_geometryRegistry) return;
 
     auto engine = m_filamentEngine->getEngine();
     auto scene = m_filamentEngine->getScene();
 
     if (!engine || !scene) return;
 
-    // 创建立方体实体
-    utils::Entity cubeEntity = utils::EntityManager::get().create();
-
-    // 立方体顶点数据（8个顶点）
     float halfX = size.x * 0.5f;
     float halfY = size.y * 0.5f;
     float halfZ = size.z * 0.5f;
 
-    static const float vertices[] = {
-        // 前面
-        -halfX, -halfY,  halfZ,
-         halfX, -halfY,  halfZ,
-         halfX,  halfY,  halfZ,
-        -halfX,  halfY,  halfZ,
-        // 后面
-        -halfX, -halfY, -halfZ,
-        -halfX,  halfY, -halfZ,
-         halfX,  halfY, -halfZ,
-         halfX, -halfY, -halfZ,
-        // 上面
-        -halfX,  halfY, -halfZ,
-        -halfX,  halfY,  halfZ,
-         halfX,  halfY,  halfZ,
-         halfX,  halfY, -halfZ,
-        // 下面
-        -halfX, -halfY, -halfZ,
-         halfX, -halfY, -halfZ,
-         halfX, -halfY,  halfZ,
-        -halfX, -halfY,  halfZ,
-        // 右面
-         halfX, -halfY, -halfZ,
-         halfX,  halfY, -halfZ,
-         halfX,  halfY,  halfZ,
-         halfX, -halfY,  halfZ,
-        // 左面
-        -halfX, -halfY, -halfZ,
-        -halfX, -halfY,  halfZ,
-        -halfX,  halfY,  halfZ,
-        -halfX,  halfY, -halfZ
-    };
-
-    // 立方体索引数据（36个索引，12个三角形）
-    static const uint16_t indices[] = {
-        // 前面
-        0, 1, 2, 2, 3, 0,
-        // 后面
-        4, 5, 6, 6, 7, 4,
-        // 上面
-        8, 9, 10, 10, 11, 8,
-        // 下面
-        12, 13, 14, 14, 15, 12,
-        // 右面
-        16, 17, 18, 18, 19, 16,
-        // 左面
-        20, 21, 22, 22, 23, 20
-    };
-
-    // 创建顶点缓冲区
-    filament::VertexBuffer* vertexBuffer = filament::VertexBuffer::Builder()
-        .vertexCount(24)
-        .bufferCount(1)
-        .attribute(filament::VertexAttribute::POSITION, 0, filament::VertexBuffer::AttributeType::FLOAT3)
-        .build(*engine);
-
-    vertexBuffer->setBufferAt(*engine, 0, filament::VertexBuffer::BufferDescriptor(
-        vertices, sizeof(vertices), nullptr));
-
-    // 创建索引缓冲区
-    filament::IndexBuffer* indexBuffer = filament::IndexBuffer::Builder()
-        .indexCount(36)
-        .bufferType(filament::IndexBuffer::IndexType::USHORT)
-        .build(*engine);
-
-    indexBuffer->setBuffer(*engine, filament::IndexBuffer::BufferDescriptor(
-        indices, sizeof(indices), nullptr));
+    // 相同尺寸的立方体共享同一对顶点/索引缓冲区，只在第一次时构建并上传
+    Kazia::GeometryRegistry::Key geometryKey = Kazia::GeometryRegistry::makeProceduralKey("cube_position", {size.x, size.y, size.z});
+    const Kazia::GeometryRegistry::Geometry* geometry = m_geometryRegistry->acquire(geometryKey, [engine, halfX, halfY, halfZ]() {
+        // 立方体顶点数据（24个顶点）
+        const float vertices[] = {
+            // 前面
+            -halfX, -halfY,  halfZ,
+             halfX, -halfY,  halfZ,
+             halfX,  halfY,  halfZ,
+            -halfX,  halfY,  halfZ,
+            // 后面
+            -halfX, -halfY, -halfZ,
+            -halfX,  halfY, -halfZ,
+             halfX,  halfY, -halfZ,
+             halfX, -halfY, -halfZ,
+            // 上面
+            -halfX,  halfY, -halfZ,
+            -halfX,  halfY,  halfZ,
+             halfX,  halfY,  halfZ,
+             halfX,  halfY, -halfZ,
+            // 下面
+            -halfX, -halfY, -halfZ,
+             halfX, -halfY, -halfZ,
+             halfX, -halfY,  halfZ,
+            -halfX, -halfY,  halfZ,
+            // 右面
+             halfX, -halfY, -halfZ,
+             halfX,  halfY, -halfZ,
+             halfX,  halfY,  halfZ,
+             halfX, -halfY,  halfZ,
+            // 左面
+            -halfX, -halfY, -halfZ,
+            -halfX, -halfY,  halfZ,
+            -halfX,  halfY,  halfZ,
+            -halfX,  halfY, -halfZ
+        };
+
+        // 立方体索引数据（36个索引，12个三角形）
+        const uint16_t indices[] = {
+            // 前面
+            0, 1, 2, 2, 3, 0,
+            // 后面
+            4, 5, 6, 6, 7, 4,
+            // 上面
+            8, 9, 10, 10, 11, 8,
+            // 下面
+            12, 13, 14, 14, 15, 12,
+            // 右面
+            16, 17, 18, 18, 19, 16,
+            // 左面
+            20, 21, 22, 22, 23, 20
+        };
+
+        Kazia::GeometryRegistry::Geometry cube;
+        cube.vertexCount = 24;
+        cube.indexCount = 36;
+        cube.boundingBox = {{-halfX, -halfY, -halfZ}, {halfX, halfY, halfZ}};
+        cube.byteSize = sizeof(vertices) + sizeof(indices);
+
+        // 创建顶点缓冲区
+        cube.vertexBuffer = filament::VertexBuffer::Builder()
+            .vertexCount(cube.vertexCount)
+            .bufferCount(1)
+            .attribute(filament::VertexAttribute::POSITION, 0, filament::VertexBuffer::AttributeType::FLOAT3)
+            .build(*engine);
+
+        cube.vertexBuffer->setBufferAt(*engine, 0, Kazia::GeometryRegistry::makeBufferDescriptor(vertices, sizeof(vertices)));
+
+        // 创建索引缓冲区
+        cube.indexBuffer = filament::IndexBuffer::Builder()
+            .indexCount(cube.indexCount)
+            .bufferType(filament::IndexBuffer::IndexType::USHORT)
+            .build(*engine);
+
+        cube.indexBuffer->setBuffer(*engine, Kazia::GeometryRegistry::makeBufferDescriptor(indices, sizeof(indices)));
+
+        return cube;
+    });
+
+    if (!geometry) return;
+
+    // 创建立方体实体
+    utils::Entity cubeEntity = utils::EntityManager::get().create();
 
     // 创建材质（使用简单的默认材质）
     // 注意：这里简化处理，实际项目中应该使用正确的材质文件
-    filament::Material* material = nullptr;
-    filament::MaterialInstance* materialInstance = nullptr;
-    
-    // 尝试创建一个简单的颜色材质
-    // 由于没有材质文件，我们暂时使用 nullptr，Filament 会使用默认材质
+    // 由于没有材质文件，我们暂时不设置材质，Filament 会使用默认材质
     // 实际项目中应该创建或加载正确的材质
 
     // 创建可渲染对象
     filament::RenderableManager::Builder(1)
-        .boundingBox({{-halfX, -halfY, -halfZ}, {halfX, halfY, halfZ}})
-        .geometry(0, filament::RenderableManager::PrimitiveType::TRIANGLES, vertexBuffer, indexBuffer)
+        .boundingBox(geometry->boundingBox)
+        .geometry(0, filament::RenderableManager::PrimitiveType::TRIANGLES, geometry->vertexBuffer, geometry->indexBuffer)
+        .castShadows(true)
+        .receiveShadows(true)
         .build(*engine, cubeEntity);
 
     // 设置立方体位置
@@ -231,4 +310,6 @@ void Renderer::addCube(const filament::math::float3& position, const filament::m
 
     // 将立方体添加到场景
     scene->addEntity(cubeEntity);
+
+    m_renderables.push_back({cubeEntity, geometryKey});
 }
@@ -1,7 +1,16 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
+#include <vector>
+
+#include <utils/Entity.h>
+
 #include "FilamentEngine.h"
+#include "GeometryRegistry.h"
+
+namespace Kazia {
+struct RenderSnapshot;
+}
 
 class Renderer
 {
@@ -9,6 +18,20 @@ private:
     FilamentEngine* m_filamentEngine;
     bool m_isInitialized; // 跟踪渲染器是否已初始化
 
+    // 共享几何体注册表，相同几何体只上传一次
+    Kazia::GeometryRegistry* m_geometryRegistry;
+
+    // 由渲染器创建的可渲染实体及其几何体键，关闭时统一销毁
+    struct RenderableEntry {
+        utils::Entity entity;
+        Kazia::GeometryRegistry::Key geometryKey;
+    };
+    std::vector<RenderableEntry> m_renderables;
+
+    // 最近一次应用的视口大小，快照中的大小变化时才调整
+    int m_viewportWidth;
+    int m_viewportHeight;
+
 public:
     Renderer();
     ~Renderer();
@@ -19,7 +42,14 @@ public:
     void renderFrame();
     void resize(int width, int height);
 
+    // 显示器刷新率和每帧占用的垂直同步周期数，Filament 据此对齐呈现时间
+    void setFramePacing(float refreshRate, uint32_t presentInterval);
+
+    // 应用渲染线程取到的快照（视口和相机），需在渲染线程上调用
+    void applySnapshot(const Kazia::RenderSnapshot& snapshot);
+
     FilamentEngine* getFilamentEngine() const { return m_filamentEngine; }
+    Kazia::GeometryRegistry* getGeometryRegistry() const { return m_geometryRegistry; }
 
     // 光照控制
     void addDirectionalLight(const filament::math::float3& direction, const filament::math::float3& color, float intensity);
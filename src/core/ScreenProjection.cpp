@@ -0,0 +1,163 @@
+#include "ScreenProjection.h"
+
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define KAZIA_PROJECTION_SSE 1
+    #include <emmintrin.h>
+#endif
+
+namespace Kazia {
+
+namespace {
+
+// w 小于该值的角点视为在相机后方
+constexpr float MIN_W = 1e-6f;
+
+constexpr float INF = std::numeric_limits<float>::infinity();
+
+void projectOneScalar(const float* m, const math::aabb& box, ScreenRect& rect) {
+    rect = {INF, INF, -INF, -INF};
+
+    for (int corner = 0; corner < 8; ++corner) {
+        float x = (corner & 1) ? box.max.x : box.min.x;
+        float y = (corner & 2) ? box.max.y : box.min.y;
+        float z = (corner & 4) ? box.max.z : box.min.z;
+
+        float clipW = m[3] * x + m[7] * y + m[11] * z + m[15];
+        if (clipW <= MIN_W) {
+            rect = {-INF, -INF, INF, INF};
+            return;
+        }
+
+        float invW = 1.0f / clipW;
+        float ndcX = (m[0] * x + m[4] * y + m[8] * z + m[12]) * invW;
+        float ndcY = (m[1] * x + m[5] * y + m[9] * z + m[13]) * invW;
+
+        rect.minX = ndcX < rect.minX ? ndcX : rect.minX;
+        rect.minY = ndcY < rect.minY ? ndcY : rect.minY;
+        rect.maxX = ndcX > rect.maxX ? ndcX : rect.maxX;
+        rect.maxY = ndcY > rect.maxY ? ndcY : rect.maxY;
+    }
+}
+
+#ifdef KAZIA_PROJECTION_SSE
+
+// 按掩码选择：mask 为真取 a，否则取 b
+inline __m128 select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// 一次投影 4 个包围盒（SoA），每个角点的 8 种组合依次计算
+void projectFourSse(const float* m, const math::aabb* boxes, ScreenRect* rects) {
+    const __m128 minX = _mm_setr_ps(boxes[0].min.x, boxes[1].min.x, boxes[2].min.x, boxes[3].min.x);
+    const __m128 minY = _mm_setr_ps(boxes[0].min.y, boxes[1].min.y, boxes[2].min.y, boxes[3].min.y);
+    const __m128 minZ = _mm_setr_ps(boxes[0].min.z, boxes[1].min.z, boxes[2].min.z, boxes[3].min.z);
+    const __m128 maxX = _mm_setr_ps(boxes[0].max.x, boxes[1].max.x, boxes[2].max.x, boxes[3].max.x);
+    const __m128 maxY = _mm_setr_ps(boxes[0].max.y, boxes[1].max.y, boxes[2].max.y, boxes[3].max.y);
+    const __m128 maxZ = _mm_setr_ps(boxes[0].max.z, boxes[1].max.z, boxes[2].max.z, boxes[3].max.z);
+
+    // 矩阵按行先乘以 x、y、z 的两个取值，8 个角点只需要加法组合
+    auto row = [&](int r, __m128& xMin, __m128& xMax, __m128& yMin, __m128& yMax, __m128& zMin, __m128& zMax) {
+        __m128 cx = _mm_set1_ps(m[r]);
+        __m128 cy = _mm_set1_ps(m[4 + r]);
+        __m128 cz = _mm_set1_ps(m[8 + r]);
+        __m128 cw = _mm_set1_ps(m[12 + r]);
+        xMin = _mm_mul_ps(cx, minX);
+        xMax = _mm_mul_ps(cx, maxX);
+        yMin = _mm_mul_ps(cy, minY);
+        yMax = _mm_mul_ps(cy, maxY);
+        zMin = _mm_add_ps(_mm_mul_ps(cz, minZ), cw);
+        zMax = _mm_add_ps(_mm_mul_ps(cz, maxZ), cw);
+    };
+
+    __m128 ax[2], ay[2], az[2];
+    __m128 bx[2], by[2], bz[2];
+    __m128 wx[2], wy[2], wz[2];
+    row(0, ax[0], ax[1], ay[0], ay[1], az[0], az[1]);
+    row(1, bx[0], bx[1], by[0], by[1], bz[0], bz[1]);
+    row(3, wx[0], wx[1], wy[0], wy[1], wz[0], wz[1]);
+
+    __m128 rectMinX = _mm_set1_ps(INF);
+    __m128 rectMinY = _mm_set1_ps(INF);
+    __m128 rectMaxX = _mm_set1_ps(-INF);
+    __m128 rectMaxY = _mm_set1_ps(-INF);
+    __m128 behind = _mm_setzero_ps();
+    const __m128 minW = _mm_set1_ps(MIN_W);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    for (int corner = 0; corner < 8; ++corner) {
+        int ix = corner & 1;
+        int iy = (corner >> 1) & 1;
+        int iz = (corner >> 2) & 1;
+
+        __m128 clipX = _mm_add_ps(_mm_add_ps(ax[ix], ay[iy]), az[iz]);
+        __m128 clipY = _mm_add_ps(_mm_add_ps(bx[ix], by[iy]), bz[iz]);
+        __m128 clipW = _mm_add_ps(_mm_add_ps(wx[ix], wy[iy]), wz[iz]);
+
+        __m128 cornerBehind = _mm_cmple_ps(clipW, minW);
+        behind = _mm_or_ps(behind, cornerBehind);
+
+        // 相机后方的角点用 w = 1 代替，避免除零，结果最后整体覆盖
+        __m128 invW = _mm_div_ps(one, select(cornerBehind, one, clipW));
+        __m128 ndcX = _mm_mul_ps(clipX, invW);
+        __m128 ndcY = _mm_mul_ps(clipY, invW);
+
+        rectMinX = _mm_min_ps(rectMinX, ndcX);
+        rectMinY = _mm_min_ps(rectMinY, ndcY);
+        rectMaxX = _mm_max_ps(rectMaxX, ndcX);
+        rectMaxY = _mm_max_ps(rectMaxY, ndcY);
+    }
+
+    const __m128 negInf = _mm_set1_ps(-INF);
+    const __m128 posInf = _mm_set1_ps(INF);
+    rectMinX = select(behind, negInf, rectMinX);
+    rectMinY = select(behind, negInf, rectMinY);
+    rectMaxX = select(behind, posInf, rectMaxX);
+    rectMaxY = select(behind, posInf, rectMaxY);
+
+    alignas(16) float outMinX[4], outMinY[4], outMaxX[4], outMaxY[4];
+    _mm_store_ps(outMinX, rectMinX);
+    _mm_store_ps(outMinY, rectMinY);
+    _mm_store_ps(outMaxX, rectMaxX);
+    _mm_store_ps(outMaxY, rectMaxY);
+    for (int i = 0; i < 4; ++i) {
+        rects[i] = {outMinX[i], outMinY[i], outMaxX[i], outMaxY[i]};
+    }
+}
+
+#endif
+
+} // namespace
+
+void projectAabbsScalar(const math::mat4f& viewProjection, const math::aabb* boxes, size_t count, ScreenRect* rects) {
+    for (size_t i = 0; i < count; ++i) {
+        projectOneScalar(viewProjection.m, boxes[i], rects[i]);
+    }
+}
+
+void projectAabbs(const math::mat4f& viewProjection, const math::aabb* boxes, size_t count, ScreenRect* rects) {
+#ifdef KAZIA_PROJECTION_SSE
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        projectFourSse(viewProjection.m, boxes + i, rects + i);
+    }
+
+    // 剩余不足 4 个的部分
+    for (; i < count; ++i) {
+        projectOneScalar(viewProjection.m, boxes[i], rects[i]);
+    }
+#else
+    projectAabbsScalar(viewProjection, boxes, count, rects);
+#endif
+}
+
+bool isSimdProjectionEnabled() {
+#ifdef KAZIA_PROJECTION_SSE
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace Kazia
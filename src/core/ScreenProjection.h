@@ -0,0 +1,35 @@
+#ifndef SCREENPROJECTION_H
+#define SCREENPROJECTION_H
+
+#include <cstddef>
+
+#include "Math.h"
+
+namespace Kazia {
+
+// 包围盒投影到归一化设备坐标后的矩形
+// 包围盒跨越近平面（有角点在相机后方）时无法得到有限的投影，矩形为整个平面
+struct ScreenRect {
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+
+    bool overlaps(float x0, float y0, float x1, float y1) const {
+        return minX <= x1 && x0 <= maxX && minY <= y1 && y0 <= maxY;
+    }
+};
+
+// 批量把世界空间包围盒的 8 个角点投影到 NDC，取 xy 的最小/最大值
+// 支持 SSE 时每次处理 4 个包围盒，否则使用标量实现
+void projectAabbs(const math::mat4f& viewProjection, const math::aabb* boxes, size_t count, ScreenRect* rects);
+
+// 标量实现，用于不支持 SSE 的平台和结果校验
+void projectAabbsScalar(const math::mat4f& viewProjection, const math::aabb* boxes, size_t count, ScreenRect* rects);
+
+// 是否启用了 SIMD 实现
+bool isSimdProjectionEnabled();
+
+} // namespace Kazia
+
+#endif // SCREENPROJECTION_H
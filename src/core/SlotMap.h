@@ -0,0 +1,140 @@
+#ifndef SLOTMAP_H
+#define SLOTMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Kazia {
+
+// 槽位句柄：槽位下标 + 代数，槽位被释放后代数递增，旧句柄随之失效
+struct SlotHandle {
+    static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+    uint32_t index = INVALID_INDEX;
+    uint32_t generation = 0;
+
+    bool isValid() const { return index != INVALID_INDEX; }
+
+    bool operator==(const SlotHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+};
+
+// 槽位映射
+// 元素紧密存放在连续数组中便于逐个遍历，删除时用末尾元素填补空位；
+// 句柄经由槽位表间接指向元素，因此其他元素的删除和移动不会使句柄失效
+template <typename T>
+class SlotMap {
+private:
+    struct Slot {
+        // 占用时为元素在紧密数组中的下标，空闲时为空闲链表的 next
+        uint32_t denseIndex;
+        uint32_t generation;
+    };
+
+    std::vector<T> m_values;
+    std::vector<uint32_t> m_denseToSlot;
+    std::vector<Slot> m_slots;
+    uint32_t m_freeHead = SlotHandle::INVALID_INDEX;
+
+public:
+    SlotHandle insert(T value) {
+        uint32_t slotIndex;
+        if (m_freeHead != SlotHandle::INVALID_INDEX) {
+            slotIndex = m_freeHead;
+            m_freeHead = m_slots[slotIndex].denseIndex;
+        } else {
+            slotIndex = static_cast<uint32_t>(m_slots.size());
+            m_slots.push_back({0, 0});
+        }
+
+        Slot& slot = m_slots[slotIndex];
+        slot.denseIndex = static_cast<uint32_t>(m_values.size());
+        m_values.push_back(std::move(value));
+        m_denseToSlot.push_back(slotIndex);
+        return {slotIndex, slot.generation};
+    }
+
+    bool erase(SlotHandle handle) {
+        if (!contains(handle)) {
+            return false;
+        }
+
+        Slot& slot = m_slots[handle.index];
+        uint32_t denseIndex = slot.denseIndex;
+        uint32_t lastIndex = static_cast<uint32_t>(m_values.size() - 1);
+
+        // 末尾元素移到空位，更新它的槽位
+        if (denseIndex != lastIndex) {
+            m_values[denseIndex] = std::move(m_values[lastIndex]);
+            m_denseToSlot[denseIndex] = m_denseToSlot[lastIndex];
+            m_slots[m_denseToSlot[denseIndex]].denseIndex = denseIndex;
+        }
+        m_values.pop_back();
+        m_denseToSlot.pop_back();
+
+        slot.generation++;
+        slot.denseIndex = m_freeHead;
+        m_freeHead = handle.index;
+        return true;
+    }
+
+    bool contains(SlotHandle handle) const {
+        return handle.index < m_slots.size() &&
+               m_slots[handle.index].generation == handle.generation &&
+               isOccupied(handle.index);
+    }
+
+    T* get(SlotHandle handle) {
+        return contains(handle) ? &m_values[m_slots[handle.index].denseIndex] : nullptr;
+    }
+
+    const T* get(SlotHandle handle) const {
+        return contains(handle) ? &m_values[m_slots[handle.index].denseIndex] : nullptr;
+    }
+
+    // 紧密数组访问，下标在删除后可能变化，只在一次遍历内使用
+    size_t size() const { return m_values.size(); }
+    bool empty() const { return m_values.empty(); }
+    T& at(size_t denseIndex) { return m_values[denseIndex]; }
+    const T& at(size_t denseIndex) const { return m_values[denseIndex]; }
+    SlotHandle handleAt(size_t denseIndex) const {
+        uint32_t slotIndex = m_denseToSlot[denseIndex];
+        return {slotIndex, m_slots[slotIndex].generation};
+    }
+
+    typename std::vector<T>::iterator begin() { return m_values.begin(); }
+    typename std::vector<T>::iterator end() { return m_values.end(); }
+    typename std::vector<T>::const_iterator begin() const { return m_values.begin(); }
+    typename std::vector<T>::const_iterator end() const { return m_values.end(); }
+
+    void reserve(size_t capacity) {
+        m_values.reserve(capacity);
+        m_denseToSlot.reserve(capacity);
+        m_slots.reserve(capacity);
+    }
+
+    // 清空所有元素，已发出的句柄全部失效
+    void clear() {
+        for (uint32_t slotIndex : m_denseToSlot) {
+            m_slots[slotIndex].generation++;
+            m_slots[slotIndex].denseIndex = m_freeHead;
+            m_freeHead = slotIndex;
+        }
+        m_values.clear();
+        m_denseToSlot.clear();
+    }
+
+private:
+    bool isOccupied(uint32_t slotIndex) const {
+        uint32_t denseIndex = m_slots[slotIndex].denseIndex;
+        return denseIndex < m_denseToSlot.size() && m_denseToSlot[denseIndex] == slotIndex;
+    }
+};
+
+} // namespace Kazia
+
+#endif // SLOTMAP_H
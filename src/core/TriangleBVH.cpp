@@ -0,0 +1,319 @@
+#include "TriangleBVH.h"
+
+#include <algorithm>
+
+namespace Kazia {
+
+namespace {
+
+// 叶子最多包含的三角形数
+constexpr uint32_t MAX_LEAF_TRIANGLES = 4;
+
+// 分箱数量
+constexpr int BIN_COUNT = 12;
+
+// 超过该深度后改用中位数划分，保证遍历栈深度有界
+constexpr uint32_t MAX_SAH_DEPTH = 48;
+
+// 遍历栈大小
+constexpr int STACK_SIZE = 96;
+
+inline float axisValue(const math::float3& v, int axis) {
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+} // namespace
+
+TriangleBVH::TriangleBVH() : m_depth(0) {
+}
+
+void TriangleBVH::build(const math::float3* positions, size_t vertexCount, const uint32_t* indices, size_t indexCount) {
+    m_nodes.clear();
+    m_triangles.clear();
+    m_triangleIds.clear();
+    m_depth = 0;
+
+    size_t triangleCount = indices ? indexCount / 3 : vertexCount / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    auto vertexIndex = [indices](size_t i) { return indices ? indices[i] : static_cast<uint32_t>(i); };
+
+    // 每个三角形的包围盒和质心
+    std::vector<math::aabb> boxes(triangleCount);
+    std::vector<math::float3> centroids(triangleCount);
+    m_triangleIds.resize(triangleCount);
+    for (size_t i = 0; i < triangleCount; ++i) {
+        const math::float3& a = positions[vertexIndex(i * 3 + 0)];
+        const math::float3& b = positions[vertexIndex(i * 3 + 1)];
+        const math::float3& c = positions[vertexIndex(i * 3 + 2)];
+        boxes[i].merge(a);
+        boxes[i].merge(b);
+        boxes[i].merge(c);
+        centroids[i] = (a + b + c) * (1.0f / 3.0f);
+        m_triangleIds[i] = static_cast<uint32_t>(i);
+    }
+
+    m_nodes.reserve(triangleCount * 2);
+    BvhNode root;
+    root.first = 0;
+    root.count = static_cast<uint32_t>(triangleCount);
+    m_nodes.push_back(root);
+    subdivide(0, boxes, centroids, 1);
+
+    // 按叶子顺序重排三角形，遍历时连续访问
+    m_triangles.resize(triangleCount);
+    for (size_t i = 0; i < triangleCount; ++i) {
+        uint32_t id = m_triangleIds[i];
+        const math::float3& a = positions[vertexIndex(id * 3 + 0)];
+        const math::float3& b = positions[vertexIndex(id * 3 + 1)];
+        const math::float3& c = positions[vertexIndex(id * 3 + 2)];
+        m_triangles[i] = {a, b - a, c - a};
+    }
+
+    m_nodes.shrink_to_fit();
+}
+
+void TriangleBVH::subdivide(uint32_t nodeIndex, std::vector<math::aabb>& boxes, std::vector<math::float3>& centroids, uint32_t depth) {
+    m_depth = std::max(m_depth, depth);
+
+    uint32_t first = m_nodes[nodeIndex].first;
+    uint32_t count = m_nodes[nodeIndex].count;
+
+    // 节点包围盒和质心包围盒
+    math::aabb box;
+    math::aabb centroidBounds;
+    for (uint32_t i = first; i < first + count; ++i) {
+        box.merge(boxes[m_triangleIds[i]]);
+        centroidBounds.merge(centroids[m_triangleIds[i]]);
+    }
+    m_nodes[nodeIndex].box = box;
+
+    if (count <= MAX_LEAF_TRIANGLES) {
+        return;
+    }
+
+    math::float3 size = centroidBounds.max - centroidBounds.min;
+    int axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+    float axisMin = axisValue(centroidBounds.min, axis);
+    float axisExtent = axisValue(size, axis);
+
+    uint32_t* begin = m_triangleIds.data() + first;
+    uint32_t* end = begin + count;
+    uint32_t* mid = nullptr;
+
+    if (axisExtent > 0.0f && depth < MAX_SAH_DEPTH) {
+        math::aabb binBounds[BIN_COUNT];
+        uint32_t binCounts[BIN_COUNT] = {};
+        float scale = BIN_COUNT / axisExtent;
+
+        auto binIndex = [&](uint32_t id) {
+            int bin = static_cast<int>((axisValue(centroids[id], axis) - axisMin) * scale);
+            return bin < BIN_COUNT - 1 ? bin : BIN_COUNT - 1;
+        };
+
+        for (uint32_t* it = begin; it != end; ++it) {
+            int bin = binIndex(*it);
+            binCounts[bin]++;
+            binBounds[bin].merge(boxes[*it]);
+        }
+
+        // 右侧累计
+        float rightArea[BIN_COUNT];
+        uint32_t rightCount[BIN_COUNT];
+        math::aabb accumulated;
+        uint32_t accumulatedCount = 0;
+        for (int i = BIN_COUNT - 1; i > 0; --i) {
+            accumulated.merge(binBounds[i]);
+            accumulatedCount += binCounts[i];
+            rightArea[i] = accumulated.isEmpty() ? 0.0f : accumulated.surfaceArea();
+            rightCount[i] = accumulatedCount;
+        }
+
+        // 左侧扫描，寻找代价最小的划分
+        float bestCost = std::numeric_limits<float>::max();
+        int bestSplit = -1;
+        accumulated = math::aabb();
+        accumulatedCount = 0;
+        for (int i = 0; i < BIN_COUNT - 1; ++i) {
+            accumulated.merge(binBounds[i]);
+            accumulatedCount += binCounts[i];
+            if (accumulatedCount == 0 || rightCount[i + 1] == 0) {
+                continue;
+            }
+            float cost = accumulatedCount * accumulated.surfaceArea() + rightCount[i + 1] * rightArea[i + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestSplit = i;
+            }
+        }
+
+        // 划分代价不低于直接作为叶子时停止（叶子过大时仍强制划分）
+        float leafCost = count * box.surfaceArea();
+        if (bestSplit >= 0 && bestCost >= leafCost && count <= MAX_LEAF_TRIANGLES * 4) {
+            return;
+        }
+
+        if (bestSplit >= 0) {
+            mid = std::partition(begin, end, [&](uint32_t id) { return binIndex(id) <= bestSplit; });
+        } else {
+            mid = begin + count / 2;
+            std::nth_element(begin, mid, end,
+                [&](uint32_t a, uint32_t b) { return axisValue(centroids[a], axis) < axisValue(centroids[b], axis); });
+        }
+    } else {
+        // 质心重合或深度过大，按中位数划分
+        mid = begin + count / 2;
+        std::nth_element(begin, mid, end,
+            [&](uint32_t a, uint32_t b) { return axisValue(centroids[a], axis) < axisValue(centroids[b], axis); });
+    }
+
+    uint32_t leftCount = static_cast<uint32_t>(mid - begin);
+
+    // 子节点成对分配，右子节点紧跟左子节点
+    uint32_t leftIndex = static_cast<uint32_t>(m_nodes.size());
+    BvhNode left;
+    left.first = first;
+    left.count = leftCount;
+    BvhNode right;
+    right.first = first + leftCount;
+    right.count = count - leftCount;
+    m_nodes.push_back(left);
+    m_nodes.push_back(right);
+
+    m_nodes[nodeIndex].first = leftIndex;
+    m_nodes[nodeIndex].count = 0;
+
+    subdivide(leftIndex, boxes, centroids, depth + 1);
+    subdivide(leftIndex + 1, boxes, centroids, depth + 1);
+}
+
+bool TriangleBVH::intersectTriangle(const math::ray& ray, const Triangle& triangle, float tMax, float& t, float& u, float& v) {
+    const float epsilon = 1e-8f;
+
+    math::float3 p = math::cross(ray.direction, triangle.edge2);
+    float det = math::dot(triangle.edge1, p);
+    if (std::fabs(det) < epsilon) {
+        return false;
+    }
+
+    float invDet = 1.0f / det;
+    math::float3 s = ray.origin - triangle.v0;
+    u = math::dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f) {
+        return false;
+    }
+
+    math::float3 q = math::cross(s, triangle.edge1);
+    v = math::dot(ray.direction, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) {
+        return false;
+    }
+
+    t = math::dot(triangle.edge2, q) * invDet;
+    return t >= 0.0f && t <= tMax;
+}
+
+bool TriangleBVH::intersect(const math::ray& ray, float tMax, Hit& hit) const {
+    if (m_nodes.empty()) {
+        return false;
+    }
+
+    float tNear;
+    if (!ray.intersects(m_nodes[0].box, tMax, tNear)) {
+        return false;
+    }
+
+    bool found = false;
+    uint32_t stack[STACK_SIZE];
+    int stackSize = 0;
+    uint32_t nodeIndex = 0;
+
+    while (true) {
+        const BvhNode& node = m_nodes[nodeIndex];
+
+        if (node.count > 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                float t, u, v;
+                if (intersectTriangle(ray, m_triangles[i], tMax, t, u, v)) {
+                    tMax = t;
+                    hit.t = t;
+                    hit.u = u;
+                    hit.v = v;
+                    hit.triangle = m_triangleIds[i];
+                    found = true;
+                }
+            }
+        } else {
+            // 先访问较近的子节点，较远的入栈
+            float t1, t2;
+            bool hit1 = ray.intersects(m_nodes[node.first].box, tMax, t1);
+            bool hit2 = ray.intersects(m_nodes[node.first + 1].box, tMax, t2);
+
+            if (hit1 && hit2) {
+                uint32_t nearChild = t1 <= t2 ? node.first : node.first + 1;
+                uint32_t farChild = t1 <= t2 ? node.first + 1 : node.first;
+                if (stackSize < STACK_SIZE) {
+                    stack[stackSize++] = farChild;
+                }
+                nodeIndex = nearChild;
+                continue;
+            }
+            if (hit1 || hit2) {
+                nodeIndex = hit1 ? node.first : node.first + 1;
+                continue;
+            }
+        }
+
+        // 出栈时用缩短后的 tMax 重新检测，剪掉比当前命中更远的节点
+        bool next = false;
+        while (stackSize > 0) {
+            nodeIndex = stack[--stackSize];
+            if (ray.intersects(m_nodes[nodeIndex].box, tMax, tNear)) {
+                next = true;
+                break;
+            }
+        }
+        if (!next) {
+            break;
+        }
+    }
+
+    return found;
+}
+
+bool TriangleBVH::intersectAny(const math::ray& ray, float tMax) const {
+    if (m_nodes.empty()) {
+        return false;
+    }
+
+    uint32_t stack[STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const BvhNode& node = m_nodes[stack[--stackSize]];
+
+        float tNear;
+        if (!ray.intersects(node.box, tMax, tNear)) {
+            continue;
+        }
+
+        if (node.count > 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                float t, u, v;
+                if (intersectTriangle(ray, m_triangles[i], tMax, t, u, v)) {
+                    return true;
+                }
+            }
+        } else if (stackSize + 2 <= STACK_SIZE) {
+            stack[stackSize++] = node.first;
+            stack[stackSize++] = node.first + 1;
+        }
+    }
+
+    return false;
+}
+
+} // namespace Kazia
@@ -0,0 +1,86 @@
+#ifndef TRIANGLEBVH_H
+#define TRIANGLEBVH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Math.h"
+
+namespace Kazia {
+
+// 网格三角形的静态层次包围盒
+// 在网格局部空间中按分箱表面积启发式构建一次，之后只读，可被同一网格的所有实例共享；
+// 拾取时把射线变换到局部空间后查询，旋转、缩放都不需要重建
+class TriangleBVH {
+public:
+    // 射线命中信息
+    struct Hit {
+        float t = 0.0f;          // 射线参数
+        uint32_t triangle = 0;   // 原始三角形索引
+        float u = 0.0f;          // 重心坐标
+        float v = 0.0f;
+    };
+
+private:
+    // 叶子节点 count > 0，first 为第一个三角形；内部节点 count == 0，
+    // 左子节点为 first，右子节点紧随其后
+    struct BvhNode {
+        math::aabb box;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    // 预先计算边向量的三角形，按叶子顺序存放
+    struct Triangle {
+        math::float3 v0;
+        math::float3 edge1;
+        math::float3 edge2;
+    };
+
+    std::vector<BvhNode> m_nodes;
+    std::vector<Triangle> m_triangles;
+    std::vector<uint32_t> m_triangleIds;
+    uint32_t m_depth;
+
+public:
+    TriangleBVH();
+    ~TriangleBVH() = default;
+
+    // 从索引三角形列表构建，indices 为空时按非索引三角形处理
+    void build(const math::float3* positions, size_t vertexCount, const uint32_t* indices, size_t indexCount);
+    void build(const std::vector<math::float3>& positions, const std::vector<uint32_t>& indices) {
+        build(positions.data(), positions.size(), indices.data(), indices.size());
+    }
+
+    // 最近命中查询，只接受 t 在 [0, tMax] 内的交点
+    bool intersect(const math::ray& ray, float tMax, Hit& hit) const;
+
+    // 任意命中查询（遮挡测试）
+    bool intersectAny(const math::ray& ray, float tMax) const;
+
+    // 局部空间包围盒
+    math::aabb getBounds() const { return m_nodes.empty() ? math::aabb() : m_nodes[0].box; }
+
+    // 统计
+    size_t getTriangleCount() const { return m_triangles.size(); }
+    size_t getNodeCount() const { return m_nodes.size(); }
+    uint32_t getDepth() const { return m_depth; }
+    size_t getMemoryUsage() const {
+        return m_nodes.capacity() * sizeof(BvhNode) + m_triangles.capacity() * sizeof(Triangle) +
+               m_triangleIds.capacity() * sizeof(uint32_t);
+    }
+
+    bool isEmpty() const { return m_triangles.empty(); }
+
+private:
+    // 对三角形 [first, first + count) 递归划分节点
+    void subdivide(uint32_t nodeIndex, std::vector<math::aabb>& boxes, std::vector<math::float3>& centroids, uint32_t depth);
+
+    // Möller-Trumbore 射线三角形相交
+    static bool intersectTriangle(const math::ray& ray, const Triangle& triangle, float tMax, float& t, float& u, float& v);
+};
+
+} // namespace Kazia
+
+#endif // TRIANGLEBVH_H
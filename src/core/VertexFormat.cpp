@@ -0,0 +1,242 @@
+#include "VertexFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Kazia {
+
+namespace {
+
+// 写入一个属性分量序列
+template<typename T, size_t N>
+void writeAttribute(uint8_t* destination, const T (&values)[N]) {
+    std::memcpy(destination, values, sizeof(values));
+}
+
+// 3x3 正交矩阵（列为 t、b、n）转换为四元数
+math::float4 quaternionFromBasis(const math::float3& t, const math::float3& b, const math::float3& n) {
+    float trace = t.x + b.y + n.z;
+    math::float4 q;
+    if (trace > 0.0f) {
+        float s = std::sqrt(trace + 1.0f) * 2.0f;
+        q = math::float4((b.z - n.y) / s, (n.x - t.z) / s, (t.y - b.x) / s, 0.25f * s);
+    } else if (t.x > b.y && t.x > n.z) {
+        float s = std::sqrt(1.0f + t.x - b.y - n.z) * 2.0f;
+        q = math::float4(0.25f * s, (b.x + t.y) / s, (n.x + t.z) / s, (b.z - n.y) / s);
+    } else if (b.y > n.z) {
+        float s = std::sqrt(1.0f + b.y - t.x - n.z) * 2.0f;
+        q = math::float4((b.x + t.y) / s, 0.25f * s, (n.y + b.z) / s, (n.x - t.z) / s);
+    } else {
+        float s = std::sqrt(1.0f + n.z - t.x - b.y) * 2.0f;
+        q = math::float4((n.x + t.z) / s, (n.y + b.z) / s, 0.25f * s, (t.y - b.x) / s);
+    }
+
+    // q 与 -q 表示同一旋转，Filament 用 w 的符号表示副切线方向，这里统一取正
+    if (q.w < 0.0f) {
+        q = math::float4(-q.x, -q.y, -q.z, -q.w);
+    }
+    return q;
+}
+
+template<typename T>
+const T& element(const T* base, size_t stride, size_t index) {
+    return *reinterpret_cast<const T*>(reinterpret_cast<const uint8_t*>(base) + index * stride);
+}
+
+} // namespace
+
+math::mat4f PackedVertices::getDequantizeMatrix() const {
+    math::mat4f matrix = math::scaling({dequantizeScale, dequantizeScale, dequantizeScale});
+    matrix.m[12] = dequantizeOffset.x;
+    matrix.m[13] = dequantizeOffset.y;
+    matrix.m[14] = dequantizeOffset.z;
+    return matrix;
+}
+
+uint32_t getVertexStride(VertexFormat format, bool hasTangents, bool hasUvs) {
+    if (format == VertexFormat::Float) {
+        return 12 + (hasTangents ? 16 : 0) + (hasUvs ? 8 : 0);
+    }
+    return 8 + (hasTangents ? 4 : 0) + (hasUvs ? 4 : 0);
+}
+
+PackedVertices packVertices(const MeshData& mesh, VertexFormat format) {
+    VertexStreams streams;
+    streams.vertexCount = mesh.positions.size();
+    streams.positions = mesh.positions.data();
+    if (!mesh.normals.empty() && mesh.normals.size() == mesh.positions.size()) {
+        streams.normals = mesh.normals.data();
+    }
+    if (!mesh.uvs.empty() && mesh.uvs.size() == mesh.positions.size()) {
+        streams.uvs = mesh.uvs.data();
+    }
+    return packVertices(streams, format);
+}
+
+PackedVertices packVertices(const VertexStreams& streams, VertexFormat format) {
+    PackedVertices packed;
+    packed.format = format;
+    packed.vertexCount = static_cast<uint32_t>(streams.vertexCount);
+    packed.hasTangents = streams.normals != nullptr;
+    packed.hasUvs = streams.uvs != nullptr;
+    packed.stride = getVertexStride(format, packed.hasTangents, packed.hasUvs);
+
+    bool compact = format != VertexFormat::Float;
+    packed.positionOffset = 0;
+    packed.tangentOffset = compact ? 8 : 12;
+    packed.uvOffset = packed.tangentOffset + (packed.hasTangents ? (compact ? 4 : 16) : 0);
+    packed.data.resize(static_cast<size_t>(packed.stride) * packed.vertexCount);
+
+    // snorm16 位置按包围盒中心和最大半边长归一化到 [-1, 1]
+    if (format == VertexFormat::CompactSnorm && streams.vertexCount > 0) {
+        math::aabb bounds;
+        for (size_t i = 0; i < streams.vertexCount; ++i) {
+            bounds.merge(element(streams.positions, streams.positionStride, i));
+        }
+        math::float3 extent = bounds.extent();
+        float scale = std::max(extent.x, std::max(extent.y, extent.z));
+        packed.dequantizeScale = scale > 0.0f ? scale : 1.0f;
+        packed.dequantizeOffset = bounds.center();
+    }
+    float inverseScale = 1.0f / packed.dequantizeScale;
+
+    for (size_t i = 0; i < streams.vertexCount; ++i) {
+        uint8_t* vertex = packed.data.data() + i * packed.stride;
+        const math::float3& position = element(streams.positions, streams.positionStride, i);
+
+        switch (format) {
+            case VertexFormat::Float: {
+                const float values[3] = {position.x, position.y, position.z};
+                writeAttribute(vertex + packed.positionOffset, values);
+                break;
+            }
+            case VertexFormat::CompactHalf: {
+                const uint16_t values[4] = {floatToHalf(position.x), floatToHalf(position.y), floatToHalf(position.z), floatToHalf(1.0f)};
+                writeAttribute(vertex + packed.positionOffset, values);
+                break;
+            }
+            case VertexFormat::CompactSnorm: {
+                math::float3 normalized = (position - packed.dequantizeOffset) * inverseScale;
+                const int16_t values[4] = {floatToSnorm16(normalized.x), floatToSnorm16(normalized.y), floatToSnorm16(normalized.z), 32767};
+                writeAttribute(vertex + packed.positionOffset, values);
+                break;
+            }
+        }
+
+        if (packed.hasTangents) {
+            math::float4 q = tangentFrameFromNormal(element(streams.normals, streams.normalStride, i));
+            if (compact) {
+                int8_t values[4] = {floatToSnorm8(q.x), floatToSnorm8(q.y), floatToSnorm8(q.z), floatToSnorm8(q.w)};
+                // w 量化为 0 时副切线方向无法确定，保留最小的正值
+                if (values[3] == 0) {
+                    values[3] = 1;
+                }
+                writeAttribute(vertex + packed.tangentOffset, values);
+            } else {
+                const float values[4] = {q.x, q.y, q.z, q.w};
+                writeAttribute(vertex + packed.tangentOffset, values);
+            }
+        }
+
+        if (packed.hasUvs) {
+            const math::float2& uv = element(streams.uvs, streams.uvStride, i);
+            if (compact) {
+                const uint16_t values[2] = {floatToHalf(uv.x), floatToHalf(uv.y)};
+                writeAttribute(vertex + packed.uvOffset, values);
+            } else {
+                const float values[2] = {uv.x, uv.y};
+                writeAttribute(vertex + packed.uvOffset, values);
+            }
+        }
+    }
+    return packed;
+}
+
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t rawExponent = (bits >> 23) & 0xFFu;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    // 无穷大和 NaN
+    if (rawExponent == 0xFFu) {
+        return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+    }
+
+    int32_t exponent = static_cast<int32_t>(rawExponent) - 127 + 15;
+    if (exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7C00u);
+    }
+
+    // 非规格化数，过小的值变为 0
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000u;
+        uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1u) {
+            half++;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    // 舍入进位可能进入指数位，结果仍然正确
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000u) {
+        half++;
+    }
+    return static_cast<uint16_t>(half);
+}
+
+float halfToFloat(uint16_t value) {
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1Fu;
+    uint32_t mantissa = value & 0x3FFu;
+
+    uint32_t bits;
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // 非规格化数
+            float result = std::ldexp(static_cast<float>(mantissa), -24);
+            return sign ? -result : result;
+        }
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+int16_t floatToSnorm16(float value) {
+    float clamped = std::clamp(value, -1.0f, 1.0f);
+    return static_cast<int16_t>(std::lround(clamped * 32767.0f));
+}
+
+int8_t floatToSnorm8(float value) {
+    float clamped = std::clamp(value, -1.0f, 1.0f);
+    return static_cast<int8_t>(std::lround(clamped * 127.0f));
+}
+
+math::float4 tangentFrameFromNormal(const math::float3& normal) {
+    float normalLength = math::length(normal);
+    math::float3 n = normalLength > 0.0f ? normal / normalLength : math::float3(0.0f, 0.0f, 1.0f);
+
+    // 选择与法线最不平行的坐标轴构造切线
+    math::float3 axis = std::fabs(n.x) < 0.9f ? math::float3(1.0f, 0.0f, 0.0f) : math::float3(0.0f, 1.0f, 0.0f);
+    math::float3 t = math::normalize(math::cross(axis, n));
+    math::float3 b = math::cross(n, t);
+    return quaternionFromBasis(t, b, n);
+}
+
+} // namespace Kazia
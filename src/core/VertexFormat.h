@@ -0,0 +1,72 @@
+#ifndef VERTEXFORMAT_H
+#define VERTEXFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Math.h"
+#include "MeshData.h"
+
+namespace Kazia {
+
+// 上传到 GPU 的顶点格式
+// 法线以切线空间四元数（Filament 的 TANGENTS 属性）存储，没有切线时按法线构造任意正交基；
+// 紧凑格式的各分量由 Filament 的归一化属性在顶点读取时解码，不需要修改材质
+enum class VertexFormat {
+    Float,        // float3 位置 + float4 四元数 + float2 UV，36 字节
+    CompactHalf,  // half4 位置 + snorm8 四元数 + half2 UV，16 字节，位置不需要反量化，适合尺寸较小的网格
+    CompactSnorm  // snorm16 位置 + snorm8 四元数 + half2 UV，16 字节，位置按包围盒归一化，需要反量化变换
+};
+
+// 交错排列的顶点数据
+struct PackedVertices {
+    VertexFormat format = VertexFormat::Float;
+    std::vector<uint8_t> data;
+    uint32_t vertexCount = 0;
+    uint32_t stride = 0;
+
+    // 各属性在顶点内的字节偏移
+    uint32_t positionOffset = 0;
+    uint32_t tangentOffset = 0;
+    uint32_t uvOffset = 0;
+    bool hasTangents = false;
+    bool hasUvs = false;
+
+    // 解码后的位置 * scale + offset 得到网格局部空间中的位置（缩放各轴相同，法线不受影响）
+    float dequantizeScale = 1.0f;
+    math::float3 dequantizeOffset;
+
+    math::mat4f getDequantizeMatrix() const;
+};
+
+// 顶点属性的只读视图，各属性可以是独立数组，也可以是交错缓冲中的字段（按字节步长访问）
+struct VertexStreams {
+    const math::float3* positions = nullptr;
+    const math::float3* normals = nullptr;   // 为空时省略切线属性
+    const math::float2* uvs = nullptr;       // 为空时省略 UV 属性
+    size_t positionStride = sizeof(math::float3);
+    size_t normalStride = sizeof(math::float3);
+    size_t uvStride = sizeof(math::float2);
+    size_t vertexCount = 0;
+};
+
+// 按格式打包顶点，normals / uvs 为空时省略对应属性
+PackedVertices packVertices(const VertexStreams& streams, VertexFormat format);
+PackedVertices packVertices(const MeshData& mesh, VertexFormat format);
+
+// 每个顶点的字节数
+uint32_t getVertexStride(VertexFormat format, bool hasTangents, bool hasUvs);
+
+// 编码辅助
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
+int16_t floatToSnorm16(float value);
+int8_t floatToSnorm8(float value);
+
+// 由法线构造切线空间四元数（x, y, z, w），w 非负
+math::float4 tangentFrameFromNormal(const math::float3& normal);
+
+} // namespace Kazia
+
+#endif // VERTEXFORMAT_H
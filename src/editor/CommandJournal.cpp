@@ -0,0 +1,319 @@
+#include "CommandJournal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace Kazia {
+
+namespace {
+
+// 块在文件中的布局：块头之后是压缩的数据
+struct BlockHeader {
+    uint32_t compressedSize;
+    uint32_t rawSize;
+    uint32_t recordCount;
+    uint32_t reserved;
+};
+
+// 记录头，之后是 size 字节的数据
+struct RecordHeader {
+    uint32_t type;
+    uint32_t size;
+};
+
+// LZ77 压缩，格式与 LZ4 块格式相同：每个序列为一个标记字节（高 4 位字面量长度，低 4 位匹配长度减 4，
+// 取满 15 时后续字节继续累加），字面量，2 字节偏移；最后一个序列只有字面量
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr uint32_t HASH_BITS = 12;
+
+uint32_t read32(const uint8_t* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+uint32_t hash32(uint32_t value) {
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+void writeLength(std::vector<uint8_t>& out, size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+void writeSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalLength, size_t offset, size_t matchLength) {
+    size_t extraMatch = matchLength > 0 ? matchLength - MIN_MATCH : 0;
+    out.push_back(static_cast<uint8_t>((std::min<size_t>(literalLength, 15) << 4) | std::min<size_t>(extraMatch, 15)));
+    if (literalLength >= 15) {
+        writeLength(out, literalLength - 15);
+    }
+    out.insert(out.end(), literals, literals + literalLength);
+    if (matchLength == 0) {
+        return;
+    }
+    out.push_back(static_cast<uint8_t>(offset & 0xFF));
+    out.push_back(static_cast<uint8_t>(offset >> 8));
+    if (extraMatch >= 15) {
+        writeLength(out, extraMatch - 15);
+    }
+}
+
+void compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    out.clear();
+    std::vector<uint32_t> table(size_t(1) << HASH_BITS, UINT32_MAX);
+    size_t anchor = 0;
+    size_t i = 0;
+    while (i + MIN_MATCH <= size) {
+        uint32_t value = read32(data + i);
+        uint32_t& entry = table[hash32(value)];
+        size_t candidate = entry;
+        entry = static_cast<uint32_t>(i);
+        if (candidate == UINT32_MAX || i - candidate > MAX_OFFSET || read32(data + candidate) != value) {
+            i++;
+            continue;
+        }
+
+        size_t length = MIN_MATCH;
+        while (i + length < size && data[candidate + length] == data[i + length]) {
+            length++;
+        }
+        writeSequence(out, data + anchor, i - anchor, i - candidate, length);
+        i += length;
+        anchor = i;
+    }
+    writeSequence(out, data + anchor, size - anchor, 0, 0);
+}
+
+// 读取累加的长度，越界时返回 false
+bool readLength(const uint8_t*& in, const uint8_t* end, size_t& length) {
+    uint8_t byte;
+    do {
+        if (in == end) {
+            return false;
+        }
+        byte = *in++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+// 解压到 out（大小为原始大小），数据不完整或越界时返回 false
+bool decompress(const uint8_t* in, size_t size, std::vector<uint8_t>& out) {
+    const uint8_t* end = in + size;
+    size_t position = 0;
+    while (in < end) {
+        uint8_t token = *in++;
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(in, end, literalLength)) {
+            return false;
+        }
+        if (literalLength > static_cast<size_t>(end - in) || literalLength > out.size() - position) {
+            return false;
+        }
+        std::memcpy(out.data() + position, in, literalLength);
+        in += literalLength;
+        position += literalLength;
+        if (in == end) {
+            break;
+        }
+
+        if (end - in < 2) {
+            return false;
+        }
+        size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+        in += 2;
+        size_t matchLength = token & 0x0F;
+        if (matchLength == 15 && !readLength(in, end, matchLength)) {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+        if (offset == 0 || offset > position || matchLength > out.size() - position) {
+            return false;
+        }
+        // 匹配可能与输出重叠，逐字节复制
+        for (size_t i = 0; i < matchLength; ++i, ++position) {
+            out[position] = out[position - offset];
+        }
+    }
+    return position == out.size();
+}
+
+} // namespace
+
+CommandJournal::CommandJournal(const std::string& path, size_t blockSize)
+    : m_path(path),
+      m_blockSize(std::max<size_t>(blockSize, 1024)),
+      m_fileSize(0),
+      m_rawBytes(0),
+      m_count(0) {
+}
+
+CommandJournal::~CommandJournal() {
+    clear();
+}
+
+size_t CommandJournal::getMemorySize() const {
+    return m_pending.capacity() + m_pendingOffsets.capacity() * sizeof(uint32_t) + m_blocks.capacity() * sizeof(Block);
+}
+
+bool CommandJournal::push(uint32_t type, const std::vector<uint8_t>& data) {
+    RecordHeader header = {type, static_cast<uint32_t>(data.size())};
+    size_t offset = m_pending.size();
+    m_pendingOffsets.push_back(static_cast<uint32_t>(offset));
+    m_pending.resize(offset + sizeof(header) + data.size());
+    std::memcpy(m_pending.data() + offset, &header, sizeof(header));
+    if (!data.empty()) {
+        std::memcpy(m_pending.data() + offset + sizeof(header), data.data(), data.size());
+    }
+    m_count++;
+
+    // 攒够两个块后写出较早的一块，pop 读回一块后还要再攒一块才会写出
+    if (m_pending.size() < 2 * m_blockSize) {
+        return true;
+    }
+    auto split = std::lower_bound(m_pendingOffsets.begin(), m_pendingOffsets.end(), static_cast<uint32_t>(m_blockSize));
+    size_t recordCount = std::max<size_t>(split - m_pendingOffsets.begin(), 1);
+    if (!writeBlock(recordCount)) {
+        // 保持原状：撤销本次追加
+        m_pending.resize(offset);
+        m_pendingOffsets.pop_back();
+        m_count--;
+        return false;
+    }
+    return true;
+}
+
+bool CommandJournal::writeBlock(size_t recordCount) {
+    size_t rawSize = recordCount < m_pendingOffsets.size() ? m_pendingOffsets[recordCount] : m_pending.size();
+    std::vector<uint8_t> compressed;
+    compress(m_pending.data(), rawSize, compressed);
+
+    BlockHeader header;
+    header.compressedSize = static_cast<uint32_t>(compressed.size());
+    header.rawSize = static_cast<uint32_t>(rawSize);
+    header.recordCount = static_cast<uint32_t>(recordCount);
+    header.reserved = 0;
+
+    // 文件为空时重新创建，否则写在记录的文件末尾（pop 会截断文件）
+    std::ofstream file(m_path, m_fileSize == 0 ? std::ios::binary | std::ios::trunc : std::ios::binary | std::ios::in | std::ios::out);
+    if (!file) {
+        return false;
+    }
+    file.seekp(static_cast<std::streamoff>(m_fileSize));
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(compressed.data()), static_cast<std::streamsize>(compressed.size()));
+    file.flush();
+    if (!file) {
+        return false;
+    }
+
+    Block block;
+    block.offset = m_fileSize;
+    block.compressedSize = header.compressedSize;
+    block.rawSize = header.rawSize;
+    block.recordCount = header.recordCount;
+    m_blocks.push_back(block);
+    m_fileSize += sizeof(header) + compressed.size();
+    m_rawBytes += rawSize;
+
+    // 把写出的记录从内存中移除
+    m_pending.erase(m_pending.begin(), m_pending.begin() + rawSize);
+    m_pendingOffsets.erase(m_pendingOffsets.begin(), m_pendingOffsets.begin() + recordCount);
+    for (uint32_t& offset : m_pendingOffsets) {
+        offset -= static_cast<uint32_t>(rawSize);
+    }
+    return true;
+}
+
+bool CommandJournal::readLastBlock() {
+    const Block& block = m_blocks.back();
+    std::vector<uint8_t> compressed(block.compressedSize);
+    {
+        std::ifstream file(m_path, std::ios::binary);
+        file.seekg(static_cast<std::streamoff>(block.offset + sizeof(BlockHeader)));
+        file.read(reinterpret_cast<char*>(compressed.data()), static_cast<std::streamsize>(compressed.size()));
+        if (!file) {
+            return false;
+        }
+    }
+
+    // 读回的块放在未写出的记录之前
+    std::vector<uint8_t> raw(block.rawSize);
+    if (!decompress(compressed.data(), compressed.size(), raw)) {
+        return false;
+    }
+    std::vector<uint32_t> offsets;
+    offsets.reserve(block.recordCount + m_pendingOffsets.size());
+    size_t offset = 0;
+    while (offset < raw.size()) {
+        RecordHeader header;
+        if (raw.size() - offset < sizeof(header)) {
+            return false;
+        }
+        std::memcpy(&header, raw.data() + offset, sizeof(header));
+        if (header.size > raw.size() - offset - sizeof(header)) {
+            return false;
+        }
+        offsets.push_back(static_cast<uint32_t>(offset));
+        offset += sizeof(header) + header.size;
+    }
+    if (offsets.size() != block.recordCount) {
+        return false;
+    }
+    for (uint32_t pendingOffset : m_pendingOffsets) {
+        offsets.push_back(pendingOffset + static_cast<uint32_t>(raw.size()));
+    }
+    raw.insert(raw.end(), m_pending.begin(), m_pending.end());
+
+    std::error_code error;
+    std::filesystem::resize_file(m_path, block.offset, error);
+    if (error) {
+        return false;
+    }
+    m_fileSize = block.offset;
+    m_rawBytes -= block.rawSize;
+    m_blocks.pop_back();
+    m_pending = std::move(raw);
+    m_pendingOffsets = std::move(offsets);
+    return true;
+}
+
+bool CommandJournal::pop(uint32_t& type, std::vector<uint8_t>& data) {
+    if (m_count == 0) {
+        return false;
+    }
+    if (m_pendingOffsets.empty() && !readLastBlock()) {
+        clear();
+        return false;
+    }
+
+    size_t offset = m_pendingOffsets.back();
+    RecordHeader header;
+    std::memcpy(&header, m_pending.data() + offset, sizeof(header));
+    const uint8_t* begin = m_pending.data() + offset + sizeof(header);
+    type = header.type;
+    data.assign(begin, begin + header.size);
+    m_pending.resize(offset);
+    m_pendingOffsets.pop_back();
+    m_count--;
+    return true;
+}
+
+void CommandJournal::clear() {
+    m_pending.clear();
+    m_pendingOffsets.clear();
+    m_blocks.clear();
+    m_rawBytes = 0;
+    m_count = 0;
+    m_fileSize = 0;
+    std::error_code error;
+    std::filesystem::remove(m_path, error);
+}
+
+} // namespace Kazia
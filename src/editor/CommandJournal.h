@@ -0,0 +1,69 @@
+#ifndef COMMANDJOURNAL_H
+#define COMMANDJOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Kazia {
+
+// 撤销历史的磁盘部分
+// 按栈使用：push 追加最新的记录，pop 取回最新的记录。记录先攒在内存中，攒够两个块后把较早的一块
+// 压缩（LZ77）后追加到文件末尾；pop 取完内存中的记录后读回文件最后一块并截断文件。留在内存中的
+// 记录不超过两个块，撤销和执行交替时不会反复读写同一块
+class CommandJournal {
+private:
+    struct Block {
+        uint64_t offset;
+        uint32_t compressedSize;
+        uint32_t rawSize;
+        uint32_t recordCount;
+    };
+
+    std::string m_path;
+    size_t m_blockSize;
+
+    // 尚未写出的记录，每条为类型、大小和数据
+    std::vector<uint8_t> m_pending;
+    std::vector<uint32_t> m_pendingOffsets;
+
+    std::vector<Block> m_blocks;
+    uint64_t m_fileSize;
+    uint64_t m_rawBytes;    // 已写出的块压缩前的大小
+    size_t m_count;
+
+public:
+    explicit CommandJournal(const std::string& path, size_t blockSize = size_t(64) << 10);
+
+    // 删除文件
+    ~CommandJournal();
+
+    CommandJournal(const CommandJournal&) = delete;
+    CommandJournal& operator=(const CommandJournal&) = delete;
+
+    // 写入失败时返回 false，此时已有的记录保持不变
+    bool push(uint32_t type, const std::vector<uint8_t>& data);
+
+    // 取回最新的记录；没有记录或读取失败时返回 false，读取失败时清空所有记录
+    bool pop(uint32_t& type, std::vector<uint8_t>& data);
+
+    // 丢弃所有记录并删除文件
+    void clear();
+
+    size_t getCount() const { return m_count; }
+    uint64_t getFileSize() const { return m_fileSize; }
+    uint64_t getRawBytes() const { return m_rawBytes; }
+    const std::string& getPath() const { return m_path; }
+
+    // 内存中未写出的记录和块索引的大小
+    size_t getMemorySize() const;
+
+private:
+    bool writeBlock(size_t recordCount);
+    bool readLastBlock();
+};
+
+} // namespace Kazia
+
+#endif // COMMANDJOURNAL_H
@@ -1,77 +1,294 @@
 #include "CommandManager.h"
 
+#include <algorithm>
+
+#include "CommandJournal.h"
+
 namespace Kazia {
 
-CommandManager::CommandManager(size_t maxStackSize) : m_maxStackSize(maxStackSize) {
+namespace {
+
+CommandManager::Options makeOptions(size_t maxStackSize) {
+    CommandManager::Options options;
+    options.maxCount = maxStackSize;
+    return options;
+}
+
+} // namespace
+
+CommandManager::CommandManager(size_t maxStackSize) : CommandManager(makeOptions(maxStackSize)) {
+}
+
+CommandManager::CommandManager(const Options& options)
+    : m_options(options),
+      m_first(0),
+      m_count(0),
+      m_cursor(0),
+      m_memoryBytes(0),
+      m_session(0),
+      m_nextSession(1),
+      m_mergeOpen(false) {
+    m_options.maxCount = std::max<size_t>(m_options.maxCount, 1);
+    if (!m_options.spillPath.empty()) {
+        m_journal = std::make_unique<CommandJournal>(m_options.spillPath);
+    }
+}
+
+CommandManager::~CommandManager() = default;
+
+void CommandManager::registerCommandType(CommandType type, CommandFactory factory) {
+    m_factories[static_cast<uint32_t>(type)] = std::move(factory);
 }
 
 bool CommandManager::executeCommand(std::unique_ptr<ICommand> command) {
     if (!command) {
         return false;
     }
-    
+
     // 执行命令
     if (!command->execute()) {
         return false;
     }
-    
-    // 添加到撤销栈
-    m_undoStack.push_back(std::move(command));
-    
-    // 如果撤销栈超过最大大小，移除最早的命令
-    if (m_undoStack.size() > m_maxStackSize) {
-        m_undoStack.erase(m_undoStack.begin());
-    }
-    
-    // 清空重做栈
-    m_redoStack.clear();
-    
+
+    // 能与之前的命令合并时直接丢弃
+    if (!mergeCommand(*command)) {
+        pushExecuted(std::move(command));
+    }
+
+    return true;
+}
+
+void CommandManager::pushExecuted(std::unique_ptr<ICommand> command) {
+    // 清空重做部分
+    while (m_count > m_cursor) {
+        dropBack();
+    }
+
+    // 添加到撤销历史，缓冲区满时把最早的命令移出内存
+    if (m_count == m_options.maxCount) {
+        evictFront();
+    }
+    pushBack(std::move(command));
+    Entry& entry = entryAt(m_count - 1);
+    entry.session = m_session;
+    entry.executeTime = std::chrono::steady_clock::now();
+    m_cursor++;
+    trim();
+
+    m_mergeOpen = true;
+}
+
+bool CommandManager::mergeCommand(const ICommand& command) {
+    // 只有最新的命令可以合并，撤销、重做之后不再合并
+    if (!m_mergeOpen || m_cursor == 0 || m_cursor != m_count) {
+        return false;
+    }
+    size_t merged = m_cursor;
+    if (m_session != 0) {
+        // 会话中按对象分别合并：从最新一条往前只看本会话的命令，单个对象时只比较一条，
+        // 多选拖动时比较的条数等于对象数
+        for (size_t i = m_cursor; i > 0 && entryAt(i - 1).session == m_session; --i) {
+            if (entryAt(i - 1).command->mergeWith(command)) {
+                merged = i - 1;
+                break;
+            }
+        }
+    } else {
+        // 会话之外只与时间窗口内的上一条命令合并，不与拖动产生的命令合并；窗口从该命令第一次执行算起
+        Entry& top = entryAt(m_cursor - 1);
+        auto window = std::chrono::milliseconds(m_options.mergeWindowMs);
+        if (m_options.mergeWindowMs > 0 && top.session == 0 && std::chrono::steady_clock::now() - top.executeTime <= window &&
+            top.command->mergeWith(command)) {
+            merged = m_cursor - 1;
+        }
+    }
+    if (merged == m_cursor) {
+        return false;
+    }
+
+    // 合并后的大小可能变化
+    Entry& entry = entryAt(merged);
+    size_t memorySize = entry.command->getMemorySize();
+    m_memoryBytes = m_memoryBytes - entry.memorySize + memorySize;
+    entry.memorySize = memorySize;
+    trim();
     return true;
 }
 
+void CommandManager::beginMergeSession() {
+    m_session = m_nextSession++;
+}
+
+void CommandManager::endMergeSession() {
+    m_session = 0;
+    m_mergeOpen = false;
+}
+
 bool CommandManager::undo() {
-    if (m_undoStack.empty()) {
+    // 内存中没有可以撤销的命令时从磁盘读回一条
+    if (m_cursor == 0 && !reload()) {
         return false;
     }
-    
-    // 获取栈顶命令
-    auto& command = m_undoStack.back();
-    
+
     // 撤销命令
-    if (!command->undo()) {
+    if (!entryAt(m_cursor - 1).command->undo()) {
         return false;
     }
-    
-    // 将命令移到重做栈
-    m_redoStack.push_back(std::move(command));
-    m_undoStack.pop_back();
-    
+
+    // 游标左移，命令变为可以重做
+    m_cursor--;
+    m_mergeOpen = false;
+
     return true;
 }
 
 bool CommandManager::redo() {
-    if (m_redoStack.empty()) {
+    if (m_cursor == m_count) {
         return false;
     }
-    
-    // 获取栈顶命令
-    auto& command = m_redoStack.back();
-    
+
     // 执行命令
-    if (!command->execute()) {
+    if (!entryAt(m_cursor).command->execute()) {
         return false;
     }
-    
-    // 将命令移到撤销栈
-    m_undoStack.push_back(std::move(command));
-    m_redoStack.pop_back();
-    
+
+    // 游标右移，命令变为可以撤销
+    m_cursor++;
+    m_mergeOpen = false;
+
     return true;
 }
 
 void CommandManager::clear() {
-    m_undoStack.clear();
-    m_redoStack.clear();
+    while (m_count > 0) {
+        dropBack();
+    }
+    m_first = 0;
+    m_cursor = 0;
+    m_mergeOpen = false;
+    if (m_journal) {
+        m_journal->clear();
+    }
+}
+
+bool CommandManager::canUndo() const {
+    return m_cursor > 0 || getSpilledCount() > 0;
+}
+
+size_t CommandManager::getUndoStackSize() const {
+    return m_cursor + getSpilledCount();
+}
+
+size_t CommandManager::getMemorySize() const {
+    size_t size = m_memoryBytes + m_entries.capacity() * sizeof(Entry) + m_buffer.capacity();
+    if (m_journal) {
+        size += m_journal->getMemorySize();
+    }
+    return size;
+}
+
+size_t CommandManager::getSpilledCount() const {
+    return m_journal ? m_journal->getCount() : 0;
+}
+
+uint64_t CommandManager::getSpilledBytes() const {
+    return m_journal ? m_journal->getFileSize() : 0;
+}
+
+void CommandManager::grow() {
+    // 按倍数增长并把内容整理为从 0 开始
+    size_t capacity = std::min(std::max<size_t>(m_entries.size() * 2, 16), m_options.maxCount);
+    std::vector<Entry> entries(capacity);
+    for (size_t i = 0; i < m_count; ++i) {
+        entries[i] = std::move(entryAt(i));
+    }
+    m_entries = std::move(entries);
+    m_first = 0;
+}
+
+void CommandManager::pushBack(std::unique_ptr<ICommand> command) {
+    if (m_count == m_entries.size()) {
+        grow();
+    }
+    Entry& entry = entryAt(m_count);
+    entry.memorySize = command->getMemorySize();
+    entry.command = std::move(command);
+    m_memoryBytes += entry.memorySize;
+    m_count++;
+}
+
+void CommandManager::evictFront() {
+    Entry& entry = m_entries[m_first];
+    m_memoryBytes -= entry.memorySize;
+    std::unique_ptr<ICommand> command = std::move(entry.command);
+    m_first = (m_first + 1) % m_entries.size();
+    m_count--;
+    m_cursor--;
+
+    // 写到磁盘；不能写出时更早的历史也不再可达，一并丢弃
+    if (!m_journal) {
+        return;
+    }
+    CommandType type = command->getType();
+    bool spilled = false;
+    if (type != CommandType::None) {
+        m_buffer.clear();
+        command->serialize(m_buffer);
+        spilled = m_journal->push(static_cast<uint32_t>(type), m_buffer);
+    }
+    if (!spilled) {
+        m_journal->clear();
+    }
+}
+
+void CommandManager::dropBack() {
+    Entry& entry = entryAt(m_count - 1);
+    m_memoryBytes -= entry.memorySize;
+    entry.command.reset();
+    m_count--;
+}
+
+bool CommandManager::reload() {
+    uint32_t type;
+    if (!m_journal || !m_journal->pop(type, m_buffer)) {
+        return false;
+    }
+    auto it = m_factories.find(type);
+    std::unique_ptr<ICommand> command = it != m_factories.end() ? it->second(m_buffer.data(), m_buffer.size()) : nullptr;
+    if (!command) {
+        m_journal->clear();
+        return false;
+    }
+
+    // 放到缓冲区最前面；缓冲区满时丢弃最远的可以重做的命令
+    if (m_count == m_options.maxCount) {
+        dropBack();
+    }
+    if (m_count == m_entries.size()) {
+        grow();
+    }
+    m_first = (m_first + m_entries.size() - 1) % m_entries.size();
+    Entry& entry = m_entries[m_first];
+    entry.memorySize = command->getMemorySize();
+    entry.session = 0;
+    entry.executeTime = std::chrono::steady_clock::time_point();
+    entry.command = std::move(command);
+    m_memoryBytes += entry.memorySize;
+    m_count++;
+    m_cursor++;
+    trim();
+    return true;
+}
+
+void CommandManager::trim() {
+    // 超出内存上限时先移出最早的可以撤销的命令，再丢弃最远的可以重做的命令，至少保留一条
+    while (m_memoryBytes > m_options.maxBytes && m_count > 1) {
+        if (m_cursor > 1) {
+            evictFront();
+        } else {
+            dropBack();
+        }
+    }
 }
 
 } // namespace Kazia
@@ -1,40 +1,130 @@
 #ifndef COMMANDMANAGER_H
 #define COMMANDMANAGER_H
 
-#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 #include "ICommand.h"
 
 namespace Kazia {
 
+class CommandJournal;
+
+// 撤销历史
+// 内存中的命令放在环形缓冲区里，游标之前的可以撤销，之后的可以重做；执行新命令时丢弃可重做的部分。
+// 命令数或占用的内存超过上限时，最早的命令序列化后写到压缩的磁盘日志里（没有指定日志路径、
+// 或命令不能序列化时直接丢弃），撤销到内存中的最早一条之后再从日志逐条读回。
+// 移出和读回都是 O(1)，内存占用只由上限决定，与会话长度无关。
+// 连续的编辑（拖动 Gizmo、调节数值）产生的命令可以合并（见 ICommand::mergeWith）：合并会话
+// （beginMergeSession / endMergeSession 之间）中的命令与本会话中作用于同一对象的命令合并，
+// 会话之外，距上一条命令第一次执行不超过 mergeWindowMs 的命令与它合并（窗口不随合并顺延，
+// 持续的编辑每隔一个窗口产生一条记录）；撤销、重做后不再合并
 class CommandManager {
+public:
+    struct Options {
+        size_t maxCount = 100;                      // 内存中最多保留的命令数
+        size_t maxBytes = size_t(16) << 20;         // 内存中的命令占用的上限
+        std::string spillPath;                      // 磁盘日志的路径，为空时不写磁盘
+        uint32_t mergeWindowMs = 500;               // 会话之外按时间合并的窗口，0 表示不按时间合并
+    };
+
+    // 从磁盘日志读回命令：data 为 ICommand::serialize 写出的内容，无法还原时返回 nullptr
+    using CommandFactory = std::function<std::unique_ptr<ICommand>(const uint8_t* data, size_t size)>;
+
 private:
-    std::vector<std::unique_ptr<ICommand>> m_undoStack;
-    std::vector<std::unique_ptr<ICommand>> m_redoStack;
-    size_t m_maxStackSize;
-    
+    struct Entry {
+        std::unique_ptr<ICommand> command;
+        size_t memorySize;
+        uint64_t session;   // 所属的合并会话，0 表示不在会话中
+        std::chrono::steady_clock::time_point executeTime;  // 第一次执行的时间，时间窗口从此算起
+    };
+
+    Options m_options;
+
+    // 环形缓冲区，按需增长到 maxCount
+    std::vector<Entry> m_entries;
+    size_t m_first;
+    size_t m_count;
+    size_t m_cursor;        // 可以撤销的命令数（内存中）
+    size_t m_memoryBytes;   // 内存中的命令占用的总和
+
+    std::unique_ptr<CommandJournal> m_journal;
+    std::unordered_map<uint32_t, CommandFactory> m_factories;
+    std::vector<uint8_t> m_buffer;
+
+    // 合并状态
+    uint64_t m_session;         // 当前的合并会话，0 表示没有
+    uint64_t m_nextSession;
+    bool m_mergeOpen;           // 最新一条命令是否还可以合并
+
 public:
     CommandManager(size_t maxStackSize = 100);
-    ~CommandManager() = default;
-    
+    CommandManager(const Options& options);
+    ~CommandManager();
+
+    CommandManager(const CommandManager&) = delete;
+    CommandManager& operator=(const CommandManager&) = delete;
+
+    // 注册从磁盘日志读回某种命令的方法，未注册的类型读回时视为历史到此为止
+    void registerCommandType(CommandType type, CommandFactory factory);
+
     // 执行命令
     bool executeCommand(std::unique_ptr<ICommand> command);
-    
+
+    // 执行栈上的命令：能合并时不分配内存，否则移动到堆上加入历史
+    template <typename T, typename = std::enable_if_t<std::is_base_of<ICommand, T>::value>>
+    bool executeCommand(T command) {
+        if (!command.execute()) {
+            return false;
+        }
+        if (!mergeCommand(command)) {
+            pushExecuted(std::make_unique<T>(std::move(command)));
+        }
+        return true;
+    }
+
+    // 合并会话：一次拖动开始和结束时调用，会话中作用于同一对象的命令合并为一条
+    void beginMergeSession();
+    void endMergeSession();
+
     // 撤销命令
     bool undo();
-    
+
     // 重做命令
     bool redo();
-    
+
     // 清理命令栈
     void clear();
-    
-    // 获取命令栈状态
-    bool canUndo() const { return !m_undoStack.empty(); }
-    bool canRedo() const { return !m_redoStack.empty(); }
-    size_t getUndoStackSize() const { return m_undoStack.size(); }
-    size_t getRedoStackSize() const { return m_redoStack.size(); }
+
+    // 获取命令栈状态（撤销栈包含写到磁盘的命令）
+    bool canUndo() const;
+    bool canRedo() const { return m_cursor < m_count; }
+    size_t getUndoStackSize() const;
+    size_t getRedoStackSize() const { return m_count - m_cursor; }
+
+    // 内存占用：命令、环形缓冲区和日志未写出的部分
+    size_t getMemorySize() const;
+
+    // 写到磁盘的命令数和日志文件的大小
+    size_t getSpilledCount() const;
+    uint64_t getSpilledBytes() const;
+
+private:
+    Entry& entryAt(size_t index) { return m_entries[(m_first + index) % m_entries.size()]; }
+    void grow();
+    void pushBack(std::unique_ptr<ICommand> command);
+    void evictFront();
+    void dropBack();
+    bool reload();
+    void trim();
+    bool mergeCommand(const ICommand& command);
+    void pushExecuted(std::unique_ptr<ICommand> command);
 };
 
 } // namespace Kazia
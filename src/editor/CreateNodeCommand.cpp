@@ -3,8 +3,17 @@
 #include "scene/Node.h"
 #include "scene/Scene.h"
 
+#include <cstring>
+
 namespace Kazia {
 
+namespace {
+
+// 序列化时表示没有父节点（添加到场景根节点下）
+constexpr uint32_t NO_NODE = 0xFFFFFFFFu;
+
+} // namespace
+
 CreateNodeCommand::CreateNodeCommand(Scene* scene, Node* parent, const std::string& nodeName) 
     : m_scene(scene), 
       m_parent(parent), 
@@ -56,4 +65,47 @@ std::string CreateNodeCommand::getName() const {
     return "Create Node Command";
 }
 
+void CreateNodeCommand::serialize(std::vector<uint8_t>& data) const {
+    // 父节点 ID、创建的节点 ID 和两者 UUID 的长度，之后是两个 UUID（读回时核对）和节点名称
+    static const std::string noUuid;
+    const std::string& parentUuid = m_parent ? m_parent->getUUID() : noUuid;
+    const std::string& nodeUuid = m_node ? m_node->getUUID() : noUuid;
+    uint32_t header[4] = {m_parent ? m_parent->getId() : NO_NODE, m_node ? m_node->getId() : NO_NODE,
+                          static_cast<uint32_t>(parentUuid.size()), static_cast<uint32_t>(nodeUuid.size())};
+    data.resize(sizeof(header) + parentUuid.size() + nodeUuid.size() + m_nodeName.size());
+    uint8_t* out = data.data();
+    std::memcpy(out, header, sizeof(header));
+    out += sizeof(header);
+    std::memcpy(out, parentUuid.data(), parentUuid.size());
+    out += parentUuid.size();
+    std::memcpy(out, nodeUuid.data(), nodeUuid.size());
+    out += nodeUuid.size();
+    std::memcpy(out, m_nodeName.data(), m_nodeName.size());
+}
+
+std::unique_ptr<ICommand> CreateNodeCommand::deserialize(Scene& scene, const uint8_t* data, size_t size) {
+    uint32_t header[4];
+    if (size < sizeof(header)) {
+        return nullptr;
+    }
+    std::memcpy(header, data, sizeof(header));
+    size_t uuidBytes = static_cast<size_t>(header[2]) + header[3];
+    if (uuidBytes > size - sizeof(header)) {
+        return nullptr;
+    }
+    const char* text = reinterpret_cast<const char*>(data) + sizeof(header);
+    std::string parentUuid(text, header[2]);
+    std::string nodeUuid(text + header[2], header[3]);
+    
+    // 只有已执行的命令会写到磁盘，创建的节点和父节点都应该还在场景中，且 ID 仍指向同一个节点
+    Node* parent = header[0] == NO_NODE ? nullptr : scene.getNodeById(header[0], parentUuid);
+    Node* node = header[1] == NO_NODE ? nullptr : scene.getNodeById(header[1], nodeUuid);
+    if (!node || (header[0] != NO_NODE && !parent)) {
+        return nullptr;
+    }
+    auto command = std::make_unique<CreateNodeCommand>(&scene, parent, std::string(text + uuidBytes, size - sizeof(header) - uuidBytes));
+    command->m_node = node;
+    return command;
+}
+
 } // namespace Kazia
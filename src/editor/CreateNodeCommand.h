@@ -3,6 +3,7 @@
 
 #include "ICommand.h"
 
+#include <memory>
 #include <string>
 
 namespace Kazia {
@@ -30,6 +31,13 @@ public:
     // 获取命令名称
     std::string getName() const override;
     
+    size_t getMemorySize() const override { return sizeof(*this) + m_nodeName.capacity(); }
+    
+    // 序列化时父节点和创建的节点按 ID 保存，读回时在 scene 中查找
+    CommandType getType() const override { return CommandType::CreateNode; }
+    void serialize(std::vector<uint8_t>& data) const override;
+    static std::unique_ptr<ICommand> deserialize(Scene& scene, const uint8_t* data, size_t size);
+    
     // 获取创建的节点
     Node* getNode() const { return m_node; }
 };
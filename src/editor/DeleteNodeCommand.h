@@ -27,6 +27,8 @@ public:
     
     // 获取命令名称
     std::string getName() const override;
+    
+    size_t getMemorySize() const override { return sizeof(*this); }
 };
 
 } // namespace Kazia
@@ -1,5 +1,7 @@
 #include "Gizmo.h"
 
+#include "CommandManager.h"
+#include "TransformCommand.h"
 #include "scene/Node.h"
 
 namespace Kazia {
@@ -8,6 +10,7 @@ Gizmo::Gizmo(filament::Engine* engine, filament::Scene* scene, SelectionManager*
     : m_engine(engine), 
       m_scene(scene), 
       m_selectionManager(selectionManager), 
+      m_commandManager(nullptr), 
       m_gizmoEntity(utils::Entity::INVALID), 
       m_type(GizmoType::MOVE), 
       m_activeAxis(Axis::NONE), 
@@ -62,6 +65,11 @@ bool Gizmo::onMousePress(int x, int y, const filament::math::float3& rayOrigin,
             m_isDragging = true;
             m_lastMouseX = x;
             m_lastMouseY = y;
+            
+            // 一次拖动作为一个合并会话
+            if (m_commandManager) {
+                m_commandManager->beginMergeSession();
+            }
             return true;
         }
     }
@@ -95,9 +103,27 @@ bool Gizmo::onMouseMove(int x, int y, const filament::math::float3& rayOrigin, c
 }
 
 bool Gizmo::onMouseRelease() {
+    if (m_isDragging && m_commandManager) {
+        m_commandManager->endMergeSession();
+    }
     m_isDragging = false;
     m_activeAxis = Axis::NONE;
     return true;
 }
 
+void Gizmo::setNodeTransform(Node* node, const math::float3& position, const math::float3& rotation, const math::float3& scale) {
+    if (!m_commandManager) {
+        node->setPosition(position);
+        node->setRotation(rotation);
+        node->setScale(scale);
+        return;
+    }
+    
+    // 命令在栈上构造，与本次拖动中同一节点的命令合并时不分配内存
+    m_commandManager->executeCommand(TransformCommand(node, 
+                                                      node->getPosition(), position, 
+                                                      node->getRotation(), rotation, 
+                                                      node->getScale(), scale));
+}
+
 } // namespace Kazia
@@ -11,6 +11,7 @@ namespace Kazia {
 
 class Node;
 class SelectionManager;
+class CommandManager;
 
 class Gizmo {
 public:
@@ -35,6 +36,7 @@ protected:
     filament::Engine* m_engine;
     filament::Scene* m_scene;
     SelectionManager* m_selectionManager;
+    CommandManager* m_commandManager;
     
     utils::Entity m_gizmoEntity;
     GizmoType m_type;
@@ -58,6 +60,9 @@ public:
     // 激活相关
     void setActive(bool active);
     
+    // 设置后拖动产生的变换经命令执行，一次拖动中每个节点合并为一条撤销记录
+    void setCommandManager(CommandManager* commandManager) { m_commandManager = commandManager; }
+    
     // 鼠标事件处理
     virtual bool onMousePress(int x, int y, const filament::math::float3& rayOrigin, const filament::math::float3& rayDirection);
     virtual bool onMouseMove(int x, int y, const filament::math::float3& rayOrigin, const filament::math::float3& rayDirection);
@@ -76,6 +81,9 @@ protected:
     // 应用变换
     virtual void applyTransform(const filament::math::float3& delta) = 0;
     
+    // 设置节点的变换，有命令管理器时经 TransformCommand 执行
+    void setNodeTransform(Node* node, const math::float3& position, const math::float3& rotation, const math::float3& scale);
+    
     // 创建 Gizmo 几何体
     virtual void createGizmoGeometry() = 0;
 };
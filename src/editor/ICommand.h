@@ -1,10 +1,20 @@
 #ifndef ICOMMAND_H
 #define ICOMMAND_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace Kazia {
 
+// 命令类型，用于把写到磁盘的命令读回来（见 CommandManager::registerCommandType）
+enum class CommandType : uint32_t {
+    None = 0,       // 不能写到磁盘
+    Transform = 1,
+    CreateNode = 2
+};
+
 class ICommand {
 public:
     virtual ~ICommand() = default;
@@ -17,6 +27,18 @@ public:
     
     // 获取命令名称
     virtual std::string getName() const = 0;
+    
+    // 命令占用的内存（自身及持有的堆内存），撤销历史据此限制总大小
+    virtual size_t getMemorySize() const = 0;
+    
+    // 撤销历史超出上限时，较早的命令序列化后写到磁盘；返回 None 的命令不能写出，
+    // 移出内存时连同更早的历史一起丢弃
+    virtual CommandType getType() const { return CommandType::None; }
+    virtual void serialize(std::vector<uint8_t>& /*data*/) const {}
+    
+    // 合并：next 已经执行，且与本命令作用于同一对象时，把 next 的结果并入本命令（保留本命令的初始状态）
+    // 并返回 true，next 随后被丢弃。合并须为 O(1) 且不分配内存，连续拖动时每次移动都会调用
+    virtual bool mergeWith(const ICommand& /*next*/) { return false; }
 };
 
 } // namespace Kazia
@@ -125,7 +125,7 @@ void MoveGizmo::applyTransform(const filament::math::float3& delta) {
         for (Node* node : selectedNodes) {
             if (node) {
                 filament::math::float3 newPosition = node->getPosition() + delta;
-                node->setPosition(newPosition);
+                setNodeTransform(node, newPosition, node->getRotation(), node->getScale());
             }
         }
     }
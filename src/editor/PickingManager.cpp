@@ -1,9 +1,12 @@
 #include "PickingManager.h"
 
+#include "scene/MeshComponent.h"
 #include "scene/Node.h"
 #include "scene/Scene.h"
 #include "scene/SelectionManager.h"
+#include "render/IGpuPicker.h"
 
+#include <algorithm>
 #include <limits>
 
 namespace Kazia {
@@ -14,11 +17,22 @@ PickingManager::PickingManager(Engine* engine, Scene* scene, SelectionManager* s
       m_scene(scene), 
       m_selectionManager(selectionManager), 
       m_screenWidth(0), 
-      m_screenHeight(0) {
+      m_screenHeight(0),
+      m_hasCameraMatrices(false),
+      m_indexedUpdateCount(0),
+      m_indexedStructureVersion(0),
+      m_indexValid(false),
+      m_gpuPicker(nullptr),
+      m_pickMode(PickMode::CPU) {
+}
+
+void PickingManager::setCameraMatrices(const math::mat4f& view, const math::mat4f& projection) {
+    m_viewProjection = math::multiply(projection, view);
+    m_hasCameraMatrices = math::inverse(m_viewProjection, m_inverseViewProjection);
 }
 
 Node* PickingManager::pickObject(int x, int y) {
-    if (!m_camera || !m_scene) {
+    if (!m_hasCameraMatrices || !m_scene || m_screenWidth <= 0 || m_screenHeight <= 0) {
         return nullptr;
     }
     
@@ -26,11 +40,271 @@ Node* PickingManager::pickObject(int x, int y) {
     math::float3 rayOrigin, rayDirection;
     screenToRay(x, y, rayOrigin, rayDirection);
     
-    // 递归检测射线与场景节点的相交
+    PickResult result;
+    if (raycast(rayOrigin, rayDirection, result)) {
+        return result.node;
+    }
+    return nullptr;
+}
+
+void PickingManager::pickObjectAsync(int x, int y, PickCallback callback) {
+    if (!callback) {
+        return;
+    }
+    
+    if (m_pickMode != PickMode::GPU || !m_gpuPicker) {
+        callback(pickObject(x, y));
+        return;
+    }
+    
+    m_gpuPicker->pick(x, y, [this, x, y, callback](const GpuPickResult& result) {
+        if (!result.completed) {
+            callback(pickObject(x, y));
+            return;
+        }
+        
+        // 回调时场景可能已经变化，按 UUID 重新查找
+        Node* node = nullptr;
+        if (result.hit && m_scene) {
+            node = m_scene->findNodeByUUID(result.nodeUUID);
+        }
+        callback(node);
+    });
+}
+
+bool PickingManager::raycast(const math::float3& rayOrigin, const math::float3& rayDirection, PickResult& result) {
+    m_lastPickStats = PickStats();
+    if (!m_scene) {
+        return false;
+    }
+    
+    updateSpatialIndex();
+    
+    // 方向归一化后射线参数即为距离
+    math::ray ray(rayOrigin, math::normalize(rayDirection));
+    
+    Node* pickedNode = nullptr;
     float closestDistance = std::numeric_limits<float>::max();
-    Node* pickedNode = intersectRayWithScene(rayOrigin, rayDirection, m_scene->getRootNode(), closestDistance);
+    uint32_t pickedTriangle = 0;
+    uint32_t candidates = 0;
+    
+    // 场景 BVH 由近到远访问，命中后缩短射线，更远的子树直接跳过
+    m_lastPickStats.bvhNodesVisited = m_sceneBvh.queryRay(ray, closestDistance,
+        [this, &ray, &pickedNode, &closestDistance, &pickedTriangle, &candidates](int32_t proxyId, float tMax) {
+            Node* node = static_cast<Node*>(m_sceneBvh.getUserData(proxyId));
+            candidates++;
+            
+            float t;
+            uint32_t triangle;
+            if (intersectNode(ray, node, tMax, t, triangle)) {
+                pickedNode = node;
+                pickedTriangle = triangle;
+                closestDistance = t;
+                return t;
+            }
+            return tMax;
+        });
+    m_lastPickStats.candidates = candidates;
+    
+    if (!pickedNode) {
+        return false;
+    }
+    
+    result.node = pickedNode;
+    result.distance = closestDistance;
+    result.position = ray.at(closestDistance);
+    result.triangle = pickedTriangle;
+    return true;
+}
+
+size_t PickingManager::pickObjectsInRect(int x0, int y0, int x1, int y1, std::vector<Node*>& result) {
+    result.clear();
+    m_lastPickStats = PickStats();
+    if (!m_hasCameraMatrices || !m_scene || m_screenWidth <= 0 || m_screenHeight <= 0) {
+        return 0;
+    }
+    
+    updateSpatialIndex();
+    
+    // 像素矩形转换到 NDC，右下边界包含整个像素
+    float left = static_cast<float>(std::min(x0, x1));
+    float right = static_cast<float>(std::max(x0, x1) + 1);
+    float top = static_cast<float>(std::min(y0, y1));
+    float bottom = static_cast<float>(std::max(y0, y1) + 1);
+    
+    float ndcX0 = 2.0f * left / m_screenWidth - 1.0f;
+    float ndcX1 = 2.0f * right / m_screenWidth - 1.0f;
+    float ndcY0 = 1.0f - 2.0f * bottom / m_screenHeight;
+    float ndcY1 = 1.0f - 2.0f * top / m_screenHeight;
+    
+    // 把矩形拉伸到 [-1, 1] 的裁剪矩阵，与视图投影矩阵相乘后提取的平面即为矩形对应的子视锥体
+    math::mat4f crop;
+    crop.m[0] = 2.0f / (ndcX1 - ndcX0);
+    crop.m[5] = 2.0f / (ndcY1 - ndcY0);
+    crop.m[12] = -(ndcX1 + ndcX0) / (ndcX1 - ndcX0);
+    crop.m[13] = -(ndcY1 + ndcY0) / (ndcY1 - ndcY0);
+    math::frustum subFrustum = math::frustum::fromMatrix(math::multiply(crop, m_viewProjection));
+    
+    m_rectCandidates.clear();
+    m_rectCandidateBounds.clear();
+    m_lastPickStats.bvhNodesVisited = m_sceneBvh.queryFrustum(subFrustum, [this, &result, &subFrustum](int32_t proxyId, bool fullyInside) {
+        Node* node = static_cast<Node*>(m_sceneBvh.getUserData(proxyId));
+        
+        // 放大包围盒完全在子视锥体内，真实包围盒的投影必然落在矩形内
+        if (fullyInside) {
+            result.push_back(node);
+            return;
+        }
+        
+        // 放大包围盒相交时用真实包围盒再检测一次
+        const math::aabb& worldBounds = node->getWorldBounds();
+        if (subFrustum.classify(worldBounds) != math::frustum::Result::OUTSIDE) {
+            m_rectCandidates.push_back(node);
+            m_rectCandidateBounds.push_back(worldBounds);
+        }
+    });
+    m_lastPickStats.candidates = static_cast<uint32_t>(m_rectCandidates.size());
+    
+    // 与子视锥体相交的候选批量投影，排除平面检测的保守误判
+    m_rectProjections.resize(m_rectCandidateBounds.size());
+    projectAabbs(m_viewProjection, m_rectCandidateBounds.data(), m_rectCandidateBounds.size(), m_rectProjections.data());
+    for (size_t i = 0; i < m_rectCandidates.size(); ++i) {
+        if (m_rectProjections[i].overlaps(ndcX0, ndcY0, ndcX1, ndcY1)) {
+            result.push_back(m_rectCandidates[i]);
+        }
+    }
+    
+    return result.size();
+}
+
+size_t PickingManager::selectObjectsInRect(int x0, int y0, int x1, int y1, SelectionOp op) {
+    std::vector<Node*> nodes;
+    pickObjectsInRect(x0, y0, x1, y1, nodes);
+    
+    if (m_selectionManager) {
+        switch (op) {
+            case SelectionOp::Replace:
+                m_selectionManager->selectNodes(nodes);
+                break;
+            case SelectionOp::Add:
+                m_selectionManager->addNodes(nodes);
+                break;
+            case SelectionOp::Remove:
+                m_selectionManager->deselectNodes(nodes);
+                break;
+        }
+    }
+    
+    return nodes.size();
+}
+
+void PickingManager::updateSpatialIndex() {
+    if (!m_scene) {
+        return;
+    }
+    
+    uint64_t updateCount = m_scene->getUpdateCount();
+    uint64_t structureVersion = m_scene->getStructureVersion();
+    
+    // 节点增删后缓存的指针可能失效；漏掉了中间某次 update 时变化列表不完整，都需要重建
+    if (!m_indexValid || structureVersion != m_indexedStructureVersion || updateCount > m_indexedUpdateCount + 1) {
+        rebuildSpatialIndex();
+        return;
+    }
+    
+    if (updateCount == m_indexedUpdateCount) {
+        return;
+    }
+    
+    const std::vector<Node*>& changedNodes = m_scene->getChangedNodes();
+    for (Node* node : changedNodes) {
+        refitNode(node);
+    }
+    
+    // 大量节点移动后逐个重新插入会降低树的质量，改为整体重建
+    if (changedNodes.size() * 4 > m_nodeToProxy.size()) {
+        m_sceneBvh.rebuild();
+    }
+    
+    m_indexedUpdateCount = updateCount;
+}
+
+void PickingManager::rebuildSpatialIndex() {
+    m_sceneBvh.clear();
+    m_nodeToProxy.clear();
+    
+    // 先逐个创建代理，再用 SAH 整体重建
+    std::vector<Node*> stack;
+    stack.push_back(m_scene->getRootNode());
+    while (!stack.empty()) {
+        Node* node = stack.back();
+        stack.pop_back();
+        
+        if (!node->getWorldBounds().isEmpty()) {
+            m_nodeToProxy[node] = m_sceneBvh.createProxy(node->getWorldBounds(), node);
+        }
+        
+        for (size_t i = 0; i < node->getChildCount(); ++i) {
+            stack.push_back(node->getChild(i));
+        }
+    }
+    m_sceneBvh.rebuild();
+    
+    m_indexedUpdateCount = m_scene->getUpdateCount();
+    m_indexedStructureVersion = m_scene->getStructureVersion();
+    m_indexValid = true;
+}
+
+void PickingManager::refitNode(Node* node) {
+    const math::aabb& worldBounds = node->getWorldBounds();
+    auto it = m_nodeToProxy.find(node);
+    
+    if (it == m_nodeToProxy.end()) {
+        if (!worldBounds.isEmpty()) {
+            m_nodeToProxy[node] = m_sceneBvh.createProxy(worldBounds, node);
+        }
+        return;
+    }
+    
+    if (worldBounds.isEmpty()) {
+        m_sceneBvh.destroyProxy(it->second);
+        m_nodeToProxy.erase(it);
+    } else {
+        m_sceneBvh.moveProxy(it->second, worldBounds);
+    }
+}
+
+bool PickingManager::intersectNode(const math::ray& ray, Node* node, float tMax, float& t, uint32_t& triangle) const {
+    // 场景 BVH 叶子是放大后的包围盒，先用精确的世界包围盒过滤
+    float tNear;
+    if (!ray.intersects(node->getWorldBounds(), tMax, tNear)) {
+        return false;
+    }
+    
+    MeshComponent* mesh = node->getComponent<MeshComponent>();
+    const TriangleBVH* triangleBvh = mesh ? mesh->getTriangleBVH().get() : nullptr;
+    if (!triangleBvh || triangleBvh->isEmpty()) {
+        // 没有三角形数据时以包围盒作为拾取形状
+        t = tNear;
+        triangle = 0;
+        return true;
+    }
+    
+    // 射线变换到网格局部空间，方向不归一化，局部射线参数与世界空间一致
+    math::mat4f inverseWorld;
+    if (!math::inverse(node->getWorldMatrix(), inverseWorld)) {
+        return false;
+    }
+    math::ray localRay(math::transformPoint(inverseWorld, ray.origin), math::transformDirection(inverseWorld, ray.direction));
     
-    return pickedNode;
+    TriangleBVH::Hit hit;
+    if (!triangleBvh->intersect(localRay, tMax, hit)) {
+        return false;
+    }
+    
+    t = hit.t;
+    triangle = hit.triangle;
+    return true;
 }
 
 bool PickingManager::intersectRayWithAABB(const math::float3& rayOrigin, 
@@ -62,98 +336,47 @@ bool PickingManager::intersectRayWithMesh(const math::float3& rayOrigin,
                                           const math::float3& rayDirection, 
                                           Node* node, 
                                           math::float3& intersection) {
-    // 简化实现：使用 AABB 代替网格
-    // 实际项目中需要实现更复杂的射线与三角形相交检测
-    
-    // 假设节点的 AABB 为中心在原点，大小为 1 的立方体
-    math::float3 aabbMin = {-0.5f, -0.5f, -0.5f};
-    math::float3 aabbMax = {0.5f, 0.5f, 0.5f};
-    
-    // 考虑节点的变换
-    math::mat4f worldMatrix = node->getWorldMatrix();
-    
-    // 计算 AABB 在世界空间中的范围
-    // 这里使用简化的方法，实际项目中需要正确计算变换后的 AABB
-    math::float3 nodePos = node->getPosition();
-    aabbMin = {aabbMin.x + nodePos.x, aabbMin.y + nodePos.y, aabbMin.z + nodePos.z};
-    aabbMax = {aabbMax.x + nodePos.x, aabbMax.y + nodePos.y, aabbMax.z + nodePos.z};
-    
-    // 检测射线与 AABB 的相交
-    float tMin, tMax;
-    if (intersectRayWithAABB(rayOrigin, rayDirection, aabbMin, aabbMax, tMin, tMax)) {
-        // 计算交点
-        intersection = {rayOrigin.x + rayDirection.x * tMin, 
-                        rayOrigin.y + rayDirection.y * tMin, 
-                        rayOrigin.z + rayDirection.z * tMin};
-        return true;
+    if (!node || node->getWorldBounds().isEmpty()) {
+        return false;
     }
     
-    return false;
+    math::ray ray(rayOrigin, rayDirection);
+    float t;
+    uint32_t triangle;
+    if (!intersectNode(ray, node, std::numeric_limits<float>::max(), t, triangle)) {
+        return false;
+    }
+    
+    // 计算交点
+    intersection = ray.at(t);
+    return true;
 }
 
 void PickingManager::screenToRay(int x, int y, math::float3& rayOrigin, math::float3& rayDirection) {
-    if (!m_camera) {
+    if (!m_hasCameraMatrices || m_screenWidth <= 0 || m_screenHeight <= 0) {
         return;
     }
     
-    // 屏幕坐标归一化到 [-1, 1] 范围
-    float nx = (2.0f * x) / m_screenWidth - 1.0f;
-    float ny = 1.0f - (2.0f * y) / m_screenHeight;
+    // 屏幕坐标（取像素中心）归一化到 [-1, 1] 范围
+    float nx = (2.0f * (x + 0.5f)) / m_screenWidth - 1.0f;
+    float ny = 1.0f - (2.0f * (y + 0.5f)) / m_screenHeight;
+    
+    // 反投影近平面和视锥体内另一深度上的点，远平面为无穷远时也有效
+    math::float3 nearPoint = math::transformProject(m_inverseViewProjection, math::float3(nx, ny, -1.0f));
+    math::float3 farPoint = math::transformProject(m_inverseViewProjection, math::float3(nx, ny, 0.0f));
     
-    // 简化实现：使用默认的相机参数
-    rayOrigin = {0.0f, 0.0f, 5.0f};
-    rayDirection = {nx, ny, -1.0f};
+    rayOrigin = nearPoint;
+    rayDirection = math::normalize(farPoint - nearPoint);
 }
 
 void PickingManager::worldToScreen(const math::float3& worldPos, math::float2& screenPos) {
-    if (!m_camera) {
+    if (!m_hasCameraMatrices) {
         return;
     }
     
-    // 简化实现：使用默认的相机参数
-    screenPos = {(worldPos.x + 1.0f) * 0.5f * m_screenWidth, 
-                 (1.0f - worldPos.y) * 0.5f * m_screenHeight};
-}
-
-Node* PickingManager::intersectRayWithScene(const math::float3& rayOrigin, 
-                                           const math::float3& rayDirection, 
-                                           Node* node, 
-                                           float& closestDistance) {
-    if (!node) {
-        return nullptr;
-    }
-    
-    // 检测射线与当前节点的相交
-    math::float3 intersection;
-    bool hit = intersectRayWithMesh(rayOrigin, rayDirection, node, intersection);
-    
-    Node* pickedNode = nullptr;
-    float nodeDistance = 0.0f;
-    
-    if (hit) {
-        // 计算交点到射线原点的距离
-        nodeDistance = std::sqrt(std::pow(intersection.x - rayOrigin.x, 2) + 
-                                std::pow(intersection.y - rayOrigin.y, 2) + 
-                                std::pow(intersection.z - rayOrigin.z, 2));
-        if (nodeDistance < closestDistance) {
-            closestDistance = nodeDistance;
-            pickedNode = node;
-        }
-    }
-    
-    // 递归检测子节点
-    for (size_t i = 0; i < node->getChildCount(); ++i) {
-        Node* child = node->getChild(i);
-        float childClosestDistance = closestDistance;
-        Node* childPickedNode = intersectRayWithScene(rayOrigin, rayDirection, child, childClosestDistance);
-        
-        if (childPickedNode && childClosestDistance < closestDistance) {
-            closestDistance = childClosestDistance;
-            pickedNode = childPickedNode;
-        }
-    }
-    
-    return pickedNode;
+    math::float3 ndc = math::transformProject(m_viewProjection, worldPos);
+    screenPos = {(ndc.x + 1.0f) * 0.5f * m_screenWidth, 
+                 (1.0f - ndc.y) * 0.5f * m_screenHeight};
 }
 
 } // namespace Kazia
@@ -1,15 +1,20 @@
 #ifndef PICKINGMANAGER_H
 #define PICKINGMANAGER_H
 
+#include <functional>
 #include <vector>
 #include <memory>
+#include <unordered_map>
 #include "core/Math.h"
+#include "core/DynamicBVH.h"
+#include "core/ScreenProjection.h"
 
 namespace Kazia {
 
 class Node;
 class Scene;
 class SelectionManager;
+class IGpuPicker;
 
 // 简化的 Engine 类
 class Engine {
@@ -25,6 +30,36 @@ public:
 };
 
 class PickingManager {
+public:
+    // 拾取方式：CPU 射线检测或 GPU ID 缓冲
+    enum class PickMode {
+        CPU,
+        GPU
+    };
+    
+    using PickCallback = std::function<void(Node*)>;
+    
+    // 框选结果如何作用于当前选择
+    enum class SelectionOp {
+        Replace,
+        Add,
+        Remove
+    };
+    
+    // 拾取结果
+    struct PickResult {
+        Node* node = nullptr;
+        math::float3 position;       // 世界空间交点
+        float distance = 0.0f;       // 到射线原点的距离
+        uint32_t triangle = 0;       // 命中的三角形（无三角形 BVH 时为 0）
+    };
+    
+    // 最近一次拾取的统计
+    struct PickStats {
+        uint32_t bvhNodesVisited = 0;   // 场景 BVH 访问的节点数
+        uint32_t candidates = 0;        // 进入精确检测的节点数
+    };
+    
 private:
     Engine* m_engine;
     Camera* m_camera;
@@ -35,6 +70,31 @@ private:
     int m_screenWidth;
     int m_screenHeight;
     
+    // 相机矩阵
+    math::mat4f m_viewProjection;
+    math::mat4f m_inverseViewProjection;
+    bool m_hasCameraMatrices;
+    
+    // 场景 BVH，叶子为世界包围盒非空的节点
+    DynamicBVH m_sceneBvh;
+    std::unordered_map<Node*, int32_t> m_nodeToProxy;
+    
+    // 场景 BVH 对应的场景状态，不一致时增量更新或重建
+    uint64_t m_indexedUpdateCount;
+    uint64_t m_indexedStructureVersion;
+    bool m_indexValid;
+    
+    PickStats m_lastPickStats;
+    
+    // GPU 拾取
+    IGpuPicker* m_gpuPicker;
+    PickMode m_pickMode;
+    
+    // 框选的临时缓冲，跨调用复用避免重复分配
+    std::vector<Node*> m_rectCandidates;
+    std::vector<math::aabb> m_rectCandidateBounds;
+    std::vector<ScreenRect> m_rectProjections;
+    
 public:
     PickingManager(Engine* engine, Scene* scene, SelectionManager* selectionManager);
     ~PickingManager() = default;
@@ -48,9 +108,45 @@ public:
         m_screenHeight = height;
     }
     
-    // 从屏幕坐标选择对象
+    // 设置相机矩阵，projection 需为有限远平面的投影矩阵（如 Filament 的 culling projection）
+    void setCameraMatrices(const math::mat4f& view, const math::mat4f& projection);
+    
+    // 设置 GPU 拾取器（由渲染器提供）
+    void setGpuPicker(IGpuPicker* gpuPicker) { m_gpuPicker = gpuPicker; }
+    
+    // 拾取方式，GPU 方式下没有拾取器时退回 CPU
+    void setPickMode(PickMode mode) { m_pickMode = mode; }
+    PickMode getPickMode() const { return m_pickMode; }
+    
+    // 从屏幕坐标选择对象（同步，始终使用 CPU 射线检测）
     Node* pickObject(int x, int y);
     
+    // 从屏幕坐标选择对象（异步）
+    // GPU 方式下结果在之后某一帧渲染完成后回调，GPU 未返回结果（如 noop 后端超时）时退回 CPU 检测；
+    // CPU 方式下立即回调
+    void pickObjectAsync(int x, int y, PickCallback callback);
+    
+    // 框选：收集世界包围盒投影与屏幕矩形（像素，含两端）重叠的节点
+    // 先用矩形对应的子视锥体查询场景 BVH 做早期排除，完全在内的子树直接接受，
+    // 其余候选批量投影（SSE）后再做矩形重叠检测
+    size_t pickObjectsInRect(int x0, int y0, int x1, int y1, std::vector<Node*>& result);
+    
+    // 框选并更新 SelectionManager，返回矩形内的节点数
+    size_t selectObjectsInRect(int x0, int y0, int x1, int y1, SelectionOp op = SelectionOp::Replace);
+    
+    // 射线拾取最近的节点，有网格三角形 BVH 的节点做精确三角形检测
+    bool raycast(const math::float3& rayOrigin, const math::float3& rayDirection, PickResult& result);
+    
+    // 同步场景 BVH：结构未变化时只根据 Scene::getChangedNodes 调整移动过的节点，
+    // 否则整体重建，拾取前自动调用
+    void updateSpatialIndex();
+    
+    // 强制下一次拾取前重建场景 BVH
+    void invalidateSpatialIndex() { m_indexValid = false; }
+    
+    const PickStats& getLastPickStats() const { return m_lastPickStats; }
+    const DynamicBVH& getSceneBvh() const { return m_sceneBvh; }
+    
     // 射线与 AABB 相交检测
     bool intersectRayWithAABB(const math::float3& rayOrigin, 
                               const math::float3& rayDirection, 
@@ -72,11 +168,14 @@ public:
     void worldToScreen(const math::float3& worldPos, math::float2& screenPos);
     
 private:
-    // 递归检测射线与场景节点的相交
-    Node* intersectRayWithScene(const math::float3& rayOrigin, 
-                                const math::float3& rayDirection, 
-                                Node* node, 
-                                float& closestDistance);
+    // 重建场景 BVH
+    void rebuildSpatialIndex();
+    
+    // 按节点当前的世界包围盒更新 BVH 中的代理
+    void refitNode(Node* node);
+    
+    // 检测射线与单个节点的相交，t 为世界空间射线参数
+    bool intersectNode(const math::ray& ray, Node* node, float tMax, float& t, uint32_t& triangle) const;
 };
 
 } // namespace Kazia
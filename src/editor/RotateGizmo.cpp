@@ -95,7 +95,7 @@ void RotateGizmo::applyTransform(const filament::math::float3& delta) {
         for (Node* node : selectedNodes) {
             if (node) {
                 filament::math::float3 newRotation = node->getRotation() + delta;
-                node->setRotation(newRotation);
+                setNodeTransform(node, node->getPosition(), newRotation, node->getScale());
             }
         }
     }
@@ -103,7 +103,7 @@ void ScaleGizmo::applyTransform(const filament::math::float3& delta) {
         for (Node* node : selectedNodes) {
             if (node) {
                 filament::math::float3 newScale = node->getScale() * (filament::math::float3{1.0f, 1.0f, 1.0f} + delta);
-                node->setScale(newScale);
+                setNodeTransform(node, node->getPosition(), node->getRotation(), newScale);
             }
         }
     }
@@ -1,6 +1,9 @@
 #include "TransformCommand.h"
 
 #include "scene/Node.h"
+#include "scene/Scene.h"
+
+#include <cstring>
 
 namespace Kazia {
 
@@ -50,4 +53,53 @@ std::string TransformCommand::getName() const {
     return "Transform Command";
 }
 
+bool TransformCommand::mergeWith(const ICommand& next) {
+    if (next.getType() != CommandType::Transform) {
+        return false;
+    }
+    const TransformCommand& command = static_cast<const TransformCommand&>(next);
+    if (command.m_node != m_node) {
+        return false;
+    }
+    
+    m_newPosition = command.m_newPosition;
+    m_newRotation = command.m_newRotation;
+    m_newScale = command.m_newScale;
+    return true;
+}
+
+void TransformCommand::serialize(std::vector<uint8_t>& data) const {
+    // 节点 ID，之后依次为旧位置、新位置、旧旋转、新旋转、旧缩放、新缩放，最后是节点的 UUID（读回时核对）
+    uint32_t id = m_node ? m_node->getId() : 0;
+    static const std::string noUuid;
+    const std::string& uuid = m_node ? m_node->getUUID() : noUuid;
+    const math::float3* values[] = {&m_oldPosition, &m_newPosition, &m_oldRotation, &m_newRotation, &m_oldScale, &m_newScale};
+    data.resize(sizeof(id) + sizeof(values) / sizeof(values[0]) * sizeof(math::float3) + uuid.size());
+    std::memcpy(data.data(), &id, sizeof(id));
+    uint8_t* out = data.data() + sizeof(id);
+    for (const math::float3* value : values) {
+        std::memcpy(out, value, sizeof(math::float3));
+        out += sizeof(math::float3);
+    }
+    std::memcpy(out, uuid.data(), uuid.size());
+}
+
+std::unique_ptr<ICommand> TransformCommand::deserialize(Scene& scene, const uint8_t* data, size_t size) {
+    math::float3 values[6];
+    uint32_t id;
+    if (size < sizeof(id) + sizeof(values)) {
+        return nullptr;
+    }
+    std::memcpy(&id, data, sizeof(id));
+    std::memcpy(values, data + sizeof(id), sizeof(values));
+    std::string uuid(reinterpret_cast<const char*>(data) + sizeof(id) + sizeof(values), size - sizeof(id) - sizeof(values));
+    
+    // 节点已经不在场景中、或该 ID 已不是同一个节点时无法还原
+    Node* node = scene.getNodeById(id, uuid);
+    if (!node) {
+        return nullptr;
+    }
+    return std::make_unique<TransformCommand>(node, values[0], values[1], values[2], values[3], values[4], values[5]);
+}
+
 } // namespace Kazia
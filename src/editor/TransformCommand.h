@@ -4,9 +4,12 @@
 #include "ICommand.h"
 #include "core/Math.h"
 
+#include <memory>
+
 namespace Kazia {
 
 class Node;
+class Scene;
 
 class TransformCommand : public ICommand {
 private:
@@ -36,6 +39,16 @@ public:
     
     // 获取命令名称
     std::string getName() const override;
+    
+    size_t getMemorySize() const override { return sizeof(*this); }
+    
+    // 序列化时节点按 ID 保存，读回时在 scene 中查找
+    CommandType getType() const override { return CommandType::Transform; }
+    void serialize(std::vector<uint8_t>& data) const override;
+    static std::unique_ptr<ICommand> deserialize(Scene& scene, const uint8_t* data, size_t size);
+    
+    // 同一节点上的变换命令合并为一条：保留本命令的旧变换，采用 next 的新变换
+    bool mergeWith(const ICommand& next) override;
 };
 
 } // namespace Kazia
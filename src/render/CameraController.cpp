@@ -136,6 +136,27 @@ void CameraController::setTarget(const math::float3& target)
     }
 }
 
+void CameraController::focusOn(const math::aabb& bounds, float fovDegrees)
+{
+    if (bounds.isEmpty()) {
+        return;
+    }
+    
+    // 计算能完整容纳包围球的距离
+    math::float3 direction = normalize(m_position - m_target);
+    float radius = std::max(length(bounds.extent()), m_minDistance);
+    float halfFov = fovDegrees * 0.5f * 3.14159265f / 180.0f;
+    float distance = radius / std::sin(halfFov);
+    
+    // 更新目标和相机位置
+    m_target = bounds.center();
+    m_position = m_target + direction * distance;
+    
+    if (m_camera) {
+        updateCamera();
+    }
+}
+
 void CameraController::updateCamera()
 {
     if (m_camera) {
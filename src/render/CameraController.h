@@ -50,6 +50,9 @@ public:
     // 设置目标
     void setTarget(const math::float3& target);
     
+    // 聚焦到包围盒（如节点的子树包围盒），保持当前观察方向
+    void focusOn(const math::aabb& bounds, float fovDegrees = 45.0f);
+    
     // 获取相机参数
     math::float3 getPosition() const { return m_position; }
     math::float3 getTarget() const { return m_target; }
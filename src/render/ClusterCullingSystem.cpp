@@ -0,0 +1,289 @@
+#include "ClusterCullingSystem.h"
+#include "CullingSystem.h"
+#include "LodSystem.h"
+
+#include <filament/RenderableManager.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+namespace Kazia {
+
+namespace {
+
+// 第 0 级在共享索引缓冲区中的范围
+MeshLodLevel getBaseLevel(const GeometryRegistry::Geometry& geometry)
+{
+    if (!geometry.lodLevels.empty()) {
+        return geometry.lodLevels[0];
+    }
+    MeshLodLevel level;
+    level.indexOffset = 0;
+    level.indexCount = geometry.indexCount;
+    return level;
+}
+
+} // namespace
+
+ClusterCullingSystem::ClusterCullingSystem()
+    : m_engine(nullptr)
+    , m_enabled(true)
+    , m_backfaceCulling(true)
+{
+}
+
+ClusterCullingSystem::~ClusterCullingSystem()
+{
+    clear();
+}
+
+void ClusterCullingSystem::initialize(filament::Engine* engine)
+{
+    m_engine = engine;
+}
+
+void ClusterCullingSystem::addRenderable(utils::Entity entity, const GeometryRegistry::Geometry* geometry, const math::mat4f& worldMatrix)
+{
+    if (!geometry || geometry->clusters.empty() || hasRenderable(entity)) {
+        return;
+    }
+
+    Renderable renderable;
+    renderable.entity = entity;
+    renderable.geometry = geometry;
+    renderable.mirrored = false;
+    renderable.indexBuffer = nullptr;
+    renderable.compacted = false;
+    renderable.hidden = false;
+    updateWorldMatrix(renderable, worldMatrix);
+
+    m_entityToIndex[entity] = m_renderables.size();
+    m_renderables.push_back(std::move(renderable));
+}
+
+void ClusterCullingSystem::removeRenderable(utils::Entity entity)
+{
+    auto it = m_entityToIndex.find(entity);
+    if (it == m_entityToIndex.end()) {
+        return;
+    }
+
+    // 实体仍存在时恢复共享索引缓冲区，再销毁压缩索引缓冲区
+    size_t index = it->second;
+    restore(m_renderables[index]);
+    destroyBuffer(m_renderables[index]);
+
+    // 与最后一个交换后删除
+    m_entityToIndex.erase(it);
+    if (index + 1 != m_renderables.size()) {
+        m_renderables[index] = std::move(m_renderables.back());
+        m_entityToIndex[m_renderables[index].entity] = index;
+    }
+    m_renderables.pop_back();
+}
+
+void ClusterCullingSystem::updateTransform(utils::Entity entity, const math::mat4f& worldMatrix)
+{
+    auto it = m_entityToIndex.find(entity);
+    if (it != m_entityToIndex.end()) {
+        updateWorldMatrix(m_renderables[it->second], worldMatrix);
+    }
+}
+
+void ClusterCullingSystem::update(const math::mat4f& viewProjection, const math::float3& cameraPosition,
+                                  const CullingSystem* cullingSystem, const LodSystem* lodSystem, FrameStats& stats)
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    stats.clusterRenderableCount = 0;
+    stats.clusterCount = 0;
+    stats.visibleClusterCount = 0;
+    stats.clusterTriangleCount = 0;
+    stats.clusterFullTriangleCount = 0;
+    stats.clusterUploadCount = 0;
+    stats.clusterUploadBytes = 0;
+
+    if (m_enabled && m_engine) {
+        for (Renderable& renderable : m_renderables) {
+            // 被剔除的对象保持原状态
+            if (cullingSystem && !cullingSystem->isVisible(renderable.entity)) {
+                continue;
+            }
+
+            // 使用较粗级别时由 LOD 系统设置索引范围，回到第 0 级后需要重新压缩
+            if (lodSystem && lodSystem->getLevel(renderable.entity) != 0) {
+                renderable.compacted = false;
+                renderable.visibleMeshlets.clear();
+                setHidden(renderable, false);
+                continue;
+            }
+
+            // 在网格局部空间中剔除
+            const MeshletSet& clusters = renderable.geometry->clusters;
+            math::frustum localFrustum = math::frustum::fromMatrix(math::multiply(viewProjection, renderable.worldMatrix));
+            math::float3 localCamera = math::transformPoint(renderable.inverseWorldMatrix, cameraPosition);
+            bool backfaceCulling = m_backfaceCulling && !renderable.mirrored;
+
+            m_visibleScratch.clear();
+            uint32_t indexCount = 0;
+            for (size_t i = 0; i < clusters.meshlets.size(); ++i) {
+                const Meshlet& meshlet = clusters.meshlets[i];
+                if (MeshletCuller::isVisible(meshlet, localFrustum, localCamera, backfaceCulling)) {
+                    m_visibleScratch.push_back(static_cast<uint32_t>(i));
+                    indexCount += meshlet.triangleCount * 3;
+                }
+            }
+
+            if (m_visibleScratch.size() == clusters.meshlets.size()) {
+                restore(renderable);
+            } else if (m_visibleScratch.empty()) {
+                setHidden(renderable, true);
+            } else {
+                setHidden(renderable, false);
+                if (!renderable.compacted || m_visibleScratch != renderable.visibleMeshlets) {
+                    upload(renderable, m_visibleScratch, indexCount);
+                    stats.clusterUploadCount++;
+                    stats.clusterUploadBytes += static_cast<uint64_t>(indexCount) *
+                        (MeshOptimizer::fitsShortIndices(renderable.geometry->vertexCount) ? sizeof(uint16_t) : sizeof(uint32_t));
+                }
+            }
+
+            stats.clusterRenderableCount++;
+            stats.clusterCount += static_cast<uint32_t>(clusters.meshlets.size());
+            stats.visibleClusterCount += static_cast<uint32_t>(m_visibleScratch.size());
+            stats.clusterTriangleCount += indexCount / 3;
+            stats.clusterFullTriangleCount += clusters.indices.size() / 3;
+        }
+    }
+
+    auto endTime = std::chrono::steady_clock::now();
+    stats.clusterTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+}
+
+void ClusterCullingSystem::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled) {
+        return;
+    }
+
+    m_enabled = enabled;
+    if (!m_enabled) {
+        for (Renderable& renderable : m_renderables) {
+            restore(renderable);
+        }
+    }
+}
+
+void ClusterCullingSystem::clear()
+{
+    for (Renderable& renderable : m_renderables) {
+        destroyBuffer(renderable);
+    }
+    m_renderables.clear();
+    m_entityToIndex.clear();
+}
+
+void ClusterCullingSystem::restore(Renderable& renderable)
+{
+    setHidden(renderable, false);
+    if (!renderable.compacted || !m_engine) {
+        return;
+    }
+
+    auto& renderableManager = m_engine->getRenderableManager();
+    auto instance = renderableManager.getInstance(renderable.entity);
+    if (instance) {
+        const GeometryRegistry::Geometry& geometry = *renderable.geometry;
+        MeshLodLevel base = getBaseLevel(geometry);
+        renderableManager.setGeometryAt(instance, 0, filament::RenderableManager::PrimitiveType::TRIANGLES,
+            geometry.vertexBuffer, geometry.indexBuffer, base.indexOffset, base.indexCount);
+    }
+    renderable.compacted = false;
+    renderable.visibleMeshlets.clear();
+}
+
+void ClusterCullingSystem::upload(Renderable& renderable, const std::vector<uint32_t>& visibleMeshlets, uint32_t indexCount)
+{
+    auto& renderableManager = m_engine->getRenderableManager();
+    auto instance = renderableManager.getInstance(renderable.entity);
+    if (!instance) {
+        return;
+    }
+
+    // 与共享索引缓冲区使用相同的索引类型，容量按第 0 级的全部索引分配
+    const GeometryRegistry::Geometry& geometry = *renderable.geometry;
+    const MeshletSet& clusters = geometry.clusters;
+    bool shortIndices = MeshOptimizer::fitsShortIndices(geometry.vertexCount);
+    if (!renderable.indexBuffer) {
+        renderable.indexBuffer = filament::IndexBuffer::Builder()
+            .indexCount(static_cast<uint32_t>(clusters.indices.size()))
+            .bufferType(shortIndices ? filament::IndexBuffer::IndexType::USHORT : filament::IndexBuffer::IndexType::UINT)
+            .build(*m_engine);
+    }
+
+    // 可见分簇的索引直接写入待上传的内存
+    size_t indexSize = shortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
+    void* data = std::malloc(static_cast<size_t>(indexCount) * indexSize);
+    size_t written = 0;
+    for (uint32_t meshletIndex : visibleMeshlets) {
+        const Meshlet& meshlet = clusters.meshlets[meshletIndex];
+        const uint32_t* source = clusters.indices.data() + meshlet.indexOffset;
+        size_t count = static_cast<size_t>(meshlet.triangleCount) * 3;
+        if (shortIndices) {
+            uint16_t* target = static_cast<uint16_t*>(data) + written;
+            for (size_t i = 0; i < count; ++i) {
+                target[i] = static_cast<uint16_t>(source[i]);
+            }
+        } else {
+            std::copy(source, source + count, static_cast<uint32_t*>(data) + written);
+        }
+        written += count;
+    }
+    renderable.indexBuffer->setBuffer(*m_engine, GeometryRegistry::adoptBufferDescriptor(data, written * indexSize));
+
+    renderableManager.setGeometryAt(instance, 0, filament::RenderableManager::PrimitiveType::TRIANGLES,
+        geometry.vertexBuffer, renderable.indexBuffer, 0, indexCount);
+    renderable.compacted = true;
+    renderable.visibleMeshlets = visibleMeshlets;
+}
+
+void ClusterCullingSystem::setHidden(Renderable& renderable, bool hidden)
+{
+    if (renderable.hidden == hidden || !m_engine) {
+        return;
+    }
+
+    // 所有分簇都被剔除时通过图层掩码隐藏（对象仍在场景中，由剔除系统管理场景成员关系）
+    auto& renderableManager = m_engine->getRenderableManager();
+    auto instance = renderableManager.getInstance(renderable.entity);
+    if (instance) {
+        renderableManager.setLayerMask(instance, 0xFF, hidden ? 0x00 : 0x01);
+    }
+    renderable.hidden = hidden;
+}
+
+void ClusterCullingSystem::destroyBuffer(Renderable& renderable)
+{
+    if (renderable.indexBuffer && m_engine) {
+        m_engine->destroy(renderable.indexBuffer);
+    }
+    renderable.indexBuffer = nullptr;
+}
+
+void ClusterCullingSystem::updateWorldMatrix(Renderable& renderable, const math::mat4f& worldMatrix)
+{
+    renderable.worldMatrix = worldMatrix;
+    if (!math::inverse(worldMatrix, renderable.inverseWorldMatrix)) {
+        renderable.inverseWorldMatrix = math::mat4f();
+    }
+
+    // 列主序，前三列的行列式为负时手性翻转
+    const float* m = worldMatrix.m;
+    float determinant = m[0] * (m[5] * m[10] - m[9] * m[6])
+                      - m[4] * (m[1] * m[10] - m[9] * m[2])
+                      + m[8] * (m[1] * m[6] - m[5] * m[2]);
+    renderable.mirrored = determinant < 0.0f;
+}
+
+} // namespace Kazia
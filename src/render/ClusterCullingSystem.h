@@ -0,0 +1,97 @@
+#ifndef CLUSTERCULLINGSYSTEM_H
+#define CLUSTERCULLINGSYSTEM_H
+
+#include <filament/Engine.h>
+#include <filament/IndexBuffer.h>
+
+#include <utils/Entity.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include "core/GeometryRegistry.h"
+#include "core/Math.h"
+#include "core/Meshlet.h"
+#include "FrameStats.h"
+
+namespace Kazia {
+
+class CullingSystem;
+class LodSystem;
+
+// 分簇剔除
+// 带分簇的大型网格在这里登记。每帧对可见且使用第 0 级的对象逐分簇做视锥体和法线锥剔除，
+// 把可见分簇的索引压缩到该对象独占的索引缓冲区中，图元只绘制压缩后的范围；
+// 可见分簇集合不变时不重新上传，全部可见时直接使用共享索引缓冲区的第 0 级
+class ClusterCullingSystem {
+private:
+    filament::Engine* m_engine;
+
+    struct Renderable {
+        utils::Entity entity;
+        const GeometryRegistry::Geometry* geometry;
+        math::mat4f worldMatrix;
+        math::mat4f inverseWorldMatrix;
+        bool mirrored;                        // 世界矩阵翻转了手性，法线锥剔除不可用
+
+        filament::IndexBuffer* indexBuffer;   // 压缩后的索引，首次需要时创建
+        std::vector<uint32_t> visibleMeshlets; // 当前上传的可见分簇
+        bool compacted;                       // 图元当前绘制压缩后的索引
+        bool hidden;                          // 没有可见分簇，图元被隐藏
+    };
+
+    std::vector<Renderable> m_renderables;
+    std::unordered_map<utils::Entity, size_t> m_entityToIndex;
+
+    // 本帧的可见分簇
+    std::vector<uint32_t> m_visibleScratch;
+
+    bool m_enabled;
+    bool m_backfaceCulling;
+
+public:
+    ClusterCullingSystem();
+    ~ClusterCullingSystem();
+
+    ClusterCullingSystem(const ClusterCullingSystem&) = delete;
+    ClusterCullingSystem& operator=(const ClusterCullingSystem&) = delete;
+
+    // 初始化
+    void initialize(filament::Engine* engine);
+
+    // 登记可渲染对象，geometry 没有分簇时忽略；几何体必须在对象移除之后才能释放
+    void addRenderable(utils::Entity entity, const GeometryRegistry::Geometry* geometry, const math::mat4f& worldMatrix);
+    void removeRenderable(utils::Entity entity);
+    bool hasRenderable(utils::Entity entity) const { return m_entityToIndex.count(entity) != 0; }
+
+    // 更新世界变换
+    void updateTransform(utils::Entity entity, const math::mat4f& worldMatrix);
+
+    // 每帧调用（剔除和 LOD 选择之后）：更新各对象绘制的分簇并写入统计
+    void update(const math::mat4f& viewProjection, const math::float3& cameraPosition,
+                const CullingSystem* cullingSystem, const LodSystem* lodSystem, FrameStats& stats);
+
+    // 禁用时所有对象恢复绘制完整的第 0 级
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    // 材质双面渲染时应关闭法线锥剔除
+    void setBackfaceCulling(bool enabled) { m_backfaceCulling = enabled; }
+    bool isBackfaceCulling() const { return m_backfaceCulling; }
+
+    size_t getRenderableCount() const { return m_renderables.size(); }
+
+    // 清理（销毁压缩索引缓冲区）
+    void clear();
+
+private:
+    void restore(Renderable& renderable);
+    void upload(Renderable& renderable, const std::vector<uint32_t>& visibleMeshlets, uint32_t indexCount);
+    void setHidden(Renderable& renderable, bool hidden);
+    void destroyBuffer(Renderable& renderable);
+    static void updateWorldMatrix(Renderable& renderable, const math::mat4f& worldMatrix);
+};
+
+} // namespace Kazia
+
+#endif // CLUSTERCULLINGSYSTEM_H
@@ -0,0 +1,225 @@
+#include "CullingSystem.h"
+
+#include <chrono>
+
+namespace Kazia {
+
+CullingSystem::CullingSystem()
+    : m_engine(nullptr)
+    , m_scene(nullptr)
+    , m_bvh(0.1f)
+    , m_frameIndex(0)
+    , m_enabled(true)
+{
+}
+
+void CullingSystem::initialize(filament::Engine* engine, filament::Scene* scene)
+{
+    m_engine = engine;
+    m_scene = scene;
+}
+
+void CullingSystem::addRenderable(utils::Entity entity, const math::aabb& localBounds, const math::mat4f& worldMatrix)
+{
+    if (hasRenderable(entity)) {
+        setLocalBounds(entity, localBounds, worldMatrix);
+        return;
+    }
+
+    int32_t proxyId = m_bvh.createProxy(math::transformAabb(worldMatrix, localBounds), nullptr);
+    if (proxyId >= static_cast<int32_t>(m_renderables.size())) {
+        m_renderables.resize(proxyId + 1);
+    }
+
+    Renderable& renderable = m_renderables[proxyId];
+    renderable.entity = entity;
+    renderable.localBounds = localBounds;
+    renderable.lastVisibleFrame = m_frameIndex;
+    renderable.inScene = false;
+    m_entityToProxy[entity] = proxyId;
+
+    // 新对象先加入场景，下一次剔除时再决定是否移出
+    setInScene(renderable, true);
+    pushVisible(proxyId);
+}
+
+void CullingSystem::removeRenderable(utils::Entity entity)
+{
+    auto it = m_entityToProxy.find(entity);
+    if (it == m_entityToProxy.end()) {
+        return;
+    }
+
+    int32_t proxyId = it->second;
+    Renderable& renderable = m_renderables[proxyId];
+    setInScene(renderable, false);
+    renderable.entity = utils::Entity();
+
+    // 从可见列表中移除，避免代理 ID 复用后产生误判
+    eraseVisible(proxyId);
+
+    m_bvh.destroyProxy(proxyId);
+    m_entityToProxy.erase(it);
+}
+
+bool CullingSystem::hasRenderable(utils::Entity entity) const
+{
+    return m_entityToProxy.find(entity) != m_entityToProxy.end();
+}
+
+math::aabb CullingSystem::getWorldBounds(utils::Entity entity) const
+{
+    auto it = m_entityToProxy.find(entity);
+    if (it == m_entityToProxy.end()) {
+        return math::aabb();
+    }
+    return m_bvh.getFatAabb(it->second);
+}
+
+bool CullingSystem::isVisible(utils::Entity entity) const
+{
+    auto it = m_entityToProxy.find(entity);
+    if (it == m_entityToProxy.end()) {
+        return true;
+    }
+    return m_renderables[it->second].inScene;
+}
+
+void CullingSystem::setLocalBounds(utils::Entity entity, const math::aabb& localBounds, const math::mat4f& worldMatrix)
+{
+    auto it = m_entityToProxy.find(entity);
+    if (it == m_entityToProxy.end()) {
+        return;
+    }
+
+    m_renderables[it->second].localBounds = localBounds;
+    m_bvh.moveProxy(it->second, math::transformAabb(worldMatrix, localBounds));
+}
+
+void CullingSystem::updateTransform(utils::Entity entity, const math::mat4f& worldMatrix)
+{
+    auto it = m_entityToProxy.find(entity);
+    if (it == m_entityToProxy.end()) {
+        return;
+    }
+
+    const Renderable& renderable = m_renderables[it->second];
+    m_bvh.moveProxy(it->second, math::transformAabb(worldMatrix, renderable.localBounds));
+}
+
+void CullingSystem::cull(const math::mat4f& viewProjection, FrameStats& stats)
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    m_frameIndex++;
+    uint32_t membershipChanges = 0;
+
+    std::swap(m_visibleProxies, m_previousVisibleProxies);
+    m_visibleProxies.clear();
+
+    uint32_t visited = 0;
+    if (m_enabled) {
+        math::frustum frustum = math::frustum::fromMatrix(viewProjection);
+
+        // 收集可见对象，不在场景中的加入场景
+        visited = m_bvh.queryFrustum(frustum, [this, &membershipChanges](int32_t proxyId, bool) {
+            Renderable& renderable = m_renderables[proxyId];
+            renderable.lastVisibleFrame = m_frameIndex;
+            if (!renderable.inScene) {
+                setInScene(renderable, true);
+                membershipChanges++;
+            }
+            pushVisible(proxyId);
+        });
+
+        // 上一帧可见但本帧不可见的对象移出场景
+        for (int32_t proxyId : m_previousVisibleProxies) {
+            Renderable& renderable = m_renderables[proxyId];
+            if (renderable.lastVisibleFrame != m_frameIndex && renderable.inScene) {
+                setInScene(renderable, false);
+                membershipChanges++;
+            }
+        }
+    } else {
+        m_visibleProxies = m_previousVisibleProxies;
+    }
+
+    auto endTime = std::chrono::steady_clock::now();
+
+    // 写入统计
+    stats.cullTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    stats.renderableCount = static_cast<uint32_t>(m_entityToProxy.size());
+    stats.visibleCount = m_enabled ? static_cast<uint32_t>(m_visibleProxies.size()) : stats.renderableCount;
+    stats.bvhNodesVisited = visited;
+    stats.sceneMembershipChanges = membershipChanges;
+}
+
+void CullingSystem::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled) {
+        return;
+    }
+
+    m_enabled = enabled;
+
+    // 禁用时把所有对象放回场景，交给 Filament 自己剔除
+    if (!m_enabled) {
+        m_visibleProxies.clear();
+        for (const auto& item : m_entityToProxy) {
+            Renderable& renderable = m_renderables[item.second];
+            renderable.lastVisibleFrame = m_frameIndex;
+            setInScene(renderable, true);
+            pushVisible(item.second);
+        }
+    }
+}
+
+void CullingSystem::clear()
+{
+    for (const auto& item : m_entityToProxy) {
+        setInScene(m_renderables[item.second], false);
+    }
+
+    m_bvh.clear();
+    m_renderables.clear();
+    m_entityToProxy.clear();
+    m_visibleProxies.clear();
+    m_previousVisibleProxies.clear();
+}
+
+void CullingSystem::setInScene(Renderable& renderable, bool inScene)
+{
+    if (renderable.inScene == inScene) {
+        return;
+    }
+
+    if (m_scene) {
+        if (inScene) {
+            m_scene->addEntity(renderable.entity);
+        } else {
+            m_scene->removeEntity(renderable.entity);
+        }
+    }
+    renderable.inScene = inScene;
+}
+
+void CullingSystem::pushVisible(int32_t proxyId)
+{
+    m_renderables[proxyId].visibleIndex = static_cast<uint32_t>(m_visibleProxies.size());
+    m_visibleProxies.push_back(proxyId);
+}
+
+void CullingSystem::eraseVisible(int32_t proxyId)
+{
+    uint32_t index = m_renderables[proxyId].visibleIndex;
+    if (index >= m_visibleProxies.size() || m_visibleProxies[index] != proxyId) {
+        return;
+    }
+
+    int32_t last = m_visibleProxies.back();
+    m_visibleProxies[index] = last;
+    m_renderables[last].visibleIndex = index;
+    m_visibleProxies.pop_back();
+}
+
+} // namespace Kazia
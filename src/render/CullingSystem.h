@@ -0,0 +1,93 @@
+#ifndef CULLINGSYSTEM_H
+#define CULLINGSYSTEM_H
+
+#include <filament/Engine.h>
+#include <filament/Scene.h>
+
+#include <utils/Entity.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include "core/DynamicBVH.h"
+#include "core/Math.h"
+#include "FrameStats.h"
+
+namespace Kazia {
+
+// CPU 视锥体剔除
+// 用动态 BVH 维护所有可渲染对象的世界包围盒，每帧只把可见对象保留在 Filament 场景中，
+// 视锥体外的整个子树通过一次包围盒检测即可排除
+class CullingSystem {
+private:
+    filament::Engine* m_engine;
+    filament::Scene* m_scene;
+
+    struct Renderable {
+        utils::Entity entity;
+        math::aabb localBounds;
+        uint64_t lastVisibleFrame;
+        uint32_t visibleIndex;      // 在 m_visibleProxies 中的下标，该位置不是本代理时表示不在列表中
+        bool inScene;
+    };
+
+    DynamicBVH m_bvh;
+
+    // 以 BVH 代理 ID 为下标
+    std::vector<Renderable> m_renderables;
+    std::unordered_map<utils::Entity, int32_t> m_entityToProxy;
+
+    // 上一帧和本帧的可见代理列表
+    std::vector<int32_t> m_visibleProxies;
+    std::vector<int32_t> m_previousVisibleProxies;
+
+    uint64_t m_frameIndex;
+    bool m_enabled;
+
+public:
+    CullingSystem();
+    ~CullingSystem() = default;
+
+    // 初始化
+    void initialize(filament::Engine* engine, filament::Scene* scene);
+
+    // 注册可渲染对象，之后由剔除系统管理其场景成员关系
+    void addRenderable(utils::Entity entity, const math::aabb& localBounds, const math::mat4f& worldMatrix);
+    void removeRenderable(utils::Entity entity);
+    bool hasRenderable(utils::Entity entity) const;
+
+    // 更新局部包围盒（网格变化时）
+    void setLocalBounds(utils::Entity entity, const math::aabb& localBounds, const math::mat4f& worldMatrix);
+
+    // 更新世界变换，物体移出放大包围盒时才调整 BVH 结构
+    void updateTransform(utils::Entity entity, const math::mat4f& worldMatrix);
+
+    // 执行剔除，更新 Filament 场景成员关系并写入统计
+    void cull(const math::mat4f& viewProjection, FrameStats& stats);
+
+    // 启用/禁用，禁用时所有对象都留在场景中
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    // 世界包围盒（BVH 中放大后的包围盒），未注册时返回空盒
+    math::aabb getWorldBounds(utils::Entity entity) const;
+
+    // 当前是否在 Filament 场景中，未注册的对象不受剔除系统管理，视为可见
+    bool isVisible(utils::Entity entity) const;
+
+    size_t getRenderableCount() const { return m_entityToProxy.size(); }
+
+    // 清理
+    void clear();
+
+private:
+    void setInScene(Renderable& renderable, bool inScene);
+
+    // 加入/移出可见列表，移出时用末尾元素填补空位，都是 O(1)
+    void pushVisible(int32_t proxyId);
+    void eraseVisible(int32_t proxyId);
+};
+
+} // namespace Kazia
+
+#endif // CULLINGSYSTEM_H
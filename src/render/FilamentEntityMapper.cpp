@@ -1,10 +1,18 @@
 #include "FilamentEntityMapper.h"
 
+#include "CullingSystem.h"
+#include "LightSystem.h"
+#include "LodSystem.h"
+#include "ClusterCullingSystem.h"
+#include "StreamingSystem.h"
 #include "scene/Node.h"
+#include "scene/MeshComponent.h"
+#include "scene/CameraComponent.h"
+#include "scene/LightComponent.h"
 
 namespace Kazia {
 
-FilamentEntityMapper::FilamentEntityMapper(filament::Engine* engine) : m_engine(engine) {
+FilamentEntityMapper::FilamentEntityMapper(filament::Engine* engine) : m_engine(engine), m_cullingSystem(nullptr), m_lightSystem(nullptr), m_lodSystem(nullptr), m_clusterCullingSystem(nullptr), m_streamingSystem(nullptr) {
 }
 
 void FilamentEntityMapper::addMapping(const std::string& nodeUUID, utils::Entity entity) {
@@ -13,10 +21,12 @@ void FilamentEntityMapper::addMapping(const std::string& nodeUUID, utils::Entity
 }
 
 void FilamentEntityMapper::removeMapping(const std::string& nodeUUID) {
+    removeLight(nodeUUID);
     auto it = m_nodeToEntityMap.find(nodeUUID);
     if (it != m_nodeToEntityMap.end()) {
         utils::Entity entity = it->second;
         m_entityToNodeMap.erase(entity);
+        m_localTransforms.erase(entity);
         m_nodeToEntityMap.erase(it);
     }
 }
@@ -28,6 +38,11 @@ void FilamentEntityMapper::removeMapping(utils::Entity entity) {
         m_nodeToEntityMap.erase(nodeUUID);
         m_entityToNodeMap.erase(it);
     }
+    m_localTransforms.erase(entity);
+}
+
+void FilamentEntityMapper::setLocalTransform(utils::Entity entity, const math::mat4f& localMatrix) {
+    m_localTransforms[entity] = localMatrix;
 }
 
 utils::Entity FilamentEntityMapper::getEntity(const std::string& nodeUUID) const {
@@ -47,11 +62,36 @@ std::string FilamentEntityMapper::getNodeUUID(utils::Entity entity) const {
 }
 
 void FilamentEntityMapper::syncTransform(const Node* node) {
-    if (!node || !m_engine) {
+    if (!node) {
         return;
     }
     
-    utils::Entity entity = getEntity(node->getUUID());
+    syncTransform(node->getUUID(), node->getWorldMatrix());
+}
+
+void FilamentEntityMapper::syncTransform(const std::string& nodeUUID, const math::mat4f& worldMatrix) {
+    if (!m_engine) {
+        return;
+    }
+    
+    // 节点上的光源跟随节点移动，未移动时不写入，静态光源的阴影不因同步而过期
+    auto light = m_lights.find(nodeUUID);
+    if (light != m_lights.end() && m_lightSystem) {
+        LightEntry& entry = light->second;
+        math::float3 world = entry.directional ? math::normalize(math::transformDirection(worldMatrix, entry.direction))
+                                               : math::float3(worldMatrix.m[12], worldMatrix.m[13], worldMatrix.m[14]);
+        if (world.x != entry.world.x || world.y != entry.world.y || world.z != entry.world.z) {
+            entry.world = world;
+            if (entry.directional) {
+                m_lightSystem->updateDirectionalLight(entry.handle, {world.x, world.y, world.z},
+                    {entry.color.x, entry.color.y, entry.color.z}, entry.intensity);
+            } else {
+                m_lightSystem->setPointLightPosition(entry.handle, {world.x, world.y, world.z});
+            }
+        }
+    }
+    
+    utils::Entity entity = getEntity(nodeUUID);
     if (!entity.isValid()) {
         return;
     }
@@ -62,13 +102,34 @@ void FilamentEntityMapper::syncTransform(const Node* node) {
         auto instance = transformManager.getInstance(entity);
         
         // 转换 math::mat4f 到 filament::math::mat4f
-        const auto& worldMatrix = node->getWorldMatrix();
+        auto local = m_localTransforms.find(entity);
+        math::mat4f matrix = local != m_localTransforms.end() ? math::multiply(worldMatrix, local->second) : worldMatrix;
         filament::math::mat4f filaMatrix;
         for (int i = 0; i < 16; i++) {
-            filaMatrix[i] = worldMatrix.m[i];
+            filaMatrix[i] = matrix.m[i];
         }
         
         transformManager.setTransform(instance, filaMatrix);
+        
+        // 更新剔除包围盒，移动前后的包围盒范围内的静态光源阴影过期
+        if (m_cullingSystem) {
+            if (m_lightSystem) {
+                m_lightSystem->invalidateShadows(m_cullingSystem->getWorldBounds(entity));
+            }
+            m_cullingSystem->updateTransform(entity, worldMatrix);
+            if (m_lightSystem) {
+                m_lightSystem->invalidateShadows(m_cullingSystem->getWorldBounds(entity));
+            }
+        }
+        if (m_lodSystem) {
+            m_lodSystem->updateTransform(entity, worldMatrix);
+        }
+        if (m_clusterCullingSystem) {
+            m_clusterCullingSystem->updateTransform(entity, worldMatrix);
+        }
+        if (m_streamingSystem) {
+            m_streamingSystem->updateTransform(entity, worldMatrix);
+        }
     }
 }
 
@@ -129,24 +190,75 @@ void FilamentEntityMapper::syncCameraComponent(const Node* node) {
 }
 
 void FilamentEntityMapper::syncLightComponent(const Node* node) {
-    if (!node || !m_engine) {
+    if (!node || !m_lightSystem) {
         return;
     }
     
-    // 获取 LightComponent
+    // 获取 LightComponent，组件被移除后光源一并移除
     auto* lightComponent = node->getComponent<LightComponent>();
-    if (!lightComponent) {
+    if (!lightComponent || (lightComponent->getLightType() != LightManager::Type::SUN && lightComponent->getLightType() != LightManager::Type::POINT)) {
+        removeLight(node->getUUID());
         return;
     }
     
-    // 获取对应的 Filament 实体
-    utils::Entity entity = getEntity(node->getUUID());
-    if (!entity.isValid()) {
+    LightEntry light;
+    light.directional = lightComponent->getLightType() == LightManager::Type::SUN;
+    light.direction = lightComponent->getDirection();
+    light.color = lightComponent->getColor();
+    light.intensity = lightComponent->getIntensity();
+    light.radius = lightComponent->getRadius();
+    light.shadow.castShadows = lightComponent->getCastShadows();
+    light.shadow.isStatic = lightComponent->isStatic();
+    
+    // 类型变化或光源已被光源系统清除时重新创建
+    auto it = m_lights.find(node->getUUID());
+    if (it != m_lights.end() && (it->second.directional != light.directional || !m_lightSystem->isValid(it->second.handle))) {
+        removeLight(node->getUUID());
+        it = m_lights.end();
+    }
+    
+    const math::mat4f& worldMatrix = node->getWorldMatrix();
+    light.world = light.directional ? math::normalize(math::transformDirection(worldMatrix, light.direction))
+                                    : math::float3(worldMatrix.m[12], worldMatrix.m[13], worldMatrix.m[14]);
+    filament::math::float3 world(light.world.x, light.world.y, light.world.z);
+    filament::math::float3 color(light.color.x, light.color.y, light.color.z);
+    if (it == m_lights.end()) {
+        if (light.directional) {
+            light.handle = m_lightSystem->addDirectionalLight(world, color, light.intensity, light.shadow);
+        } else {
+            light.handle = m_lightSystem->addPointLight(world, color, light.intensity, light.radius, light.shadow);
+        }
+        m_lights[node->getUUID()] = light;
         return;
     }
     
-    // 这里需要与 Filament 的 LightManager 进行交互
-    // 暂时留空，后续集成 Filament 后实现
+    // 阴影设置只在变化时写入，setShadowSettings 会重新设置阴影投射并让阴影过期
+    LightEntry& entry = it->second;
+    light.handle = entry.handle;
+    if (light.directional) {
+        m_lightSystem->updateDirectionalLight(light.handle, world, color, light.intensity);
+    } else {
+        m_lightSystem->updatePointLight(light.handle, world, color, light.intensity, light.radius);
+    }
+    if (light.shadow.castShadows != entry.shadow.castShadows || light.shadow.isStatic != entry.shadow.isStatic) {
+        m_lightSystem->setShadowSettings(light.handle, light.shadow);
+    }
+    entry = light;
+}
+
+void FilamentEntityMapper::removeLight(const std::string& nodeUUID) {
+    auto it = m_lights.find(nodeUUID);
+    if (it == m_lights.end()) {
+        return;
+    }
+    if (m_lightSystem) {
+        if (it->second.directional) {
+            m_lightSystem->removeDirectionalLight(it->second.handle);
+        } else {
+            m_lightSystem->removePointLight(it->second.handle);
+        }
+    }
+    m_lights.erase(it);
 }
 
 void FilamentEntityMapper::syncAllComponents(const Node* rootNode) {
@@ -166,8 +278,12 @@ void FilamentEntityMapper::syncAllComponents(const Node* rootNode) {
 }
 
 void FilamentEntityMapper::clear() {
+    while (!m_lights.empty()) {
+        removeLight(m_lights.begin()->first);
+    }
     m_nodeToEntityMap.clear();
     m_entityToNodeMap.clear();
+    m_localTransforms.clear();
 }
 
 } // namespace Kazia
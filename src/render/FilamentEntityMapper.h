@@ -4,21 +4,59 @@
 #include <string>
 #include <unordered_map>
 
+#include "core/Math.h"
+#include "LightSystem.h"
+
 #include <filament/Engine.h>
 #include <filament/TransformManager.h>
 
 namespace Kazia {
 
 class Node;
+class CullingSystem;
+class LodSystem;
+class ClusterCullingSystem;
+class StreamingSystem;
 
 class FilamentEntityMapper {
 private:
     filament::Engine* m_engine;
     
+    // 变换同步时更新剔除包围盒
+    CullingSystem* m_cullingSystem;
+    
+    // 变换同步时让受影响的静态光源阴影过期
+    LightSystem* m_lightSystem;
+    
+    // 变换同步时更新 LOD 选择用的包围球
+    LodSystem* m_lodSystem;
+    
+    // 变换同步时更新分簇剔除用的局部空间变换
+    ClusterCullingSystem* m_clusterCullingSystem;
+    
+    // 变换同步时更新流式网格的包围球和各级的提交矩阵
+    StreamingSystem* m_streamingSystem;
+    
     // 映射表
     std::unordered_map<std::string, utils::Entity> m_nodeToEntityMap;
     std::unordered_map<utils::Entity, std::string> m_entityToNodeMap;
     
+    // 几何体自身的局部变换（量化顶点的反量化），同步时右乘到世界矩阵上
+    std::unordered_map<utils::Entity, math::mat4f> m_localTransforms;
+    
+    // 节点的 LightComponent 在光源系统中创建的光源，方向和位置随节点的世界矩阵更新
+    struct LightEntry {
+        LightHandle handle;
+        bool directional;
+        math::float3 direction;     // 组件中的方向（节点局部空间）
+        math::float3 world;         // 最近写入的世界空间方向（方向光）或位置（点光源）
+        math::float3 color;
+        float intensity;
+        float radius;
+        ShadowSettings shadow;
+    };
+    std::unordered_map<std::string, LightEntry> m_lights;
+    
 public:
     FilamentEntityMapper(filament::Engine* engine);
     ~FilamentEntityMapper() = default;
@@ -32,15 +70,36 @@ public:
     utils::Entity getEntity(const std::string& nodeUUID) const;
     std::string getNodeUUID(utils::Entity entity) const;
     
+    // 剔除系统
+    void setCullingSystem(CullingSystem* cullingSystem) { m_cullingSystem = cullingSystem; }
+    
+    // 光源系统，切换时已创建的光源句柄不再有效
+    void setLightSystem(LightSystem* lightSystem) { m_lightSystem = lightSystem; m_lights.clear(); }
+    
+    // LOD 系统
+    void setLodSystem(LodSystem* lodSystem) { m_lodSystem = lodSystem; }
+    
+    // 分簇剔除
+    void setClusterCullingSystem(ClusterCullingSystem* clusterCullingSystem) { m_clusterCullingSystem = clusterCullingSystem; }
+    
+    // 流式网格
+    void setStreamingSystem(StreamingSystem* streamingSystem) { m_streamingSystem = streamingSystem; }
+    
+    // 局部变换，只影响提交给 Filament 的矩阵，剔除和 LOD 仍使用节点的世界矩阵
+    void setLocalTransform(utils::Entity entity, const math::mat4f& localMatrix);
+    
     // 同步方法
     void syncTransform(const Node* node);
+    void syncTransform(const std::string& nodeUUID, const math::mat4f& worldMatrix);
     void syncAllTransforms(const Node* rootNode);
     void syncMeshComponent(const Node* node);
     void syncCameraComponent(const Node* node);
+    // 按节点的 LightComponent 创建或更新光源（类型、参数和阴影设置），目前支持方向光和点光源
     void syncLightComponent(const Node* node);
     void syncAllComponents(const Node* rootNode);
     
     // 清理方法
+    void removeLight(const std::string& nodeUUID);
     void clear();
 };
 
@@ -1,7 +1,8 @@
-#include "IRenderer.h"
+#include "FilamentRenderer.h"
 #include "RenderContext.h"
 
 #include "scene/Node.h"
+#include "scene/LightComponent.h"
 
 #include <filament/Engine.h>
 #include <filament/Renderer.h>
@@ -17,9 +18,16 @@
 #include <filament/MaterialInstance.h>
 #include <filament/TransformManager.h>
 
+#include <backend/PixelBufferDescriptor.h>
+
 #include <utils/EntityManager.h>
 #include <utils/Entity.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <unordered_map>
+
 namespace Kazia {
 
 class FilamentRenderer : public IRenderer {
@@ -27,8 +35,21 @@ private:
     std::shared_ptr<RenderContext> m_context;
     void* m_nativeWindow;
     
+    // 下一帧读回颜色缓冲的目标
+    std::vector<uint8_t>* m_captureTarget;
+    
+    // 由渲染器创建的可渲染实体及其几何体键，移除或关闭时据此注销并释放几何体
+    struct RenderableEntry {
+        GeometryRegistry::Key geometryKey;
+        bool registryGeometry;      // false 表示几何体由流式系统持有
+    };
+    std::unordered_map<utils::Entity, RenderableEntry> m_renderables;
+    
+    // addMesh 按名称创建的实体
+    std::unordered_map<std::string, utils::Entity> m_namedMeshes;
+    
 public:
-    FilamentRenderer() {
+    FilamentRenderer() : m_nativeWindow(nullptr), m_captureTarget(nullptr) {
         m_context = std::make_shared<RenderContext>();
     }
     
@@ -38,6 +59,7 @@ public:
     
     bool initialize(void* nativeWindow, int width, int height) override {
         m_nativeWindow = nativeWindow;
+        m_context->headless = false;
         
         // 创建 Filament 引擎
         m_context->engine = filament::Engine::create();
@@ -45,47 +67,73 @@ public:
             return false;
         }
         
-        // 创建渲染器
-        m_context->renderer = m_context->engine->createRenderer();
-        
-        // 创建场景
-        m_context->scene = m_context->engine->createScene();
-        
-        // 创建相机
-        utils::Entity cameraEntity = utils::EntityManager::get().create();
-        m_context->camera = m_context->engine->createCamera(cameraEntity);
-        
-        // 创建视图
-        m_context->view = m_context->engine->createView();
-        m_context->view->setScene(m_context->scene);
-        m_context->view->setCamera(m_context->camera);
-        
         // 创建交换链
         m_context->swapChain = m_context->engine->createSwapChain(nativeWindow);
         
-        // 设置窗口大小
-        m_context->width = width;
-        m_context->height = height;
-        resize(width, height);
-        
-        // 设置初始相机参数
-        setCameraProjection(45.0f, static_cast<float>(width) / static_cast<float>(height), 0.1f, 1000.0f);
-        setCameraPosition({0.0f, 0.0f, 5.0f});
-        setCameraTarget({0.0f, 0.0f, 0.0f});
+        return initializeScene(width, height);
+    }
+    
+    bool initializeHeadless(int width, int height, RenderBackend backend) override {
+        m_nativeWindow = nullptr;
+        m_context->headless = true;
         
-        // 设置清除选项
-        m_context->clearOptions.clear = true;
-        m_context->clearOptions.clearColor = {0.1f, 0.1f, 0.1f, 1.0f};
-        m_context->clearOptions.discard = true;
+        // 创建 Filament 引擎
+        m_context->engine = filament::Engine::create(toFilamentBackend(backend));
+        if (!m_context->engine) {
+            return false;
+        }
         
-        // 创建实体映射器
-        m_context->entityMapper = std::make_unique<FilamentEntityMapper>(m_context->engine);
+        // 创建固定大小的离屏交换链，可读回像素
+        m_context->swapChain = m_context->engine->createSwapChain(static_cast<uint32_t>(width), static_cast<uint32_t>(height),
+            filament::SwapChain::CONFIG_READABLE);
         
-        return m_context->isValid();
+        return initializeScene(width, height);
     }
     
     void shutdown() override {
         if (m_context->isValid()) {
+            // 先销毁可渲染对象（仍引用共享几何体的缓冲区），各系统随之注销
+            while (!m_renderables.empty()) {
+                destroyRenderable(m_renderables.begin()->first);
+            }
+            m_namedMeshes.clear();
+            
+            // 销毁 GPU 拾取
+            m_context->gpuPicker.reset();
+            
+            // 销毁剔除系统
+            if (m_context->entityMapper) {
+                m_context->entityMapper->setCullingSystem(nullptr);
+            }
+            m_context->cullingSystem.reset();
+            
+            // 销毁 LOD 系统（在共享几何体之前）
+            if (m_context->entityMapper) {
+                m_context->entityMapper->setLodSystem(nullptr);
+            }
+            m_context->lodSystem.reset();
+            
+            // 销毁分簇剔除系统（在共享几何体之前）
+            if (m_context->entityMapper) {
+                m_context->entityMapper->setClusterCullingSystem(nullptr);
+            }
+            m_context->clusterCullingSystem.reset();
+            
+            // 销毁流式网格（各级缓冲区由其自己持有，必须在引擎之前）
+            if (m_context->entityMapper) {
+                m_context->entityMapper->setStreamingSystem(nullptr);
+            }
+            m_context->streamingSystem.reset();
+            
+            // 销毁光源（必须在引擎之前）
+            if (m_context->entityMapper) {
+                m_context->entityMapper->setLightSystem(nullptr);
+            }
+            m_context->lightSystem.reset();
+            
+            // 销毁共享几何体（必须在引擎之前）
+            m_context->geometryRegistry.reset();
+            
             // 销毁交换链
             if (m_context->swapChain) {
                 m_context->engine->destroy(m_context->swapChain);
@@ -118,21 +166,73 @@ public:
             
             // 重置相机
             m_context->camera = nullptr;
+            m_captureTarget = nullptr;
             
             // 清理实体映射器
             m_context->entityMapper.reset();
         }
     }
     
-    void beginFrame() override {
+    bool beginFrame() override {
         if (m_context->isValid() && m_context->renderer && m_context->swapChain) {
-            m_context->renderer->beginFrame(m_context->swapChain);
+            return m_context->renderer->beginFrame(m_context->swapChain);
         }
+        return false;
     }
     
     void render() override {
         if (m_context->isValid() && m_context->renderer && m_context->view) {
+            m_context->frameStats.frameIndex++;
+            
+            // 先在 CPU 上剔除，只把可见对象留在 Filament 场景中
+            math::mat4f viewProjection = getViewProjectionMatrix();
+            if (m_context->cullingSystem) {
+                m_context->cullingSystem->cull(viewProjection, m_context->frameStats);
+            }
+            
+            // 写入光源参数，只保留影响范围在视锥体内且在预算内的点光源
+            if (m_context->lightSystem) {
+                filament::math::double3 eye = m_context->camera->getPosition();
+                math::float3 cameraPosition(static_cast<float>(eye.x), static_cast<float>(eye.y), static_cast<float>(eye.z));
+                m_context->lightSystem->update(viewProjection, cameraPosition, m_context->frameStats);
+            }
+            
+            // 为可见对象选择 LOD 级别
+            if (m_context->lodSystem) {
+                filament::math::double3 eye = m_context->camera->getPosition();
+                math::float3 cameraPosition(static_cast<float>(eye.x), static_cast<float>(eye.y), static_cast<float>(eye.z));
+                m_context->lodSystem->update(cameraPosition, m_context->fov, m_context->height,
+                    m_context->cullingSystem.get(), m_context->frameStats);
+            }
+            
+            // 使用第 0 级的大型网格逐分簇剔除，只提交可见分簇的三角形
+            if (m_context->clusterCullingSystem) {
+                filament::math::double3 eye = m_context->camera->getPosition();
+                math::float3 cameraPosition(static_cast<float>(eye.x), static_cast<float>(eye.y), static_cast<float>(eye.z));
+                m_context->clusterCullingSystem->update(viewProjection, cameraPosition,
+                    m_context->cullingSystem.get(), m_context->lodSystem.get(), m_context->frameStats);
+            }
+            
+            // 为可见的流式网格请求目标级别，切换到已驻留的最接近级别
+            if (m_context->streamingSystem) {
+                filament::math::double3 eye = m_context->camera->getPosition();
+                math::float3 cameraPosition(static_cast<float>(eye.x), static_cast<float>(eye.y), static_cast<float>(eye.z));
+                m_context->streamingSystem->update(cameraPosition, m_context->fov, m_context->height,
+                    m_context->cullingSystem.get(), m_context->frameStats);
+            }
+            
             m_context->renderer->render(m_context->view);
+            
+            // 读回本帧颜色缓冲，数据在 flush() 后可用
+            if (m_captureTarget) {
+                captureFrame(*m_captureTarget);
+                m_captureTarget = nullptr;
+            }
+            
+            // 有拾取请求时渲染离屏拾取视图
+            if (m_context->gpuPicker) {
+                m_context->gpuPicker->render();
+            }
         }
     }
     
@@ -143,25 +243,47 @@ public:
     }
     
     void resize(int width, int height) override {
-        if (m_context->isValid()) {
-            m_context->width = width;
-            m_context->height = height;
-            
-            // 更新视口
-            filament::Viewport viewport(0, 0, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
-            m_context->view->setViewport(viewport);
-            
-            // 更新相机投影
-            if (m_context->camera) {
-                float aspect = static_cast<float>(width) / static_cast<float>(height);
-                m_context->camera->setProjection(45.0f, aspect, 0.1f, 1000.0f, filament::Camera::Fov::VERTICAL);
-            }
-            
-            // 重新创建交换链
-            if (m_context->swapChain) {
-                m_context->engine->destroy(m_context->swapChain);
-                m_context->swapChain = m_context->engine->createSwapChain(m_nativeWindow);
-            }
+        if (!m_context->isValid() || width <= 0 || height <= 0) {
+            return;
+        }
+        if (width == m_context->width && height == m_context->height) {
+            return;
+        }
+        
+        int previousWidth = m_context->width;
+        m_context->width = width;
+        m_context->height = height;
+        
+        // 更新视口
+        filament::Viewport viewport(0, 0, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+        m_context->view->setViewport(viewport);
+        
+        if (m_context->gpuPicker) {
+            m_context->gpuPicker->resize(width, height);
+        }
+        
+        // 更新相机投影，保持当前的视野和裁剪面
+        if (m_context->camera) {
+            float aspect = static_cast<float>(width) / static_cast<float>(height);
+            m_context->camera->setProjection(m_context->fov, aspect, m_context->nearPlane, m_context->farPlane, filament::Camera::Fov::VERTICAL);
+        }
+        
+        // 基于原生窗口的交换链由后端跟随窗口大小，不需要重新创建；
+        // 离屏交换链大小固定，只能重新创建（初始化时已按初始大小创建）
+        if (m_context->headless && m_context->swapChain && previousWidth > 0) {
+            m_context->engine->destroy(m_context->swapChain);
+            m_context->swapChain = m_context->engine->createSwapChain(static_cast<uint32_t>(width), static_cast<uint32_t>(height),
+                filament::SwapChain::CONFIG_READABLE);
+        }
+    }
+    
+    void requestFrameCapture(std::vector<uint8_t>* rgbaPixels) override {
+        m_captureTarget = rgbaPixels;
+    }
+    
+    void flush() override {
+        if (m_context->engine) {
+            m_context->engine->flushAndWait();
         }
     }
     
@@ -169,98 +291,100 @@ public:
         // 实现网格加载逻辑
         // 这里需要使用 glTF 加载器来加载网格
         // 暂时创建一个简单的立方体作为示例
-        if (m_context->isValid()) {
-            // 创建立方体实体
-            utils::Entity cubeEntity = utils::EntityManager::get().create();
-            
-            // 立方体顶点数据
-            float halfSize = 0.5f;
-            static const float vertices[] = {
-                // 前面
-                -halfSize, -halfSize,  halfSize,
-                 halfSize, -halfSize,  halfSize,
-                 halfSize,  halfSize,  halfSize,
-                -halfSize,  halfSize,  halfSize,
-                // 后面
-                -halfSize, -halfSize, -halfSize,
-                -halfSize,  halfSize, -halfSize,
-                 halfSize,  halfSize, -halfSize,
-                 halfSize, -halfSize, -halfSize,
-                // 上面
-                -halfSize,  halfSize, -halfSize,
-                -halfSize,  halfSize,  halfSize,
-                 halfSize,  halfSize,  halfSize,
-                 halfSize,  halfSize, -halfSize,
-                // 下面
-                -halfSize, -halfSize, -halfSize,
-                 halfSize, -halfSize, -halfSize,
-                 halfSize, -halfSize,  halfSize,
-                -halfSize, -halfSize,  halfSize,
-                // 右面
-                 halfSize, -halfSize, -halfSize,
-                 halfSize,  halfSize, -halfSize,
-                 halfSize,  halfSize,  halfSize,
-                 halfSize, -halfSize,  halfSize,
-                // 左面
-                -halfSize, -halfSize, -halfSize,
-                -halfSize, -halfSize,  halfSize,
-                -halfSize,  halfSize,  halfSize,
-                -halfSize,  halfSize, -halfSize
-            };
-            
-            // 立方体索引数据
-            static const uint16_t indices[] = {
-                // 前面
-                0, 1, 2, 2, 3, 0,
-                // 后面
-                4, 5, 6, 6, 7, 4,
-                // 上面
-                8, 9, 10, 10, 11, 8,
-                // 下面
-                12, 13, 14, 14, 15, 12,
-                // 右面
-                16, 17, 18, 18, 19, 16,
-                // 左面
-                20, 21, 22, 22, 23, 20
-            };
-            
-            // 创建顶点缓冲区
-            filament::VertexBuffer* vertexBuffer = filament::VertexBuffer::Builder()
-                .vertexCount(24)
-                .bufferCount(1)
-                .attribute(filament::VertexAttribute::POSITION, 0, filament::VertexBuffer::AttributeType::FLOAT3)
-                .build(*m_context->engine);
-            
-            vertexBuffer->setBufferAt(*m_context->engine, 0, filament::VertexBuffer::BufferDescriptor(
-                vertices, sizeof(vertices), nullptr));
-            
-            // 创建索引缓冲区
-            filament::IndexBuffer* indexBuffer = filament::IndexBuffer::Builder()
-                .indexCount(36)
-                .bufferType(filament::IndexBuffer::IndexType::USHORT)
-                .build(*m_context->engine);
-            
-            indexBuffer->setBuffer(*m_context->engine, filament::IndexBuffer::BufferDescriptor(
-                indices, sizeof(indices), nullptr));
-            
-            // 创建可渲染对象
-            filament::RenderableManager::Builder(1)
-                .boundingBox({{-halfSize, -halfSize, -halfSize}, {halfSize, halfSize, halfSize}})
-                .geometry(0, filament::RenderableManager::PrimitiveType::TRIANGLES, vertexBuffer, indexBuffer)
-                .build(*m_context->engine, cubeEntity);
-            
-            // 设置立方体位置
-            auto& transformManager = m_context->engine->getTransformManager();
-            transformManager.setTransform(transformManager.getInstance(cubeEntity),
-                filament::math::mat4f::translation({0.0f, 0.0f, 0.0f}));
-            
-            // 将立方体添加到场景
-            m_context->scene->addEntity(cubeEntity);
+        utils::Entity entity = createPrimitiveEntity(PrimitiveDesc::cube(1.0f), math::mat4f());
+        if (entity.isNull()) {
+            return;
+        }
+        
+        // 同名的网格被替换（先创建新的，共享的几何体不会被释放后重建）
+        auto it = m_namedMeshes.find(meshName);
+        if (it != m_namedMeshes.end()) {
+            destroyRenderable(it->second);
         }
+        m_namedMeshes[meshName] = entity;
+    }
+    
+    bool addNodeMesh(const Node* node) override {
+        if (!node || !m_context->entityMapper) {
+            return false;
+        }
+        
+        utils::Entity entity = createPrimitiveEntity(PrimitiveDesc::cube(1.0f), node->getWorldMatrix());
+        if (entity.isNull()) {
+            return false;
+        }
+        m_context->entityMapper->addMapping(node->getUUID(), entity);
+        return true;
+    }
+    
+    bool addNodePrimitive(const Node* node, const PrimitiveDesc& desc) override {
+        if (!node || !m_context->entityMapper) {
+            return false;
+        }
+        
+        utils::Entity entity = createPrimitiveEntity(desc, node->getWorldMatrix());
+        if (entity.isNull()) {
+            return false;
+        }
+        m_context->entityMapper->addMapping(node->getUUID(), entity);
+        return true;
+    }
+    
+    bool addNodeMesh(const Node* node, const MeshData& mesh) override {
+        if (!node || !m_context->entityMapper) {
+            return false;
+        }
+        
+        utils::Entity entity = createMeshEntity(mesh, node->getWorldMatrix());
+        if (entity.isNull()) {
+            return false;
+        }
+        m_context->entityMapper->addMapping(node->getUUID(), entity);
+        return true;
+    }
+    
+    bool addNodeStreamedMesh(const Node* node, const std::string& streamPath) override {
+        if (!node || !m_context->entityMapper || !m_context->isValid() || !m_context->streamingSystem) {
+            return false;
+        }
+        
+        // 用常驻的最粗一级创建可渲染对象，之后由流式系统切换级别
+        m_context->streamingSystem->setVertexFormat(m_context->vertexFormat);
+        const GeometryRegistry::Geometry* geometry = m_context->streamingSystem->acquireMesh(streamPath);
+        if (!geometry) {
+            return false;
+        }
+        utils::Entity entity = createRenderable(*geometry, node->getWorldMatrix());
+        m_context->streamingSystem->addRenderable(entity, streamPath, node->getWorldMatrix());
+        m_context->entityMapper->addMapping(node->getUUID(), entity);
+        m_renderables[entity] = {0, false};
+        return true;
+    }
+    
+    bool addNodeLight(const Node* node) override {
+        if (!node || !m_context->isValid() || !m_context->entityMapper || !m_context->lightSystem || !node->getComponent<LightComponent>()) {
+            return false;
+        }
+        
+        m_context->entityMapper->syncLightComponent(node);
+        return true;
     }
     
     void removeMesh(const std::string& meshName) override {
-        // 实现网格移除逻辑
+        if (!m_context->isValid()) {
+            return;
+        }
+        
+        // addMesh 的名称，否则视为节点 UUID
+        auto it = m_namedMeshes.find(meshName);
+        if (it != m_namedMeshes.end()) {
+            utils::Entity entity = it->second;
+            m_namedMeshes.erase(it);
+            destroyRenderable(entity);
+        } else if (m_context->entityMapper) {
+            destroyRenderable(m_context->entityMapper->getEntity(meshName));
+            m_context->entityMapper->removeLight(meshName);
+        }
     }
     
     void setCameraPosition(const math::float3& position) override {
@@ -279,43 +403,24 @@ public:
     }
     
     void setCameraProjection(float fov, float aspect, float near, float far) override {
+        m_context->fov = fov;
+        m_context->nearPlane = near;
+        m_context->farPlane = far;
         if (m_context->isValid() && m_context->camera) {
             m_context->camera->setProjection(fov, aspect, near, far, filament::Camera::Fov::VERTICAL);
         }
     }
     
     void addDirectionalLight(const math::float3& direction, const math::float3& color, float intensity) override {
-        if (m_context->isValid()) {
-            // 创建方向光
-            filament::math::float3 filaDirection = {direction.x, direction.y, direction.z};
-            filament::math::float3 filaColor = {color.x, color.y, color.z};
-            
-            filament::LightManager::Builder lightBuilder(filament::LightManager::Type::DIRECTIONAL);
-            lightBuilder.color(filaColor);
-            lightBuilder.intensity(intensity);
-            lightBuilder.direction(filaDirection);
-            
-            utils::Entity lightEntity = utils::EntityManager::get().create();
-            lightBuilder.build(*m_context->engine, lightEntity);
-            m_context->scene->addEntity(lightEntity);
+        if (m_context->isValid() && m_context->lightSystem) {
+            // 不投射阴影：Filament 每帧都为投射阴影的光源重新渲染阴影贴图，需要阴影的光源由节点的 LightComponent 打开
+            m_context->lightSystem->addDirectionalLight({direction.x, direction.y, direction.z}, {color.x, color.y, color.z}, intensity);
         }
     }
     
     void addPointLight(const math::float3& position, const math::float3& color, float intensity, float radius) override {
-        if (m_context->isValid()) {
-            // 创建点光源
-            filament::math::float3 filaPosition = {position.x, position.y, position.z};
-            filament::math::float3 filaColor = {color.x, color.y, color.z};
-            
-            filament::LightManager::Builder lightBuilder(filament::LightManager::Type::POINT);
-            lightBuilder.color(filaColor);
-            lightBuilder.intensity(intensity);
-            lightBuilder.position(filaPosition);
-            lightBuilder.falloff(radius);
-            
-            utils::Entity lightEntity = utils::EntityManager::get().create();
-            lightBuilder.build(*m_context->engine, lightEntity);
-            m_context->scene->addEntity(lightEntity);
+        if (m_context->isValid() && m_context->lightSystem) {
+            m_context->lightSystem->addPointLight({position.x, position.y, position.z}, {color.x, color.y, color.z}, intensity, radius);
         }
     }
     
@@ -331,11 +436,403 @@ public:
         return m_context;
     }
     
+    IGpuPicker* getGpuPicker() const override {
+        return m_context->gpuPicker.get();
+    }
+    
+    const FrameStats& getFrameStats() const override {
+        return m_context->frameStats;
+    }
+    
     void syncSceneTransforms(const Node* rootNode) override {
+        auto syncStart = std::chrono::steady_clock::now();
         if (m_context->entityMapper) {
             m_context->entityMapper->syncAllTransforms(rootNode);
         }
+        m_context->frameStats.syncTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - syncStart).count();
+    }
+    
+    void applySnapshot(const RenderSnapshot& snapshot) override {
+        if (!m_context->isValid()) {
+            return;
+        }
+        
+        if (snapshot.width > 0 && snapshot.height > 0 &&
+            (snapshot.width != m_context->width || snapshot.height != m_context->height)) {
+            resize(snapshot.width, snapshot.height);
+        }
+        
+        filament::math::float3 position = {snapshot.cameraPosition.x, snapshot.cameraPosition.y, snapshot.cameraPosition.z};
+        filament::math::float3 target = {snapshot.cameraTarget.x, snapshot.cameraTarget.y, snapshot.cameraTarget.z};
+        filament::math::float3 up = {snapshot.cameraUp.x, snapshot.cameraUp.y, snapshot.cameraUp.z};
+        m_context->camera->lookAt(position, target, up);
+        
+        if (m_context->width > 0 && m_context->height > 0) {
+            float aspect = static_cast<float>(m_context->width) / static_cast<float>(m_context->height);
+            setCameraProjection(snapshot.fov, aspect, snapshot.nearPlane, snapshot.farPlane);
+        }
+        
+        auto syncStart = std::chrono::steady_clock::now();
+        if (m_context->entityMapper) {
+            for (const RenderSnapshot::NodeTransform& transform : snapshot.transforms) {
+                m_context->entityMapper->syncTransform(transform.nodeUUID, transform.worldMatrix);
+            }
+        }
+        m_context->frameStats.syncTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - syncStart).count();
+        m_context->frameStats.syncedTransformCount = static_cast<uint32_t>(snapshot.transforms.size());
+    }
+    
+private:
+    // 创建程序化几何体的可渲染实体，参数元组相同的几何体只生成和上传一次
+    utils::Entity createPrimitiveEntity(const PrimitiveDesc& desc, const math::mat4f& worldMatrix) {
+        if (!m_context->isValid() || !m_context->geometryRegistry) {
+            return {};
+        }
+        filament::Engine* engine = m_context->engine;
+        VertexFormat vertexFormat = m_context->vertexFormat;
+        
+        GeometryRegistry::Key geometryKey = GeometryRegistry::makePrimitiveKey(desc, static_cast<uint32_t>(vertexFormat));
+        const GeometryRegistry::Geometry* geometry = m_context->geometryRegistry->acquire(geometryKey,
+            [engine, &desc, vertexFormat]() {
+            PrimitiveGenerator::Counts counts = PrimitiveGenerator::count(desc);
+            bool shortIndices = MeshOptimizer::fitsShortIndices(counts.vertexCount);
+            size_t indexBytes = counts.indexCount * (shortIndices ? sizeof(uint16_t) : sizeof(uint32_t));
+            
+            // 索引直接生成到待上传的内存中，顶点生成后按顶点格式打包
+            std::vector<PrimitiveVertex> vertices(counts.vertexCount);
+            void* indices = std::malloc(indexBytes);
+            if (shortIndices) {
+                PrimitiveGenerator::generate(desc, vertices.data(), static_cast<uint16_t*>(indices));
+            } else {
+                PrimitiveGenerator::generate(desc, vertices.data(), static_cast<uint32_t*>(indices));
+            }
+            
+            VertexStreams streams;
+            streams.vertexCount = vertices.size();
+            streams.positions = &vertices[0].position;
+            streams.normals = &vertices[0].normal;
+            streams.uvs = &vertices[0].uv;
+            streams.positionStride = streams.normalStride = streams.uvStride = sizeof(PrimitiveVertex);
+            PackedVertices packed = packVertices(streams, vertexFormat);
+            
+            math::aabb bounds = PrimitiveGenerator::getBounds(desc);
+            math::float3 center = bounds.center();
+            math::float3 halfExtent = bounds.extent();
+            
+            GeometryRegistry::Geometry result;
+            result.vertexCount = counts.vertexCount;
+            result.indexCount = counts.indexCount;
+            result.boundingBox = {{center.x, center.y, center.z}, {halfExtent.x, halfExtent.y, halfExtent.z}};
+            result.dequantizeScale = packed.dequantizeScale;
+            result.dequantizeOffset = packed.dequantizeOffset;
+            result.byteSize = packed.data.size() + indexBytes;
+            result.vertexBuffer = GeometryRegistry::buildVertexBuffer(engine, packed);
+            
+            result.indexBuffer = filament::IndexBuffer::Builder()
+                .indexCount(result.indexCount)
+                .bufferType(shortIndices ? filament::IndexBuffer::IndexType::USHORT : filament::IndexBuffer::IndexType::UINT)
+                .build(*engine);
+            result.indexBuffer->setBuffer(*engine, GeometryRegistry::adoptBufferDescriptor(indices, indexBytes));
+            
+            return result;
+        });
+        
+        if (!geometry) {
+            return {};
+        }
+        utils::Entity entity = createRenderable(*geometry, worldMatrix);
+        m_renderables[entity] = {geometryKey, true};
+        return entity;
+    }
+    
+    // 创建导入网格的可渲染实体：焊接顶点，生成（或从缓存读取）LOD 链，再按顶点缓存和过度绘制重排，
+    // 大型网格的第 0 级划分为分簇，所有级别放在同一个索引缓冲区中；顶点按 RenderContext::vertexFormat 打包
+    utils::Entity createMeshEntity(const MeshData& mesh, const math::mat4f& worldMatrix) {
+        if (!m_context->isValid() || !m_context->geometryRegistry || mesh.positions.empty() || mesh.getTriangleCount() == 0) {
+            return {};
+        }
+        filament::Engine* engine = m_context->engine;
+        
+        // 相同内容的网格共享几何体，LOD 链也只生成一次
+        GeometryRegistry::Key geometryKey = GeometryRegistry::makeContentKey(
+            mesh.positions.data(), mesh.positions.size() * sizeof(math::float3),
+            mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t),
+            static_cast<uint32_t>(m_context->vertexFormat));
+        MeshLodCache* lodCache = m_context->lodCache;
+        VertexFormat vertexFormat = m_context->vertexFormat;
+        bool optimize = m_context->optimizeMeshes;
+        const MeshOptimizer::Options& optimizerOptions = m_context->meshOptimizerOptions;
+        uint32_t clusterMinTriangles = m_context->clusterMinTriangles;
+        const MeshletSet::Options& meshletOptions = m_context->meshletOptions;
+        const GeometryRegistry::Geometry* geometry = m_context->geometryRegistry->acquire(geometryKey,
+            [engine, &mesh, lodCache, optimize, &optimizerOptions, vertexFormat, clusterMinTriangles, &meshletOptions]() {
+            // 焊接在生成 LOD 之前进行，简化和缓存都基于焊接后的网格
+            MeshData source = mesh;
+            if (optimize && optimizerOptions.weldVertices) {
+                MeshOptimizer::weldVertices(source);
+            }
+            
+            MeshLodChain::Options lodOptions;
+            MeshLodChain chain = lodCache ? lodCache->getOrBuild(source, lodOptions) : MeshLodChain::build(source, lodOptions);
+            
+            // 各级重排三角形，顶点按使用顺序重排
+            MeshOptimizer::Report report;
+            if (optimize) {
+                report = MeshOptimizer::optimize(source, chain, optimizerOptions);
+                report.vertexCountBefore = mesh.positions.size();
+            } else {
+                report.vertexCountBefore = report.vertexCountAfter = mesh.positions.size();
+                report.shortIndices = MeshOptimizer::fitsShortIndices(mesh.positions.size());
+            }
+            
+            math::aabb bounds = source.computeBounds();
+            math::float3 center = bounds.center();
+            math::float3 halfExtent = bounds.extent();
+            
+            GeometryRegistry::Geometry result;
+            result.vertexCount = static_cast<uint32_t>(source.positions.size());
+            result.indexCount = static_cast<uint32_t>(chain.indices.size());
+            result.boundingBox = {{center.x, center.y, center.z}, {halfExtent.x, halfExtent.y, halfExtent.z}};
+            result.lodLevels = chain.levels;
+            result.optimization = report;
+            
+            // 第 0 级划分为分簇，分簇内的三角形在索引缓冲区中连续存放
+            if (clusterMinTriangles > 0 && !chain.levels.empty() && chain.levels[0].indexCount / 3 >= clusterMinTriangles) {
+                const MeshLodLevel& base = chain.levels[0];
+                result.clusters = MeshletSet::build(source.positions.data(), source.positions.size(),
+                    chain.indices.data() + base.indexOffset, base.indexCount, meshletOptions);
+                std::copy(result.clusters.indices.begin(), result.clusters.indices.end(), chain.indices.begin() + base.indexOffset);
+            }
+            
+            // 创建顶点缓冲区，交错存放位置、切线空间四元数和 UV
+            PackedVertices packed = packVertices(source, vertexFormat);
+            result.dequantizeScale = packed.dequantizeScale;
+            result.dequantizeOffset = packed.dequantizeOffset;
+            result.vertexBuffer = GeometryRegistry::buildVertexBuffer(engine, packed);
+            
+            // 创建索引缓冲区，包含所有级别；顶点数允许时使用 16 位索引
+            result.indexBuffer = GeometryRegistry::buildIndexBuffer(engine, chain.indices.data(), chain.indices.size(), report.shortIndices);
+            result.byteSize = packed.data.size() + chain.indices.size() * (report.shortIndices ? sizeof(uint16_t) : sizeof(uint32_t));
+            
+            return result;
+        });
+        
+        if (!geometry) {
+            return {};
+        }
+        utils::Entity entity = createRenderable(*geometry, worldMatrix);
+        m_renderables[entity] = {geometryKey, true};
+        return entity;
+    }
+    
+    // 为共享几何体创建可渲染实体，交给剔除系统和 LOD 系统管理
+    utils::Entity createRenderable(const GeometryRegistry::Geometry& geometry, const math::mat4f& worldMatrix) {
+        filament::Engine* engine = m_context->engine;
+        utils::Entity entity = utils::EntityManager::get().create();
+        
+        // 量化顶点的位置需要反量化，Filament 的包围盒和变换都在量化空间中
+        bool quantized = geometry.isQuantized();
+        math::mat4f dequantize = geometry.getDequantizeMatrix();
+        filament::Box quantizedBox = geometry.getQuantizedBox();
+        
+        // 创建可渲染对象，初始绘制第 0 级
+        size_t indexCount = geometry.lodLevels.empty() ? geometry.indexCount : geometry.lodLevels[0].indexCount;
+        filament::RenderableManager::Builder(1)
+            .boundingBox(quantizedBox)
+            .geometry(0, filament::RenderableManager::PrimitiveType::TRIANGLES, geometry.vertexBuffer, geometry.indexBuffer, 0, indexCount)
+            .castShadows(true)
+            .receiveShadows(true)
+            .build(*engine, entity);
+        
+        // 设置变换
+        math::mat4f matrix = quantized ? math::multiply(worldMatrix, dequantize) : worldMatrix;
+        filament::math::mat4f filaMatrix;
+        for (int i = 0; i < 16; i++) {
+            filaMatrix[i] = matrix.m[i];
+        }
+        auto& transformManager = engine->getTransformManager();
+        if (!transformManager.hasComponent(entity)) {
+            transformManager.create(entity);
+        }
+        transformManager.setTransform(transformManager.getInstance(entity), filaMatrix);
+        if (quantized && m_context->entityMapper) {
+            m_context->entityMapper->setLocalTransform(entity, dequantize);
+        }
+        
+        // 交给剔除系统，由其决定是否加入场景
+        const filament::Box& box = geometry.boundingBox;
+        math::aabb localBounds(
+            {box.center.x - box.halfExtent.x, box.center.y - box.halfExtent.y, box.center.z - box.halfExtent.z},
+            {box.center.x + box.halfExtent.x, box.center.y + box.halfExtent.y, box.center.z + box.halfExtent.z});
+        if (m_context->cullingSystem) {
+            m_context->cullingSystem->addRenderable(entity, localBounds, worldMatrix);
+        } else {
+            m_context->scene->addEntity(entity);
+        }
+        
+        // 有多级 LOD 时登记到 LOD 系统
+        if (m_context->lodSystem) {
+            m_context->lodSystem->addRenderable(entity, &geometry, localBounds, worldMatrix);
+        }
+        
+        // 有分簇时登记到分簇剔除系统
+        if (m_context->clusterCullingSystem) {
+            m_context->clusterCullingSystem->addRenderable(entity, &geometry, worldMatrix);
+        }
+        return entity;
+    }
+    
+    // 销毁 createRenderable 创建的实体：从各系统注销、移除映射，销毁可渲染对象后再释放几何体
+    void destroyRenderable(utils::Entity entity) {
+        auto it = m_renderables.find(entity);
+        if (it == m_renderables.end()) {
+            return;
+        }
+        RenderableEntry entry = it->second;
+        m_renderables.erase(it);
+        
+        // 移除的投射者所在范围内的静态光源阴影过期
+        if (m_context->cullingSystem) {
+            if (m_context->lightSystem) {
+                m_context->lightSystem->invalidateShadows(m_context->cullingSystem->getWorldBounds(entity));
+            }
+            m_context->cullingSystem->removeRenderable(entity);
+        } else {
+            m_context->scene->remove(entity);
+        }
+        if (m_context->lodSystem) {
+            m_context->lodSystem->removeRenderable(entity);
+        }
+        // 分簇剔除要在实体仍存在时恢复共享的索引缓冲区
+        if (m_context->clusterCullingSystem) {
+            m_context->clusterCullingSystem->removeRenderable(entity);
+        }
+        if (m_context->entityMapper) {
+            m_context->entityMapper->removeMapping(entity);
+        }
+        
+        // 先销毁可渲染对象，再释放它引用的缓冲区：流式系统在最后一个使用者移除后销毁各级缓冲区，
+        // 注册表在引用计数归零时销毁共享几何体
+        m_context->engine->destroy(entity);
+        if (m_context->streamingSystem) {
+            m_context->streamingSystem->removeRenderable(entity);
+        }
+        if (entry.registryGeometry && m_context->geometryRegistry) {
+            m_context->geometryRegistry->release(entry.geometryKey);
+        }
+        utils::EntityManager::get().destroy(entity);
+    }
+    
+    // 创建引擎和交换链之后的公共初始化
+    bool initializeScene(int width, int height) {
+        // 创建渲染器
+        m_context->renderer = m_context->engine->createRenderer();
+        
+        // 创建场景
+        m_context->scene = m_context->engine->createScene();
+        
+        // 创建相机
+        utils::Entity cameraEntity = utils::EntityManager::get().create();
+        m_context->camera = m_context->engine->createCamera(cameraEntity);
+        
+        // 创建视图
+        m_context->view = m_context->engine->createView();
+        m_context->view->setScene(m_context->scene);
+        m_context->view->setCamera(m_context->camera);
+        
+        // 设置窗口大小
+        resize(width, height);
+        
+        // 设置初始相机参数
+        setCameraProjection(45.0f, static_cast<float>(width) / static_cast<float>(height), 0.1f, 1000.0f);
+        setCameraPosition({0.0f, 0.0f, 5.0f});
+        setCameraTarget({0.0f, 0.0f, 0.0f});
+        
+        // 设置清除选项
+        m_context->clearOptions.clear = true;
+        m_context->clearOptions.clearColor = {0.1f, 0.1f, 0.1f, 1.0f};
+        m_context->clearOptions.discard = true;
+        m_context->renderer->setClearOptions(m_context->clearOptions);
+        
+        // 创建实体映射器
+        m_context->entityMapper = std::make_unique<FilamentEntityMapper>(m_context->engine);
+        
+        // 创建共享几何体注册表
+        m_context->geometryRegistry = std::make_unique<GeometryRegistry>(m_context->engine);
+        
+        // 创建剔除系统
+        m_context->cullingSystem = std::make_unique<CullingSystem>();
+        m_context->cullingSystem->initialize(m_context->engine, m_context->scene);
+        m_context->entityMapper->setCullingSystem(m_context->cullingSystem.get());
+        
+        // 创建光源系统
+        m_context->lightSystem = std::make_unique<LightSystem>();
+        m_context->lightSystem->initialize(m_context->engine, m_context->scene);
+        m_context->entityMapper->setLightSystem(m_context->lightSystem.get());
+        
+        // 创建 LOD 系统
+        m_context->lodSystem = std::make_unique<LodSystem>();
+        m_context->lodSystem->initialize(m_context->engine);
+        m_context->entityMapper->setLodSystem(m_context->lodSystem.get());
+        
+        // 创建分簇剔除系统
+        m_context->clusterCullingSystem = std::make_unique<ClusterCullingSystem>();
+        m_context->clusterCullingSystem->initialize(m_context->engine);
+        m_context->entityMapper->setClusterCullingSystem(m_context->clusterCullingSystem.get());
+        
+        // 创建流式网格系统
+        m_context->streamingSystem = std::make_unique<StreamingSystem>();
+        m_context->streamingSystem->initialize(m_context->engine, m_context->entityMapper.get(), m_context->streamingOptions);
+        m_context->entityMapper->setStreamingSystem(m_context->streamingSystem.get());
+        
+        // 创建 GPU 拾取
+        m_context->gpuPicker = std::make_unique<GpuPicker>();
+        m_context->gpuPicker->initialize(m_context->engine, m_context->renderer, m_context->scene,
+            m_context->camera, m_context->entityMapper.get(), width, height);
+        
+        return m_context->isValid();
+    }
+    
+    // 在 render 之后、endFrame 之前调用，异步读回整个视口
+    void captureFrame(std::vector<uint8_t>& rgbaPixels) {
+        uint32_t width = static_cast<uint32_t>(m_context->width);
+        uint32_t height = static_cast<uint32_t>(m_context->height);
+        rgbaPixels.assign(static_cast<size_t>(width) * height * 4, 0);
+        
+        filament::backend::PixelBufferDescriptor buffer(rgbaPixels.data(), rgbaPixels.size(),
+            filament::backend::PixelDataFormat::RGBA, filament::backend::PixelDataType::UBYTE);
+        m_context->renderer->readPixels(0, 0, width, height, std::move(buffer));
+    }
+    
+    static filament::Engine::Backend toFilamentBackend(RenderBackend backend) {
+        switch (backend) {
+            case RenderBackend::OpenGL:
+                return filament::Engine::Backend::OPENGL;
+            case RenderBackend::Vulkan:
+                return filament::Engine::Backend::VULKAN;
+            case RenderBackend::Noop:
+                return filament::Engine::Backend::NOOP;
+            default:
+                return filament::Engine::Backend::DEFAULT;
+        }
+    }
+    
+    // 当前相机的视图投影矩阵（用于剔除）
+    math::mat4f getViewProjectionMatrix() const {
+        filament::math::mat4 viewProjection = m_context->camera->getCullingProjectionMatrix() * m_context->camera->getViewMatrix();
+        
+        math::mat4f result;
+        for (int col = 0; col < 4; col++) {
+            for (int row = 0; row < 4; row++) {
+                result.m[col * 4 + row] = static_cast<float>(viewProjection[col][row]);
+            }
+        }
+        return result;
     }
 };
 
+std::unique_ptr<IRenderer> createFilamentRenderer() {
+    return std::make_unique<FilamentRenderer>();
+}
+
 } // namespace Kazia
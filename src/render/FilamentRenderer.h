@@ -0,0 +1,15 @@
+#ifndef FILAMENTRENDERER_H
+#define FILAMENTRENDERER_H
+
+#include <memory>
+
+#include "IRenderer.h"
+
+namespace Kazia {
+
+// 创建基于 Filament 的渲染器，调用 initialize 或 initializeHeadless 后使用
+std::unique_ptr<IRenderer> createFilamentRenderer();
+
+} // namespace Kazia
+
+#endif // FILAMENTRENDERER_H
@@ -0,0 +1,76 @@
+#include "FrameScheduler.h"
+
+#include <cmath>
+
+namespace Kazia {
+
+FrameScheduler::FrameScheduler()
+    : m_frameRequested(true)
+    , m_animationCount(0)
+    , m_refreshRate(60.0f)
+    , m_maxFrameRate(0.0f)
+    , m_presentInterval(1)
+    , m_frameInterval(0)
+    , m_lastFrameTime()
+{
+    updateInterval();
+}
+
+void FrameScheduler::endAnimation()
+{
+    if (m_animationCount > 0) {
+        m_animationCount--;
+    }
+
+    // 动画结束后再渲染一帧，保证显示的是最终状态
+    m_frameRequested = true;
+}
+
+void FrameScheduler::setRefreshRate(float refreshRate)
+{
+    m_refreshRate = refreshRate > 1.0f ? refreshRate : 60.0f;
+    updateInterval();
+}
+
+void FrameScheduler::setMaxFrameRate(float maxFrameRate)
+{
+    m_maxFrameRate = maxFrameRate > 0.0f ? maxFrameRate : 0.0f;
+    updateInterval();
+}
+
+int FrameScheduler::getDelayUntilNextFrame(Clock::time_point now) const
+{
+    if (!needsFrame()) {
+        return -1;
+    }
+
+    Clock::time_point next = m_lastFrameTime + m_frameInterval;
+    if (next <= now) {
+        return 0;
+    }
+
+    // 向上取整，避免提前醒来后再等一轮
+    auto wait = std::chrono::duration_cast<std::chrono::microseconds>(next - now).count();
+    return static_cast<int>((wait + 999) / 1000);
+}
+
+void FrameScheduler::onFramePublished(Clock::time_point now)
+{
+    m_frameRequested = false;
+    m_lastFrameTime = now;
+}
+
+void FrameScheduler::updateInterval()
+{
+    // 取满足 刷新率 / n <= 上限 的最小 n，使每帧都落在垂直同步上
+    m_presentInterval = 1;
+    if (m_maxFrameRate > 0.0f && m_maxFrameRate < m_refreshRate) {
+        m_presentInterval = static_cast<uint32_t>(std::ceil(m_refreshRate / m_maxFrameRate - 1e-3f));
+    }
+
+    // 发布间隔略短于目标帧间隔，留出定时器误差，实际节奏由交换链的垂直同步决定
+    double seconds = static_cast<double>(m_presentInterval) / m_refreshRate;
+    m_frameInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds * 0.9));
+}
+
+} // namespace Kazia
@@ -0,0 +1,66 @@
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <chrono>
+#include <cstdint>
+
+namespace Kazia {
+
+// 按需渲染的帧调度
+// 只有在场景、相机或视口变化（requestFrame）或有动画进行时才需要新帧；
+// 帧间隔按显示器刷新率对齐，可设置帧率上限，上限落在两个刷新倍数之间时取不超过上限的那一档
+class FrameScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    FrameScheduler();
+
+    // 请求渲染一帧，同一帧间隔内的多次请求合并为一帧
+    void requestFrame() { m_frameRequested = true; }
+
+    // 动画期间连续渲染，begin/end 需成对调用
+    void beginAnimation() { m_animationCount++; }
+    void endAnimation();
+    bool isAnimating() const { return m_animationCount > 0; }
+
+    // 是否需要渲染新帧
+    bool needsFrame() const { return m_frameRequested || m_animationCount > 0; }
+
+    // 显示器刷新率（Hz）
+    void setRefreshRate(float refreshRate);
+    float getRefreshRate() const { return m_refreshRate; }
+
+    // 帧率上限，0 表示跟随刷新率
+    void setMaxFrameRate(float maxFrameRate);
+    float getMaxFrameRate() const { return m_maxFrameRate; }
+
+    // 每帧占用的垂直同步周期数
+    uint32_t getPresentInterval() const { return m_presentInterval; }
+
+    // 实际目标帧率和帧间隔
+    float getTargetFrameRate() const { return m_refreshRate / static_cast<float>(m_presentInterval); }
+    Clock::duration getFrameInterval() const { return m_frameInterval; }
+
+    // 距离下一帧还需等待的毫秒数，不需要渲染时返回 -1
+    int getDelayUntilNextFrame(Clock::time_point now) const;
+
+    // 已发布一帧，清除请求并记录时间
+    void onFramePublished(Clock::time_point now);
+
+private:
+    void updateInterval();
+
+    bool m_frameRequested;
+    uint32_t m_animationCount;
+
+    float m_refreshRate;
+    float m_maxFrameRate;
+    uint32_t m_presentInterval;
+    Clock::duration m_frameInterval;
+
+    Clock::time_point m_lastFrameTime;
+};
+
+} // namespace Kazia
+
+#endif // FRAMESCHEDULER_H
@@ -0,0 +1,73 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#include <cstdint>
+
+namespace Kazia {
+
+// 每帧渲染统计
+struct FrameStats {
+    uint64_t frameIndex = 0;
+    
+    // CPU 视锥体剔除
+    double cullTimeMs = 0.0;
+    uint32_t renderableCount = 0;     // 参与剔除的可渲染对象总数
+    uint32_t visibleCount = 0;        // 可见的可渲染对象数量
+    uint32_t bvhNodesVisited = 0;     // 剔除时访问的 BVH 节点数
+    uint32_t sceneMembershipChanges = 0; // 本帧加入/移出 Filament 场景的实体数
+    
+    // 场景同步
+    double syncTimeMs = 0.0;          // 节点变换同步到 Filament 的耗时
+    uint32_t syncedTransformCount = 0; // 本帧同步的变换数
+    
+    // 光源
+    double lightTimeMs = 0.0;         // 光源参数写入和剔除的耗时
+    uint32_t pointLightCount = 0;     // 点光源总数
+    uint32_t visibleLightCount = 0;   // 影响范围与视锥体相交的点光源数量
+    uint32_t activeLightCount = 0;    // 留在 Filament 场景中的点光源数量（预算内的加上正在淡出的）
+    uint32_t fadingLightCount = 0;    // 正在淡入或淡出的点光源数量
+    uint32_t lightUpdateCount = 0;    // 本帧写入 Filament 的光源参数数
+    uint32_t lightMembershipChanges = 0; // 本帧加入/移出 Filament 场景的点光源数
+    uint32_t shadowUpdateCount = 0;   // 阴影过期的投射阴影光源数（动态光源和阴影过期的静态光源）
+    uint32_t shadowReuseCount = 0;    // 阴影未过期的静态光源数（Filament 仍会每帧渲染其阴影）
+    
+    // 网格 LOD
+    double lodTimeMs = 0.0;           // LOD 级别选择和切换的耗时
+    uint32_t lodRenderableCount = 0;  // 本帧参与 LOD 选择的可见对象数量
+    uint32_t lodSwitchCount = 0;      // 本帧切换了级别的对象数量
+    uint64_t lodTriangleCount = 0;    // 这些对象按所选级别绘制的三角形数
+    uint64_t lodFullTriangleCount = 0; // 这些对象全部使用第 0 级时的三角形数
+    
+    // 分簇剔除
+    double clusterTimeMs = 0.0;       // 分簇剔除和压缩索引上传的耗时
+    uint32_t clusterRenderableCount = 0; // 本帧参与分簇剔除的对象数量
+    uint32_t clusterCount = 0;        // 这些对象的分簇总数
+    uint32_t visibleClusterCount = 0; // 可见的分簇数量
+    uint64_t clusterTriangleCount = 0; // 这些对象提交的三角形数
+    uint64_t clusterFullTriangleCount = 0; // 这些对象不做分簇剔除时的三角形数
+    uint32_t clusterUploadCount = 0;  // 本帧重新上传压缩索引的对象数量
+    uint64_t clusterUploadBytes = 0;  // 本帧上传的压缩索引字节数
+    
+    // 流式网格
+    double streamTimeMs = 0.0;        // 级别请求、到达数据上传和淘汰处理的耗时
+    uint32_t streamRenderableCount = 0; // 流式网格对象数量
+    uint32_t streamWaitingCount = 0;  // 可见但目标级别尚未驻留的对象数量
+    uint32_t streamLoadCount = 0;     // 本帧到达并上传的级别数
+    uint32_t streamEvictionCount = 0; // 本帧淘汰的级别数
+    uint32_t streamPendingCount = 0;  // 排队等待读取的级别数
+    uint64_t streamResidentBytes = 0; // 驻留的网格数据字节数（含在途）
+    uint64_t streamBudgetBytes = 0;   // 驻留预算
+};
+
+// 帧时间统计，基于最近若干帧
+struct FrameTiming {
+    uint64_t frameCount = 0;          // 已渲染的总帧数
+    double lastFrameMs = 0.0;         // 最近一帧的渲染耗时
+    double averageFrameMs = 0.0;      // 平均渲染耗时
+    double maxFrameMs = 0.0;          // 最大渲染耗时
+    double averageIntervalMs = 0.0;   // 相邻两帧开始时间的平均间隔（按需渲染时包含空闲时间）
+};
+
+} // namespace Kazia
+
+#endif // FRAMESTATS_H
@@ -0,0 +1,253 @@
+#include "GpuPicker.h"
+
+#include "FilamentEntityMapper.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace Kazia {
+
+GpuPicker::GpuPicker()
+    : m_engine(nullptr)
+    , m_renderer(nullptr)
+    , m_entityMapper(nullptr)
+    , m_view(nullptr)
+    , m_renderTarget(nullptr)
+    , m_colorTexture(nullptr)
+    , m_depthTexture(nullptr)
+    , m_viewportWidth(0)
+    , m_viewportHeight(0)
+    , m_resolutionScale(0.5f)
+    , m_targetWidth(0)
+    , m_targetHeight(0)
+    , m_textureWidth(0)
+    , m_textureHeight(0)
+    , m_nextPickId(1)
+    , m_frameIndex(0)
+    , m_timeoutFrames(8)
+    , m_alive(std::make_shared<bool>(true))
+{
+}
+
+GpuPicker::~GpuPicker()
+{
+    shutdown();
+}
+
+bool GpuPicker::initialize(filament::Engine* engine, filament::Renderer* renderer, filament::Scene* scene,
+                           filament::Camera* camera, FilamentEntityMapper* entityMapper, int width, int height)
+{
+    m_engine = engine;
+    m_renderer = renderer;
+    m_entityMapper = entityMapper;
+    if (!m_engine || !m_renderer) {
+        return false;
+    }
+
+    // 拾取视图只需要深度和实体 ID，关闭后处理和阴影等开销
+    m_view = m_engine->createView();
+    m_view->setScene(scene);
+    m_view->setCamera(camera);
+    m_view->setPostProcessingEnabled(false);
+    m_view->setShadowingEnabled(false);
+    m_view->setScreenSpaceRefractionEnabled(false);
+    m_view->setName("GpuPicker");
+
+    m_viewportWidth = width;
+    m_viewportHeight = height;
+    updateRenderTarget();
+    return true;
+}
+
+void GpuPicker::shutdown()
+{
+    if (!m_engine) {
+        return;
+    }
+
+    // 未完成的请求以未命中返回
+    std::vector<uint64_t> pickIds;
+    for (const auto& item : m_pendingPicks) {
+        pickIds.push_back(item.first);
+    }
+    for (uint64_t pickId : pickIds) {
+        complete(pickId, GpuPickResult());
+    }
+
+    destroyRenderTarget();
+    if (m_view) {
+        m_engine->destroy(m_view);
+        m_view = nullptr;
+    }
+
+    m_engine = nullptr;
+    m_renderer = nullptr;
+    m_entityMapper = nullptr;
+}
+
+void GpuPicker::resize(int width, int height)
+{
+    if (width == m_viewportWidth && height == m_viewportHeight) {
+        return;
+    }
+
+    m_viewportWidth = width;
+    m_viewportHeight = height;
+    if (m_engine) {
+        updateRenderTarget();
+    }
+}
+
+void GpuPicker::setResolutionScale(float scale)
+{
+    scale = std::clamp(scale, 0.05f, 1.0f);
+    if (scale == m_resolutionScale) {
+        return;
+    }
+
+    m_resolutionScale = scale;
+    if (m_engine) {
+        updateRenderTarget();
+    }
+}
+
+void GpuPicker::updateRenderTarget()
+{
+    m_targetWidth = static_cast<uint32_t>(std::max(1.0f, m_viewportWidth * m_resolutionScale));
+    m_targetHeight = static_cast<uint32_t>(std::max(1.0f, m_viewportHeight * m_resolutionScale));
+
+    if (m_renderTarget && m_targetWidth <= m_textureWidth && m_targetHeight <= m_textureHeight) {
+        m_view->setViewport(filament::Viewport(0, 0, m_targetWidth, m_targetHeight));
+        return;
+    }
+
+    destroyRenderTarget();
+    createRenderTarget();
+}
+
+void GpuPicker::createRenderTarget()
+{
+    // 纹理按 128 像素向上取整，拖动窗口边缘时大多数变化不需要重新分配
+    m_textureWidth = (m_targetWidth + 127) & ~127u;
+    m_textureHeight = (m_targetHeight + 127) & ~127u;
+
+    m_colorTexture = filament::Texture::Builder()
+        .width(m_textureWidth)
+        .height(m_textureHeight)
+        .levels(1)
+        .usage(filament::Texture::Usage::COLOR_ATTACHMENT | filament::Texture::Usage::SAMPLEABLE)
+        .format(filament::Texture::InternalFormat::RGBA8)
+        .build(*m_engine);
+
+    m_depthTexture = filament::Texture::Builder()
+        .width(m_textureWidth)
+        .height(m_textureHeight)
+        .levels(1)
+        .usage(filament::Texture::Usage::DEPTH_ATTACHMENT)
+        .format(filament::Texture::InternalFormat::DEPTH32F)
+        .build(*m_engine);
+
+    m_renderTarget = filament::RenderTarget::Builder()
+        .texture(filament::RenderTarget::AttachmentPoint::COLOR, m_colorTexture)
+        .texture(filament::RenderTarget::AttachmentPoint::DEPTH, m_depthTexture)
+        .build(*m_engine);
+
+    m_view->setRenderTarget(m_renderTarget);
+    m_view->setViewport(filament::Viewport(0, 0, m_targetWidth, m_targetHeight));
+}
+
+void GpuPicker::destroyRenderTarget()
+{
+    if (m_view) {
+        m_view->setRenderTarget(nullptr);
+    }
+    if (m_renderTarget) {
+        m_engine->destroy(m_renderTarget);
+        m_renderTarget = nullptr;
+    }
+    if (m_colorTexture) {
+        m_engine->destroy(m_colorTexture);
+        m_colorTexture = nullptr;
+    }
+    if (m_depthTexture) {
+        m_engine->destroy(m_depthTexture);
+        m_depthTexture = nullptr;
+    }
+    m_textureWidth = 0;
+    m_textureHeight = 0;
+}
+
+void GpuPicker::pick(int x, int y, Callback callback)
+{
+    if (!m_view || x < 0 || y < 0 || x >= m_viewportWidth || y >= m_viewportHeight) {
+        if (callback) {
+            callback(GpuPickResult());
+        }
+        return;
+    }
+
+    uint64_t pickId = m_nextPickId++;
+    m_pendingPicks[pickId] = {std::move(callback), m_frameIndex, false};
+
+    // 视口坐标缩放到拾取缓冲，Filament 的原点在左下角
+    uint32_t targetX = std::min(static_cast<uint32_t>(x * m_resolutionScale), m_targetWidth - 1);
+    uint32_t targetY = std::min(static_cast<uint32_t>((m_viewportHeight - 1 - y) * m_resolutionScale), m_targetHeight - 1);
+
+    std::weak_ptr<bool> alive = m_alive;
+    m_view->pick(targetX, targetY, [this, alive, pickId](const filament::View::PickingQueryResult& queryResult) {
+        if (alive.expired()) {
+            return;
+        }
+
+        GpuPickResult result;
+        result.completed = true;
+        if (!queryResult.renderable.isNull() && m_entityMapper) {
+            result.nodeUUID = m_entityMapper->getNodeUUID(queryResult.renderable);
+            result.hit = !result.nodeUUID.empty();
+            result.depth = queryResult.depth;
+        }
+        complete(pickId, result);
+    });
+}
+
+void GpuPicker::render()
+{
+    m_frameIndex++;
+
+    // 清理超时请求
+    std::vector<uint64_t> expired;
+    bool needsRender = false;
+    for (auto& item : m_pendingPicks) {
+        if (m_frameIndex - item.second.issuedFrame > m_timeoutFrames) {
+            expired.push_back(item.first);
+        } else if (!item.second.submitted) {
+            item.second.submitted = true;
+            needsRender = true;
+        }
+    }
+    for (uint64_t pickId : expired) {
+        complete(pickId, GpuPickResult());
+    }
+
+    // 新的请求随本次渲染解析，读回完成后回调
+    if (needsRender && m_renderer && m_view) {
+        m_renderer->render(m_view);
+    }
+}
+
+void GpuPicker::complete(uint64_t pickId, const GpuPickResult& result)
+{
+    auto it = m_pendingPicks.find(pickId);
+    if (it == m_pendingPicks.end()) {
+        return;
+    }
+
+    // 先移出再回调，回调中可以发起新的请求
+    Callback callback = std::move(it->second.callback);
+    m_pendingPicks.erase(it);
+    if (callback) {
+        callback(result);
+    }
+}
+
+} // namespace Kazia
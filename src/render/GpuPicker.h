@@ -0,0 +1,103 @@
+#ifndef GPUPICKER_H
+#define GPUPICKER_H
+
+#include <filament/Engine.h>
+#include <filament/Renderer.h>
+#include <filament/Scene.h>
+#include <filament/View.h>
+#include <filament/Camera.h>
+#include <filament/RenderTarget.h>
+#include <filament/Texture.h>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include "IGpuPicker.h"
+
+namespace Kazia {
+
+class FilamentEntityMapper;
+
+// 基于 ID 缓冲的 GPU 拾取
+// 使用独立的离屏视图，按降低后的分辨率渲染到 RenderTarget，并通过 Filament 的拾取查询
+// 异步读回像素处的实体 ID，再由 FilamentEntityMapper 映射为节点 UUID。
+// 只有存在未完成的请求时才渲染拾取视图，代价与三角形数量无关
+class GpuPicker : public IGpuPicker {
+private:
+    filament::Engine* m_engine;
+    filament::Renderer* m_renderer;
+    FilamentEntityMapper* m_entityMapper;
+
+    // 离屏拾取视图
+    filament::View* m_view;
+    filament::RenderTarget* m_renderTarget;
+    filament::Texture* m_colorTexture;
+    filament::Texture* m_depthTexture;
+
+    // 主视口大小和拾取缓冲的缩放比例
+    int m_viewportWidth;
+    int m_viewportHeight;
+    float m_resolutionScale;
+    uint32_t m_targetWidth;
+    uint32_t m_targetHeight;
+
+    // 已分配纹理的大小，只增不减；拾取缓冲只使用其中 m_targetWidth x m_targetHeight 的区域
+    uint32_t m_textureWidth;
+    uint32_t m_textureHeight;
+
+    struct PendingPick {
+        Callback callback;
+        uint64_t issuedFrame;
+        bool submitted;
+    };
+
+    std::unordered_map<uint64_t, PendingPick> m_pendingPicks;
+    uint64_t m_nextPickId;
+    uint64_t m_frameIndex;
+
+    // 超过该帧数仍未返回的请求视为失败（如 noop 后端不会产生读回结果）
+    uint32_t m_timeoutFrames;
+
+    // Filament 回调可能晚于本对象销毁，回调通过它判断对象是否仍然有效
+    std::shared_ptr<bool> m_alive;
+
+public:
+    GpuPicker();
+    ~GpuPicker() override;
+
+    // 初始化，拾取视图与主视图共享场景和相机
+    bool initialize(filament::Engine* engine, filament::Renderer* renderer, filament::Scene* scene,
+                    filament::Camera* camera, FilamentEntityMapper* entityMapper, int width, int height);
+    void shutdown();
+
+    // 主视口大小变化，纹理足够大时只调整视口，不重新分配
+    void resize(int width, int height);
+
+    // 拾取缓冲相对主视口的分辨率比例，(0, 1]
+    void setResolutionScale(float scale);
+    float getResolutionScale() const { return m_resolutionScale; }
+
+    void setTimeoutFrames(uint32_t frames) { m_timeoutFrames = frames; }
+
+    // IGpuPicker
+    void pick(int x, int y, Callback callback) override;
+    bool hasPendingPicks() const override { return !m_pendingPicks.empty(); }
+
+    // 在 beginFrame / endFrame 之间调用：有未完成的请求时渲染拾取视图，并清理超时请求
+    void render();
+
+private:
+    void createRenderTarget();
+    void destroyRenderTarget();
+
+    // 按当前视口和缩放比例计算拾取缓冲大小，纹理不够大时重新分配
+    void updateRenderTarget();
+
+    // 完成请求并从等待列表移除
+    void complete(uint64_t pickId, const GpuPickResult& result);
+};
+
+} // namespace Kazia
+
+#endif // GPUPICKER_H
@@ -0,0 +1,35 @@
+#ifndef IGPUPICKER_H
+#define IGPUPICKER_H
+
+#include <functional>
+#include <string>
+
+namespace Kazia {
+
+// GPU 拾取结果
+struct GpuPickResult {
+    bool completed = false; // GPU 是否返回了结果，超时或取消时为 false
+    bool hit = false;
+    std::string nodeUUID;   // 命中的节点，未命中或超时时为空
+    float depth = 0.0f;     // 命中点的深度缓冲值
+};
+
+// GPU 拾取接口
+// 拾取请求在下一次渲染时随 ID 缓冲一起解析，结果异步回调；
+// 编辑器层只依赖此接口，不直接包含 Filament 头文件
+class IGpuPicker {
+public:
+    using Callback = std::function<void(const GpuPickResult&)>;
+
+    virtual ~IGpuPicker() = default;
+
+    // 请求拾取屏幕坐标（左上角为原点，单位为视口像素）
+    virtual void pick(int x, int y, Callback callback) = 0;
+
+    // 是否还有未完成的拾取请求
+    virtual bool hasPendingPicks() const = 0;
+};
+
+} // namespace Kazia
+
+#endif // IGPUPICKER_H
@@ -1,23 +1,30 @@
 #ifndef IRENDERER_H
 #define IRENDERER_H
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "RenderContext.h"
+#include "FrameStats.h"
+#include "IGpuPicker.h"
+#include "RenderSnapshot.h"
+#include "core/Math.h"
+#include "core/MeshData.h"
+#include "core/PrimitiveGenerator.h"
 
 namespace Kazia {
 
 class Node;
 
-// 简化的数学库
-namespace math {
-    struct float3 {
-        float x, y, z;
-        float3(float x = 0.0f, float y = 0.0f, float z = 0.0f) : x(x), y(y), z(z) {}
-    };
-}
+// 渲染后端
+enum class RenderBackend {
+    Default,
+    OpenGL,
+    Vulkan,
+    Noop    // 不提交任何 GPU 命令，只测量 CPU 开销
+};
 
 class IRenderer {
 public:
@@ -27,8 +34,11 @@ public:
     virtual bool initialize(void* nativeWindow, int width, int height) = 0;
     virtual void shutdown() = 0;
     
-    // 渲染相关
-    virtual void beginFrame() = 0;
+    // 无窗口初始化，渲染到固定大小的离屏交换链，用于基准测试和无显示器的环境
+    virtual bool initializeHeadless(int width, int height, RenderBackend backend) = 0;
+    
+    // 渲染相关，beginFrame 返回 false 时应跳过本帧的 render 和 endFrame
+    virtual bool beginFrame() = 0;
     virtual void render() = 0;
     virtual void endFrame() = 0;
     
@@ -37,8 +47,25 @@ public:
     
     // 场景操作
     virtual void addMesh(const std::string& meshName, const std::string& meshPath) = 0;
+    
+    // 移除 addMesh 创建的网格，或 addNode* 为该 UUID 的节点创建的实体和光源，并释放不再使用的几何体
     virtual void removeMesh(const std::string& meshName) = 0;
     
+    // 为节点创建可渲染实体并建立映射，之后随 syncSceneTransforms / applySnapshot 更新变换
+    virtual bool addNodeMesh(const Node* node) = 0;
+    
+    // 同上，使用给定的网格数据，导入时生成 LOD 链，渲染时按屏幕上的投影误差切换级别
+    virtual bool addNodeMesh(const Node* node, const MeshData& mesh) = 0;
+    
+    // 同上，使用程序化几何体，参数相同的几何体在所有节点之间共享
+    virtual bool addNodePrimitive(const Node* node, const PrimitiveDesc& desc) = 0;
+    
+    // 同上，使用流式缓存文件（见 MeshStream.h）：先绘制最粗一级，更精细的级别按需在后台载入，超出预算时淘汰
+    virtual bool addNodeStreamedMesh(const Node* node, const std::string& streamPath) = 0;
+    
+    // 按节点的 LightComponent 创建光源（阴影是否投射、是否静态取自组件），之后随节点的变换移动
+    virtual bool addNodeLight(const Node* node) = 0;
+    
     // 相机操作
     virtual void setCameraPosition(const math::float3& position) = 0;
     virtual void setCameraTarget(const math::float3& target) = 0;
@@ -55,8 +82,23 @@ public:
     // 获取上下文
     virtual std::shared_ptr<RenderContext> getContext() const = 0;
     
+    // GPU 拾取，不支持时返回 nullptr
+    virtual IGpuPicker* getGpuPicker() const = 0;
+    
+    // 获取上一帧的统计
+    virtual const FrameStats& getFrameStats() const = 0;
+    
     // 场景同步
     virtual void syncSceneTransforms(const Node* rootNode) = 0;
+    
+    // 应用主线程发布的快照（视口、相机、变化的节点变换），在渲染线程上调用
+    virtual void applySnapshot(const RenderSnapshot& snapshot) = 0;
+    
+    // 在下一帧 render 之后读回颜色缓冲（RGBA8，左下角为原点），flush 返回后数据可用
+    virtual void requestFrameCapture(std::vector<uint8_t>* rgbaPixels) = 0;
+    
+    // 提交所有命令并等待完成
+    virtual void flush() = 0;
 };
 
 } // namespace Kazia
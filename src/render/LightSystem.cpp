@@ -3,12 +3,27 @@
 #include <utils/EntityManager.h>
 #include <utils/Entity.h>
 
+#include <algorithm>
+#include <chrono>
+
 namespace Kazia {
 
 LightSystem::LightSystem()
     : m_engine(nullptr)
     , m_scene(nullptr)
+    , m_bvh(0.5f)
+    , m_lightBudget(0)
+    , m_fadeDuration(0.25f)
+    , m_lastUpdateTime()
+    , m_instancesStale(false)
+    , m_frameIndex(0)
+    , m_cullingEnabled(true)
+{
+}
+
+LightSystem::~LightSystem()
 {
+    clearAllLights();
 }
 
 void LightSystem::initialize(filament::Engine* engine, filament::Scene* scene)
@@ -17,161 +32,538 @@ void LightSystem::initialize(filament::Engine* engine, filament::Scene* scene)
     m_scene = scene;
 }
 
-void LightSystem::addDirectionalLight(const filament::math::float3& direction, const filament::math::float3& color, float intensity)
+LightHandle LightSystem::addDirectionalLight(const filament::math::float3& direction, const filament::math::float3& color, float intensity,
+    const ShadowSettings& shadow)
 {
     if (!m_engine || !m_scene) {
-        return;
+        return {};
     }
-    
+
     // 创建方向光
     filament::LightManager::Builder lightBuilder(filament::LightManager::Type::DIRECTIONAL);
     lightBuilder.color(color);
     lightBuilder.intensity(intensity);
     lightBuilder.direction(direction);
-    
+    lightBuilder.castShadows(shadow.castShadows);
+    lightBuilder.shadowOptions(toShadowOptions(shadow));
+
     utils::Entity lightEntity = utils::EntityManager::get().create();
     lightBuilder.build(*m_engine, lightEntity);
     m_scene->addEntity(lightEntity);
-    
-    // 添加到列表
+
     DirectionalLight light;
     light.entity = lightEntity;
+    light.instance = m_engine->getLightManager().getInstance(lightEntity);
     light.direction = direction;
     light.color = color;
     light.intensity = intensity;
-    m_directionalLights.push_back(light);
+    light.shadow = shadow;
+    light.shadowDirty = true;
+    light.dirty = false;
+    return m_directionalLights.insert(light);
 }
 
-void LightSystem::addPointLight(const filament::math::float3& position, const filament::math::float3& color, float intensity, float radius)
+LightHandle LightSystem::addPointLight(const filament::math::float3& position, const filament::math::float3& color, float intensity, float radius,
+    const ShadowSettings& shadow)
 {
     if (!m_engine || !m_scene) {
-        return;
+        return {};
     }
-    
-    // 创建点光源
+
+    // 创建点光源，先不加入场景，由 setInScene 统一管理成员关系，强度随淡入逐渐增加
     filament::LightManager::Builder lightBuilder(filament::LightManager::Type::POINT);
     lightBuilder.color(color);
-    lightBuilder.intensity(intensity);
+    lightBuilder.intensity(0.0f);
     lightBuilder.position(position);
     lightBuilder.falloff(radius);
-    
+    lightBuilder.castShadows(shadow.castShadows);
+    lightBuilder.shadowOptions(toShadowOptions(shadow));
+
     utils::Entity lightEntity = utils::EntityManager::get().create();
     lightBuilder.build(*m_engine, lightEntity);
-    m_scene->addEntity(lightEntity);
-    
-    // 添加到列表
+
     PointLight light;
     light.entity = lightEntity;
+    light.instance = m_engine->getLightManager().getInstance(lightEntity);
     light.position = position;
     light.color = color;
     light.intensity = intensity;
     light.radius = radius;
-    m_pointLights.push_back(light);
+    light.proxyId = m_bvh.createProxy(pointLightBounds(position, radius), nullptr);
+    light.lastVisibleFrame = m_frameIndex;
+    light.fade = 0.0f;
+    light.shadow = shadow;
+    light.shadowDirty = true;
+    light.selected = false;
+    light.inScene = false;
+    light.dirty = false;
+    LightHandle handle = m_pointLights.insert(light);
+
+    if (light.proxyId >= static_cast<int32_t>(m_proxyToLight.size())) {
+        m_proxyToLight.resize(light.proxyId + 1);
+    }
+    m_proxyToLight[light.proxyId] = handle;
+
+    // 下一次 update 时经过剔除和排序再决定是否加入场景
+    return handle;
 }
 
-void LightSystem::removeDirectionalLight(size_t index)
+void LightSystem::removeDirectionalLight(LightHandle handle)
 {
-    if (index >= m_directionalLights.size()) {
+    DirectionalLight* light = m_directionalLights.get(handle);
+    if (!light) {
         return;
     }
-    
-    if (m_engine && m_scene) {
-        // 从场景中移除
-        m_scene->removeEntity(m_directionalLights[index].entity);
-        
-        // 销毁实体
-        utils::EntityManager::get().destroy(m_directionalLights[index].entity);
+
+    if (m_scene) {
+        m_scene->removeEntity(light->entity);
     }
-    
-    // 从列表中移除
-    m_directionalLights.erase(m_directionalLights.begin() + index);
+    destroyLightEntity(light->entity);
+    m_directionalLights.erase(handle);
 }
 
-void LightSystem::removePointLight(size_t index)
+void LightSystem::removePointLight(LightHandle handle)
 {
-    if (index >= m_pointLights.size()) {
+    PointLight* light = m_pointLights.get(handle);
+    if (!light) {
         return;
     }
-    
-    if (m_engine && m_scene) {
-        // 从场景中移除
-        m_scene->removeEntity(m_pointLights[index].entity);
-        
-        // 销毁实体
-        utils::EntityManager::get().destroy(m_pointLights[index].entity);
+
+    // 各列表中的句柄随之失效，遍历时跳过即可
+    setInScene(*light, false);
+    m_bvh.destroyProxy(light->proxyId);
+    m_proxyToLight[light->proxyId] = LightHandle();
+    destroyLightEntity(light->entity);
+    m_pointLights.erase(handle);
+}
+
+void LightSystem::updateDirectionalLight(LightHandle handle, const filament::math::float3& direction, const filament::math::float3& color, float intensity)
+{
+    DirectionalLight* light = m_directionalLights.get(handle);
+    if (!light) {
+        return;
+    }
+
+    light->direction = direction;
+    light->color = color;
+    light->intensity = intensity;
+    light->shadowDirty = true;
+    if (!light->dirty) {
+        light->dirty = true;
+        m_dirtyDirectionalLights.push_back(handle);
     }
-    
-    // 从列表中移除
-    m_pointLights.erase(m_pointLights.begin() + index);
 }
 
-void LightSystem::updateDirectionalLight(size_t index, const filament::math::float3& direction, const filament::math::float3& color, float intensity)
+void LightSystem::updatePointLight(LightHandle handle, const filament::math::float3& position, const filament::math::float3& color, float intensity, float radius)
 {
-    if (index >= m_directionalLights.size()) {
+    PointLight* light = m_pointLights.get(handle);
+    if (!light) {
         return;
     }
-    
-    if (m_engine) {
-        // 获取光源管理器
-        auto& lightManager = m_engine->getLightManager();
-        auto instance = lightManager.getInstance(m_directionalLights[index].entity);
-        
-        // 更新光源参数
-        lightManager.setDirection(instance, direction);
-        lightManager.setColor(instance, color);
-        lightManager.setIntensity(instance, intensity);
-        
-        // 更新列表中的参数
-        m_directionalLights[index].direction = direction;
-        m_directionalLights[index].color = color;
-        m_directionalLights[index].intensity = intensity;
+
+    light->position = position;
+    light->color = color;
+    light->intensity = intensity;
+    light->radius = radius;
+    light->shadowDirty = true;
+    if (!light->dirty) {
+        light->dirty = true;
+        m_dirtyPointLights.push_back(handle);
+    }
+}
+
+void LightSystem::setPointLightPosition(LightHandle handle, const filament::math::float3& position)
+{
+    PointLight* light = m_pointLights.get(handle);
+    if (!light) {
+        return;
+    }
+
+    light->position = position;
+    light->shadowDirty = true;
+    if (!light->dirty) {
+        light->dirty = true;
+        m_dirtyPointLights.push_back(handle);
     }
 }
 
-void LightSystem::updatePointLight(size_t index, const filament::math::float3& position, const filament::math::float3& color, float intensity, float radius)
+void LightSystem::setShadowSettings(LightHandle handle, const ShadowSettings& shadow)
 {
-    if (index >= m_pointLights.size()) {
+    ShadowSettings* settings = nullptr;
+    utils::Entity entity;
+    if (DirectionalLight* light = m_directionalLights.get(handle)) {
+        settings = &light->shadow;
+        light->shadowDirty = true;
+        entity = light->entity;
+    } else if (PointLight* light = m_pointLights.get(handle)) {
+        settings = &light->shadow;
+        light->shadowDirty = true;
+        entity = light->entity;
+    }
+    if (!settings) {
         return;
     }
-    
+
+    *settings = shadow;
     if (m_engine) {
-        // 获取光源管理器
         auto& lightManager = m_engine->getLightManager();
-        auto instance = lightManager.getInstance(m_pointLights[index].entity);
-        
-        // 更新光源参数
-        lightManager.setPosition(instance, position);
-        lightManager.setColor(instance, color);
-        lightManager.setIntensity(instance, intensity);
-        lightManager.setFalloff(instance, radius);
-        
-        // 更新列表中的参数
-        m_pointLights[index].position = position;
-        m_pointLights[index].color = color;
-        m_pointLights[index].intensity = intensity;
-        m_pointLights[index].radius = radius;
+        auto instance = lightManager.getInstance(entity);
+        lightManager.setShadowCaster(instance, shadow.castShadows);
+        lightManager.setShadowOptions(instance, toShadowOptions(shadow));
     }
 }
 
-void LightSystem::clearAllLights()
+void LightSystem::invalidateShadows(const math::aabb& casterBounds)
 {
-    if (m_engine && m_scene) {
-        // 移除所有方向光
-        for (const auto& light : m_directionalLights) {
-            m_scene->removeEntity(light.entity);
-            utils::EntityManager::get().destroy(light.entity);
+    if (casterBounds.isEmpty()) {
+        return;
+    }
+
+    // 方向光照亮整个场景，任何投射者移动都会改变它的阴影
+    for (auto& light : m_directionalLights) {
+        if (light.shadow.castShadows) {
+            light.shadowDirty = true;
+        }
+    }
+
+    // 点光源只检查影响范围与投射者相交的那些
+    m_bvh.queryAabb(casterBounds, [this](int32_t proxyId) {
+        PointLight* light = m_pointLights.get(m_proxyToLight[proxyId]);
+        if (light && light->shadow.castShadows) {
+            light->shadowDirty = true;
+        }
+    });
+}
+
+bool LightSystem::needsShadowUpdate(LightHandle handle) const
+{
+    for (LightHandle updated : m_shadowUpdates) {
+        if (updated == handle) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void LightSystem::update(const math::mat4f& viewProjection, const math::float3& cameraPosition, FrameStats& stats)
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    // 按距上一次更新的时间推进淡入淡出，长时间未渲染时不跳过整个过渡；第一帧直接显示
+    float fadeStep = 1.0f;
+    if (m_frameIndex > 0 && m_fadeDuration > 0.0f) {
+        float deltaTime = std::chrono::duration<float>(startTime - m_lastUpdateTime).count();
+        fadeStep = std::min(std::max(deltaTime, 0.0f), 0.1f) / m_fadeDuration;
+    }
+    m_lastUpdateTime = startTime;
+
+    uint32_t updatedCount = static_cast<uint32_t>(m_dirtyDirectionalLights.size() + m_dirtyPointLights.size());
+    flushUpdates();
+
+    m_frameIndex++;
+    collectCandidates(viewProjection);
+    selectLights(cameraPosition);
+
+    uint32_t membershipChanges = 0;
+    uint32_t fadingCount = 0;
+    filament::LightManager* lightManager = m_engine ? &m_engine->getLightManager() : nullptr;
+
+    std::swap(m_activeLights, m_previousActiveLights);
+    m_activeLights.clear();
+
+    // 离开视锥体的光源对画面没有贡献，直接移出场景，再次进入时重新淡入
+    for (LightHandle handle : m_previousActiveLights) {
+        PointLight* light = m_pointLights.get(handle);
+        if (light && light->lastVisibleFrame != m_frameIndex && light->inScene) {
+            setInScene(*light, false);
+            light->fade = 0.0f;
+            membershipChanges++;
+        }
+    }
+
+    // 预算内的光源淡入，被挤出预算的淡出，完全淡出后移出场景
+    for (LightHandle handle : m_candidateLights) {
+        PointLight& light = *m_pointLights.get(handle);
+        float fade = light.selected ? std::min(light.fade + fadeStep, 1.0f) : std::max(light.fade - fadeStep, 0.0f);
+        if (fade != light.fade) {
+            light.fade = fade;
+            if (lightManager) {
+                lightManager->setIntensity(light.instance, light.intensity * fade);
+            }
+        }
+
+        bool inScene = fade > 0.0f;
+        if (inScene != light.inScene) {
+            setInScene(light, inScene);
+            membershipChanges++;
+        }
+        if (inScene) {
+            m_activeLights.push_back(handle);
+            if (fade < 1.0f) {
+                fadingCount++;
+            }
+        }
+    }
+
+    resolveShadows(stats);
+
+    auto endTime = std::chrono::steady_clock::now();
+
+    // 写入统计
+    stats.lightTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    stats.pointLightCount = static_cast<uint32_t>(m_pointLights.size());
+    stats.visibleLightCount = static_cast<uint32_t>(m_candidateLights.size());
+    stats.activeLightCount = static_cast<uint32_t>(m_activeLights.size());
+    stats.fadingLightCount = fadingCount;
+    stats.lightUpdateCount = updatedCount;
+    stats.lightMembershipChanges = membershipChanges;
+}
+
+void LightSystem::collectCandidates(const math::mat4f& viewProjection)
+{
+    m_candidateLights.clear();
+
+    if (!m_cullingEnabled) {
+        for (size_t i = 0; i < m_pointLights.size(); ++i) {
+            m_pointLights.at(i).lastVisibleFrame = m_frameIndex;
+            m_candidateLights.push_back(m_pointLights.handleAt(i));
+        }
+        return;
+    }
+
+    math::frustum frustum = math::frustum::fromMatrix(viewProjection);
+
+    // BVH 按放大后的包围盒粗筛，与视锥体相交的再用影响球精确检测
+    m_bvh.queryFrustum(frustum, [this, &frustum](int32_t proxyId, bool fullyInside) {
+        LightHandle handle = m_proxyToLight[proxyId];
+        PointLight* light = m_pointLights.get(handle);
+        if (!light) {
+            return;
+        }
+
+        if (!fullyInside) {
+            math::float3 center(light->position.x, light->position.y, light->position.z);
+            if (!frustum.intersectsSphere(center, light->radius)) {
+                return;
+            }
+        }
+
+        light->lastVisibleFrame = m_frameIndex;
+        m_candidateLights.push_back(handle);
+    });
+}
+
+void LightSystem::selectLights(const math::float3& cameraPosition)
+{
+    if (m_lightBudget == 0 || m_candidateLights.size() <= m_lightBudget) {
+        for (LightHandle handle : m_candidateLights) {
+            m_pointLights.get(handle)->selected = true;
+        }
+        return;
+    }
+
+    // 上一帧已生效的光源得分上浮，排名接近的光源不会每帧来回切换
+    const float hysteresis = 1.25f;
+
+    m_rankedLights.clear();
+    for (LightHandle handle : m_candidateLights) {
+        PointLight& light = *m_pointLights.get(handle);
+        float importance = computeImportance(light, cameraPosition);
+        if (light.selected && light.inScene) {
+            importance *= hysteresis;
+        }
+        m_rankedLights.emplace_back(importance, handle);
+        light.selected = false;
+    }
+
+    // 只需要前 N 个，不需要完整排序
+    std::nth_element(m_rankedLights.begin(), m_rankedLights.begin() + m_lightBudget, m_rankedLights.end(),
+        [](const std::pair<float, LightHandle>& a, const std::pair<float, LightHandle>& b) {
+            return a.first > b.first;
+        });
+
+    for (uint32_t i = 0; i < m_lightBudget; ++i) {
+        m_pointLights.get(m_rankedLights[i].second)->selected = true;
+    }
+}
+
+void LightSystem::resolveShadows(FrameStats& stats)
+{
+    // 动态光源每帧都要重新渲染阴影；静态光源只在阴影过期时重新渲染，之后清除标记
+    m_shadowUpdates.clear();
+    uint32_t reusedCount = 0;
+
+    for (size_t i = 0; i < m_directionalLights.size(); ++i) {
+        DirectionalLight& light = m_directionalLights.at(i);
+        if (!light.shadow.castShadows) {
+            continue;
+        }
+        if (!light.shadow.isStatic || light.shadowDirty) {
+            m_shadowUpdates.push_back(m_directionalLights.handleAt(i));
+            light.shadowDirty = false;
+        } else {
+            reusedCount++;
         }
-        
-        // 移除所有点光源
-        for (const auto& light : m_pointLights) {
+    }
+
+    // 不在场景中的点光源没有阴影贴图，过期标记保留到它重新生效
+    for (LightHandle handle : m_activeLights) {
+        PointLight& light = *m_pointLights.get(handle);
+        if (!light.shadow.castShadows) {
+            continue;
+        }
+        if (!light.shadow.isStatic || light.shadowDirty) {
+            m_shadowUpdates.push_back(handle);
+            light.shadowDirty = false;
+        } else {
+            reusedCount++;
+        }
+    }
+
+    stats.shadowUpdateCount = static_cast<uint32_t>(m_shadowUpdates.size());
+    stats.shadowReuseCount = reusedCount;
+}
+
+void LightSystem::clearAllLights()
+{
+    // 移除所有方向光
+    for (const auto& light : m_directionalLights) {
+        if (m_scene) {
             m_scene->removeEntity(light.entity);
-            utils::EntityManager::get().destroy(light.entity);
         }
+        destroyLightEntity(light.entity);
     }
-    
+
+    // 移除所有点光源
+    for (auto& light : m_pointLights) {
+        setInScene(light, false);
+        destroyLightEntity(light.entity);
+    }
+
     // 清空列表
     m_directionalLights.clear();
     m_pointLights.clear();
+    m_dirtyDirectionalLights.clear();
+    m_dirtyPointLights.clear();
+    m_candidateLights.clear();
+    m_activeLights.clear();
+    m_previousActiveLights.clear();
+    m_rankedLights.clear();
+    m_shadowUpdates.clear();
+    m_bvh.clear();
+    m_proxyToLight.clear();
+    m_instancesStale = false;
+}
+
+void LightSystem::flushUpdates()
+{
+    if (m_instancesStale) {
+        refreshInstances();
+    }
+
+    if (!m_engine) {
+        m_dirtyDirectionalLights.clear();
+        m_dirtyPointLights.clear();
+        return;
+    }
+
+    auto& lightManager = m_engine->getLightManager();
+
+    for (LightHandle handle : m_dirtyDirectionalLights) {
+        DirectionalLight* light = m_directionalLights.get(handle);
+        if (!light) {
+            continue;
+        }
+
+        lightManager.setDirection(light->instance, light->direction);
+        lightManager.setColor(light->instance, light->color);
+        lightManager.setIntensity(light->instance, light->intensity);
+        light->dirty = false;
+    }
+    m_dirtyDirectionalLights.clear();
+
+    for (LightHandle handle : m_dirtyPointLights) {
+        PointLight* light = m_pointLights.get(handle);
+        if (!light) {
+            continue;
+        }
+
+        lightManager.setPosition(light->instance, light->position);
+        lightManager.setColor(light->instance, light->color);
+        lightManager.setIntensity(light->instance, light->intensity * light->fade);
+        lightManager.setFalloff(light->instance, light->radius);
+        m_bvh.moveProxy(light->proxyId, pointLightBounds(light->position, light->radius));
+        light->dirty = false;
+    }
+    m_dirtyPointLights.clear();
+}
+
+void LightSystem::refreshInstances()
+{
+    m_instancesStale = false;
+    if (!m_engine) {
+        return;
+    }
+
+    auto& lightManager = m_engine->getLightManager();
+    for (auto& light : m_directionalLights) {
+        light.instance = lightManager.getInstance(light.entity);
+    }
+    for (auto& light : m_pointLights) {
+        light.instance = lightManager.getInstance(light.entity);
+    }
+}
+
+void LightSystem::destroyLightEntity(utils::Entity entity)
+{
+    if (m_engine) {
+        m_engine->getLightManager().destroy(entity);
+        m_instancesStale = true;
+    }
+    utils::EntityManager::get().destroy(entity);
+}
+
+void LightSystem::setInScene(PointLight& light, bool inScene)
+{
+    if (light.inScene == inScene) {
+        return;
+    }
+
+    if (m_scene) {
+        if (inScene) {
+            m_scene->addEntity(light.entity);
+        } else {
+            m_scene->removeEntity(light.entity);
+        }
+    }
+    light.inScene = inScene;
+}
+
+filament::LightManager::ShadowOptions LightSystem::toShadowOptions(const ShadowSettings& shadow)
+{
+    filament::LightManager::ShadowOptions options;
+    options.mapSize = shadow.mapSize;
+
+    // 静态光源使用稳定的阴影投影，相机移动时阴影贴图的投影不随之抖动
+    options.stable = shadow.isStatic;
+    return options;
+}
+
+// 屏幕上的影响程度：亮度 × 强度 × 影响球投影尺寸的平方（相机在影响范围内时取 1）
+float LightSystem::computeImportance(const PointLight& light, const math::float3& cameraPosition)
+{
+    math::float3 position(light.position.x, light.position.y, light.position.z);
+    float distance = math::length(position - cameraPosition);
+    float coverage = light.radius / std::max(distance, light.radius);
+    float luminance = 0.2126f * light.color.x + 0.7152f * light.color.y + 0.0722f * light.color.z;
+    return luminance * light.intensity * coverage * coverage;
+}
+
+math::aabb LightSystem::pointLightBounds(const filament::math::float3& position, float radius)
+{
+    math::float3 center(position.x, position.y, position.z);
+    math::float3 extent(radius, radius, radius);
+    return math::aabb(center - extent, center + extent);
 }
 
 } // namespace Kazia
@@ -6,67 +6,180 @@
 #include <filament/LightManager.h>
 #include <filament/math.h>
 
-#include <vector>
+#include <chrono>
 #include <memory>
+#include <utility>
+#include <vector>
+
+#include "core/DynamicBVH.h"
+#include "core/Math.h"
+#include "core/SlotMap.h"
+#include "FrameStats.h"
 
 namespace Kazia {
 
+// 光源句柄，光源被移除后失效，其他光源的增删不影响它
+using LightHandle = SlotHandle;
+
+// 光源的阴影设置
+struct ShadowSettings {
+    bool castShadows = false;
+    // 静态光源不移动，使用稳定的阴影投影；阴影只在影响范围内的投射者移动或光源参数变化后才过期
+    bool isStatic = false;
+    uint32_t mapSize = 1024;
+};
+
+// 光源管理
+// 光源存放在槽位映射中，句柄稳定；参数修改先记录下来，在 update 中一次性写入 Filament。
+// 点光源按影响范围（以衰减半径为半径的球）放入动态 BVH，每帧对相机视锥体剔除，
+// 只有影响范围与视锥体相交的点光源留在 Filament 场景中，Filament 只需为这些光源做分簇（froxel）分配。
+// 设置光源预算后，可见点光源再按屏幕上的影响程度排序，只保留前 N 个，
+// 排名变化或刚进入视锥体的光源在若干帧内淡入淡出，光源数量增加时每帧的着色开销保持在预算之内。
+// 投射阴影的静态光源记录阴影是否过期：变换同步时移动的投射者通过 invalidateShadows 标记
+// 影响范围与其相交的光源，结果见 needsShadowUpdate 和帧统计。Filament 不能沿用上一帧的阴影贴图，
+// 投射阴影的光源每帧都会渲染阴影，因此光源默认不投射阴影
 class LightSystem {
 private:
     filament::Engine* m_engine;
     filament::Scene* m_scene;
-    
+
     struct DirectionalLight {
         utils::Entity entity;
+        filament::LightManager::Instance instance;
         filament::math::float3 direction;
         filament::math::float3 color;
         float intensity;
+        ShadowSettings shadow;
+        bool shadowDirty;
+        bool dirty;
     };
-    
+
     struct PointLight {
         utils::Entity entity;
+        filament::LightManager::Instance instance;
         filament::math::float3 position;
         filament::math::float3 color;
         float intensity;
         float radius;
+        int32_t proxyId;
+        uint64_t lastVisibleFrame;
+        // 淡入淡出系数，写入 Filament 的强度为 intensity * fade
+        float fade;
+        ShadowSettings shadow;
+        bool shadowDirty;
+        bool selected;
+        bool inScene;
+        bool dirty;
     };
-    
-    std::vector<DirectionalLight> m_directionalLights;
-    std::vector<PointLight> m_pointLights;
-    
+
+    SlotMap<DirectionalLight> m_directionalLights;
+    SlotMap<PointLight> m_pointLights;
+
+    // 等待写入 Filament 的光源
+    std::vector<LightHandle> m_dirtyDirectionalLights;
+    std::vector<LightHandle> m_dirtyPointLights;
+
+    // 点光源影响范围的 BVH，以代理 ID 为下标记录对应的光源
+    DynamicBVH m_bvh;
+    std::vector<LightHandle> m_proxyToLight;
+
+    // 本帧通过视锥体剔除的点光源
+    std::vector<LightHandle> m_candidateLights;
+
+    // 上一帧和本帧留在 Filament 场景中的点光源
+    std::vector<LightHandle> m_activeLights;
+    std::vector<LightHandle> m_previousActiveLights;
+
+    // 排序用的临时数组：影响程度和光源
+    std::vector<std::pair<float, LightHandle>> m_rankedLights;
+
+    // 同时生效的点光源上限，0 表示不限制
+    uint32_t m_lightBudget;
+
+    // 最近一次 update 时需要重新渲染阴影的光源
+    std::vector<LightHandle> m_shadowUpdates;
+
+    // 淡入淡出时长（秒）
+    float m_fadeDuration;
+    std::chrono::steady_clock::time_point m_lastUpdateTime;
+
+    // 销毁光源组件后，Filament 会移动其他组件的实例，缓存的实例需要重新获取
+    bool m_instancesStale;
+
+    uint64_t m_frameIndex;
+    bool m_cullingEnabled;
+
 public:
     LightSystem();
-    ~LightSystem() = default;
-    
+    ~LightSystem();
+
     // 初始化
     void initialize(filament::Engine* engine, filament::Scene* scene);
-    
-    // 添加方向光
-    void addDirectionalLight(const filament::math::float3& direction, const filament::math::float3& color, float intensity);
-    
-    // 添加点光源
-    void addPointLight(const filament::math::float3& position, const filament::math::float3& color, float intensity, float radius);
-    
-    // 移除方向光
-    void removeDirectionalLight(size_t index);
-    
-    // 移除点光源
-    void removePointLight(size_t index);
-    
-    // 更新方向光
-    void updateDirectionalLight(size_t index, const filament::math::float3& direction, const filament::math::float3& color, float intensity);
-    
-    // 更新点光源
-    void updatePointLight(size_t index, const filament::math::float3& position, const filament::math::float3& color, float intensity, float radius);
-    
+
+    // 添加方向光，方向光不参与剔除
+    LightHandle addDirectionalLight(const filament::math::float3& direction, const filament::math::float3& color, float intensity,
+        const ShadowSettings& shadow = ShadowSettings());
+
+    // 添加点光源，radius 为衰减半径
+    LightHandle addPointLight(const filament::math::float3& position, const filament::math::float3& color, float intensity, float radius,
+        const ShadowSettings& shadow = ShadowSettings());
+
+    // 移除光源，句柄无效时忽略
+    void removeDirectionalLight(LightHandle handle);
+    void removePointLight(LightHandle handle);
+
+    // 更新光源参数，在下一次 update 时写入 Filament
+    void updateDirectionalLight(LightHandle handle, const filament::math::float3& direction, const filament::math::float3& color, float intensity);
+    void updatePointLight(LightHandle handle, const filament::math::float3& position, const filament::math::float3& color, float intensity, float radius);
+    void setPointLightPosition(LightHandle handle, const filament::math::float3& position);
+
+    // 修改阴影设置，阴影随之过期
+    void setShadowSettings(LightHandle handle, const ShadowSettings& shadow);
+
+    // 世界空间中的投射者移动过（传入移动前后的包围盒），影响范围与之相交的静态光源阴影过期
+    void invalidateShadows(const math::aabb& casterBounds);
+
+    // 最近一次 update 时该光源的阴影是否需要重新渲染，动态光源始终需要
+    bool needsShadowUpdate(LightHandle handle) const;
+
+    bool isValid(LightHandle handle) const { return m_directionalLights.contains(handle) || m_pointLights.contains(handle); }
+
+    // 每帧调用：写入待更新的参数，按视锥体剔除点光源，超出预算时按影响程度筛选，并写入统计
+    void update(const math::mat4f& viewProjection, const math::float3& cameraPosition, FrameStats& stats);
+
+    // 启用/禁用点光源剔除，禁用时所有点光源都参与排序
+    void setCullingEnabled(bool enabled) { m_cullingEnabled = enabled; }
+    bool isCullingEnabled() const { return m_cullingEnabled; }
+
+    // 同时生效的点光源上限，0 表示不限制
+    void setLightBudget(uint32_t maxActiveLights) { m_lightBudget = maxActiveLights; }
+    uint32_t getLightBudget() const { return m_lightBudget; }
+
+    // 光源进出预算时的淡入淡出时长（秒），0 表示立即切换
+    void setFadeDuration(float seconds) { m_fadeDuration = seconds > 0.0f ? seconds : 0.0f; }
+    float getFadeDuration() const { return m_fadeDuration; }
+
     // 获取方向光数量
     size_t getDirectionalLightCount() const { return m_directionalLights.size(); }
-    
+
     // 获取点光源数量
     size_t getPointLightCount() const { return m_pointLights.size(); }
-    
+
     // 清理所有光源
     void clearAllLights();
+
+private:
+    void flushUpdates();
+    void refreshInstances();
+    void collectCandidates(const math::mat4f& viewProjection);
+    void selectLights(const math::float3& cameraPosition);
+    void destroyLightEntity(utils::Entity entity);
+    void setInScene(PointLight& light, bool inScene);
+    void resolveShadows(FrameStats& stats);
+
+    static filament::LightManager::ShadowOptions toShadowOptions(const ShadowSettings& shadow);
+    static math::aabb pointLightBounds(const filament::math::float3& position, float radius);
+    static float computeImportance(const PointLight& light, const math::float3& cameraPosition);
 };
 
 } // namespace Kazia
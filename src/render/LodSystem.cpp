@@ -0,0 +1,154 @@
+#include "LodSystem.h"
+#include "CullingSystem.h"
+
+#include <filament/RenderableManager.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace Kazia {
+
+LodSystem::LodSystem()
+    : m_engine(nullptr)
+    , m_enabled(true)
+{
+}
+
+void LodSystem::initialize(filament::Engine* engine)
+{
+    m_engine = engine;
+}
+
+void LodSystem::addRenderable(utils::Entity entity, const GeometryRegistry::Geometry* geometry,
+                              const math::aabb& localBounds, const math::mat4f& worldMatrix)
+{
+    if (!geometry || geometry->lodLevels.size() < 2 || hasRenderable(entity)) {
+        return;
+    }
+
+    Renderable renderable;
+    renderable.entity = entity;
+    renderable.geometry = geometry;
+    renderable.localBounds = math::sphere::fromAabb(localBounds);
+    renderable.worldBounds = math::transformSphere(worldMatrix, renderable.localBounds, &renderable.worldScale);
+    renderable.currentLevel = 0;
+
+    m_entityToIndex[entity] = m_renderables.size();
+    m_renderables.push_back(renderable);
+}
+
+void LodSystem::removeRenderable(utils::Entity entity)
+{
+    auto it = m_entityToIndex.find(entity);
+    if (it == m_entityToIndex.end()) {
+        return;
+    }
+
+    // 与最后一个交换后删除
+    size_t index = it->second;
+    m_entityToIndex.erase(it);
+    if (index + 1 != m_renderables.size()) {
+        m_renderables[index] = m_renderables.back();
+        m_entityToIndex[m_renderables[index].entity] = index;
+    }
+    m_renderables.pop_back();
+}
+
+void LodSystem::updateTransform(utils::Entity entity, const math::mat4f& worldMatrix)
+{
+    auto it = m_entityToIndex.find(entity);
+    if (it != m_entityToIndex.end()) {
+        Renderable& renderable = m_renderables[it->second];
+        renderable.worldBounds = math::transformSphere(worldMatrix, renderable.localBounds, &renderable.worldScale);
+    }
+}
+
+void LodSystem::update(const math::float3& cameraPosition, float fovYDegrees, int viewportHeight,
+                       const CullingSystem* cullingSystem, FrameStats& stats)
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    stats.lodRenderableCount = 0;
+    stats.lodSwitchCount = 0;
+    stats.lodTriangleCount = 0;
+    stats.lodFullTriangleCount = 0;
+
+    if (m_enabled && m_engine && viewportHeight > 0) {
+        // 单位距离处每单位长度的像素数，除以距离即得到任意距离处的值
+        float pixelsAtUnitDistance = LodSelector::pixelsPerUnit(1.0f, fovYDegrees, static_cast<float>(viewportHeight));
+
+        for (Renderable& renderable : m_renderables) {
+            if (cullingSystem && !cullingSystem->isVisible(renderable.entity)) {
+                continue;
+            }
+
+            // 到包围球表面的距离，相机在包围球内时使用最精细的级别
+            float distance = math::length(renderable.worldBounds.center - cameraPosition) - renderable.worldBounds.radius;
+            const std::vector<MeshLodLevel>& levels = renderable.geometry->lodLevels;
+            uint32_t level = 0;
+            if (distance > 0.0f) {
+                float pixelsPerUnit = pixelsAtUnitDistance / distance * renderable.worldScale;
+                level = m_selector.select(levels.data(), levels.size(), pixelsPerUnit, renderable.currentLevel);
+            }
+
+            if (level != renderable.currentLevel) {
+                applyLevel(renderable, level);
+                stats.lodSwitchCount++;
+            }
+
+            stats.lodRenderableCount++;
+            stats.lodTriangleCount += levels[renderable.currentLevel].indexCount / 3;
+            stats.lodFullTriangleCount += levels[0].indexCount / 3;
+        }
+    }
+
+    auto endTime = std::chrono::steady_clock::now();
+    stats.lodTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+}
+
+void LodSystem::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled) {
+        return;
+    }
+
+    m_enabled = enabled;
+    if (!m_enabled) {
+        for (Renderable& renderable : m_renderables) {
+            applyLevel(renderable, 0);
+        }
+    }
+}
+
+uint32_t LodSystem::getLevel(utils::Entity entity) const
+{
+    auto it = m_entityToIndex.find(entity);
+    return it == m_entityToIndex.end() ? 0 : m_renderables[it->second].currentLevel;
+}
+
+void LodSystem::clear()
+{
+    m_renderables.clear();
+    m_entityToIndex.clear();
+}
+
+void LodSystem::applyLevel(Renderable& renderable, uint32_t level)
+{
+    if (renderable.currentLevel == level || !m_engine) {
+        return;
+    }
+
+    // 只改变索引范围，顶点和索引缓冲区不变
+    auto& renderableManager = m_engine->getRenderableManager();
+    auto instance = renderableManager.getInstance(renderable.entity);
+    if (instance) {
+        const GeometryRegistry::Geometry& geometry = *renderable.geometry;
+        const MeshLodLevel& lod = geometry.lodLevels[level];
+        renderableManager.setGeometryAt(instance, 0, filament::RenderableManager::PrimitiveType::TRIANGLES,
+            geometry.vertexBuffer, geometry.indexBuffer, lod.indexOffset, lod.indexCount);
+    }
+    renderable.currentLevel = level;
+}
+
+} // namespace Kazia
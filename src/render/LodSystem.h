@@ -0,0 +1,82 @@
+#ifndef LODSYSTEM_H
+#define LODSYSTEM_H
+
+#include <filament/Engine.h>
+
+#include <utils/Entity.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include "core/GeometryRegistry.h"
+#include "core/Math.h"
+#include "core/MeshLod.h"
+#include "FrameStats.h"
+
+namespace Kazia {
+
+class CullingSystem;
+
+// 网格 LOD 切换
+// 带 LOD 链的可渲染对象在这里登记，每帧按包围球到相机的距离估算投影误差，为可见对象选择级别，
+// 级别变化时只改写图元的索引范围（所有级别共享同一对缓冲区）。被剔除的对象保持原级别，不参与计算
+class LodSystem {
+private:
+    filament::Engine* m_engine;
+
+    struct Renderable {
+        utils::Entity entity;
+        const GeometryRegistry::Geometry* geometry;
+        math::sphere localBounds;
+        math::sphere worldBounds;
+        // 世界矩阵的最大缩放，级别误差乘以它换算到世界空间
+        float worldScale;
+        uint32_t currentLevel;
+    };
+
+    std::vector<Renderable> m_renderables;
+    std::unordered_map<utils::Entity, size_t> m_entityToIndex;
+
+    LodSelector m_selector;
+    bool m_enabled;
+
+public:
+    LodSystem();
+    ~LodSystem() = default;
+
+    // 初始化
+    void initialize(filament::Engine* engine);
+
+    // 登记可渲染对象，geometry 的 lodLevels 少于两级时忽略；几何体必须在对象移除之后才能释放
+    void addRenderable(utils::Entity entity, const GeometryRegistry::Geometry* geometry,
+                       const math::aabb& localBounds, const math::mat4f& worldMatrix);
+    void removeRenderable(utils::Entity entity);
+    bool hasRenderable(utils::Entity entity) const { return m_entityToIndex.count(entity) != 0; }
+
+    // 更新世界变换
+    void updateTransform(utils::Entity entity, const math::mat4f& worldMatrix);
+
+    // 每帧调用（剔除之后）：为可见对象选择级别并写入统计
+    void update(const math::float3& cameraPosition, float fovYDegrees, int viewportHeight,
+                const CullingSystem* cullingSystem, FrameStats& stats);
+
+    // 禁用时所有对象恢复到第 0 级
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    LodSelector& getSelector() { return m_selector; }
+    const LodSelector& getSelector() const { return m_selector; }
+
+    uint32_t getLevel(utils::Entity entity) const;
+    size_t getRenderableCount() const { return m_renderables.size(); }
+
+    // 清理
+    void clear();
+
+private:
+    void applyLevel(Renderable& renderable, uint32_t level);
+};
+
+} // namespace Kazia
+
+#endif // LODSYSTEM_H
@@ -12,6 +12,16 @@
 #include <filament/SwapChain.h>
 
 #include "FilamentEntityMapper.h"
+#include "CullingSystem.h"
+#include "LightSystem.h"
+#include "LodSystem.h"
+#include "ClusterCullingSystem.h"
+#include "StreamingSystem.h"
+#include "GpuPicker.h"
+#include "FrameStats.h"
+#include "core/GeometryRegistry.h"
+#include "core/MeshOptimizer.h"
+#include "core/VertexFormat.h"
 
 namespace Kazia {
 
@@ -32,12 +42,61 @@ public:
     int width = 0;
     int height = 0;
     
+    // 是否使用离屏交换链
+    bool headless = false;
+    
+    // 投影参数，调整大小时只更新宽高比
+    float fov = 45.0f;
+    float nearPlane = 0.1f;
+    float farPlane = 1000.0f;
+    
     // 清除选项
     filament::Renderer::ClearOptions clearOptions;
     
     // 实体映射器
     std::unique_ptr<FilamentEntityMapper> entityMapper;
     
+    // 共享几何体注册表
+    std::unique_ptr<GeometryRegistry> geometryRegistry;
+    
+    // CPU 视锥体剔除
+    std::unique_ptr<CullingSystem> cullingSystem;
+    
+    // 光源管理和点光源剔除
+    std::unique_ptr<LightSystem> lightSystem;
+    
+    // 网格 LOD 切换
+    std::unique_ptr<LodSystem> lodSystem;
+    
+    // 大型网格的分簇剔除
+    std::unique_ptr<ClusterCullingSystem> clusterCullingSystem;
+    
+    // 流式网格的分级载入和淘汰
+    std::unique_ptr<StreamingSystem> streamingSystem;
+    
+    // 导入网格时执行顶点缓存/过度绘制/顶点读取优化
+    bool optimizeMeshes = true;
+    MeshOptimizer::Options meshOptimizerOptions;
+    
+    // 第 0 级三角形数不少于该值的导入网格划分为分簇，0 表示不划分
+    uint32_t clusterMinTriangles = 16384;
+    MeshletSet::Options meshletOptions;
+    
+    // 流式网格的驻留预算和 I/O 线程数，在场景初始化时生效
+    MeshStreamer::Options streamingOptions;
+    
+    // 导入网格上传时使用的顶点格式
+    VertexFormat vertexFormat = VertexFormat::Float;
+    
+    // LOD 链的磁盘缓存（由资产管理持有），为空时每次导入都重新生成
+    MeshLodCache* lodCache = nullptr;
+    
+    // GPU 拾取
+    std::unique_ptr<GpuPicker> gpuPicker;
+    
+    // 帧统计
+    FrameStats frameStats;
+    
     // 检查是否有效
     bool isValid() const {
         return engine != nullptr && renderer != nullptr && scene != nullptr && view != nullptr && camera != nullptr;
@@ -0,0 +1,32 @@
+#include "RenderSnapshot.h"
+
+#include "scene/Node.h"
+
+namespace Kazia {
+
+void RenderSnapshot::captureTransforms(const Node* root) {
+    if (!root) {
+        return;
+    }
+
+    std::vector<const Node*> stack;
+    stack.push_back(root);
+    while (!stack.empty()) {
+        const Node* node = stack.back();
+        stack.pop_back();
+
+        transforms.push_back({node->getUUID(), node->getWorldMatrix()});
+        for (size_t i = 0; i < node->getChildCount(); ++i) {
+            stack.push_back(node->getChild(i));
+        }
+    }
+}
+
+void RenderSnapshot::captureChangedTransforms(const std::vector<Node*>& changedNodes) {
+    transforms.reserve(transforms.size() + changedNodes.size());
+    for (const Node* node : changedNodes) {
+        transforms.push_back({node->getUUID(), node->getWorldMatrix()});
+    }
+}
+
+} // namespace Kazia
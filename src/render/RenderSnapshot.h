@@ -0,0 +1,50 @@
+#ifndef RENDERSNAPSHOT_H
+#define RENDERSNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/Math.h"
+
+namespace Kazia {
+
+class Node;
+
+// 一帧渲染所需的场景状态
+// 由主线程填写并发布，渲染线程只读；渲染线程不再访问 Node 等主线程对象
+struct RenderSnapshot {
+    // 主线程发布序号
+    uint64_t sequence = 0;
+
+    // 视口大小
+    int width = 0;
+    int height = 0;
+
+    // 相机
+    math::float3 cameraPosition = {0.0f, 0.0f, 5.0f};
+    math::float3 cameraTarget = {0.0f, 0.0f, 0.0f};
+    math::float3 cameraUp = {0.0f, 1.0f, 0.0f};
+    float fov = 45.0f;
+    float nearPlane = 0.1f;
+    float farPlane = 1000.0f;
+
+    // 节点世界变换，按节点 UUID 对应到渲染实体
+    struct NodeTransform {
+        std::string nodeUUID;
+        math::mat4f worldMatrix;
+    };
+
+    // 自上一份快照以来变化的节点变换，按顺序应用（同一节点后面的覆盖前面的）
+    std::vector<NodeTransform> transforms;
+
+    // 采集 root 及其所有后代的世界变换（用于首帧或层级结构变化后全量同步）
+    void captureTransforms(const Node* root);
+
+    // 只采集本次更新中变化的节点，通常传入 Scene::getChangedNodes()
+    void captureChangedTransforms(const std::vector<Node*>& changedNodes);
+};
+
+} // namespace Kazia
+
+#endif // RENDERSNAPSHOT_H
@@ -0,0 +1,175 @@
+#include "RenderThread.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace Kazia {
+
+RenderThread::RenderThread()
+    : m_stop(false)
+    , m_hasPendingSnapshot(false)
+    , m_nextSequence(1)
+    , m_renderedFrames(0)
+    , m_frameTimes{}
+    , m_frameIntervals{}
+    , m_frameTimeCursor(0)
+    , m_frameTimeSamples(0)
+    , m_lastFrameStart()
+{
+}
+
+RenderThread::~RenderThread()
+{
+    stop();
+}
+
+void RenderThread::start(FrameCallback onFrame)
+{
+    if (isRunning()) {
+        return;
+    }
+
+    m_onFrame = std::move(onFrame);
+    m_stop = false;
+    m_thread = std::thread(&RenderThread::run, this);
+}
+
+void RenderThread::stop()
+{
+    if (!isRunning()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_one();
+    m_thread.join();
+
+    // 线程退出后剩余的快照不再渲染
+    m_hasPendingSnapshot = false;
+}
+
+void RenderThread::post(Command command)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_commands.push_back(std::move(command));
+    }
+    m_condition.notify_one();
+}
+
+RenderSnapshot& RenderThread::beginSnapshot()
+{
+    m_writeSnapshot.transforms.clear();
+    return m_writeSnapshot;
+}
+
+void RenderThread::publishSnapshot()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // 被替换的快照中的变换放在前面，新快照中同一节点的变换会覆盖它们
+        if (m_hasPendingSnapshot && !m_pendingSnapshot.transforms.empty()) {
+            m_writeSnapshot.transforms.insert(m_writeSnapshot.transforms.begin(),
+                std::make_move_iterator(m_pendingSnapshot.transforms.begin()),
+                std::make_move_iterator(m_pendingSnapshot.transforms.end()));
+        }
+
+        m_writeSnapshot.sequence = m_nextSequence++;
+        std::swap(m_writeSnapshot, m_pendingSnapshot);
+        m_hasPendingSnapshot = true;
+    }
+    m_condition.notify_one();
+}
+
+bool RenderThread::hasPendingSnapshot()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hasPendingSnapshot;
+}
+
+FrameTiming RenderThread::getFrameTiming() const
+{
+    FrameTiming timing;
+    timing.frameCount = getRenderedFrameCount();
+
+    std::lock_guard<std::mutex> lock(m_timingMutex);
+    if (m_frameTimeSamples == 0) {
+        return timing;
+    }
+
+    double totalTime = 0.0;
+    double totalInterval = 0.0;
+    for (size_t i = 0; i < m_frameTimeSamples; ++i) {
+        totalTime += m_frameTimes[i];
+        totalInterval += m_frameIntervals[i];
+        timing.maxFrameMs = std::max(timing.maxFrameMs, m_frameTimes[i]);
+    }
+    timing.lastFrameMs = m_frameTimes[(m_frameTimeCursor + FRAME_TIME_HISTORY - 1) % FRAME_TIME_HISTORY];
+    timing.averageFrameMs = totalTime / static_cast<double>(m_frameTimeSamples);
+    timing.averageIntervalMs = totalInterval / static_cast<double>(m_frameTimeSamples);
+    return timing;
+}
+
+void RenderThread::recordFrameTime(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    std::lock_guard<std::mutex> lock(m_timingMutex);
+    double interval = m_frameTimeSamples > 0 ? Milliseconds(start - m_lastFrameStart).count() : 0.0;
+    m_frameTimes[m_frameTimeCursor] = Milliseconds(end - start).count();
+    m_frameIntervals[m_frameTimeCursor] = interval;
+    m_frameTimeCursor = (m_frameTimeCursor + 1) % FRAME_TIME_HISTORY;
+    m_frameTimeSamples = std::min(m_frameTimeSamples + 1, FRAME_TIME_HISTORY);
+    m_lastFrameStart = start;
+}
+
+void RenderThread::run()
+{
+    std::vector<Command> commands;
+
+    while (true) {
+        bool hasSnapshot = false;
+        bool stopping = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() {
+                return m_stop || !m_commands.empty() || m_hasPendingSnapshot;
+            });
+
+            commands.swap(m_commands);
+            if (m_hasPendingSnapshot && !m_stop) {
+                std::swap(m_pendingSnapshot, m_readSnapshot);
+                m_hasPendingSnapshot = false;
+                hasSnapshot = true;
+            }
+            stopping = m_stop;
+        }
+
+        // 命令在渲染前执行，例如初始化必须先于第一帧
+        for (Command& command : commands) {
+            command();
+        }
+        commands.clear();
+
+        if (hasSnapshot && m_onFrame) {
+            auto frameStart = std::chrono::steady_clock::now();
+            m_onFrame(m_readSnapshot);
+            recordFrameTime(frameStart, std::chrono::steady_clock::now());
+            m_renderedFrames.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (stopping) {
+            // 退出前再执行一次在设置停止标志之后才投递的命令
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_commands.empty()) {
+                break;
+            }
+        }
+    }
+}
+
+} // namespace Kazia
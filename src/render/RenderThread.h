@@ -0,0 +1,97 @@
+#ifndef RENDERTHREAD_H
+#define RENDERTHREAD_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "RenderSnapshot.h"
+#include "FrameStats.h"
+
+namespace Kazia {
+
+// 专用渲染线程
+// Filament 引擎只能在创建它的线程上使用，因此初始化、关闭以及所有渲染器调用都以命令形式投递到这里执行。
+// 主线程每帧填写自己持有的快照并发布，渲染线程取走最新一份后渲染，两边互不等待：
+// 主线程发布只需交换指针大小的数据，渲染线程渲染时不持有锁
+class RenderThread {
+public:
+    using Command = std::function<void()>;
+    using FrameCallback = std::function<void(const RenderSnapshot&)>;
+
+    RenderThread();
+    ~RenderThread();
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // 启动线程，每取到一份新快照调用一次 onFrame
+    void start(FrameCallback onFrame);
+
+    // 执行完已投递的命令后退出并等待线程结束
+    void stop();
+
+    bool isRunning() const { return m_thread.joinable(); }
+
+    // 投递在渲染线程上执行的命令，按投递顺序执行，且先于同一时刻发布的快照
+    void post(Command command);
+
+    // 主线程：取得可写快照，变换列表已清空，其余字段需要重新填写
+    RenderSnapshot& beginSnapshot();
+
+    // 主线程：发布 beginSnapshot 返回的快照
+    // 上一份快照尚未被渲染线程取走时直接被替换，但其中的变换会合并进新快照，保证增量不丢失
+    void publishSnapshot();
+
+    // 已发布的快照是否还未被渲染线程取走，主线程可据此推迟下一次发布
+    bool hasPendingSnapshot();
+
+    // 已渲染的帧数
+    uint64_t getRenderedFrameCount() const { return m_renderedFrames.load(std::memory_order_relaxed); }
+
+    // 最近若干帧的帧时间统计
+    FrameTiming getFrameTiming() const;
+
+private:
+    void run();
+    void recordFrameTime(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stop;
+
+    FrameCallback m_onFrame;
+
+    // 待执行的命令
+    std::vector<Command> m_commands;
+
+    // 双缓冲快照：主线程只写 m_writeSnapshot，渲染线程只读 m_readSnapshot，
+    // 二者通过受锁保护的 m_pendingSnapshot 交换，交换后缓冲区复用，不重新分配
+    RenderSnapshot m_writeSnapshot;
+    RenderSnapshot m_pendingSnapshot;
+    RenderSnapshot m_readSnapshot;
+    bool m_hasPendingSnapshot;
+    uint64_t m_nextSequence;
+
+    std::atomic<uint64_t> m_renderedFrames;
+
+    // 帧时间环形缓冲区，渲染线程写入，其他线程通过 getFrameTiming 读取
+    static constexpr size_t FRAME_TIME_HISTORY = 120;
+    mutable std::mutex m_timingMutex;
+    std::array<double, FRAME_TIME_HISTORY> m_frameTimes;
+    std::array<double, FRAME_TIME_HISTORY> m_frameIntervals;
+    size_t m_frameTimeCursor;
+    size_t m_frameTimeSamples;
+    std::chrono::steady_clock::time_point m_lastFrameStart;
+};
+
+} // namespace Kazia
+
+#endif // RENDERTHREAD_H
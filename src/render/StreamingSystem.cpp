@@ -0,0 +1,325 @@
+#include "StreamingSystem.h"
+#include "CullingSystem.h"
+#include "FilamentEntityMapper.h"
+
+#include <filament/RenderableManager.h>
+#include <filament/TransformManager.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace Kazia {
+
+StreamingSystem::StreamingSystem()
+    : m_engine(nullptr)
+    , m_entityMapper(nullptr)
+    , m_vertexFormat(VertexFormat::Float)
+{
+}
+
+StreamingSystem::~StreamingSystem()
+{
+    clear();
+}
+
+void StreamingSystem::initialize(filament::Engine* engine, FilamentEntityMapper* entityMapper, const MeshStreamer::Options& options)
+{
+    m_engine = engine;
+    m_entityMapper = entityMapper;
+    m_streamer = std::make_unique<MeshStreamer>(options);
+}
+
+const GeometryRegistry::Geometry* StreamingSystem::acquireMesh(const std::string& path)
+{
+    if (!m_engine || !m_streamer) {
+        return nullptr;
+    }
+
+    auto existing = m_pathToMesh.find(path);
+    if (existing != m_pathToMesh.end()) {
+        StreamedMesh& mesh = m_meshes.at(existing->second);
+        mesh.refCount++;
+        return &mesh.levels[m_streamer->getPinnedLevel(mesh.handle)];
+    }
+
+    // 最粗的一级同步读入并上传，对象创建后立即有可以绘制的数据
+    MeshData coarsest;
+    MeshStreamer::MeshHandle handle = m_streamer->addMesh(path, coarsest);
+    if (!handle.isValid()) {
+        return nullptr;
+    }
+
+    const MeshStreamFile* file = m_streamer->getFile(handle);
+    StreamedMesh mesh;
+    mesh.path = path;
+    mesh.handle = handle;
+    for (const MeshStreamFile::Level& level : file->getLevels()) {
+        MeshLodLevel lod;
+        lod.indexCount = level.indexCount;
+        lod.error = level.error;
+        mesh.lodLevels.push_back(lod);
+    }
+    mesh.levels.resize(file->getLevelCount());
+    math::float3 center = file->getBounds().center();
+    math::float3 halfExtent = file->getBounds().extent();
+    mesh.boundingBox = {{center.x, center.y, center.z}, {halfExtent.x, halfExtent.y, halfExtent.z}};
+    mesh.refCount = 1;
+
+    uint32_t pinnedLevel = m_streamer->getPinnedLevel(handle);
+    if (!uploadLevel(mesh, pinnedLevel, coarsest)) {
+        m_streamer->removeMesh(handle);
+        return nullptr;
+    }
+
+    m_pathToMesh[path] = handle.index;
+    StreamedMesh& inserted = m_meshes.emplace(handle.index, std::move(mesh)).first->second;
+    return &inserted.levels[pinnedLevel];
+}
+
+void StreamingSystem::addRenderable(utils::Entity entity, const std::string& path, const math::mat4f& worldMatrix)
+{
+    auto it = m_pathToMesh.find(path);
+    if (it == m_pathToMesh.end() || hasRenderable(entity)) {
+        return;
+    }
+
+    const StreamedMesh& mesh = m_meshes.at(it->second);
+    const filament::Box& box = mesh.boundingBox;
+    uint32_t pinnedLevel = m_streamer->getPinnedLevel(mesh.handle);
+
+    Renderable renderable;
+    renderable.entity = entity;
+    renderable.mesh = it->second;
+    renderable.worldMatrix = worldMatrix;
+    renderable.localBounds = math::sphere(math::float3(box.center.x, box.center.y, box.center.z),
+                                          math::length(math::float3(box.halfExtent.x, box.halfExtent.y, box.halfExtent.z)));
+    renderable.worldBounds = math::transformSphere(worldMatrix, renderable.localBounds, &renderable.worldScale);
+    renderable.desiredLevel = pinnedLevel;
+    renderable.displayedLevel = pinnedLevel;
+
+    m_entityToIndex[entity] = m_renderables.size();
+    m_renderables.push_back(renderable);
+}
+
+void StreamingSystem::removeRenderable(utils::Entity entity)
+{
+    auto it = m_entityToIndex.find(entity);
+    if (it == m_entityToIndex.end()) {
+        return;
+    }
+
+    // 与最后一个交换后删除
+    size_t index = it->second;
+    uint32_t meshIndex = m_renderables[index].mesh;
+    m_entityToIndex.erase(it);
+    if (index + 1 != m_renderables.size()) {
+        m_renderables[index] = m_renderables.back();
+        m_entityToIndex[m_renderables[index].entity] = index;
+    }
+    m_renderables.pop_back();
+
+    // 最后一个使用者移除后关闭文件，销毁所有级别
+    StreamedMesh& mesh = m_meshes.at(meshIndex);
+    if (--mesh.refCount > 0) {
+        return;
+    }
+    for (GeometryRegistry::Geometry& geometry : mesh.levels) {
+        destroyLevel(geometry);
+    }
+    m_streamer->removeMesh(mesh.handle);
+    m_pathToMesh.erase(mesh.path);
+    m_meshes.erase(meshIndex);
+}
+
+void StreamingSystem::updateTransform(utils::Entity entity, const math::mat4f& worldMatrix)
+{
+    auto it = m_entityToIndex.find(entity);
+    if (it != m_entityToIndex.end()) {
+        Renderable& renderable = m_renderables[it->second];
+        renderable.worldMatrix = worldMatrix;
+        renderable.worldBounds = math::transformSphere(worldMatrix, renderable.localBounds, &renderable.worldScale);
+    }
+}
+
+void StreamingSystem::update(const math::float3& cameraPosition, float fovYDegrees, int viewportHeight,
+                             const CullingSystem* cullingSystem, FrameStats& stats)
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    stats.streamRenderableCount = static_cast<uint32_t>(m_renderables.size());
+    stats.streamWaitingCount = 0;
+    stats.streamLoadCount = 0;
+    stats.streamEvictionCount = 0;
+
+    if (m_engine && m_streamer && viewportHeight > 0) {
+        // 可见对象请求目标级别：误差按投影到屏幕上的像素选择，优先级为包围球投影到屏幕上的半径
+        float pixelsAtUnitDistance = LodSelector::pixelsPerUnit(1.0f, fovYDegrees, static_cast<float>(viewportHeight));
+        for (Renderable& renderable : m_renderables) {
+            if (cullingSystem && !cullingSystem->isVisible(renderable.entity)) {
+                continue;
+            }
+
+            const StreamedMesh& mesh = m_meshes.at(renderable.mesh);
+            float centerDistance = math::length(renderable.worldBounds.center - cameraPosition);
+            float distance = centerDistance - renderable.worldBounds.radius;
+            uint32_t level = 0;
+            if (distance > 0.0f) {
+                float pixelsPerUnit = pixelsAtUnitDistance / distance * renderable.worldScale;
+                level = m_selector.select(mesh.lodLevels.data(), mesh.lodLevels.size(), pixelsPerUnit, renderable.desiredLevel);
+            }
+            renderable.desiredLevel = level;
+
+            float priority = renderable.worldBounds.radius * pixelsAtUnitDistance / std::max(centerDistance, 1e-3f);
+            m_streamer->request(mesh.handle, level, priority);
+        }
+
+        // 上传到达的级别；淘汰的级别先从网格上摘下，所有对象改用已驻留的级别之后再销毁
+        m_events.clear();
+        m_streamer->update(m_events);
+        std::vector<GeometryRegistry::Geometry> retired;
+        for (MeshStreamer::Event& event : m_events) {
+            auto it = m_meshes.find(event.mesh.index);
+            if (it == m_meshes.end()) {
+                continue;
+            }
+            StreamedMesh& mesh = it->second;
+            if (event.type == MeshStreamer::Event::Type::Loaded) {
+                if (!mesh.levels[event.level].vertexBuffer && uploadLevel(mesh, event.level, event.data)) {
+                    stats.streamLoadCount++;
+                }
+            } else {
+                retired.push_back(mesh.levels[event.level]);
+                mesh.levels[event.level] = GeometryRegistry::Geometry();
+                stats.streamEvictionCount++;
+            }
+        }
+
+        for (Renderable& renderable : m_renderables) {
+            const StreamedMesh& mesh = m_meshes.at(renderable.mesh);
+            uint32_t level = pickLevel(mesh, renderable.desiredLevel);
+            if (level != renderable.displayedLevel) {
+                applyLevel(renderable, level);
+            }
+            if (level != renderable.desiredLevel && (!cullingSystem || cullingSystem->isVisible(renderable.entity))) {
+                stats.streamWaitingCount++;
+            }
+        }
+
+        for (GeometryRegistry::Geometry& geometry : retired) {
+            destroyLevel(geometry);
+        }
+    }
+
+    if (m_streamer) {
+        const MeshStreamer::Stats& streamerStats = m_streamer->getStats();
+        stats.streamPendingCount = static_cast<uint32_t>(streamerStats.pendingRequests);
+        stats.streamResidentBytes = streamerStats.residentBytes + streamerStats.inflightBytes;
+        stats.streamBudgetBytes = m_streamer->getBudget();
+    }
+
+    auto endTime = std::chrono::steady_clock::now();
+    stats.streamTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+}
+
+uint32_t StreamingSystem::getLevel(utils::Entity entity) const
+{
+    auto it = m_entityToIndex.find(entity);
+    return it == m_entityToIndex.end() ? 0 : m_renderables[it->second].displayedLevel;
+}
+
+void StreamingSystem::clear()
+{
+    for (auto& item : m_meshes) {
+        for (GeometryRegistry::Geometry& geometry : item.second.levels) {
+            destroyLevel(geometry);
+        }
+        if (m_streamer) {
+            m_streamer->removeMesh(item.second.handle);
+        }
+    }
+    m_meshes.clear();
+    m_pathToMesh.clear();
+    m_renderables.clear();
+    m_entityToIndex.clear();
+}
+
+bool StreamingSystem::uploadLevel(StreamedMesh& mesh, uint32_t level, const MeshData& data)
+{
+    if (data.positions.empty() || data.indices.empty()) {
+        return false;
+    }
+
+    // 每一级都有独立的顶点和索引缓冲区；包围盒使用整个网格的，级别切换时剔除结果不变
+    PackedVertices packed = packVertices(data, m_vertexFormat);
+    bool shortIndices = MeshOptimizer::fitsShortIndices(data.positions.size());
+
+    GeometryRegistry::Geometry& geometry = mesh.levels[level];
+    geometry.vertexCount = static_cast<uint32_t>(data.positions.size());
+    geometry.indexCount = static_cast<uint32_t>(data.indices.size());
+    geometry.boundingBox = mesh.boundingBox;
+    geometry.dequantizeScale = packed.dequantizeScale;
+    geometry.dequantizeOffset = packed.dequantizeOffset;
+    geometry.vertexBuffer = GeometryRegistry::buildVertexBuffer(m_engine, packed);
+    geometry.indexBuffer = GeometryRegistry::buildIndexBuffer(m_engine, data.indices.data(), data.indices.size(), shortIndices);
+    geometry.byteSize = packed.data.size() + data.indices.size() * (shortIndices ? sizeof(uint16_t) : sizeof(uint32_t));
+    return true;
+}
+
+void StreamingSystem::destroyLevel(GeometryRegistry::Geometry& geometry)
+{
+    if (m_engine) {
+        if (geometry.vertexBuffer) {
+            m_engine->destroy(geometry.vertexBuffer);
+        }
+        if (geometry.indexBuffer) {
+            m_engine->destroy(geometry.indexBuffer);
+        }
+    }
+    geometry = GeometryRegistry::Geometry();
+}
+
+void StreamingSystem::applyLevel(Renderable& renderable, uint32_t level)
+{
+    const GeometryRegistry::Geometry& geometry = m_meshes.at(renderable.mesh).levels[level];
+    auto& renderableManager = m_engine->getRenderableManager();
+    auto instance = renderableManager.getInstance(renderable.entity);
+    if (instance) {
+        renderableManager.setGeometryAt(instance, 0, filament::RenderableManager::PrimitiveType::TRIANGLES,
+            geometry.vertexBuffer, geometry.indexBuffer, 0, geometry.indexCount);
+        renderableManager.setAxisAlignedBoundingBox(instance, geometry.getQuantizedBox());
+    }
+
+    // 各级的量化范围不同，提交给 Filament 的变换随级别更新
+    math::mat4f dequantize = geometry.getDequantizeMatrix();
+    math::mat4f matrix = math::multiply(renderable.worldMatrix, dequantize);
+    filament::math::mat4f filaMatrix;
+    for (int i = 0; i < 16; i++) {
+        filaMatrix[i] = matrix.m[i];
+    }
+    auto& transformManager = m_engine->getTransformManager();
+    if (transformManager.hasComponent(renderable.entity)) {
+        transformManager.setTransform(transformManager.getInstance(renderable.entity), filaMatrix);
+    }
+    if (m_entityMapper) {
+        m_entityMapper->setLocalTransform(renderable.entity, dequantize);
+    }
+    renderable.displayedLevel = level;
+}
+
+uint32_t StreamingSystem::pickLevel(const StreamedMesh& mesh, uint32_t desiredLevel)
+{
+    // 离目标最近的已驻留级别，距离相同时取更精细的；最粗的一级常驻，总能找到
+    uint32_t best = static_cast<uint32_t>(mesh.levels.size() - 1);
+    uint32_t bestDistance = ~0u;
+    for (uint32_t level = 0; level < mesh.levels.size(); ++level) {
+        uint32_t distance = level > desiredLevel ? level - desiredLevel : desiredLevel - level;
+        if (mesh.levels[level].vertexBuffer && distance < bestDistance) {
+            best = level;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+} // namespace Kazia
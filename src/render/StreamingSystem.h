@@ -0,0 +1,115 @@
+#ifndef STREAMINGSYSTEM_H
+#define STREAMINGSYSTEM_H
+
+#include <filament/Engine.h>
+
+#include <utils/Entity.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/GeometryRegistry.h"
+#include "core/Math.h"
+#include "core/MeshLod.h"
+#include "core/MeshStreamer.h"
+#include "core/VertexFormat.h"
+#include "FrameStats.h"
+
+namespace Kazia {
+
+class CullingSystem;
+class FilamentEntityMapper;
+
+// 流式网格
+// 网格数据不常驻内存，从流式缓存文件（见 MeshStream.h）按需分页载入。每个网格先绘制常驻的最粗一级；
+// 每帧按投影误差为可见对象选择目标级别，按投影到屏幕上的半径作为优先级向 MeshStreamer 请求，
+// 数据到达后上传为该级独立的缓冲区并切换图元；超出预算被淘汰的级别销毁缓冲区，对象改用最接近的已驻留级别。
+// 相同路径的网格在对象之间共享，这些对象不登记到 LodSystem
+class StreamingSystem {
+private:
+    filament::Engine* m_engine;
+    FilamentEntityMapper* m_entityMapper;
+    VertexFormat m_vertexFormat;
+    std::unique_ptr<MeshStreamer> m_streamer;
+
+    struct StreamedMesh {
+        std::string path;
+        MeshStreamer::MeshHandle handle;
+        std::vector<MeshLodLevel> lodLevels;                // 各级误差，用于级别选择
+        std::vector<GeometryRegistry::Geometry> levels;     // vertexBuffer 为空表示该级未驻留
+        filament::Box boundingBox;                          // 整个网格（第 0 级）的包围盒
+        int refCount;
+    };
+
+    // 以 MeshStreamer 句柄的槽位下标为键
+    std::unordered_map<uint32_t, StreamedMesh> m_meshes;
+    std::unordered_map<std::string, uint32_t> m_pathToMesh;
+
+    struct Renderable {
+        utils::Entity entity;
+        uint32_t mesh;
+        math::mat4f worldMatrix;
+        math::sphere localBounds;
+        math::sphere worldBounds;
+        float worldScale;
+        uint32_t desiredLevel;
+        uint32_t displayedLevel;
+    };
+
+    std::vector<Renderable> m_renderables;
+    std::unordered_map<utils::Entity, size_t> m_entityToIndex;
+
+    LodSelector m_selector;
+    std::vector<MeshStreamer::Event> m_events;
+
+public:
+    StreamingSystem();
+    ~StreamingSystem();
+
+    StreamingSystem(const StreamingSystem&) = delete;
+    StreamingSystem& operator=(const StreamingSystem&) = delete;
+
+    // 初始化，entityMapper 用于记录各级的反量化变换（可以为空）
+    void initialize(filament::Engine* engine, FilamentEntityMapper* entityMapper, const MeshStreamer::Options& options);
+
+    // 上传的顶点格式，只影响之后载入的级别
+    void setVertexFormat(VertexFormat format) { m_vertexFormat = format; }
+
+    // 打开流式文件（相同路径共享）并增加引用，返回最粗一级的几何体，用它创建可渲染对象后调用 addRenderable；
+    // 失败时返回 nullptr
+    const GeometryRegistry::Geometry* acquireMesh(const std::string& path);
+
+    // 登记使用 path 的可渲染对象，移除时释放 acquireMesh 增加的引用
+    void addRenderable(utils::Entity entity, const std::string& path, const math::mat4f& worldMatrix);
+    void removeRenderable(utils::Entity entity);
+    bool hasRenderable(utils::Entity entity) const { return m_entityToIndex.count(entity) != 0; }
+
+    // 更新世界变换
+    void updateTransform(utils::Entity entity, const math::mat4f& worldMatrix);
+
+    // 每帧调用（剔除之后）：请求可见对象的目标级别，上传到达的数据，处理淘汰并写入统计
+    void update(const math::float3& cameraPosition, float fovYDegrees, int viewportHeight,
+                const CullingSystem* cullingSystem, FrameStats& stats);
+
+    LodSelector& getSelector() { return m_selector; }
+    MeshStreamer* getStreamer() { return m_streamer.get(); }
+    const MeshStreamer* getStreamer() const { return m_streamer.get(); }
+
+    uint32_t getLevel(utils::Entity entity) const;
+    size_t getRenderableCount() const { return m_renderables.size(); }
+
+    // 清理（销毁所有级别的缓冲区，关闭所有文件）
+    void clear();
+
+private:
+    bool uploadLevel(StreamedMesh& mesh, uint32_t level, const MeshData& data);
+    void destroyLevel(GeometryRegistry::Geometry& geometry);
+    void applyLevel(Renderable& renderable, uint32_t level);
+    static uint32_t pickLevel(const StreamedMesh& mesh, uint32_t desiredLevel);
+};
+
+} // namespace Kazia
+
+#endif // STREAMINGSYSTEM_H
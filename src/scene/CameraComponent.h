@@ -39,13 +39,13 @@ public:
     
     // 相机参数相关
     float getFOV() const { return m_fov; }
-    void setFOV(float fov) { m_fov = fov; }
+    void setFOV(float fov) { m_fov = fov; markModified(); }
     
     float getNear() const { return m_near; }
-    void setNear(float near) { m_near = near; }
+    void setNear(float near) { m_near = near; markModified(); }
     
     float getFar() const { return m_far; }
-    void setFar(float far) { m_far = far; }
+    void setFar(float far) { m_far = far; markModified(); }
     
     // 生命周期方法
     void initialize() override;
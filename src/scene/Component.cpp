@@ -1,8 +1,16 @@
 #include "Component.h"
+#include "Node.h"
 
 namespace Kazia {
 
-Component::Component() {
+Component::Component() : m_owner(nullptr) {
+}
+
+const std::string& Component::getUUID() const {
+    if (!m_uuid.empty()) {
+        return m_uuid;
+    }
+    
     // 生成 UUID
     char uuid_str[37];
     #ifdef _WIN32
@@ -25,8 +33,13 @@ Component::Component() {
         uuid_unparse(uuid, uuid_str);
     #endif
     m_uuid = uuid_str;
-    
-    m_owner = nullptr;
+    return m_uuid;
+}
+
+void Component::markModified() {
+    if (m_owner) {
+        m_owner->markModified();
+    }
 }
 
 } // namespace Kazia
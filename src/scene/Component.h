@@ -15,15 +15,16 @@ class Node;
 
 class Component {
 private:
-    std::string m_uuid;
+    // 首次访问时生成，大量创建组件（如载入场景）时不必为每个组件生成 UUID
+    mutable std::string m_uuid;
     Node* m_owner;
     
 public:
     Component();
     virtual ~Component() = default;
     
-    // UUID 相关
-    const std::string& getUUID() const { return m_uuid; }
+    // UUID 相关（首次调用时生成，不能在多个线程中同时首次调用）
+    const std::string& getUUID() const;
     
     // 所有者相关
     Node* getOwner() const { return m_owner; }
@@ -34,6 +35,10 @@ public:
     virtual void update() {}
     virtual void render() {}
     virtual void shutdown() {}
+    
+protected:
+    // 需要保存的属性变化后调用，记录到所属节点的修改跟踪中
+    void markModified();
 };
 
 } // namespace Kazia
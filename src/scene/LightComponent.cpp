@@ -8,7 +8,9 @@ LightComponent::LightComponent()
       m_color({1.0f, 1.0f, 1.0f}), 
       m_intensity(1.0f), 
       m_direction({0.0f, -1.0f, 0.0f}), 
-      m_radius(10.0f) {
+      m_radius(10.0f), 
+      m_castShadows(false), 
+      m_static(false) {
 }
 
 void LightComponent::initialize() {
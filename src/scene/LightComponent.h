@@ -35,6 +35,10 @@ private:
     // 点光源参数
     float m_radius;
     
+    // 阴影
+    bool m_castShadows;
+    bool m_static;
+    
 public:
     LightComponent();
     ~LightComponent() override = default;
@@ -45,22 +49,30 @@ public:
     
     // 光源类型相关
     LightManager::Type getLightType() const { return m_lightType; }
-    void setLightType(LightManager::Type type) { m_lightType = type; }
+    void setLightType(LightManager::Type type) { m_lightType = type; markModified(); }
     
     // 通用参数
     const math::float3& getColor() const { return m_color; }
-    void setColor(const math::float3& color) { m_color = color; }
+    void setColor(const math::float3& color) { m_color = color; markModified(); }
     
     float getIntensity() const { return m_intensity; }
-    void setIntensity(float intensity) { m_intensity = intensity; }
+    void setIntensity(float intensity) { m_intensity = intensity; markModified(); }
     
     // 方向光参数
     const math::float3& getDirection() const { return m_direction; }
-    void setDirection(const math::float3& direction) { m_direction = direction; }
+    void setDirection(const math::float3& direction) { m_direction = direction; markModified(); }
     
     // 点光源参数
     float getRadius() const { return m_radius; }
-    void setRadius(float radius) { m_radius = radius; }
+    void setRadius(float radius) { m_radius = radius; markModified(); }
+    
+    // 阴影参数
+    bool getCastShadows() const { return m_castShadows; }
+    void setCastShadows(bool castShadows) { m_castShadows = castShadows; markModified(); }
+    
+    // 静态光源不移动，使用稳定的阴影投影，阴影只在影响范围内的投射者移动后才标记为过期
+    bool isStatic() const { return m_static; }
+    void setStatic(bool isStatic) { m_static = isStatic; markModified(); }
     
     // 生命周期方法
     void initialize() override;
@@ -1,4 +1,5 @@
 #include "MeshComponent.h"
+#include "Node.h"
 
 namespace Kazia {
 
@@ -12,6 +13,24 @@ void MeshComponent::initialize() {
     m_meshEntity = 1;
 }
 
+void MeshComponent::setBounds(const math::aabb& bounds) {
+    m_bounds = bounds;
+    markModified();
+    
+    // 同步到节点
+    if (getOwner()) {
+        getOwner()->setLocalBounds(bounds);
+    }
+}
+
+void MeshComponent::setTriangleBVH(std::shared_ptr<const TriangleBVH> triangleBvh) {
+    m_triangleBvh = std::move(triangleBvh);
+    
+    if (m_triangleBvh) {
+        setBounds(m_triangleBvh->getBounds());
+    }
+}
+
 void MeshComponent::update() {
     // 同步变换到 Filament 实体
     if (getOwner() && m_meshEntity != 0) {
@@ -1,7 +1,11 @@
 #ifndef MESHCOMPONENT_H
 #define MESHCOMPONENT_H
 
+#include <memory>
+
 #include "Component.h"
+#include "core/Math.h"
+#include "core/TriangleBVH.h"
 
 namespace Kazia {
 
@@ -13,6 +17,12 @@ private:
     Entity m_meshEntity;
     std::string m_meshPath;
     
+    // 网格局部空间包围盒
+    math::aabb m_bounds;
+    
+    // 三角形层次包围盒，同一网格的所有实例共享
+    std::shared_ptr<const TriangleBVH> m_triangleBvh;
+    
 public:
     MeshComponent();
     ~MeshComponent() override = default;
@@ -23,7 +33,15 @@ public:
     
     // 网格路径相关
     const std::string& getMeshPath() const { return m_meshPath; }
-    void setMeshPath(const std::string& path) { m_meshPath = path; }
+    void setMeshPath(const std::string& path) { m_meshPath = path; markModified(); }
+    
+    // 包围盒相关（同步到所属节点的局部包围盒）
+    const math::aabb& getBounds() const { return m_bounds; }
+    void setBounds(const math::aabb& bounds);
+    
+    // 三角形层次包围盒（用于精确拾取），设置时同步包围盒
+    const std::shared_ptr<const TriangleBVH>& getTriangleBVH() const { return m_triangleBvh; }
+    void setTriangleBVH(std::shared_ptr<const TriangleBVH> triangleBvh);
     
     // 生命周期方法
     void initialize() override;
@@ -1,17 +1,21 @@
 #include "Node.h"
+#include "MeshComponent.h"
 
+#include <algorithm>
+#include <atomic>
 #include <sstream>
 
 namespace Kazia {
 
-Node::Node(const std::string& name) 
-    : m_name(name), 
-      m_position({0.0f, 0.0f, 0.0f}), 
-      m_rotation({0.0f, 0.0f, 0.0f}), 
-      m_scale({1.0f, 1.0f, 1.0f}), 
-      m_parent(nullptr), 
-      m_dirty(true)
-{
+namespace {
+
+// 下一个可用的节点 ID，单调递增不复用：撤销历史和选择集可能在节点销毁后仍持有它的 ID
+std::atomic<uint32_t> s_nextNodeId{0};
+
+// 下一个挂接序号
+std::atomic<uint64_t> s_nextAttachOrder{0};
+
+std::string generateUuid() {
     // 生成 UUID
     char uuid_str[37];
     #ifdef _WIN32
@@ -33,8 +37,86 @@ Node::Node(const std::string& name)
         uuid_generate(uuid);
         uuid_unparse(uuid, uuid_str);
     #endif
-    m_uuid = uuid_str;
+    return uuid_str;
+}
+
+} // namespace
+
+struct Node::ChangeTracking {
+    // 以 ID 为下标的节点表，按修改跟踪的分块分页，页中没有节点时释放；
+    // ID 不复用，页目录只随创建过的 ID 总数缓慢增长（每个分块一个指针）
+    struct Page {
+        Node* nodes[size_t(1) << CHANGE_CHUNK_SHIFT] = {};
+        uint32_t count = 0;
+    };
+    std::vector<std::unique_ptr<Page>> pages;
+    
+    std::vector<uint64_t> modifiedBits;
+    size_t modifiedCount = 0;
+    
+    Node* find(uint32_t id) const {
+        size_t page = id >> CHANGE_CHUNK_SHIFT;
+        return page < pages.size() && pages[page] ? pages[page]->nodes[id & ((1u << CHANGE_CHUNK_SHIFT) - 1)] : nullptr;
+    }
+    
+    void insert(Node* node) {
+        size_t page = node->m_id >> CHANGE_CHUNK_SHIFT;
+        if (page >= pages.size()) {
+            pages.resize(page + 1);
+        }
+        if (!pages[page]) {
+            pages[page] = std::make_unique<Page>();
+        }
+        Node*& slot = pages[page]->nodes[node->m_id & ((1u << CHANGE_CHUNK_SHIFT) - 1)];
+        if (!slot) {
+            pages[page]->count++;
+        }
+        slot = node;
+    }
+    
+    void erase(Node* node) {
+        size_t page = node->m_id >> CHANGE_CHUNK_SHIFT;
+        if (page >= pages.size() || !pages[page]) {
+            return;
+        }
+        Node*& slot = pages[page]->nodes[node->m_id & ((1u << CHANGE_CHUNK_SHIFT) - 1)];
+        if (slot == node) {
+            slot = nullptr;
+            if (--pages[page]->count == 0) {
+                pages[page].reset();
+            }
+        }
+    }
     
+    void markChunk(uint32_t chunk) {
+        size_t word = chunk >> 6;
+        uint64_t mask = uint64_t(1) << (chunk & 63);
+        if (word >= modifiedBits.size()) {
+            modifiedBits.resize(word + 1, 0);
+        }
+        if (!(modifiedBits[word] & mask)) {
+            modifiedBits[word] |= mask;
+            modifiedCount++;
+        }
+    }
+};
+
+Node::Node(const std::string& name) : Node(name, generateUuid()) {
+}
+
+Node::Node(const std::string& name, const std::string& uuid) 
+    : m_name(name), 
+      m_uuid(uuid),
+      m_id(s_nextNodeId.fetch_add(1, std::memory_order_relaxed)),
+      m_position({0.0f, 0.0f, 0.0f}), 
+      m_rotation({0.0f, 0.0f, 0.0f}), 
+      m_scale({1.0f, 1.0f, 1.0f}), 
+      m_parent(nullptr), 
+      m_dirty(true),
+      m_boundsDirty(false),
+      m_structureVersion(0),
+      m_attachOrder(0)
+{
     // 初始化矩阵
     updateMatrix();
 }
@@ -50,19 +132,36 @@ Node::~Node() {
     m_children.clear();
 }
 
+void Node::setName(const std::string& name) {
+    m_name = name;
+    markModified();
+}
+
 void Node::setPosition(const math::float3& position) {
     m_position = position;
     setDirty();
+    markModified();
 }
 
 void Node::setRotation(const math::float3& rotation) {
     m_rotation = rotation;
     setDirty();
+    markModified();
 }
 
 void Node::setScale(const math::float3& scale) {
     m_scale = scale;
     setDirty();
+    markModified();
+}
+
+void Node::setLocalBounds(const math::aabb& bounds) {
+    m_localBounds = bounds;
+    m_worldBounds = math::transformAabb(m_worldMatrix, m_localBounds);
+    markBoundsDirty();
+    
+    // 只标记自身，下一次更新时报告为已变化，子节点不受影响
+    m_dirty = true;
 }
 
 void Node::setParent(Node* parent) {
@@ -70,23 +169,46 @@ void Node::setParent(Node* parent) {
         return;
     }
     
-    // 从旧父节点移除
+    // 没有新父节点时从旧父节点移除（节点随之销毁）
+    if (!parent) {
+        if (m_parent) {
+            m_parent->removeChild(this);
+        }
+        return;
+    }
+
+    // 从旧父节点取出所有权，移到新父节点下；removeChild 会销毁节点，不能在这里使用
+    std::unique_ptr<Node> self;
     if (m_parent) {
-        m_parent->removeChild(this);
+        auto it = std::find_if(m_parent->m_children.begin(), m_parent->m_children.end(),
+            [this](const std::unique_ptr<Node>& child) { return child.get() == this; });
+
+        if (it != m_parent->m_children.end()) {
+            m_parent->untrackSubtree(this);
+            self = std::move(*it);
+            m_parent->m_children.erase(it);
+            m_parent->markBoundsDirty();
+            m_parent->notifyStructureChanged();
+        }
     }
-    
+
     // 设置新父节点
     m_parent = parent;
-    
+
     // 添加到新父节点
     if (m_parent) {
-        auto it = std::find_if(m_parent->m_children.begin(), m_parent->m_children.end(), 
+        auto it = std::find_if(m_parent->m_children.begin(), m_parent->m_children.end(),
             [this](const std::unique_ptr<Node>& child) { return child.get() == this; });
-        
+
         if (it == m_parent->m_children.end()) {
             // 如果还没有在子节点列表中，添加一个新的
-            m_parent->m_children.push_back(std::unique_ptr<Node>(this));
+            m_attachOrder = s_nextAttachOrder.fetch_add(1, std::memory_order_relaxed);
+            m_parent->m_children.push_back(self ? std::move(self) : std::unique_ptr<Node>(this));
         }
+        
+        m_parent->markBoundsDirty();
+        m_parent->notifyStructureChanged();
+        trackSubtree(this);
     }
     
     setDirty();
@@ -94,8 +216,15 @@ void Node::setParent(Node* parent) {
 
 void Node::addChild(std::unique_ptr<Node> child) {
     if (child) {
-        child->setParent(this);
+        // 调用方持有所有权，这里直接接管，不能再经过 setParent 插入第二份
+        child->m_parent = this;
+        child->m_attachOrder = s_nextAttachOrder.fetch_add(1, std::memory_order_relaxed);
+        child->setDirty();
+        Node* attached = child.get();
         m_children.push_back(std::move(child));
+        markBoundsDirty();
+        notifyStructureChanged();
+        trackSubtree(attached);
     }
 }
 
@@ -104,14 +233,21 @@ void Node::removeChild(Node* child) {
         [child](const std::unique_ptr<Node>& c) { return c.get() == child; });
     
     if (it != m_children.end()) {
+        untrackSubtree(it->get());
         (*it)->m_parent = nullptr;
         m_children.erase(it);
+        markBoundsDirty();
+        notifyStructureChanged();
     }
 }
 
-void Node::update() {
+void Node::update(std::vector<Node*>* changedNodes) {
     if (m_dirty) {
         updateMatrix();
+        
+        if (changedNodes) {
+            changedNodes->push_back(this);
+        }
     }
     
     // 更新所有组件
@@ -121,57 +257,30 @@ void Node::update() {
     
     // 更新所有子节点
     for (auto& child : m_children) {
-        child->update();
-    }
-}
-
-// 辅助函数：创建平移矩阵
-math::mat4f translationMatrix(const math::float3& translation) {
-    math::mat4f mat;
-    mat.m[12] = translation.x;
-    mat.m[13] = translation.y;
-    mat.m[14] = translation.z;
-    return mat;
-}
-
-// 辅助函数：创建缩放矩阵
-math::mat4f scalingMatrix(const math::float3& scale) {
-    math::mat4f mat;
-    mat.m[0] = scale.x;
-    mat.m[5] = scale.y;
-    mat.m[10] = scale.z;
-    return mat;
-}
-
-// 辅助函数：矩阵乘法
-math::mat4f multiplyMatrices(const math::mat4f& a, const math::mat4f& b) {
-    math::mat4f result;
-    // 实现 4x4 矩阵乘法
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 4; j++) {
-            result.m[i * 4 + j] = 
-                a.m[i * 4 + 0] * b.m[0 * 4 + j] +
-                a.m[i * 4 + 1] * b.m[1 * 4 + j] +
-                a.m[i * 4 + 2] * b.m[2 * 4 + j] +
-                a.m[i * 4 + 3] * b.m[3 * 4 + j];
-        }
+        child->update(changedNodes);
+    }
+    
+    // 子节点更新完成后再合并子树包围盒（后序），只处理被标记的路径
+    if (m_boundsDirty) {
+        updateSubtreeBounds();
     }
-    return result;
 }
 
 void Node::updateMatrix() {
-    // 计算本地矩阵
-    math::mat4f translationMat = translationMatrix(m_position);
-    math::mat4f scalingMat = scalingMatrix(m_scale);
-    m_localMatrix = multiplyMatrices(translationMat, scalingMat);
+    // 计算本地矩阵（T * R * S）
+    m_localMatrix = math::composeTRS(m_position, m_rotation, m_scale);
     
     // 计算世界矩阵
     if (m_parent) {
-        m_worldMatrix = multiplyMatrices(m_parent->getWorldMatrix(), m_localMatrix);
+        m_worldMatrix = math::multiply(m_parent->getWorldMatrix(), m_localMatrix);
     } else {
         m_worldMatrix = m_localMatrix;
     }
     
+    // 更新世界包围盒
+    m_worldBounds = math::transformAabb(m_worldMatrix, m_localBounds);
+    markBoundsDirty();
+    
     m_dirty = false;
     
     // 标记所有子节点为脏
@@ -189,6 +298,116 @@ void Node::setDirty() {
     }
 }
 
+void Node::markBoundsDirty() {
+    // 已标记的节点其祖先必然也已标记，到此为止
+    Node* node = this;
+    while (node && !node->m_boundsDirty) {
+        node->m_boundsDirty = true;
+        node = node->m_parent;
+    }
+}
+
+void Node::updateSubtreeBounds() {
+    m_subtreeBounds = m_worldBounds;
+    for (auto& child : m_children) {
+        m_subtreeBounds.merge(child->m_subtreeBounds);
+    }
+    m_boundsDirty = false;
+}
+
+void Node::notifyStructureChanged() {
+    findRoot()->m_structureVersion++;
+}
+
+Node* Node::findRoot() {
+    Node* root = this;
+    while (root->m_parent) {
+        root = root->m_parent;
+    }
+    return root;
+}
+
+void Node::markModified() {
+    Node* root = findRoot();
+    if (root->m_tracking) {
+        root->m_tracking->markChunk(m_id >> CHANGE_CHUNK_SHIFT);
+    }
+}
+
+void Node::trackSubtree(Node* subtree) {
+    Node* root = findRoot();
+    if (!root->m_tracking) {
+        root->m_tracking = std::make_unique<ChangeTracking>();
+    }
+    ChangeTracking& tracking = *root->m_tracking;
+    
+    // 子树此前作为独立的树记录的修改已经没有意义，挂接后整棵子树都标记为已修改
+    subtree->m_tracking.reset();
+    
+    subtree->traverse([](Node* node, void* userData) {
+        ChangeTracking& tracking = *static_cast<ChangeTracking*>(userData);
+        tracking.insert(node);
+        tracking.markChunk(node->m_id >> CHANGE_CHUNK_SHIFT);
+    }, &tracking);
+}
+
+void Node::untrackSubtree(Node* subtree) {
+    Node* root = findRoot();
+    if (!root->m_tracking) {
+        return;
+    }
+    ChangeTracking& tracking = *root->m_tracking;
+    
+    // 移除的节点所在的分块也要标记，保存时才能记录它们已不存在
+    subtree->traverse([](Node* node, void* userData) {
+        ChangeTracking& tracking = *static_cast<ChangeTracking*>(userData);
+        tracking.erase(node);
+        tracking.markChunk(node->m_id >> CHANGE_CHUNK_SHIFT);
+    }, &tracking);
+}
+
+Node* Node::findNodeById(uint32_t id) const {
+    return m_tracking ? m_tracking->find(id) : nullptr;
+}
+
+void Node::markAllModified() {
+    if (!m_tracking) {
+        return;
+    }
+    // 只标记有节点的分块（即已分配的页），没有节点的分块不需要保存
+    const auto& pages = m_tracking->pages;
+    for (size_t page = 0; page < pages.size(); ++page) {
+        if (pages[page]) {
+            m_tracking->markChunk(static_cast<uint32_t>(page));
+        }
+    }
+}
+
+size_t Node::takeModifiedChunks(std::vector<uint32_t>& chunks, size_t maxCount) {
+    if (!m_tracking) {
+        return 0;
+    }
+    
+    size_t taken = 0;
+    std::vector<uint64_t>& bits = m_tracking->modifiedBits;
+    for (size_t word = 0; word < bits.size() && taken < maxCount; ++word) {
+        for (uint32_t bit = 0; bit < 64 && bits[word] != 0 && taken < maxCount; ++bit) {
+            uint64_t mask = uint64_t(1) << bit;
+            if (bits[word] & mask) {
+                bits[word] &= ~mask;
+                chunks.push_back(static_cast<uint32_t>(word * 64 + bit));
+                taken++;
+            }
+        }
+    }
+    m_tracking->modifiedCount -= taken;
+    return taken;
+}
+
+bool Node::hasModifiedChunks() const {
+    return m_tracking && m_tracking->modifiedCount > 0;
+}
+
 void Node::traverse(void (*callback)(Node*, void*), void* userData) {
     // 先调用当前节点的回调
     callback(this, userData);
@@ -204,8 +423,15 @@ void Node::removeComponent(Component* component) {
         [component](const std::unique_ptr<Component>& c) { return c.get() == component; });
     
     if (it != m_components.end()) {
+        // 移除网格组件时清空局部包围盒
+        bool isMesh = dynamic_cast<MeshComponent*>(it->get()) != nullptr;
+        
         (*it)->shutdown();
         m_components.erase(it);
+        
+        if (isMesh && !getComponent<MeshComponent>()) {
+            setLocalBounds(math::aabb());
+        }
     }
 }
 
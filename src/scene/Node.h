@@ -21,6 +21,9 @@ private:
     std::string m_name;
     std::string m_uuid;
     
+    // 进程内唯一的顺序 ID，从 0 开始连续分配，不复用；以 ID 为下标的表应按页分配（见 PagedBitset）
+    uint32_t m_id;
+    
     // 变换属性
     Kazia::math::float3 m_position;
     Kazia::math::float3 m_rotation;
@@ -37,19 +40,47 @@ private:
     // 组件
     std::vector<std::unique_ptr<Component>> m_components;
     
+    // 包围盒：局部空间（网格）、世界空间、以及包含所有子节点的子树包围盒
+    Kazia::math::aabb m_localBounds;
+    Kazia::math::aabb m_worldBounds;
+    Kazia::math::aabb m_subtreeBounds;
+    
     // 标记是否需要更新矩阵
     bool m_dirty;
     
+    // 标记子树包围盒是否需要重新计算
+    bool m_boundsDirty;
+    
+    // 层级结构版本号，增删子节点时递增（只记录在根节点上）
+    uint64_t m_structureVersion;
+    
+    // 挂接到父节点时分配的全局递增序号，子节点列表按此排列
+    uint64_t m_attachOrder;
+    
+    // 修改跟踪（只在根节点上创建）：以 ID 为下标的分页节点表和按 ID 分块的修改位图
+    struct ChangeTracking;
+    std::unique_ptr<ChangeTracking> m_tracking;
+    
 public:
+    // 修改跟踪按 ID 分块，每块 1 << CHANGE_CHUNK_SHIFT 个 ID
+    static constexpr uint32_t CHANGE_CHUNK_SHIFT = 10;
+    
+
     Node(const std::string& name = "Node");
+    
+    // 使用已有的 UUID（如从场景文件载入），不重新生成
+    Node(const std::string& name, const std::string& uuid);
     virtual ~Node();
     
     // UUID 相关
     const std::string& getUUID() const { return m_uuid; }
     
+    // 顺序 ID 相关
+    uint32_t getId() const { return m_id; }
+    
     // 名称相关
     const std::string& getName() const { return m_name; }
-    void setName(const std::string& name) { m_name = name; }
+    void setName(const std::string& name);
     
     // 变换相关
     const Kazia::math::float3& getPosition() const { return m_position; }
@@ -65,6 +96,12 @@ public:
     const Kazia::math::mat4f& getLocalMatrix() const { return m_localMatrix; }
     const Kazia::math::mat4f& getWorldMatrix() const { return m_worldMatrix; }
     
+    // 包围盒相关
+    const Kazia::math::aabb& getLocalBounds() const { return m_localBounds; }
+    void setLocalBounds(const Kazia::math::aabb& bounds);
+    const Kazia::math::aabb& getWorldBounds() const { return m_worldBounds; }
+    const Kazia::math::aabb& getSubtreeBounds() const { return m_subtreeBounds; }
+    
     // 层级结构相关
     Node* getParent() const { return m_parent; }
     void setParent(Node* parent);
@@ -74,11 +111,36 @@ public:
     size_t getChildCount() const { return m_children.size(); }
     Node* getChild(size_t index) const { return m_children[index].get(); }
     
+    // 层级结构版本号，仅对根节点有意义，缓存节点指针的系统据此判断是否需要重建
+    uint64_t getStructureVersion() const { return m_structureVersion; }
+    
+    // 挂接序号，同一父节点下的子节点按此升序排列
+    uint64_t getAttachOrder() const { return m_attachOrder; }
+    
+    // 修改跟踪：名称、变换、组件或层级发生变化时把所在的 ID 分块记录到根节点上
+    // （只记录需要保存的状态，世界矩阵和包围盒的更新不算修改）
+    void markModified();
+    
+    // 以下只对根节点有意义
+    // 按 ID 查找挂在该树上的节点（不含根节点本身），不存在时返回 nullptr
+    Node* findNodeById(uint32_t id) const;
+    
+    // 把所有有节点的分块标记为已修改
+    void markAllModified();
+    
+    // 取出至多 maxCount 个已修改的分块（按分块序号升序）并清除标记，返回取出的数量
+    size_t takeModifiedChunks(std::vector<uint32_t>& chunks, size_t maxCount);
+    bool hasModifiedChunks() const;
+    
     // 更新相关
-    void update();
+    // changedNodes 非空时收集本次更新中世界包围盒发生变化的节点
+    void update(std::vector<Node*>* changedNodes = nullptr);
     void updateMatrix();
     void setDirty();
     
+    // 标记子树包围盒需要重新计算（向上传播到所有祖先）
+    void markBoundsDirty();
+    
     // 遍历相关
     void traverse(void (*callback)(Node*, void*), void* userData);
     
@@ -89,6 +151,7 @@ public:
         component->setOwner(this);
         component->initialize();
         m_components.push_back(std::move(component));
+        markModified();
         return static_cast<T*>(m_components.back().get());
     }
     
@@ -118,7 +181,21 @@ public:
     void removeComponent(Component* component);
     size_t getComponentCount() const { return m_components.size(); }
     Component* getComponent(size_t index) const { return m_components[index].get(); }
+    
+private:
+    // 由世界包围盒和子节点的子树包围盒重新计算子树包围盒
+    void updateSubtreeBounds();
+    
+    // 递增根节点的层级结构版本号
+    void notifyStructureChanged();
+    
+    Node* findRoot();
+    
+    // 把子树登记到根节点的节点表中 / 从中移除，并标记所在分块
+    void trackSubtree(Node* subtree);
+    void untrackSubtree(Node* subtree);
 };
 
+} // namespace Kazia
 
 #endif // NODE_H
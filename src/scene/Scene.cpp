@@ -2,7 +2,7 @@
 
 namespace Kazia {
 
-Scene::Scene(const std::string& name) : m_name(name) {
+Scene::Scene(const std::string& name) : m_name(name), m_updateCount(0) {
     // 创建根节点
     m_rootNode = std::make_unique<Node>("Root");
 }
@@ -30,7 +30,7 @@ Node* Scene::findNodeByName(const std::string& name) const {
     Node* result = nullptr;
     
     auto findCallback = [](Node* node, void* userData) {
-        auto data = reinterpret_cast<std::pair<const std::string*, Node**>>(userData);
+        auto data = reinterpret_cast<std::pair<const std::string*, Node**>*>(userData);
         const std::string& name = *(data->first);
         Node** result = data->second;
         
@@ -49,7 +49,7 @@ Node* Scene::findNodeByUUID(const std::string& uuid) const {
     Node* result = nullptr;
     
     auto findCallback = [](Node* node, void* userData) {
-        auto data = reinterpret_cast<std::pair<const std::string*, Node**>>(userData);
+        auto data = reinterpret_cast<std::pair<const std::string*, Node**>*>(userData);
         const std::string& uuid = *(data->first);
         Node** result = data->second;
         
@@ -66,7 +66,47 @@ Node* Scene::findNodeByUUID(const std::string& uuid) const {
 
 void Scene::update() {
     // 更新根节点，会递归更新所有子节点
-    m_rootNode->update();
+    m_changedNodes.clear();
+    m_rootNode->update(&m_changedNodes);
+    m_updateCount++;
+}
+
+void Scene::collectNodesInFrustum(const math::frustum& frustum, std::vector<Node*>& result) const {
+    struct StackEntry {
+        Node* node;
+        uint32_t planeMask;
+    };
+    
+    std::vector<StackEntry> stack;
+    stack.push_back({m_rootNode.get(), math::frustum::ALL_PLANES});
+    
+    while (!stack.empty()) {
+        StackEntry entry = stack.back();
+        stack.pop_back();
+        
+        // 子树包围盒在视锥体外，跳过整棵子树
+        uint32_t planeMask = entry.planeMask;
+        const math::aabb& subtreeBounds = entry.node->getSubtreeBounds();
+        if (subtreeBounds.isEmpty()) {
+            continue;
+        }
+        if (planeMask != 0 && frustum.classify(subtreeBounds, planeMask) == math::frustum::Result::OUTSIDE) {
+            continue;
+        }
+        
+        // 完全在内的子树 planeMask 为 0，后代不再做平面检测
+        const math::aabb& worldBounds = entry.node->getWorldBounds();
+        if (!worldBounds.isEmpty()) {
+            uint32_t nodeMask = planeMask;
+            if (nodeMask == 0 || frustum.classify(worldBounds, nodeMask) != math::frustum::Result::OUTSIDE) {
+                result.push_back(entry.node);
+            }
+        }
+        
+        for (size_t i = 0; i < entry.node->getChildCount(); ++i) {
+            stack.push_back({entry.node->getChild(i), planeMask});
+        }
+    }
 }
 
 void Scene::render() {
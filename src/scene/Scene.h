@@ -14,6 +14,12 @@ private:
     std::string m_name;
     std::unique_ptr<Node> m_rootNode;
     
+    // 最近一次 update 中世界变换或包围盒发生变化的节点
+    std::vector<Node*> m_changedNodes;
+    
+    // update 调用次数
+    uint64_t m_updateCount;
+    
 public:
     Scene(const std::string& name = "Scene");
     ~Scene();
@@ -33,6 +39,33 @@ public:
     void update();
     void render();
     
+    // 最近一次 update 中发生变化的节点（下一次 update 前有效）
+    const std::vector<Node*>& getChangedNodes() const { return m_changedNodes; }
+    
+    // update 调用次数，增量消费 getChangedNodes 的系统用它判断是否漏掉了某次更新
+    uint64_t getUpdateCount() const { return m_updateCount; }
+    
+    // 层级结构版本号，增删节点后变化
+    uint64_t getStructureVersion() const { return m_rootNode->getStructureVersion(); }
+    
+    // 修改跟踪（见 Node::markModified），增量保存据此只处理变化的 ID 分块
+    Node* getNodeById(uint32_t id) const { return m_rootNode->findNodeById(id); }
+    
+    // 按 ID 查找并核对 UUID，用于还原写到磁盘的引用：ID 对应的不是同一个节点时返回 nullptr
+    Node* getNodeById(uint32_t id, const std::string& uuid) const {
+        Node* node = getNodeById(id);
+        return node && node->getUUID() == uuid ? node : nullptr;
+    }
+    void markAllModified() { m_rootNode->markAllModified(); }
+    size_t takeModifiedChunks(std::vector<uint32_t>& chunks, size_t maxCount) { return m_rootNode->takeModifiedChunks(chunks, maxCount); }
+    bool hasModifiedChunks() const { return m_rootNode->hasModifiedChunks(); }
+    
+    // 场景包围盒
+    const math::aabb& getBounds() const { return m_rootNode->getSubtreeBounds(); }
+    
+    // 收集与视锥体相交的节点，子树包围盒在视锥体外时整棵子树一次排除
+    void collectNodesInFrustum(const math::frustum& frustum, std::vector<Node*>& result) const;
+    
     // 名称相关
     const std::string& getName() const { return m_name; }
     void setName(const std::string& name) { m_name = name; }
@@ -0,0 +1,669 @@
+#include "SceneAutosave.h"
+
+#include "Scene.h"
+#include "Node.h"
+#include "SceneFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <unordered_map>
+
+#include "utils/MappedFile.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Kazia {
+
+namespace {
+
+// 日志格式：文件头，之后是一串记录。每条记录有类型、分块序号、负载大小、提交序号和负载校验和；
+// 分块记录的负载是该分块的全部节点（空负载表示分块中已没有节点），提交记录的负载是场景名称
+constexpr uint32_t JOURNAL_MAGIC = 0x4C4E4A4B; // "KJNL"
+constexpr uint32_t JOURNAL_VERSION = 1;
+
+constexpr uint32_t RECORD_CHUNK = 1;
+constexpr uint32_t RECORD_COMMIT = 2;
+
+struct JournalHeader {
+    uint32_t magic;
+    uint32_t version;
+};
+
+struct RecordHeader {
+    uint32_t type;
+    uint32_t chunk;
+    uint64_t size;
+    uint64_t sequence;
+    uint64_t checksum;
+};
+
+struct ChunkHeader {
+    uint32_t nodeCount;
+    uint32_t componentCount;
+    uint32_t assetCount;
+    uint32_t reserved;
+    uint64_t componentDataSize;
+    uint64_t stringsSize;
+};
+
+// FNV-1a 64 位哈希
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+uint64_t hashBytes(const void* data, size_t size) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+template <typename T>
+void appendArray(std::vector<uint8_t>& out, const T* data, size_t count) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    out.insert(out.end(), bytes, bytes + count * sizeof(T));
+}
+
+void appendRecord(std::vector<uint8_t>& out, uint32_t type, uint32_t chunk, uint64_t sequence, const void* payload, size_t size) {
+    RecordHeader header;
+    header.type = type;
+    header.chunk = chunk;
+    header.size = size;
+    header.sequence = sequence;
+    header.checksum = hashBytes(payload, size);
+    appendArray(out, &header, 1);
+    appendArray(out, static_cast<const uint8_t*>(payload), size);
+}
+
+// 顺序读取负载中的数组，越界后所有读取都返回 nullptr
+class PayloadReader {
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_offset;
+
+public:
+    PayloadReader(const uint8_t* data, size_t size) : m_data(data), m_size(size), m_offset(0) {
+    }
+
+    template <typename T>
+    const uint8_t* read(uint64_t count) {
+        if (count > (m_size - m_offset) / sizeof(T)) {
+            m_offset = m_size;
+            return nullptr;
+        }
+        const uint8_t* data = m_data + m_offset;
+        m_offset += static_cast<size_t>(count * sizeof(T));
+        return data;
+    }
+};
+
+template <typename T>
+T loadValue(const uint8_t* data, size_t index) {
+    T value;
+    std::memcpy(&value, data + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+// 把文件（或目录项）写到磁盘，保证替换之后断电也不会读到不完整的内容
+bool syncFile(const std::string& path) {
+#ifdef _WIN32
+    int fd = _open(path.c_str(), _O_RDWR | _O_BINARY);
+    if (fd < 0) {
+        return false;
+    }
+    bool success = _commit(fd) == 0;
+    _close(fd);
+    return success;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool success = ::fsync(fd) == 0;
+    ::close(fd);
+    return success;
+#endif
+}
+
+// Windows 上目录不能单独刷新，重命名在 MoveFileEx 返回时已经写入
+bool syncDirectory(const std::string& path) {
+#ifdef _WIN32
+    (void)path;
+    return true;
+#else
+    return syncFile(path.empty() ? std::string(".") : path);
+#endif
+}
+
+} // namespace
+
+// 一个分块的快照，创建后不再修改，可以在线程之间共享
+struct SceneAutosave::Chunk {
+    std::vector<uint32_t> ids;
+    std::vector<uint32_t> parents;      // 父节点 ID，父节点为场景根节点时为 NO_PARENT
+    std::vector<uint64_t> orders;       // 挂接序号
+    std::vector<SceneFile::StringRef> names;
+    std::string uuids;                  // 每个节点 UUID_LENGTH 个字符
+    std::vector<math::float3> positions;
+    std::vector<math::float3> rotations;
+    std::vector<math::float3> scales;
+    std::vector<uint32_t> componentStarts;
+    std::vector<SceneFile::ComponentRecord> components;
+    std::vector<uint8_t> componentData;
+    std::vector<SceneFile::StringRef> assets;
+    std::string strings;
+
+    // 编码为日志记录的负载，没有节点时为空
+    void encode(std::vector<uint8_t>& out) const {
+        out.clear();
+        if (ids.empty()) {
+            return;
+        }
+        ChunkHeader header;
+        header.nodeCount = static_cast<uint32_t>(ids.size());
+        header.componentCount = static_cast<uint32_t>(components.size());
+        header.assetCount = static_cast<uint32_t>(assets.size());
+        header.reserved = 0;
+        header.componentDataSize = componentData.size();
+        header.stringsSize = strings.size();
+        appendArray(out, &header, 1);
+        appendArray(out, ids.data(), ids.size());
+        appendArray(out, parents.data(), parents.size());
+        appendArray(out, orders.data(), orders.size());
+        appendArray(out, names.data(), names.size());
+        appendArray(out, uuids.data(), uuids.size());
+        appendArray(out, positions.data(), positions.size());
+        appendArray(out, rotations.data(), rotations.size());
+        appendArray(out, scales.data(), scales.size());
+        appendArray(out, componentStarts.data(), componentStarts.size());
+        appendArray(out, components.data(), components.size());
+        appendArray(out, componentData.data(), componentData.size());
+        appendArray(out, assets.data(), assets.size());
+        appendArray(out, strings.data(), strings.size());
+    }
+};
+
+SceneAutosave::SceneAutosave(Scene& scene, const std::string& path) : SceneAutosave(scene, path, Options()) {
+}
+
+SceneAutosave::SceneAutosave(Scene& scene, const std::string& path, const Options& options)
+    : m_scene(scene),
+      m_path(path),
+      m_options(options),
+      m_rewriteNext(true),
+      m_hasJob(false),
+      m_busy(false),
+      m_failed(false),
+      m_stop(false),
+      m_journalBytes(0),
+      m_liveBytes(0),
+      m_sequence(0) {
+    // 第一次保存需要完整的快照
+    m_scene.markAllModified();
+    m_thread = std::thread([this]() {
+        workerThread();
+    });
+}
+
+SceneAutosave::~SceneAutosave() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+}
+
+bool SceneAutosave::hasPendingChanges() const {
+    return m_scene.hasModifiedChunks();
+}
+
+bool SceneAutosave::capture() {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint32_t> modified;
+    m_scene.takeModifiedChunks(modified, std::max<size_t>(m_options.maxChunksPerCapture, 1));
+    if (modified.empty()) {
+        return false;
+    }
+
+    // 只替换修改过的分块，其余分块的指针原样复制
+    size_t nodeCount = 0;
+    std::vector<uint32_t> changed;
+    for (uint32_t index : modified) {
+        std::shared_ptr<const Chunk> chunk = captureChunk(index);
+        if (index >= m_chunks.size()) {
+            m_chunks.resize(static_cast<size_t>(index) + 1);
+        }
+        // 从未保存过且仍然为空的分块不需要写入
+        if (!m_chunks[index] && chunk->ids.empty()) {
+            continue;
+        }
+        nodeCount += chunk->ids.size();
+        m_chunks[index] = std::move(chunk);
+        changed.push_back(index);
+    }
+
+    bool submitted = !changed.empty() || m_rewriteNext;
+    if (submitted) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // 后台线程还没取走上一份快照时合并，只写最新的状态
+        if (m_hasJob) {
+            changed.insert(changed.end(), m_job.changed.begin(), m_job.changed.end());
+            std::sort(changed.begin(), changed.end());
+            changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+        }
+        m_job.chunks = m_chunks;
+        m_job.changed = std::move(changed);
+        m_job.sceneName = m_scene.getName();
+        m_job.rewrite = m_job.rewrite || m_rewriteNext;
+        m_hasJob = true;
+        m_rewriteNext = false;
+    }
+    if (submitted) {
+        m_condition.notify_all();
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.captures++;
+    m_stats.capturedChunks += modified.size();
+    m_stats.capturedNodes += nodeCount;
+    m_stats.lastCaptureMs = ms;
+    m_stats.maxCaptureMs = std::max(m_stats.maxCaptureMs, ms);
+    return submitted;
+}
+
+std::shared_ptr<const SceneAutosave::Chunk> SceneAutosave::captureChunk(uint32_t index) const {
+    auto chunk = std::make_shared<Chunk>();
+    std::unordered_map<std::string, uint32_t> assetIndices;
+    std::function<uint32_t(const std::string&)> addAsset = [&](const std::string& path) {
+        auto inserted = assetIndices.emplace(path, static_cast<uint32_t>(chunk->assets.size()));
+        if (inserted.second) {
+            chunk->assets.push_back({static_cast<uint32_t>(chunk->strings.size()), static_cast<uint32_t>(path.size())});
+            chunk->strings += path;
+        }
+        return inserted.first->second;
+    };
+
+    const Node* root = m_scene.getRootNode();
+    uint32_t first = index << Node::CHANGE_CHUNK_SHIFT;
+    uint32_t last = first + (1u << Node::CHANGE_CHUNK_SHIFT);
+    for (uint32_t id = first; id < last; ++id) {
+        const Node* node = m_scene.getNodeById(id);
+        if (!node) {
+            continue;
+        }
+
+        chunk->ids.push_back(id);
+        chunk->parents.push_back(node->getParent() == root ? SceneFile::NO_PARENT : node->getParent()->getId());
+        chunk->orders.push_back(node->getAttachOrder());
+        chunk->names.push_back({static_cast<uint32_t>(chunk->strings.size()), static_cast<uint32_t>(node->getName().size())});
+        chunk->strings += node->getName();
+        const std::string& uuid = node->getUUID();
+        size_t uuidLength = std::min(uuid.size(), SceneFile::UUID_LENGTH);
+        chunk->uuids.append(uuid, 0, uuidLength);
+        chunk->uuids.append(SceneFile::UUID_LENGTH - uuidLength, '\0');
+        chunk->positions.push_back(node->getPosition());
+        chunk->rotations.push_back(node->getRotation());
+        chunk->scales.push_back(node->getScale());
+
+        chunk->componentStarts.push_back(static_cast<uint32_t>(chunk->components.size()));
+        for (size_t i = 0; i < node->getComponentCount(); ++i) {
+            SceneFile::ComponentRecord record;
+            if (SceneFile::encodeComponent(*node->getComponent(i), record, chunk->componentData, addAsset)) {
+                chunk->components.push_back(record);
+            }
+        }
+    }
+    chunk->componentStarts.push_back(static_cast<uint32_t>(chunk->components.size()));
+    return chunk;
+}
+
+bool SceneAutosave::flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]() {
+        return (!m_hasJob || m_failed) && !m_busy;
+    });
+    return !m_failed;
+}
+
+SceneAutosave::Stats SceneAutosave::getStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void SceneAutosave::workerThread() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            // 写入失败后隔一段时间再重试，期间新的快照合并到等待重试的快照中
+            if (m_failed) {
+                m_condition.wait_for(lock, std::chrono::milliseconds(m_options.retryDelayMs), [this]() {
+                    return m_stop;
+                });
+            }
+            m_condition.wait(lock, [this]() {
+                return m_stop || m_hasJob;
+            });
+            // 退出前写完最后一份快照，已经失败过的不再重试
+            if (!m_hasJob || (m_stop && m_failed)) {
+                return;
+            }
+            job = std::move(m_job);
+            m_job = Job();
+            m_hasJob = false;
+            m_busy = true;
+        }
+
+        bool success = job.rewrite ? rewriteJournal(job) : appendJournal(job);
+        bool compacted = false;
+        if (success && !job.rewrite && m_journalBytes >= m_options.minCompactBytes &&
+            static_cast<double>(m_journalBytes) > m_options.compactRatio * static_cast<double>(m_liveBytes)) {
+            compacted = rewriteJournal(job);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_busy = false;
+            m_failed = !success;
+            if (success) {
+                m_stats.commits++;
+            } else {
+                m_stats.failedWrites++;
+                // 写入失败后日志的内容不确定，重新排队并重写完整的快照；期间又有新的快照时，
+                // 新快照已经包含全部分块，只需并入本次要写的分块
+                if (m_hasJob) {
+                    m_job.changed.insert(m_job.changed.end(), job.changed.begin(), job.changed.end());
+                    std::sort(m_job.changed.begin(), m_job.changed.end());
+                    m_job.changed.erase(std::unique(m_job.changed.begin(), m_job.changed.end()), m_job.changed.end());
+                } else {
+                    m_job = std::move(job);
+                    m_hasJob = true;
+                }
+                m_job.rewrite = true;
+            }
+            m_stats.compactions += compacted ? 1 : 0;
+            m_stats.journalBytes = static_cast<size_t>(m_journalBytes);
+            m_stats.liveBytes = static_cast<size_t>(m_liveBytes);
+        }
+        m_condition.notify_all();
+    }
+}
+
+bool SceneAutosave::appendJournal(const Job& job) {
+    std::vector<uint8_t> buffer;
+    std::vector<uint8_t> payload;
+    uint64_t sequence = m_sequence + 1;
+    for (uint32_t index : job.changed) {
+        const Chunk* chunk = index < job.chunks.size() ? job.chunks[index].get() : nullptr;
+        if (!chunk) {
+            continue;
+        }
+        chunk->encode(payload);
+        appendRecord(buffer, RECORD_CHUNK, index, sequence, payload.data(), payload.size());
+        if (index >= m_chunkBytes.size()) {
+            m_chunkBytes.resize(static_cast<size_t>(index) + 1, 0);
+        }
+        m_liveBytes = m_liveBytes - m_chunkBytes[index] + payload.size();
+        m_chunkBytes[index] = payload.size();
+    }
+    appendRecord(buffer, RECORD_COMMIT, 0, sequence, job.sceneName.data(), job.sceneName.size());
+
+    std::ofstream file(m_path, std::ios::binary | std::ios::app);
+    if (!file) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    file.flush();
+    if (!file) {
+        return false;
+    }
+
+    m_sequence = sequence;
+    m_journalBytes += buffer.size();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.writtenBytes += buffer.size();
+    return true;
+}
+
+bool SceneAutosave::rewriteJournal(const Job& job) {
+    std::error_code error;
+    std::filesystem::path parent = std::filesystem::path(m_path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, error);
+        if (error) {
+            return false;
+        }
+    }
+
+    // 最新快照的所有分块写成一次提交，先写临时文件再替换，替换前旧日志仍然可用
+    std::vector<uint64_t> chunkBytes(job.chunks.size(), 0);
+    uint64_t liveBytes = 0;
+    uint64_t written = 0;
+    uint64_t sequence = m_sequence + 1;
+    std::string tempPath = m_path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        JournalHeader header = {JOURNAL_MAGIC, JOURNAL_VERSION};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        written += sizeof(header);
+
+        std::vector<uint8_t> buffer;
+        std::vector<uint8_t> payload;
+        for (size_t index = 0; index < job.chunks.size(); ++index) {
+            if (!job.chunks[index] || job.chunks[index]->ids.empty()) {
+                continue;
+            }
+            job.chunks[index]->encode(payload);
+            appendRecord(buffer, RECORD_CHUNK, static_cast<uint32_t>(index), sequence, payload.data(), payload.size());
+            chunkBytes[index] = payload.size();
+            liveBytes += payload.size();
+            if (buffer.size() >= (size_t(1) << 20)) {
+                file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+                written += buffer.size();
+                buffer.clear();
+            }
+        }
+        appendRecord(buffer, RECORD_COMMIT, 0, sequence, job.sceneName.data(), job.sceneName.size());
+        file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        written += buffer.size();
+        file.close();
+        if (!file) {
+            return false;
+        }
+    }
+
+    // 临时文件的内容先落盘再替换，否则断电后可能留下替换过但内容不完整的日志；
+    // 替换后再刷新目录，使新的目录项也落盘
+    if (!syncFile(tempPath)) {
+        return false;
+    }
+    std::filesystem::rename(tempPath, m_path, error);
+    if (error || !syncDirectory(parent.string())) {
+        return false;
+    }
+
+    m_sequence = sequence;
+    m_chunkBytes = std::move(chunkBytes);
+    m_liveBytes = liveBytes;
+    m_journalBytes = written;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.writtenBytes += static_cast<size_t>(written);
+    return true;
+}
+
+bool SceneAutosave::recover(const std::string& path, Scene& scene) {
+    MappedFile file;
+    JournalHeader header;
+    if (!file.open(path) || file.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != JOURNAL_MAGIC || header.version != JOURNAL_VERSION) {
+        return false;
+    }
+
+    // 逐条校验，遇到截断或损坏的记录就停止；只有提交记录之前的分块才生效
+    struct Payload {
+        const uint8_t* data;
+        size_t size;
+    };
+    std::unordered_map<uint32_t, Payload> pending;
+    std::unordered_map<uint32_t, Payload> committed;
+    std::string sceneName;
+    bool hasCommit = false;
+    size_t offset = sizeof(header);
+    while (file.size() - offset >= sizeof(RecordHeader)) {
+        RecordHeader record;
+        std::memcpy(&record, file.data() + offset, sizeof(record));
+        offset += sizeof(record);
+        if (record.size > file.size() - offset) {
+            break;
+        }
+        const uint8_t* payload = file.data() + offset;
+        size_t size = static_cast<size_t>(record.size);
+        offset += size;
+        if (hashBytes(payload, size) != record.checksum) {
+            break;
+        }
+
+        if (record.type == RECORD_CHUNK) {
+            pending[record.chunk] = {payload, size};
+        } else if (record.type == RECORD_COMMIT) {
+            for (const auto& entry : pending) {
+                committed[entry.first] = entry.second;
+            }
+            pending.clear();
+            sceneName.assign(reinterpret_cast<const char*>(payload), size);
+            hasCommit = true;
+        } else {
+            break;
+        }
+    }
+    if (!hasCommit) {
+        return false;
+    }
+
+    // 创建所有节点，再按挂接序号挂到父节点下，兄弟节点因此保持原来的顺序
+    struct Recovered {
+        uint32_t id;
+        uint32_t parent;
+        uint64_t order;
+        std::unique_ptr<Node> node;
+    };
+    std::vector<Recovered> nodes;
+    for (const auto& entry : committed) {
+        PayloadReader reader(entry.second.data, entry.second.size);
+        const uint8_t* headerData = reader.read<ChunkHeader>(1);
+        if (!headerData) {
+            continue;
+        }
+        ChunkHeader chunk = loadValue<ChunkHeader>(headerData, 0);
+        uint64_t nodeCount = chunk.nodeCount;
+        const uint8_t* ids = reader.read<uint32_t>(nodeCount);
+        const uint8_t* parents = reader.read<uint32_t>(nodeCount);
+        const uint8_t* orders = reader.read<uint64_t>(nodeCount);
+        const uint8_t* names = reader.read<SceneFile::StringRef>(nodeCount);
+        const uint8_t* uuids = reader.read<char>(nodeCount * SceneFile::UUID_LENGTH);
+        const uint8_t* positions = reader.read<math::float3>(nodeCount);
+        const uint8_t* rotations = reader.read<math::float3>(nodeCount);
+        const uint8_t* scales = reader.read<math::float3>(nodeCount);
+        const uint8_t* componentStarts = reader.read<uint32_t>(nodeCount + 1);
+        const uint8_t* components = reader.read<SceneFile::ComponentRecord>(chunk.componentCount);
+        const uint8_t* componentData = reader.read<uint8_t>(chunk.componentDataSize);
+        const uint8_t* assetRefs = reader.read<SceneFile::StringRef>(chunk.assetCount);
+        const uint8_t* strings = reader.read<char>(chunk.stringsSize);
+        if (!ids || !parents || !orders || !names || !uuids || !positions || !rotations || !scales || !componentStarts ||
+            (chunk.componentCount > 0 && !components) || (chunk.componentDataSize > 0 && !componentData) ||
+            (chunk.assetCount > 0 && !assetRefs) || (chunk.stringsSize > 0 && !strings)) {
+            continue;
+        }
+
+        auto getString = [&](const SceneFile::StringRef& ref) {
+            if (static_cast<uint64_t>(ref.offset) + ref.length > chunk.stringsSize) {
+                return std::string();
+            }
+            return std::string(reinterpret_cast<const char*>(strings) + ref.offset, ref.length);
+        };
+        std::vector<std::string> assets(chunk.assetCount);
+        for (uint32_t i = 0; i < chunk.assetCount; ++i) {
+            assets[i] = getString(loadValue<SceneFile::StringRef>(assetRefs, i));
+        }
+
+        for (uint32_t i = 0; i < chunk.nodeCount; ++i) {
+            const char* uuid = reinterpret_cast<const char*>(uuids) + static_cast<size_t>(i) * SceneFile::UUID_LENGTH;
+            size_t uuidLength = 0;
+            while (uuidLength < SceneFile::UUID_LENGTH && uuid[uuidLength] != '\0') {
+                uuidLength++;
+            }
+
+            Recovered recovered;
+            recovered.id = loadValue<uint32_t>(ids, i);
+            recovered.parent = loadValue<uint32_t>(parents, i);
+            recovered.order = loadValue<uint64_t>(orders, i);
+            recovered.node = std::make_unique<Node>(getString(loadValue<SceneFile::StringRef>(names, i)), std::string(uuid, uuidLength));
+            recovered.node->setPosition(loadValue<math::float3>(positions, i));
+            recovered.node->setRotation(loadValue<math::float3>(rotations, i));
+            recovered.node->setScale(loadValue<math::float3>(scales, i));
+
+            uint32_t componentStart = loadValue<uint32_t>(componentStarts, i);
+            uint32_t componentEnd = std::min(loadValue<uint32_t>(componentStarts, i + 1), chunk.componentCount);
+            for (uint32_t c = componentStart; c < componentEnd; ++c) {
+                SceneFile::ComponentRecord record = loadValue<SceneFile::ComponentRecord>(components, c);
+                uint32_t size = SceneFile::getComponentDataSize(record.type);
+                if (size != 0 && record.size == size && record.offset <= chunk.componentDataSize &&
+                    record.size <= chunk.componentDataSize - record.offset) {
+                    SceneFile::decodeComponent(*recovered.node, record.type, componentData + record.offset, assets);
+                }
+            }
+            nodes.push_back(std::move(recovered));
+        }
+    }
+
+    std::sort(nodes.begin(), nodes.end(), [](const Recovered& a, const Recovered& b) {
+        return a.order < b.order;
+    });
+    std::unordered_map<uint32_t, Node*> nodesById;
+    for (Recovered& recovered : nodes) {
+        nodesById[recovered.id] = recovered.node.get();
+    }
+
+    // 不同时间复制的分块可能不一致：父节点缺失，或者挂接后会形成环的节点挂到根节点下
+    scene.setName(sceneName);
+    for (Recovered& recovered : nodes) {
+        Node* child = recovered.node.get();
+        auto it = recovered.parent == SceneFile::NO_PARENT ? nodesById.end() : nodesById.find(recovered.parent);
+        Node* parent = it != nodesById.end() ? it->second : nullptr;
+        for (Node* ancestor = parent; ancestor; ancestor = ancestor->getParent()) {
+            if (ancestor == child) {
+                parent = nullptr;
+                break;
+            }
+        }
+        if (parent) {
+            parent->addChild(std::move(recovered.node));
+        } else {
+            scene.addNode(std::move(recovered.node));
+        }
+    }
+    return true;
+}
+
+} // namespace Kazia
@@ -0,0 +1,115 @@
+#ifndef SCENEAUTOSAVE_H
+#define SCENEAUTOSAVE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Kazia {
+
+class Scene;
+
+// 后台增量自动保存
+// 场景按节点 ID 分块（见 Node::CHANGE_CHUNK_SHIFT），每块保存为不可变的快照。capture 在修改场景的线程上
+// 只重新复制有修改的分块，未修改的分块与上一次快照共享（写时复制），每次复制的分块数有上限，
+// 剩余的留到下一次，调用方的耗时不随场景大小增长。快照交给后台线程编码后追加到日志文件，
+// 每次追加以提交记录结尾，恢复时只应用完整提交的部分；日志中的过期数据超过一定比例时，
+// 后台线程用最新的快照重写一份紧凑的日志再替换。分块可能在不同的 capture 中复制，
+// 恢复时父节点缺失或形成环的节点挂到根节点下
+class SceneAutosave {
+public:
+    struct Options {
+        size_t maxChunksPerCapture = 4;             // 每次 capture 最多复制的分块数
+        double compactRatio = 2.0;                  // 日志超过有效数据的该倍数时压缩
+        size_t minCompactBytes = size_t(1) << 20;   // 日志小于该大小时不压缩
+        uint32_t retryDelayMs = 1000;               // 写入失败后重试的间隔
+    };
+
+    struct Stats {
+        size_t captures = 0;
+        size_t capturedChunks = 0;
+        size_t capturedNodes = 0;
+        double lastCaptureMs = 0.0;     // 调用线程上的耗时
+        double maxCaptureMs = 0.0;
+        size_t commits = 0;
+        size_t compactions = 0;
+        size_t failedWrites = 0;
+        size_t writtenBytes = 0;
+        size_t journalBytes = 0;
+        size_t liveBytes = 0;           // 最新状态编码后的大小
+    };
+
+private:
+    struct Chunk;
+    struct Job {
+        std::vector<std::shared_ptr<const Chunk>> chunks;   // 完整快照，压缩时使用
+        std::vector<uint32_t> changed;                      // 需要追加的分块
+        std::string sceneName;
+        bool rewrite = false;
+    };
+
+    Scene& m_scene;
+    std::string m_path;
+    Options m_options;
+
+    // 最新的快照，下标为分块序号
+    std::vector<std::shared_ptr<const Chunk>> m_chunks;
+    bool m_rewriteNext;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    Job m_job;
+    bool m_hasJob;
+    bool m_busy;
+    bool m_failed;      // 最近一次写入失败，快照留在 m_job 中等待重试
+    bool m_stop;
+    Stats m_stats;
+    std::thread m_thread;
+
+    // 以下只在后台线程上访问
+    std::vector<uint64_t> m_chunkBytes;
+    uint64_t m_journalBytes;
+    uint64_t m_liveBytes;
+    uint64_t m_sequence;
+
+public:
+    // 第一次写入时用完整快照替换 path 处已有的日志
+    SceneAutosave(Scene& scene, const std::string& path);
+    SceneAutosave(Scene& scene, const std::string& path, const Options& options);
+
+    // 等待后台线程写完
+    ~SceneAutosave();
+
+    SceneAutosave(const SceneAutosave&) = delete;
+    SceneAutosave& operator=(const SceneAutosave&) = delete;
+
+    // 复制有修改的分块并交给后台线程，没有修改时返回 false；须在修改场景的线程上调用
+    bool capture();
+
+    // 还有未复制的修改（超过 maxChunksPerCapture 时留下的）
+    bool hasPendingChanges() const;
+
+    // 等待已交给后台线程的快照写完；写入失败时不等待重试，返回 false
+    bool flush();
+
+    const std::string& getPath() const { return m_path; }
+    Stats getStats();
+
+    // 从日志恢复最后一次完整提交的状态，节点添加到 scene 的根节点下；日志不存在或没有完整的提交时返回 false
+    static bool recover(const std::string& path, Scene& scene);
+
+private:
+    std::shared_ptr<const Chunk> captureChunk(uint32_t index) const;
+    void workerThread();
+    bool appendJournal(const Job& job);
+    bool rewriteJournal(const Job& job);
+};
+
+} // namespace Kazia
+
+#endif // SCENEAUTOSAVE_H
@@ -0,0 +1,753 @@
+#include "SceneFile.h"
+
+#include "Scene.h"
+#include "Node.h"
+#include "MeshComponent.h"
+#include "LightComponent.h"
+#include "CameraComponent.h"
+#include "TransformComponent.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+namespace Kazia {
+
+namespace {
+
+// 文件格式：头部、段表，之后是按 16 字节对齐的各段。读取时不认识的段被忽略，
+// 新增字段放在新的段中，改变已有段的布局时递增版本号
+constexpr uint32_t SCENE_MAGIC = 0x4E43534B; // "KSCN"
+constexpr uint32_t SCENE_VERSION = 1;
+constexpr uint64_t SECTION_ALIGNMENT = 16;
+
+enum SectionId : uint32_t {
+    SECTION_PARENTS = 1,            // uint32_t[nodeCount]
+    SECTION_NAMES = 2,              // StringRef[nodeCount]
+    SECTION_UUIDS = 3,              // char[nodeCount][36]，不足 36 个字符时以 0 填充
+    SECTION_POSITIONS = 4,          // float3[nodeCount]
+    SECTION_ROTATIONS = 5,          // float3[nodeCount]
+    SECTION_SCALES = 6,             // float3[nodeCount]
+    SECTION_COMPONENT_STARTS = 7,   // uint32_t[nodeCount + 1]
+    SECTION_COMPONENTS = 8,         // ComponentRecord[componentCount]
+    SECTION_COMPONENT_DATA = 9,     // 组件数据块
+    SECTION_ASSETS = 10,            // StringRef[assetCount]
+    SECTION_STRINGS = 11,           // 字符串池
+    SECTION_COUNT = 11
+};
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sectionCount;
+    uint32_t nodeCount;
+    uint32_t componentCount;
+    uint32_t assetCount;
+    SceneFile::StringRef sceneName;
+};
+
+struct SectionEntry {
+    uint32_t id;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+};
+
+// 各类组件的数据块
+struct MeshBlob {
+    uint32_t asset;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+constexpr uint32_t LIGHT_CAST_SHADOWS = 1u << 0;
+constexpr uint32_t LIGHT_STATIC = 1u << 1;
+
+struct LightBlob {
+    uint32_t lightType;
+    float color[3];
+    float intensity;
+    float direction[3];
+    float radius;
+    uint32_t flags;
+};
+
+struct CameraBlob {
+    float fov;
+    float nearPlane;
+    float farPlane;
+};
+
+struct TransformBlob {
+    float position[3];
+    float rotation[3];
+    float scale[3];
+};
+
+uint32_t getBlobSize(uint32_t type) {
+    switch (static_cast<SceneFile::ComponentType>(type)) {
+        case SceneFile::ComponentType::Mesh: return sizeof(MeshBlob);
+        case SceneFile::ComponentType::Light: return sizeof(LightBlob);
+        case SceneFile::ComponentType::Camera: return sizeof(CameraBlob);
+        case SceneFile::ComponentType::Transform: return sizeof(TransformBlob);
+    }
+    return 0;
+}
+
+uint64_t alignSection(uint64_t offset) {
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+void storeFloat3(float* target, const math::float3& value) {
+    target[0] = value.x;
+    target[1] = value.y;
+    target[2] = value.z;
+}
+
+math::float3 loadFloat3(const float* source) {
+    return math::float3(source[0], source[1], source[2]);
+}
+
+bool isInPool(const SceneFile::StringRef& ref, uint64_t poolSize) {
+    return static_cast<uint64_t>(ref.offset) + ref.length <= poolSize;
+}
+
+// JSON 输出，缓冲区满时写入文件
+class JsonWriter {
+private:
+    std::ofstream& m_file;
+    std::string m_buffer;
+
+public:
+    explicit JsonWriter(std::ofstream& file) : m_file(file) {
+        m_buffer.reserve(1 << 20);
+    }
+
+    ~JsonWriter() {
+        flush();
+    }
+
+    void flush() {
+        m_file.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+        m_buffer.clear();
+    }
+
+    void raw(const char* text) {
+        m_buffer += text;
+        if (m_buffer.size() >= (1 << 20)) {
+            flush();
+        }
+    }
+
+    void string(const char* text, size_t length) {
+        m_buffer += '"';
+        for (size_t i = 0; i < length; ++i) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c == '"' || c == '\\') {
+                m_buffer += '\\';
+                m_buffer += static_cast<char>(c);
+            } else if (c < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                m_buffer += escaped;
+            } else {
+                m_buffer += static_cast<char>(c);
+            }
+        }
+        m_buffer += '"';
+    }
+
+    void string(const std::string& text) {
+        string(text.data(), text.size());
+    }
+
+    void number(double value) {
+        // 非有限值在 JSON 中没有表示，写为 null
+        if (!std::isfinite(value)) {
+            m_buffer += "null";
+            return;
+        }
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.9g", value);
+        m_buffer += text;
+    }
+
+    void integer(uint64_t value) {
+        char text[24];
+        std::snprintf(text, sizeof(text), "%llu", static_cast<unsigned long long>(value));
+        m_buffer += text;
+    }
+
+    void vector3(const float* value) {
+        m_buffer += '[';
+        number(value[0]);
+        m_buffer += ", ";
+        number(value[1]);
+        m_buffer += ", ";
+        number(value[2]);
+        m_buffer += ']';
+    }
+};
+
+const char* getLightTypeName(uint32_t type) {
+    switch (static_cast<LightManager::Type>(type)) {
+        case LightManager::Type::SUN: return "sun";
+        case LightManager::Type::POINT: return "point";
+        case LightManager::Type::SPOT: return "spot";
+        case LightManager::Type::AREA: return "area";
+    }
+    return "unknown";
+}
+
+} // namespace
+
+SceneFile::SceneFile()
+    : m_data(nullptr),
+      m_size(0) {
+    close();
+}
+
+bool SceneFile::open(const std::string& path) {
+    close();
+    if (!m_file.open(path)) {
+        return false;
+    }
+    if (!openData(m_file.data(), m_file.size())) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool SceneFile::openBuffer(std::vector<uint8_t> buffer) {
+    close();
+    m_buffer = std::move(buffer);
+    if (!openData(m_buffer.data(), m_buffer.size())) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SceneFile::close() {
+    m_file.close();
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+    m_data = nullptr;
+    m_size = 0;
+    m_nodeCount = 0;
+    m_componentCount = 0;
+    m_assetCount = 0;
+    m_sceneName = {0, 0};
+    m_parents = nullptr;
+    m_names = nullptr;
+    m_uuids = nullptr;
+    m_positions = nullptr;
+    m_rotations = nullptr;
+    m_scales = nullptr;
+    m_componentStarts = nullptr;
+    m_components = nullptr;
+    m_componentData = nullptr;
+    m_componentDataSize = 0;
+    m_assets = nullptr;
+    m_strings = nullptr;
+    m_stringsSize = 0;
+}
+
+bool SceneFile::openData(const uint8_t* data, size_t size) {
+    // 文件可能被截断或来自其他版本，任何不一致都视为无法打开
+    FileHeader header;
+    if (size < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    uint64_t tableEnd = sizeof(header) + static_cast<uint64_t>(header.sectionCount) * sizeof(SectionEntry);
+    if (header.magic != SCENE_MAGIC || header.version != SCENE_VERSION || tableEnd > size ||
+        header.nodeCount == std::numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+
+    // 段偏移换成指针，同时检查大小和对齐
+    const uint8_t* sections[SECTION_COUNT + 1] = {};
+    uint64_t sectionSizes[SECTION_COUNT + 1] = {};
+    for (uint32_t i = 0; i < header.sectionCount; ++i) {
+        SectionEntry entry;
+        std::memcpy(&entry, data + sizeof(header) + i * sizeof(SectionEntry), sizeof(entry));
+        if (entry.offset % SECTION_ALIGNMENT != 0 || entry.offset < tableEnd || entry.offset > size || entry.size > size - entry.offset) {
+            return false;
+        }
+        if (entry.id == 0 || entry.id > SECTION_COUNT || sections[entry.id]) {
+            continue;
+        }
+        sections[entry.id] = data + entry.offset;
+        sectionSizes[entry.id] = entry.size;
+    }
+
+    uint64_t nodeCount = header.nodeCount;
+    const uint64_t expectedSizes[SECTION_COUNT + 1] = {
+        0,
+        nodeCount * sizeof(uint32_t),
+        nodeCount * sizeof(StringRef),
+        nodeCount * UUID_LENGTH,
+        nodeCount * sizeof(math::float3),
+        nodeCount * sizeof(math::float3),
+        nodeCount * sizeof(math::float3),
+        (nodeCount + 1) * sizeof(uint32_t),
+        static_cast<uint64_t>(header.componentCount) * sizeof(ComponentRecord),
+        sectionSizes[SECTION_COMPONENT_DATA],
+        static_cast<uint64_t>(header.assetCount) * sizeof(StringRef),
+        sectionSizes[SECTION_STRINGS]
+    };
+    for (uint32_t id = 1; id <= SECTION_COUNT; ++id) {
+        if (sectionSizes[id] != expectedSizes[id] || (!sections[id] && expectedSizes[id] != 0 && id != SECTION_COMPONENT_DATA && id != SECTION_STRINGS)) {
+            return false;
+        }
+    }
+    if (!sections[SECTION_COMPONENT_STARTS]) {
+        return false;
+    }
+
+    m_data = data;
+    m_size = size;
+    m_nodeCount = header.nodeCount;
+    m_componentCount = header.componentCount;
+    m_assetCount = header.assetCount;
+    m_sceneName = header.sceneName;
+    m_parents = reinterpret_cast<const uint32_t*>(sections[SECTION_PARENTS]);
+    m_names = reinterpret_cast<const StringRef*>(sections[SECTION_NAMES]);
+    m_uuids = reinterpret_cast<const char*>(sections[SECTION_UUIDS]);
+    m_positions = reinterpret_cast<const math::float3*>(sections[SECTION_POSITIONS]);
+    m_rotations = reinterpret_cast<const math::float3*>(sections[SECTION_ROTATIONS]);
+    m_scales = reinterpret_cast<const math::float3*>(sections[SECTION_SCALES]);
+    m_componentStarts = reinterpret_cast<const uint32_t*>(sections[SECTION_COMPONENT_STARTS]);
+    m_components = reinterpret_cast<const ComponentRecord*>(sections[SECTION_COMPONENTS]);
+    m_componentData = sections[SECTION_COMPONENT_DATA];
+    m_componentDataSize = sectionSizes[SECTION_COMPONENT_DATA];
+    m_assets = reinterpret_cast<const StringRef*>(sections[SECTION_ASSETS]);
+    m_strings = reinterpret_cast<const char*>(sections[SECTION_STRINGS]);
+    m_stringsSize = sectionSizes[SECTION_STRINGS];
+
+    // 引用检查：每个数组顺序扫描一遍，之后的访问不再检查
+    bool valid = isInPool(m_sceneName, m_stringsSize);
+    for (uint32_t i = 0; i < m_nodeCount; ++i) {
+        valid &= m_parents[i] == NO_PARENT || m_parents[i] < i;
+        valid &= isInPool(m_names[i], m_stringsSize);
+        valid &= m_componentStarts[i] <= m_componentStarts[i + 1];
+    }
+    valid &= m_componentStarts[0] == 0 && m_componentStarts[m_nodeCount] == m_componentCount;
+    for (uint32_t i = 0; i < m_assetCount; ++i) {
+        valid &= isInPool(m_assets[i], m_stringsSize);
+    }
+    for (uint32_t i = 0; i < m_componentCount && valid; ++i) {
+        const ComponentRecord& record = m_components[i];
+        uint32_t blobSize = getBlobSize(record.type);
+        valid &= record.offset <= m_componentDataSize && record.size <= m_componentDataSize - record.offset;
+        valid &= blobSize == 0 || record.size == blobSize;
+        if (valid && static_cast<ComponentType>(record.type) == ComponentType::Mesh) {
+            MeshBlob blob;
+            std::memcpy(&blob, m_componentData + record.offset, sizeof(blob));
+            valid &= blob.asset == NO_ASSET || blob.asset < m_assetCount;
+        }
+    }
+    return valid;
+}
+
+std::string SceneFile::getUUID(uint32_t node) const {
+    const char* uuid = m_uuids + static_cast<size_t>(node) * UUID_LENGTH;
+    size_t length = 0;
+    while (length < UUID_LENGTH && uuid[length] != '\0') {
+        length++;
+    }
+    return std::string(uuid, length);
+}
+
+uint32_t SceneFile::getComponentDataSize(uint32_t type) {
+    return getBlobSize(type);
+}
+
+bool SceneFile::encodeComponent(const Component& component, ComponentRecord& record, std::vector<uint8_t>& data,
+                                const std::function<uint32_t(const std::string&)>& addAsset) {
+    auto append = [&](ComponentType type, const void* blob, size_t size) {
+        record.type = static_cast<uint32_t>(type);
+        record.size = static_cast<uint32_t>(size);
+        record.offset = data.size();
+        const uint8_t* bytes = static_cast<const uint8_t*>(blob);
+        data.insert(data.end(), bytes, bytes + size);
+    };
+
+    if (const MeshComponent* mesh = dynamic_cast<const MeshComponent*>(&component)) {
+        MeshBlob blob;
+        blob.asset = mesh->getMeshPath().empty() ? NO_ASSET : addAsset(mesh->getMeshPath());
+        storeFloat3(blob.boundsMin, mesh->getBounds().min);
+        storeFloat3(blob.boundsMax, mesh->getBounds().max);
+        append(ComponentType::Mesh, &blob, sizeof(blob));
+    } else if (const LightComponent* light = dynamic_cast<const LightComponent*>(&component)) {
+        LightBlob blob;
+        blob.lightType = static_cast<uint32_t>(light->getLightType());
+        storeFloat3(blob.color, light->getColor());
+        blob.intensity = light->getIntensity();
+        storeFloat3(blob.direction, light->getDirection());
+        blob.radius = light->getRadius();
+        blob.flags = (light->getCastShadows() ? LIGHT_CAST_SHADOWS : 0) | (light->isStatic() ? LIGHT_STATIC : 0);
+        append(ComponentType::Light, &blob, sizeof(blob));
+    } else if (const CameraComponent* camera = dynamic_cast<const CameraComponent*>(&component)) {
+        CameraBlob blob;
+        blob.fov = camera->getFOV();
+        blob.nearPlane = camera->getNear();
+        blob.farPlane = camera->getFar();
+        append(ComponentType::Camera, &blob, sizeof(blob));
+    } else if (const TransformComponent* transform = dynamic_cast<const TransformComponent*>(&component)) {
+        TransformBlob blob;
+        storeFloat3(blob.position, transform->getPosition());
+        storeFloat3(blob.rotation, transform->getRotation());
+        storeFloat3(blob.scale, transform->getScale());
+        append(ComponentType::Transform, &blob, sizeof(blob));
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void SceneFile::decodeComponent(Node& node, uint32_t type, const uint8_t* data, const std::vector<std::string>& assets) {
+    switch (static_cast<ComponentType>(type)) {
+        case ComponentType::Mesh: {
+            MeshBlob blob;
+            std::memcpy(&blob, data, sizeof(blob));
+            MeshComponent* mesh = node.addComponent<MeshComponent>();
+            if (blob.asset < assets.size()) {
+                mesh->setMeshPath(assets[blob.asset]);
+            }
+            math::aabb bounds(loadFloat3(blob.boundsMin), loadFloat3(blob.boundsMax));
+            if (!bounds.isEmpty()) {
+                mesh->setBounds(bounds);
+            }
+            break;
+        }
+        case ComponentType::Light: {
+            LightBlob blob;
+            std::memcpy(&blob, data, sizeof(blob));
+            LightComponent* light = node.addComponent<LightComponent>();
+            if (blob.lightType <= static_cast<uint32_t>(LightManager::Type::AREA)) {
+                light->setLightType(static_cast<LightManager::Type>(blob.lightType));
+            }
+            light->setColor(loadFloat3(blob.color));
+            light->setIntensity(blob.intensity);
+            light->setDirection(loadFloat3(blob.direction));
+            light->setRadius(blob.radius);
+            light->setCastShadows((blob.flags & LIGHT_CAST_SHADOWS) != 0);
+            light->setStatic((blob.flags & LIGHT_STATIC) != 0);
+            break;
+        }
+        case ComponentType::Camera: {
+            CameraBlob blob;
+            std::memcpy(&blob, data, sizeof(blob));
+            CameraComponent* camera = node.addComponent<CameraComponent>();
+            camera->setFOV(blob.fov);
+            camera->setNear(blob.nearPlane);
+            camera->setFar(blob.farPlane);
+            break;
+        }
+        case ComponentType::Transform: {
+            // 变换组件的值在更新时从节点同步，这里只恢复组件本身
+            node.addComponent<TransformComponent>();
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+size_t SceneFile::instantiate(Scene& scene) const {
+    if (!isOpen()) {
+        return 0;
+    }
+    scene.setName(getSceneName());
+
+    // 资源路径只构造一次，各组件复制
+    std::vector<std::string> assets(m_assetCount);
+    for (uint32_t i = 0; i < m_assetCount; ++i) {
+        assets[i] = getAsset(i);
+    }
+
+    // 父节点总在子节点之前，按顺序创建即可挂到已创建的父节点下
+    std::vector<Node*> nodes(m_nodeCount);
+    for (uint32_t i = 0; i < m_nodeCount; ++i) {
+        auto node = std::make_unique<Node>(getName(i), getUUID(i));
+        node->setPosition(m_positions[i]);
+        node->setRotation(m_rotations[i]);
+        node->setScale(m_scales[i]);
+
+        for (uint32_t c = getComponentStart(i); c < getComponentEnd(i); ++c) {
+            decodeComponent(*node, m_components[c].type, getComponentData(c), assets);
+        }
+
+        nodes[i] = node.get();
+        if (m_parents[i] == NO_PARENT) {
+            scene.addNode(std::move(node));
+        } else {
+            nodes[m_parents[i]]->addChild(std::move(node));
+        }
+    }
+    return m_nodeCount;
+}
+
+bool SceneFile::exportJson(const std::string& path) const {
+    if (!isOpen()) {
+        return false;
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    {
+        JsonWriter json(file);
+        json.raw("{\n  \"format\": \"KSCN\",\n  \"version\": ");
+        json.integer(SCENE_VERSION);
+        json.raw(",\n  \"name\": ");
+        json.string(getSceneName());
+        json.raw(",\n  \"assets\": [");
+        for (uint32_t i = 0; i < m_assetCount; ++i) {
+            json.raw(i == 0 ? "\n    " : ",\n    ");
+            json.string(m_strings + m_assets[i].offset, m_assets[i].length);
+        }
+        json.raw(m_assetCount == 0 ? "],\n  \"nodes\": [" : "\n  ],\n  \"nodes\": [");
+
+        for (uint32_t i = 0; i < m_nodeCount; ++i) {
+            json.raw(i == 0 ? "\n    {\n      \"index\": " : ",\n    {\n      \"index\": ");
+            json.integer(i);
+            json.raw(",\n      \"name\": ");
+            json.string(m_strings + m_names[i].offset, m_names[i].length);
+            json.raw(",\n      \"uuid\": ");
+            json.string(getUUID(i));
+            json.raw(",\n      \"parent\": ");
+            if (m_parents[i] == NO_PARENT) {
+                json.raw("null");
+            } else {
+                json.integer(m_parents[i]);
+            }
+            json.raw(",\n      \"position\": ");
+            json.vector3(&m_positions[i].x);
+            json.raw(",\n      \"rotation\": ");
+            json.vector3(&m_rotations[i].x);
+            json.raw(",\n      \"scale\": ");
+            json.vector3(&m_scales[i].x);
+            json.raw(",\n      \"components\": [");
+
+            uint32_t start = getComponentStart(i);
+            for (uint32_t c = start; c < getComponentEnd(i); ++c) {
+                const ComponentRecord& record = m_components[c];
+                const uint8_t* data = getComponentData(c);
+                json.raw(c == start ? "\n        {\"type\": " : ",\n        {\"type\": ");
+                switch (static_cast<ComponentType>(record.type)) {
+                    case ComponentType::Mesh: {
+                        MeshBlob blob;
+                        std::memcpy(&blob, data, sizeof(blob));
+                        json.raw("\"mesh\", \"asset\": ");
+                        if (blob.asset == NO_ASSET) {
+                            json.raw("null");
+                        } else {
+                            json.integer(blob.asset);
+                        }
+                        json.raw(", \"boundsMin\": ");
+                        json.vector3(blob.boundsMin);
+                        json.raw(", \"boundsMax\": ");
+                        json.vector3(blob.boundsMax);
+                        break;
+                    }
+                    case ComponentType::Light: {
+                        LightBlob blob;
+                        std::memcpy(&blob, data, sizeof(blob));
+                        json.raw("\"light\", \"lightType\": \"");
+                        json.raw(getLightTypeName(blob.lightType));
+                        json.raw("\", \"color\": ");
+                        json.vector3(blob.color);
+                        json.raw(", \"intensity\": ");
+                        json.number(blob.intensity);
+                        json.raw(", \"direction\": ");
+                        json.vector3(blob.direction);
+                        json.raw(", \"radius\": ");
+                        json.number(blob.radius);
+                        json.raw((blob.flags & LIGHT_CAST_SHADOWS) ? ", \"castShadows\": true" : ", \"castShadows\": false");
+                        json.raw((blob.flags & LIGHT_STATIC) ? ", \"static\": true" : ", \"static\": false");
+                        break;
+                    }
+                    case ComponentType::Camera: {
+                        CameraBlob blob;
+                        std::memcpy(&blob, data, sizeof(blob));
+                        json.raw("\"camera\", \"fov\": ");
+                        json.number(blob.fov);
+                        json.raw(", \"near\": ");
+                        json.number(blob.nearPlane);
+                        json.raw(", \"far\": ");
+                        json.number(blob.farPlane);
+                        break;
+                    }
+                    case ComponentType::Transform:
+                        json.raw("\"transform\"");
+                        break;
+                    default:
+                        json.integer(record.type);
+                        json.raw(", \"size\": ");
+                        json.integer(record.size);
+                        break;
+                }
+                json.raw("}");
+            }
+            json.raw(start == getComponentEnd(i) ? "]\n    }" : "\n      ]\n    }");
+        }
+        json.raw(m_nodeCount == 0 ? "]\n}\n" : "\n  ]\n}\n");
+    }
+    return static_cast<bool>(file);
+}
+
+std::vector<uint8_t> SceneFile::serialize(const Scene& scene) {
+    std::vector<uint32_t> parents;
+    std::vector<StringRef> names;
+    std::string uuids;
+    std::vector<math::float3> positions;
+    std::vector<math::float3> rotations;
+    std::vector<math::float3> scales;
+    std::vector<uint32_t> componentStarts;
+    std::vector<ComponentRecord> components;
+    std::vector<uint8_t> componentData;
+    std::vector<StringRef> assets;
+    std::unordered_map<std::string, uint32_t> assetIndices;
+    std::string strings;
+
+    auto addString = [&strings](const std::string& text) {
+        StringRef ref = {static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(text.size())};
+        strings += text;
+        return ref;
+    };
+    std::function<uint32_t(const std::string&)> addAsset = [&](const std::string& path) {
+        auto inserted = assetIndices.emplace(path, static_cast<uint32_t>(assets.size()));
+        if (inserted.second) {
+            assets.push_back(addString(path));
+        }
+        return inserted.first->second;
+    };
+
+    StringRef sceneName = addString(scene.getName());
+
+    // 先序遍历，子节点逆序入栈以保持原有顺序
+    std::vector<std::pair<const Node*, uint32_t>> stack;
+    const Node* root = scene.getRootNode();
+    for (size_t i = root->getChildCount(); i > 0; --i) {
+        stack.emplace_back(root->getChild(i - 1), NO_PARENT);
+    }
+    while (!stack.empty()) {
+        const Node* node = stack.back().first;
+        uint32_t index = static_cast<uint32_t>(parents.size());
+        parents.push_back(stack.back().second);
+        stack.pop_back();
+
+        names.push_back(addString(node->getName()));
+        std::string uuid = node->getUUID();
+        uuid.resize(UUID_LENGTH, '\0');
+        uuids += uuid;
+        positions.push_back(node->getPosition());
+        rotations.push_back(node->getRotation());
+        scales.push_back(node->getScale());
+
+        componentStarts.push_back(static_cast<uint32_t>(components.size()));
+        for (size_t i = 0; i < node->getComponentCount(); ++i) {
+            ComponentRecord record;
+            if (encodeComponent(*node->getComponent(i), record, componentData, addAsset)) {
+                components.push_back(record);
+            }
+        }
+
+        for (size_t i = node->getChildCount(); i > 0; --i) {
+            stack.emplace_back(node->getChild(i - 1), index);
+        }
+    }
+    componentStarts.push_back(static_cast<uint32_t>(components.size()));
+
+    // 字符串池的偏移是 32 位的
+    if (strings.size() > std::numeric_limits<uint32_t>::max() || parents.size() >= std::numeric_limits<uint32_t>::max()) {
+        return std::vector<uint8_t>();
+    }
+
+    FileHeader header;
+    header.magic = SCENE_MAGIC;
+    header.version = SCENE_VERSION;
+    header.sectionCount = SECTION_COUNT;
+    header.nodeCount = static_cast<uint32_t>(parents.size());
+    header.componentCount = static_cast<uint32_t>(components.size());
+    header.assetCount = static_cast<uint32_t>(assets.size());
+    header.sceneName = sceneName;
+
+    const std::pair<const void*, size_t> sections[SECTION_COUNT] = {
+        {parents.data(), parents.size() * sizeof(uint32_t)},
+        {names.data(), names.size() * sizeof(StringRef)},
+        {uuids.data(), uuids.size()},
+        {positions.data(), positions.size() * sizeof(math::float3)},
+        {rotations.data(), rotations.size() * sizeof(math::float3)},
+        {scales.data(), scales.size() * sizeof(math::float3)},
+        {componentStarts.data(), componentStarts.size() * sizeof(uint32_t)},
+        {components.data(), components.size() * sizeof(ComponentRecord)},
+        {componentData.data(), componentData.size()},
+        {assets.data(), assets.size() * sizeof(StringRef)},
+        {strings.data(), strings.size()}
+    };
+
+    SectionEntry entries[SECTION_COUNT];
+    uint64_t offset = alignSection(sizeof(header) + sizeof(entries));
+    for (uint32_t i = 0; i < SECTION_COUNT; ++i) {
+        entries[i].id = i + 1;
+        entries[i].reserved = 0;
+        entries[i].offset = offset;
+        entries[i].size = sections[i].second;
+        offset = alignSection(offset + sections[i].second);
+    }
+
+    std::vector<uint8_t> data(static_cast<size_t>(offset), 0);
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::memcpy(data.data() + sizeof(header), entries, sizeof(entries));
+    for (uint32_t i = 0; i < SECTION_COUNT; ++i) {
+        if (sections[i].second > 0) {
+            std::memcpy(data.data() + entries[i].offset, sections[i].first, sections[i].second);
+        }
+    }
+    return data;
+}
+
+bool SceneFile::write(const std::string& path, const Scene& scene) {
+    std::vector<uint8_t> data = serialize(scene);
+    if (data.empty()) {
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, error);
+        if (error) {
+            return false;
+        }
+    }
+
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file) {
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, error);
+    return !error;
+}
+
+} // namespace Kazia
@@ -0,0 +1,143 @@
+#ifndef SCENEFILE_H
+#define SCENEFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "core/Math.h"
+#include "utils/MappedFile.h"
+
+namespace Kazia {
+
+class Scene;
+class Node;
+class Component;
+
+// 二进制场景文件
+// 节点按先序存放在扁平的节点表中（父节点总在子节点之前），父节点用下标表示；名称、UUID、
+// 位置、旋转、缩放分别连续存放（SoA），组件是按节点排列的定长记录加上各自的数据块，
+// 网格等外部资源通过资源表引用。各段按 16 字节对齐，打开时只映射文件、校验段表并把段偏移
+// 换成指针，不逐个节点解析；节点表可以直接读取，也可以实例化为 Scene
+class SceneFile {
+public:
+    static constexpr uint32_t NO_PARENT = 0xFFFFFFFFu;
+    static constexpr uint32_t NO_ASSET = 0xFFFFFFFFu;
+    static constexpr size_t UUID_LENGTH = 36;
+
+    enum class ComponentType : uint32_t {
+        Mesh = 1,
+        Light = 2,
+        Camera = 3,
+        Transform = 4
+    };
+
+    // 字符串池中的一段
+    struct StringRef {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    // 组件记录，数据块位于组件数据段中，布局由类型决定
+    struct ComponentRecord {
+        uint32_t type;
+        uint32_t size;
+        uint64_t offset;
+    };
+
+private:
+    MappedFile m_file;
+    std::vector<uint8_t> m_buffer;  // openBuffer 打开时持有数据
+    const uint8_t* m_data;
+    size_t m_size;
+
+    uint32_t m_nodeCount;
+    uint32_t m_componentCount;
+    uint32_t m_assetCount;
+    StringRef m_sceneName;
+
+    // 指向映射中各段的指针
+    const uint32_t* m_parents;
+    const StringRef* m_names;
+    const char* m_uuids;
+    const math::float3* m_positions;
+    const math::float3* m_rotations;
+    const math::float3* m_scales;
+    const uint32_t* m_componentStarts;     // nodeCount + 1 项，节点 i 的组件为 [starts[i], starts[i + 1])
+    const ComponentRecord* m_components;
+    const uint8_t* m_componentData;
+    uint64_t m_componentDataSize;
+    const StringRef* m_assets;
+    const char* m_strings;
+    uint64_t m_stringsSize;
+
+public:
+    SceneFile();
+
+    SceneFile(const SceneFile&) = delete;
+    SceneFile& operator=(const SceneFile&) = delete;
+
+    // 映射文件并校验，版本不符、截断或引用越界时返回 false
+    bool open(const std::string& path);
+
+    // 从内存中的数据打开（如 serialize 的结果）
+    bool openBuffer(std::vector<uint8_t> buffer);
+
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    std::string getSceneName() const { return getString(m_sceneName); }
+
+    // 节点表
+    uint32_t getNodeCount() const { return m_nodeCount; }
+    uint32_t getParent(uint32_t node) const { return m_parents[node]; }
+    std::string getName(uint32_t node) const { return getString(m_names[node]); }
+    std::string getUUID(uint32_t node) const;
+    const math::float3* getPositions() const { return m_positions; }
+    const math::float3* getRotations() const { return m_rotations; }
+    const math::float3* getScales() const { return m_scales; }
+
+    // 组件
+    uint32_t getComponentCount() const { return m_componentCount; }
+    uint32_t getComponentStart(uint32_t node) const { return m_componentStarts[node]; }
+    uint32_t getComponentEnd(uint32_t node) const { return m_componentStarts[node + 1]; }
+    const ComponentRecord& getComponent(uint32_t component) const { return m_components[component]; }
+    const uint8_t* getComponentData(uint32_t component) const { return m_componentData + m_components[component].offset; }
+
+    // 资源表
+    uint32_t getAssetCount() const { return m_assetCount; }
+    std::string getAsset(uint32_t asset) const { return getString(m_assets[asset]); }
+
+    // 把所有节点和组件添加到场景根节点下，并设置场景名称；返回创建的节点数
+    size_t instantiate(Scene& scene) const;
+
+    // 导出为 JSON（节点按节点表顺序，每个字段一行），用于比较两个场景文件
+    bool exportJson(const std::string& path) const;
+
+    // 组件数据块的编码和解码，场景文件和自动保存日志共用
+    // 数据块大小，不认识的类型返回 0
+    static uint32_t getComponentDataSize(uint32_t type);
+
+    // 把组件的数据块追加到 data 并填写记录，网格路径经 addAsset 换成资源下标；不认识的组件返回 false
+    static bool encodeComponent(const Component& component, ComponentRecord& record, std::vector<uint8_t>& data,
+                                const std::function<uint32_t(const std::string&)>& addAsset);
+
+    // 按数据块为节点添加组件，data 的大小须为 getComponentDataSize(type)；越界的资源下标视为没有网格路径
+    static void decodeComponent(Node& node, uint32_t type, const uint8_t* data, const std::vector<std::string>& assets);
+
+    // 序列化场景（不含根节点本身），不认识的组件类型被忽略
+    static std::vector<uint8_t> serialize(const Scene& scene);
+
+    // 序列化并写入文件；先写临时文件再改名
+    static bool write(const std::string& path, const Scene& scene);
+
+private:
+    bool openData(const uint8_t* data, size_t size);
+    std::string getString(const StringRef& ref) const { return std::string(m_strings + ref.offset, ref.length); }
+};
+
+} // namespace Kazia
+
+#endif // SCENEFILE_H
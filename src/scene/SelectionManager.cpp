@@ -5,25 +5,46 @@
 
 namespace Kazia {
 
-SelectionManager::SelectionManager() : m_activeNode(nullptr) {
+SelectionManager::SelectionManager() : m_staleCount(0), m_selectionCount(0), m_activeNode(nullptr) {
+}
+
+bool SelectionManager::setBit(uint32_t id) {
+    if (!m_selectedBits.set(id)) {
+        return false;
+    }
+    m_selectionCount++;
+    return true;
+}
+
+bool SelectionManager::clearBit(uint32_t id) {
+    if (!m_selectedBits.clear(id)) {
+        return false;
+    }
+    m_selectionCount--;
+    return true;
+}
+
+void SelectionManager::append(Node* node) {
+    m_selectedNodes.push_back(node);
+    m_selectedIds.push_back(node->getId());
 }
 
 void SelectionManager::selectNode(Node* node) {
     if (!node) {
         return;
     }
-    
+
     // 检查节点是否已经被选中
-    if (isNodeSelected(node)) {
+    if (!setBit(node->getId())) {
         return;
     }
-    
+
     // 添加到选中列表
-    m_selectedNodes.push_back(node);
-    
+    append(node);
+
     // 设置为活动节点
     m_activeNode = node;
-    
+
     // 触发选择变化信号
     // onSelectionChanged();
 }
@@ -31,64 +52,195 @@ void SelectionManager::selectNode(Node* node) {
 void SelectionManager::selectNodes(const std::vector<Node*>& nodes) {
     // 清空当前选择
     deselectAll();
-    
-    // 添加新的选择
+
+    // 添加新的选择，活动节点为第一个选中的节点
+    addNodes(nodes);
+}
+
+void SelectionManager::addNodes(const std::vector<Node*>& nodes) {
+    m_selectedNodes.reserve(m_selectedNodes.size() + nodes.size());
+    m_selectedIds.reserve(m_selectedIds.size() + nodes.size());
     for (Node* node : nodes) {
-        if (node) {
-            m_selectedNodes.push_back(node);
+        if (node && setBit(node->getId())) {
+            append(node);
+            if (!m_activeNode) {
+                m_activeNode = node;
+            }
         }
     }
-    
-    // 设置活动节点为第一个选中的节点
-    if (!m_selectedNodes.empty()) {
-        m_activeNode = m_selectedNodes[0];
-    } else {
-        m_activeNode = nullptr;
-    }
-    
+
     // 触发选择变化信号
     // onSelectionChanged();
 }
 
 void SelectionManager::deselectNode(Node* node) {
-    if (!node) {
+    if (!node || !clearBit(node->getId())) {
         return;
     }
-    
-    // 从选中列表中移除
-    auto it = std::find(m_selectedNodes.begin(), m_selectedNodes.end(), node);
-    if (it != m_selectedNodes.end()) {
-        m_selectedNodes.erase(it);
-    }
-    
+
+    // 列表中的项留到压缩时再移除
+    m_staleCount++;
+
     // 如果移除的是活动节点，重新设置活动节点
     if (node == m_activeNode) {
-        if (!m_selectedNodes.empty()) {
-            m_activeNode = m_selectedNodes[0];
-        } else {
-            m_activeNode = nullptr;
+        resetActiveNode();
+    } else if (m_staleCount > m_selectionCount + 64) {
+        compact();
+    }
+
+    // 触发选择变化信号
+    // onSelectionChanged();
+}
+
+void SelectionManager::deselectNodes(const std::vector<Node*>& nodes) {
+    bool activeRemoved = false;
+    for (Node* node : nodes) {
+        if (node && clearBit(node->getId())) {
+            m_staleCount++;
+            activeRemoved = activeRemoved || node == m_activeNode;
         }
     }
-    
+
+    if (activeRemoved) {
+        resetActiveNode();
+    } else if (m_staleCount > m_selectionCount + 64) {
+        compact();
+    }
+
     // 触发选择变化信号
     // onSelectionChanged();
 }
 
 void SelectionManager::deselectAll() {
+    // 只清除已设置的位，代价与选择数量成正比
+    for (uint32_t id : m_selectedIds) {
+        m_selectedBits.clear(id);
+    }
     m_selectedNodes.clear();
+    m_selectedIds.clear();
+    m_staleCount = 0;
+    m_selectionCount = 0;
     m_activeNode = nullptr;
-    
+
+    // 触发选择变化信号
+    // onSelectionChanged();
+}
+
+void SelectionManager::selectAll(Node* root) {
+    if (!root) {
+        return;
+    }
+
+    std::vector<Node*> stack;
+    for (size_t i = 0; i < root->getChildCount(); ++i) {
+        stack.push_back(root->getChild(i));
+    }
+
+    while (!stack.empty()) {
+        Node* node = stack.back();
+        stack.pop_back();
+
+        if (setBit(node->getId())) {
+            append(node);
+        }
+        for (size_t i = 0; i < node->getChildCount(); ++i) {
+            stack.push_back(node->getChild(i));
+        }
+    }
+
+    if (!m_activeNode && !m_selectedNodes.empty()) {
+        m_activeNode = m_selectedNodes[0];
+    }
+
     // 触发选择变化信号
     // onSelectionChanged();
 }
 
+void SelectionManager::invertSelection(Node* root) {
+    if (!root) {
+        return;
+    }
+
+    std::vector<Node*> stack;
+    for (size_t i = 0; i < root->getChildCount(); ++i) {
+        stack.push_back(root->getChild(i));
+    }
+
+    bool activeRemoved = false;
+    while (!stack.empty()) {
+        Node* node = stack.back();
+        stack.pop_back();
+
+        if (clearBit(node->getId())) {
+            m_staleCount++;
+            activeRemoved = activeRemoved || node == m_activeNode;
+        } else {
+            setBit(node->getId());
+            append(node);
+        }
+        for (size_t i = 0; i < node->getChildCount(); ++i) {
+            stack.push_back(node->getChild(i));
+        }
+    }
+
+    // 反选后原有项全部过期，直接压缩
+    compact();
+    if (activeRemoved || !m_activeNode) {
+        m_activeNode = m_selectedNodes.empty() ? nullptr : m_selectedNodes[0];
+    }
+
+    // 触发选择变化信号
+    // onSelectionChanged();
+}
+
+const std::vector<Node*>& SelectionManager::getSelectedNodes() const {
+    if (m_staleCount > 0) {
+        compact();
+    }
+    return m_selectedNodes;
+}
+
 bool SelectionManager::isNodeSelected(Node* node) const {
     if (!node) {
         return false;
     }
-    
-    auto it = std::find(m_selectedNodes.begin(), m_selectedNodes.end(), node);
-    return it != m_selectedNodes.end();
+
+    return testBit(node->getId());
+}
+
+size_t SelectionManager::getMemorySize() const {
+    return m_selectedBits.getMemorySize() + m_compactBits.getMemorySize() + m_selectedNodes.capacity() * sizeof(Node*) +
+           m_selectedIds.capacity() * sizeof(uint32_t);
+}
+
+void SelectionManager::compact() const {
+    if (m_staleCount == 0) {
+        return;
+    }
+
+    // 从后向前保留每个仍被选中节点的最后一次出现（取消后重新选择的节点排在后面）
+    size_t write = m_selectedNodes.size();
+    for (size_t read = m_selectedNodes.size(); read-- > 0;) {
+        uint32_t id = m_selectedIds[read];
+        if (testBit(id) && m_compactBits.set(id)) {
+            --write;
+            m_selectedNodes[write] = m_selectedNodes[read];
+            m_selectedIds[write] = id;
+        }
+    }
+    m_selectedNodes.erase(m_selectedNodes.begin(), m_selectedNodes.begin() + write);
+    m_selectedIds.erase(m_selectedIds.begin(), m_selectedIds.begin() + write);
+
+    // 还原去重位图
+    for (uint32_t id : m_selectedIds) {
+        m_compactBits.clear(id);
+    }
+    m_staleCount = 0;
+}
+
+void SelectionManager::resetActiveNode() {
+    compact();
+    m_activeNode = m_selectedNodes.empty() ? nullptr : m_selectedNodes[0];
 }
 
 } // namespace Kazia
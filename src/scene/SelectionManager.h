@@ -1,40 +1,88 @@
 #ifndef SELECTIONMANAGER_H
 #define SELECTIONMANAGER_H
 
+#include <cstdint>
 #include <vector>
 #include <string>
 
+#include "core/PagedBitset.h"
+
 namespace Kazia {
 
 class Node;
 
+// 选择集
+// 成员关系用以 Node::getId() 为下标的分页位图保存，查询、添加、移除都是 O(1)，
+// 节点 ID 单调递增且不复用，位图只为含有选中节点的页分配内存；
+// 另有按选择顺序排列的列表，移除时只留下空位，读取列表或空位过多时再统一压缩
 class SelectionManager {
 private:
-    std::vector<Node*> m_selectedNodes;
+    // 按选择顺序排列，可能包含已取消选择的过期项；
+    // 过期项可能指向已删除的节点，因此同时保存 ID，压缩时不访问节点
+    mutable std::vector<Node*> m_selectedNodes;
+    mutable std::vector<uint32_t> m_selectedIds;
+    mutable size_t m_staleCount;
+
+    // 选择位图
+    PagedBitset m_selectedBits;
+
+    // 压缩时的去重位图，平时为空
+    mutable PagedBitset m_compactBits;
+
+    size_t m_selectionCount;
     Node* m_activeNode;
-    
+
 public:
     SelectionManager();
     ~SelectionManager() = default;
-    
+
     // 选择相关
     void selectNode(Node* node);
     void selectNodes(const std::vector<Node*>& nodes);
     void deselectNode(Node* node);
     void deselectAll();
-    
-    // 获取选中的节点
-    const std::vector<Node*>& getSelectedNodes() const { return m_selectedNodes; }
+
+    // 批量添加/移除，不影响其他已选节点
+    void addNodes(const std::vector<Node*>& nodes);
+    void deselectNodes(const std::vector<Node*>& nodes);
+
+    // 选择 root 的所有后代（不含 root 本身）
+    void selectAll(Node* root);
+
+    // 反选 root 的所有后代（不含 root 本身）
+    void invertSelection(Node* root);
+
+    // 获取选中的节点（按选择顺序）
+    const std::vector<Node*>& getSelectedNodes() const;
     Node* getActiveNode() const { return m_activeNode; }
-    
+
     // 检查节点是否被选中
     bool isNodeSelected(Node* node) const;
-    
+
     // 选择数量
-    size_t getSelectionCount() const { return m_selectedNodes.size(); }
-    
+    size_t getSelectionCount() const { return m_selectionCount; }
+
+    // 位图和选择列表占用的内存
+    size_t getMemorySize() const;
+
     // 信号（暂时留空，后续与 UI 系统集成）
     // void onSelectionChanged();
+
+private:
+    bool testBit(uint32_t id) const { return m_selectedBits.test(id); }
+
+    // 设置/清除选择位，返回状态是否发生变化
+    bool setBit(uint32_t id);
+    bool clearBit(uint32_t id);
+
+    // 追加到选择列表末尾
+    void append(Node* node);
+
+    // 移除过期项，保持选择顺序
+    void compact() const;
+
+    // 活动节点被取消选择时，改为最早选中的节点
+    void resetActiveNode();
 };
 
 } // namespace Kazia
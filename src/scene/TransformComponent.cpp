@@ -1,4 +1,5 @@
 #include "TransformComponent.h"
+#include "Node.h"
 
 namespace Kazia {
 
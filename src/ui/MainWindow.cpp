@@ -4,12 +4,20 @@
 #include "PropertiesPanel.h"
 #include "TitleBar.h"
 #include "DockTitleBar.h"
+#include "../scene/Scene.h"
+#include "../scene/SceneFile.h"
+#include "../scene/SceneAutosave.h"
 #include <QMenuBar>
 #include <QMenu>
 #include <QToolBar>
 #include <QApplication>
 #include <QVBoxLayout>
 #include <QWidget>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
+#include <QStandardPaths>
+#include <QFile>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -23,6 +31,10 @@ MainWindow::MainWindow(QWidget *parent)
     , m_coordinateInfo(nullptr)
     , m_fpsIndicator(nullptr)
     , m_logInfo(nullptr)
+    , m_frameStatsTimer(nullptr)
+    , m_lastFrameCount(0)
+    , m_scene(std::make_unique<Kazia::Scene>())
+    , m_autosaveTimer(nullptr)
 {
     // 设置无边框窗口
     setWindowFlags(Qt::FramelessWindowHint);
@@ -37,6 +49,7 @@ MainWindow::MainWindow(QWidget *parent)
 
     // 创建渲染视口
     m_renderWidget = new RenderWidget(this);
+    m_renderWidget->setScene(m_scene.get());
     setCentralWidget(m_renderWidget);
 
     // 创建菜单
@@ -50,6 +63,13 @@ MainWindow::MainWindow(QWidget *parent)
     
     // 设置状态栏
     setupStatusBar();
+    
+    // 上次没有正常退出时从自动保存日志恢复，然后开始自动保存
+    recoverAutosave();
+    m_autosaveTimer = new QTimer(this);
+    m_autosaveTimer->setSingleShot(true);
+    connect(m_autosaveTimer, &QTimer::timeout, this, &MainWindow::runAutosave);
+    startAutosave();
 
     // 设置布局
     resize(1200, 800);
@@ -57,6 +77,15 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    // 等待后台线程写完后再删除日志，自动保存须在场景之前销毁
+    if (m_autosave) {
+        m_autosaveTimer->stop();
+        m_autosave.reset();
+        QFile::remove(getAutosavePath());
+    }
+    
+    // 渲染视口在场景之后才随子对象销毁
+    m_renderWidget->setScene(nullptr);
 }
 
 void MainWindow::setupCustomTitleBar()
@@ -79,8 +108,10 @@ void MainWindow::createMenus()
     QMenu* fileMenu = menuBar->addMenu("文件");
     fileMenu->setObjectName("FileMenu");
     fileMenu->addAction("新建", this, nullptr, QKeySequence::New);
-    fileMenu->addAction("打开", this, nullptr, QKeySequence::Open);
-    fileMenu->addAction("保存", this, nullptr, QKeySequence::Save);
+    fileMenu->addAction("打开", this, &MainWindow::openScene, QKeySequence::Open);
+    fileMenu->addAction("保存", this, &MainWindow::saveScene, QKeySequence::Save);
+    fileMenu->addAction("另存为", this, &MainWindow::saveSceneAs, QKeySequence::SaveAs);
+    fileMenu->addAction("导出 JSON", this, &MainWindow::exportSceneJson);
     fileMenu->addSeparator();
     fileMenu->addAction("退出", this, &QApplication::quit);
 
@@ -111,8 +142,8 @@ void MainWindow::createToolbars()
     QToolBar* mainToolbar = addToolBar("主工具栏");
     mainToolbar->setObjectName("MainToolbar");
     mainToolbar->addAction("新建");
-    mainToolbar->addAction("打开");
-    mainToolbar->addAction("保存");
+    mainToolbar->addAction("打开", this, &MainWindow::openScene);
+    mainToolbar->addAction("保存", this, &MainWindow::saveScene);
     mainToolbar->addSeparator();
     mainToolbar->addAction("撤销");
     mainToolbar->addAction("重做");
@@ -239,11 +270,16 @@ void MainWindow::setupStatusBar()
     statusBar->addWidget(separator2);
     
     // 创建FPS性能指标显示
-    m_fpsIndicator = new QLabel("FPS: 60", this);
+    m_fpsIndicator = new QLabel("FPS: 0", this);
     m_fpsIndicator->setObjectName("FpsIndicator");
     m_fpsIndicator->setMinimumWidth(80);
     statusBar->addWidget(m_fpsIndicator);
     
+    // 每 500 毫秒刷新一次帧率和帧时间
+    m_frameStatsTimer = new QTimer(this);
+    connect(m_frameStatsTimer, &QTimer::timeout, this, &MainWindow::updateFrameStats);
+    m_frameStatsTimer->start(500);
+    
     // 添加分隔线
     QFrame* separator3 = new QFrame(this);
     separator3->setObjectName("StatusBarSeparator");
@@ -259,3 +295,142 @@ void MainWindow::setupStatusBar()
     m_logInfo->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
     statusBar->addWidget(m_logInfo);
 }
+
+void MainWindow::updateFrameStats()
+{
+    if (!m_renderWidget || !m_fpsIndicator) {
+        return;
+    }
+    
+    // 按需渲染时空闲期间不出帧，帧率按实际渲染的帧数计算
+    Kazia::FrameTiming timing = m_renderWidget->getFrameTiming();
+    double fps = static_cast<double>(timing.frameCount - m_lastFrameCount) * 1000.0 / m_frameStatsTimer->interval();
+    m_lastFrameCount = timing.frameCount;
+    
+    m_fpsIndicator->setText(QString("FPS: %1").arg(fps, 0, 'f', 0));
+    m_fpsIndicator->setToolTip(QString("帧时间: 平均 %1 ms，最大 %2 ms")
+        .arg(timing.averageFrameMs, 0, 'f', 2)
+        .arg(timing.maxFrameMs, 0, 'f', 2));
+}
+
+void MainWindow::openScene()
+{
+    QString path = QFileDialog::getOpenFileName(this, "打开场景", m_scenePath, "Kazia 场景 (*.kscene)");
+    if (path.isEmpty()) {
+        return;
+    }
+    
+    // 映射文件后按节点表直接创建节点，失败时保留当前场景
+    Kazia::SceneFile file;
+    if (!file.open(path.toStdString())) {
+        QMessageBox::warning(this, "打开场景", QString("无法打开场景文件 %1").arg(path));
+        return;
+    }
+    auto scene = std::make_unique<Kazia::Scene>();
+    file.instantiate(*scene);
+    m_autosave.reset();
+    m_scene = std::move(scene);
+    m_renderWidget->setScene(m_scene.get());
+    m_scenePath = path;
+    startAutosave();
+    
+    refreshSceneTree();
+    m_logInfo->setText(QString("已打开 %1（%2 个节点）").arg(QFileInfo(path).fileName()).arg(file.getNodeCount()));
+}
+
+void MainWindow::saveScene()
+{
+    if (m_scenePath.isEmpty()) {
+        saveSceneAs();
+        return;
+    }
+    
+    if (!Kazia::SceneFile::write(m_scenePath.toStdString(), *m_scene)) {
+        QMessageBox::warning(this, "保存场景", QString("无法写入场景文件 %1").arg(m_scenePath));
+        return;
+    }
+    m_logInfo->setText(QString("已保存 %1").arg(QFileInfo(m_scenePath).fileName()));
+}
+
+void MainWindow::saveSceneAs()
+{
+    QString path = QFileDialog::getSaveFileName(this, "保存场景", m_scenePath, "Kazia 场景 (*.kscene)");
+    if (path.isEmpty()) {
+        return;
+    }
+    if (QFileInfo(path).suffix().isEmpty()) {
+        path += ".kscene";
+    }
+    
+    m_scenePath = path;
+    saveScene();
+}
+
+void MainWindow::exportSceneJson()
+{
+    QString path = QFileDialog::getSaveFileName(this, "导出 JSON", QString(), "JSON (*.json)");
+    if (path.isEmpty()) {
+        return;
+    }
+    
+    // 与保存的文件使用同一份序列化结果，导出的内容与场景文件一致
+    Kazia::SceneFile file;
+    if (!file.openBuffer(Kazia::SceneFile::serialize(*m_scene)) || !file.exportJson(path.toStdString())) {
+        QMessageBox::warning(this, "导出 JSON", QString("无法导出到 %1").arg(path));
+        return;
+    }
+    m_logInfo->setText(QString("已导出 %1").arg(QFileInfo(path).fileName()));
+}
+
+void MainWindow::refreshSceneTree()
+{
+    // 场景树只列出顶层节点
+    m_sceneTree->clear();
+    Kazia::Node* root = m_scene->getRootNode();
+    for (size_t i = 0; i < root->getChildCount(); ++i) {
+        m_sceneTree->addGameObject(QString::fromStdString(root->getChild(i)->getName()));
+    }
+}
+
+QString MainWindow::getAutosavePath() const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/autosave.kjournal";
+}
+
+void MainWindow::startAutosave()
+{
+    // 第一次写入用当前场景的完整快照替换旧日志（目录不存在时创建）
+    m_autosave = std::make_unique<Kazia::SceneAutosave>(*m_scene, getAutosavePath().toStdString());
+    m_autosaveTimer->start(0);
+}
+
+void MainWindow::runAutosave()
+{
+    // 每次只复制有限的分块，还有剩余时下一帧继续，全部交出后等到下一个周期
+    m_autosave->capture();
+    m_autosaveTimer->start(m_autosave->hasPendingChanges() ? 16 : 5000);
+}
+
+void MainWindow::recoverAutosave()
+{
+    QString path = getAutosavePath();
+    if (!QFile::exists(path)) {
+        return;
+    }
+    
+    QMessageBox::StandardButton button = QMessageBox::question(this, "恢复场景", "编辑器上次没有正常退出，是否恢复自动保存的场景？");
+    if (button != QMessageBox::Yes) {
+        return;
+    }
+    
+    auto scene = std::make_unique<Kazia::Scene>();
+    if (!Kazia::SceneAutosave::recover(path.toStdString(), *scene)) {
+        QMessageBox::warning(this, "恢复场景", "自动保存的日志已损坏，无法恢复");
+        return;
+    }
+    m_scene = std::move(scene);
+    m_renderWidget->setScene(m_scene.get());
+    
+    refreshSceneTree();
+    m_logInfo->setText("已从自动保存恢复场景");
+}
@@ -7,6 +7,15 @@
 #include <QDockWidget>
 #include <QLabel>
 #include <QStatusBar>
+#include <QTimer>
+#include <QString>
+
+#include <memory>
+
+namespace Kazia {
+class Scene;
+class SceneAutosave;
+}
 
 class RenderWidget;
 class SceneTree;
@@ -31,12 +40,38 @@ private:
     QLabel* m_coordinateInfo;
     QLabel* m_fpsIndicator;
     QLabel* m_logInfo;
+    
+    // 定时刷新帧率显示
+    QTimer* m_frameStatsTimer;
+    uint64_t m_lastFrameCount;
+    
+    // 当前编辑的场景及其文件路径（尚未保存过时为空）
+    std::unique_ptr<Kazia::Scene> m_scene;
+    QString m_scenePath;
+    
+    // 自动保存：定时复制有修改的部分交给后台线程写入日志，正常退出时删除日志
+    std::unique_ptr<Kazia::SceneAutosave> m_autosave;
+    QTimer* m_autosaveTimer;
 
     void createMenus();
     void createToolbars();
     void createDockWidgets();
     void setupCustomTitleBar();
     void setupStatusBar();
+    void updateFrameStats();
+    
+    // 场景文件
+    void openScene();
+    void saveScene();
+    void saveSceneAs();
+    void exportSceneJson();
+    void refreshSceneTree();
+    
+    // 自动保存
+    QString getAutosavePath() const;
+    void startAutosave();
+    void runAutosave();
+    void recoverAutosave();
 
 public:
     MainWindow(QWidget *parent = nullptr);
@@ -46,6 +81,7 @@ public:
     SceneTree* getSceneTree() const { return m_sceneTree; }
     PropertiesPanel* getPropertiesPanel() const { return m_propertiesPanel; }
     TitleBar* getTitleBar() const { return m_titleBar; }
+    Kazia::Scene* getScene() const { return m_scene.get(); }
 
 protected:
     void resizeEvent(QResizeEvent* event) override;
@@ -1,20 +1,28 @@
 #include "RenderWidget.h"
+#include "../scene/Scene.h"
 #include <QtOpenGLWidgets/QOpenGLWidget>
 #include <QOpenGLFunctions>
 #include <QTimer>
 #include <QMouseEvent>
 #include <QWheelEvent>
+#include <QScreen>
 
 RenderWidget::RenderWidget(QWidget *parent)
     : QOpenGLWidget(parent)
     , m_renderer(nullptr)
+    , m_renderThread(nullptr)
     , m_renderTimer(nullptr)
     , m_isDragging(false)
     , m_cameraDistance(5.0f)
     , m_cameraYaw(0.0f)
     , m_cameraPitch(0.0f)
-    , m_initialWidth(0)
-    , m_initialHeight(0)
+    , m_cameraPosition(0.0f, 0.0f, 5.0f)
+    , m_viewportWidth(0)
+    , m_viewportHeight(0)
+    , m_scene(nullptr)
+    , m_publishedUpdateCount(0)
+    , m_publishedStructureVersion(0)
+    , m_publishAllTransforms(true)
 {
     // 设置 OpenGL 格式
     QSurfaceFormat format;
@@ -24,9 +32,11 @@ RenderWidget::RenderWidget(QWidget *parent)
     format.setStencilBufferSize(8);
     setFormat(format);
 
-    // 创建渲染定时器
+    // 创建渲染定时器，需要新帧时才启动
     m_renderTimer = new QTimer(this);
-    connect(m_renderTimer, &QTimer::timeout, this, &RenderWidget::renderFrame);
+    m_renderTimer->setSingleShot(true);
+    m_renderTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_renderTimer, &QTimer::timeout, this, &RenderWidget::onFrameTimer);
 }
 
 RenderWidget::~RenderWidget()
@@ -51,24 +61,21 @@ void RenderWidget::initializeGL()
 {
     initializeRenderer();
 
-    // 启动渲染定时器
-    m_renderTimer->start(16); // 约 60 FPS
+    // 渲染第一帧
+    requestFrame();
 }
 
 void RenderWidget::paintGL()
 {
-    renderFrame();
+    requestFrame();
 }
 
 void RenderWidget::resizeGL(int w, int h)
 {
-    if (m_renderer) {
-        m_renderer->resize(w, h);
-    } else {
-        // 存储初始大小，以便在渲染器初始化时使用
-        m_initialWidth = w;
-        m_initialHeight = h;
-    }
+    // 只记录大小，由下一份快照带到渲染线程
+    m_viewportWidth = w;
+    m_viewportHeight = h;
+    requestFrame();
 }
 
 void RenderWidget::mousePressEvent(QMouseEvent* event)
@@ -91,14 +98,7 @@ void RenderWidget::mouseMoveEvent(QMouseEvent* event)
         // 限制俯仰角范围
         m_cameraPitch = qMax(-1.5f, qMin(1.5f, m_cameraPitch));
         
-        // 计算相机位置
-        float x = m_cameraDistance * cos(m_cameraYaw) * cos(m_cameraPitch);
-        float y = m_cameraDistance * sin(m_cameraPitch);
-        float z = m_cameraDistance * sin(m_cameraYaw) * cos(m_cameraPitch);
-        
-        if (m_renderer) {
-            m_renderer->setCameraPosition(filament::math::float3{x, y, z});
-        }
+        updateCameraPosition();
         
         m_lastMousePos = event->pos();
     }
@@ -117,14 +117,88 @@ void RenderWidget::wheelEvent(QWheelEvent* event)
     m_cameraDistance -= event->angleDelta().y() * 0.001f;
     m_cameraDistance = qMax(1.0f, qMin(20.0f, m_cameraDistance));
     
-    // 计算相机位置
+    updateCameraPosition();
+}
+
+void RenderWidget::updateCameraPosition()
+{
+    // 计算相机位置，在下一份快照中生效
     float x = m_cameraDistance * cos(m_cameraYaw) * cos(m_cameraPitch);
     float y = m_cameraDistance * sin(m_cameraPitch);
     float z = m_cameraDistance * sin(m_cameraYaw) * cos(m_cameraPitch);
-    
-    if (m_renderer) {
-        m_renderer->setCameraPosition(filament::math::float3{x, y, z});
+    m_cameraPosition = Kazia::math::float3(x, y, z);
+    requestFrame();
+}
+
+void RenderWidget::setScene(Kazia::Scene* scene)
+{
+    m_scene = scene;
+    m_publishAllTransforms = true;
+    requestFrame();
+}
+
+void RenderWidget::requestFrame()
+{
+    m_frameScheduler.requestFrame();
+    scheduleFrame();
+}
+
+void RenderWidget::beginAnimation()
+{
+    m_frameScheduler.beginAnimation();
+    scheduleFrame();
+}
+
+void RenderWidget::endAnimation()
+{
+    m_frameScheduler.endAnimation();
+    scheduleFrame();
+}
+
+void RenderWidget::setMaxFrameRate(float maxFrameRate)
+{
+    m_frameScheduler.setMaxFrameRate(maxFrameRate);
+
+    if (m_renderThread) {
+        Renderer* renderer = m_renderer;
+        float refreshRate = m_frameScheduler.getRefreshRate();
+        uint32_t presentInterval = m_frameScheduler.getPresentInterval();
+        m_renderThread->post([renderer, refreshRate, presentInterval]() {
+            renderer->setFramePacing(refreshRate, presentInterval);
+        });
+    }
+}
+
+Kazia::FrameTiming RenderWidget::getFrameTiming() const
+{
+    return m_renderThread ? m_renderThread->getFrameTiming() : Kazia::FrameTiming();
+}
+
+void RenderWidget::scheduleFrame()
+{
+    if (!m_renderThread || m_renderTimer->isActive()) {
+        return;
+    }
+
+    int delay = m_frameScheduler.getDelayUntilNextFrame(Kazia::FrameScheduler::Clock::now());
+    if (delay >= 0) {
+        m_renderTimer->start(delay);
+    }
+}
+
+void RenderWidget::onFrameTimer()
+{
+    if (!m_renderThread || !m_frameScheduler.needsFrame()) {
+        return;
+    }
+
+    // 渲染线程还没取走上一份快照时不再发布，等该帧渲染完成后再调度
+    if (m_renderThread->hasPendingSnapshot()) {
+        return;
     }
+
+    publishSnapshot();
+    m_frameScheduler.onFramePublished(Kazia::FrameScheduler::Clock::now());
 }
 
 void RenderWidget::initializeRenderer()
@@ -135,19 +209,56 @@ void RenderWidget::initializeRenderer()
     // 获取本地窗口句柄
     void* nativeWindow = reinterpret_cast<void*>(winId());
 
-    // 使用存储的初始大小或当前窗口大小
-    int initWidth = (m_initialWidth > 0) ? m_initialWidth : width();
-    int initHeight = (m_initialHeight > 0) ? m_initialHeight : height();
+    // 使用记录的大小或当前窗口大小
+    if (m_viewportWidth <= 0 || m_viewportHeight <= 0) {
+        m_viewportWidth = width();
+        m_viewportHeight = height();
+    }
+    int initWidth = m_viewportWidth;
+    int initHeight = m_viewportHeight;
 
-    // 初始化渲染器
-    m_renderer->initialize(nativeWindow, initWidth, initHeight);
+    // 按显示器刷新率对齐帧间隔
+    if (screen()) {
+        m_frameScheduler.setRefreshRate(static_cast<float>(screen()->refreshRate()));
+    }
+    float refreshRate = m_frameScheduler.getRefreshRate();
+    uint32_t presentInterval = m_frameScheduler.getPresentInterval();
+
+    // 启动渲染线程，每取到一份快照渲染一帧，完成后回到主线程调度下一帧
+    Renderer* renderer = m_renderer;
+    m_renderThread = new Kazia::RenderThread();
+    m_renderThread->start([this, renderer](const Kazia::RenderSnapshot& snapshot) {
+        renderer->applySnapshot(snapshot);
+        renderer->renderFrame();
+        QMetaObject::invokeMethod(this, [this]() { scheduleFrame(); }, Qt::QueuedConnection);
+    });
+
+    // Filament 引擎在渲染线程上创建，之后只在该线程上使用
+    m_renderThread->post([renderer, nativeWindow, initWidth, initHeight, refreshRate, presentInterval]() {
+        renderer->initialize(nativeWindow, initWidth, initHeight);
+        renderer->setFramePacing(refreshRate, presentInterval);
+    });
 }
 
 void RenderWidget::shutdownRenderer()
 {
+    if (m_renderThread) {
+        // 在渲染线程上关闭渲染器，然后等待线程退出
+        Renderer* renderer = m_renderer;
+        m_renderThread->post([renderer]() {
+            try {
+                renderer->shutdown();
+            } catch (...) {
+                // 忽略关闭渲染器时的错误
+            }
+        });
+        m_renderThread->stop();
+        delete m_renderThread;
+        m_renderThread = nullptr;
+    }
+
     if (m_renderer) {
         try {
-            m_renderer->shutdown();
             delete m_renderer;
             m_renderer = nullptr;
         } catch (...) {
@@ -157,9 +268,32 @@ void RenderWidget::shutdownRenderer()
     }
 }
 
-void RenderWidget::renderFrame()
+void RenderWidget::publishSnapshot()
 {
-    if (m_renderer) {
-        m_renderer->renderFrame();
+    if (!m_renderThread) {
+        return;
+    }
+
+    Kazia::RenderSnapshot& snapshot = m_renderThread->beginSnapshot();
+    snapshot.width = m_viewportWidth;
+    snapshot.height = m_viewportHeight;
+    snapshot.cameraPosition = m_cameraPosition;
+    snapshot.cameraTarget = Kazia::math::float3(0.0f, 0.0f, 0.0f);
+    snapshot.cameraUp = Kazia::math::float3(0.0f, 1.0f, 0.0f);
+
+    // 更新场景后只带上变化的节点变换；首帧、换了场景、层级结构变化或漏掉了某次 update（变化列表不完整）时全量采集
+    if (m_scene) {
+        m_scene->update();
+        uint64_t updateCount = m_scene->getUpdateCount();
+        uint64_t structureVersion = m_scene->getStructureVersion();
+        if (m_publishAllTransforms || structureVersion != m_publishedStructureVersion || updateCount > m_publishedUpdateCount + 1) {
+            snapshot.captureTransforms(m_scene->getRootNode());
+        } else {
+            snapshot.captureChangedTransforms(m_scene->getChangedNodes());
+        }
+        m_publishedUpdateCount = updateCount;
+        m_publishedStructureVersion = structureVersion;
+        m_publishAllTransforms = false;
     }
+    m_renderThread->publishSnapshot();
 }
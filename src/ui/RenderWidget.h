@@ -9,6 +9,12 @@
 #include <QTimer>
 
 #include "../core/Renderer.h"
+#include "../render/RenderThread.h"
+#include "../render/FrameScheduler.h"
+
+namespace Kazia {
+class Scene;
+}
 
 class RenderWidget : public QOpenGLWidget
 {
@@ -16,7 +22,13 @@ class RenderWidget : public QOpenGLWidget
 
 private:
     Renderer* m_renderer;
+    
+    // 渲染器的所有调用都在渲染线程上执行，主线程只发布快照
+    Kazia::RenderThread* m_renderThread;
+    
+    // 按需发布快照：单次定时器，只在有新帧需要渲染时启动
     QTimer* m_renderTimer;
+    Kazia::FrameScheduler m_frameScheduler;
 
     // 相机控制变量
     bool m_isDragging;
@@ -24,13 +36,23 @@ private:
     float m_cameraDistance;
     float m_cameraYaw;
     float m_cameraPitch;
+    Kazia::math::float3 m_cameraPosition;
     
-    // 初始窗口大小
-    int m_initialWidth;
-    int m_initialHeight;
+    // 当前窗口大小
+    int m_viewportWidth;
+    int m_viewportHeight;
+
+    // 渲染的场景，发布快照时据其修改跟踪带上变化的节点变换
+    Kazia::Scene* m_scene;
+    uint64_t m_publishedUpdateCount;
+    uint64_t m_publishedStructureVersion;
+    bool m_publishAllTransforms;
 
     void initializeRenderer();
     void shutdownRenderer();
+    void updateCameraPosition();
+    void scheduleFrame();
+    void publishSnapshot();
 
 protected:
     void initializeGL() override;
@@ -48,8 +70,25 @@ public:
 
     Renderer* getRenderer() const { return m_renderer; }
 
+    // 设置渲染的场景（可为 nullptr），下一份快照带上全部节点的变换
+    void setScene(Kazia::Scene* scene);
+
+    // 场景、相机或视口变化后请求重绘
+    void requestFrame();
+
+    // 动画期间连续渲染，begin/end 需成对调用
+    void beginAnimation();
+    void endAnimation();
+
+    // 帧率上限，0 表示跟随显示器刷新率
+    void setMaxFrameRate(float maxFrameRate);
+    float getMaxFrameRate() const { return m_frameScheduler.getMaxFrameRate(); }
+
+    // 帧时间统计
+    Kazia::FrameTiming getFrameTiming() const;
+
 private slots:
-    void renderFrame();
+    void onFrameTimer();
 };
 
 #endif // RENDERINGWIDGET_H
@@ -0,0 +1,50 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 只读内存映射文件
+// 映射后由操作系统按页载入，访问时才产生实际 I/O；映射的页属于页缓存，内存紧张时可以直接丢弃，
+// 不占用交换空间。可以在多个线程中同时读取
+class MappedFile
+{
+public:
+    // 访问模式提示
+    enum class Advice {
+        WillNeed,   // 即将读取，提前预读
+        DontNeed    // 不再需要，从本进程的工作集中移除（数据仍可再次访问）
+    };
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#else
+    int m_file;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 打开并映射整个文件，空文件或失败时返回 false
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+    // 范围越界的部分会被忽略
+    void advise(size_t offset, size_t size, Advice advice) const;
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,233 @@
+// 异步文件读取基准
+// 生成大量小文件（大小在 0 到 2 倍 --size 之间变化，另有一个空文件和一个不存在的路径），
+// 分别用调用线程上的阻塞读取、线程池 pread 后备和 io_uring 读取全部文件，校验内容，
+// 报告耗时、吞吐、每秒文件数和提交读取的系统调用次数。每轮之前丢弃这些文件的页缓存，模拟冷启动
+//
+// 用法：AsyncReadBenchmark [--files 4000] [--size 16] [--queue-depth 256] [--threads 4] [--directory 目录]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "core/AsyncFileReader.h"
+
+using namespace Kazia;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+uint8_t expectedByte(size_t file, size_t offset) {
+    return static_cast<uint8_t>(file * 31 + offset * 7);
+}
+
+bool checkContent(size_t file, const uint8_t* data, size_t size, size_t expectedSize) {
+    if (size != expectedSize) {
+        return false;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] != expectedByte(file, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 丢弃文件的页缓存（只对已写回的页有效，写入后先 sync）
+void dropCache(const std::vector<std::string>& paths) {
+#if defined(__linux__)
+    for (const std::string& path : paths) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            ::close(fd);
+        }
+    }
+#else
+    (void)paths;
+#endif
+}
+
+struct RunResult {
+    double ms = 0.0;
+    size_t bytes = 0;
+    size_t failures = 0;
+    size_t mismatches = 0;
+};
+
+void printRun(const char* name, const RunResult& run, size_t fileCount, size_t syscalls, size_t fixedReads) {
+    std::printf("%-10s %8.1f ms  %7.1f MB/s  %8.0f files/s  read syscalls %zu  fixed-buffer reads %zu  failed %zu\n",
+                name, run.ms, run.bytes / 1048576.0 / (run.ms / 1000.0), fileCount / (run.ms / 1000.0),
+                syscalls, fixedReads, run.failures);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t fileCount = 4000;
+    size_t sizeKb = 16;
+    uint32_t queueDepth = 256;
+    uint32_t threads = 4;
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "kazia_async_read_benchmark";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--files") == 0) {
+            fileCount = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--size") == 0) {
+            sizeKb = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--queue-depth") == 0) {
+            queueDepth = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--threads") == 0) {
+            threads = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--directory") == 0) {
+            directory = argv[i + 1];
+        } else {
+            std::fprintf(stderr, "usage: AsyncReadBenchmark [--files N] [--size KB] [--queue-depth N] [--threads N] [--directory DIR]\n");
+            return 2;
+        }
+    }
+    if (fileCount == 0) {
+        std::fprintf(stderr, "usage: AsyncReadBenchmark [--files N] [--size KB] [--queue-depth N] [--threads N] [--directory DIR]\n");
+        return 2;
+    }
+
+    // 生成文件，第 0 个为空文件，最后一个路径不存在
+    auto setupStart = Clock::now();
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    std::vector<std::string> paths(fileCount + 1);
+    std::vector<size_t> sizes(fileCount + 1, 0);
+    size_t totalBytes = 0;
+    std::vector<uint8_t> content;
+    for (size_t i = 0; i < fileCount; ++i) {
+        paths[i] = (directory / ("asset" + std::to_string(i) + ".bin")).string();
+        sizes[i] = i == 0 ? 0 : (i * 2654435761u) % (2 * sizeKb * 1024 + 1);
+        content.resize(sizes[i]);
+        for (size_t j = 0; j < sizes[i]; ++j) {
+            content[j] = expectedByte(i, j);
+        }
+        std::ofstream file(paths[i], std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(content.data()), static_cast<std::streamsize>(content.size()));
+        totalBytes += sizes[i];
+    }
+    paths[fileCount] = (directory / "missing.bin").string();
+    std::filesystem::remove(paths[fileCount], error);
+#ifndef _WIN32
+    ::sync();
+#endif
+    std::printf("%zu files  %.1f MB  queue depth %u  threads %u  setup %.0f ms\n", fileCount, totalBytes / 1048576.0,
+                queueDepth, threads, elapsedMs(setupStart));
+
+    bool ok = true;
+
+    // 阻塞读取：调用线程上逐个打开并读取
+    {
+        dropCache(paths);
+        RunResult run;
+        size_t syscalls = 0;
+        auto start = Clock::now();
+        std::vector<uint8_t> data;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            std::ifstream file(paths[i], std::ios::binary | std::ios::ate);
+            if (!file) {
+                run.failures++;
+                continue;
+            }
+            data.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            syscalls++;
+            run.bytes += data.size();
+            if (!checkContent(i, data.data(), data.size(), sizes[i])) {
+                run.mismatches++;
+            }
+        }
+        run.ms = elapsedMs(start);
+        printRun("blocking", run, paths.size(), syscalls, 0);
+        ok &= run.failures == 1 && run.mismatches == 0 && run.bytes == totalBytes;
+    }
+
+    // 线程池 pread 后备和 io_uring
+    for (int mode = 0; mode < 2; ++mode) {
+        AsyncFileReader::Options options;
+        options.queueDepth = queueDepth;
+        options.fallbackThreads = threads;
+        options.useIoUring = mode == 1;
+        AsyncFileReader reader(options);
+        if (mode == 1 && reader.getBackend() != AsyncFileReader::Backend::IoUring) {
+            std::printf("io_uring   not available\n");
+            continue;
+        }
+
+        dropCache(paths);
+        RunResult run;
+        auto start = Clock::now();
+        for (size_t i = 0; i < paths.size(); ++i) {
+            reader.readFile(paths[i], [&run, &sizes, i](const AsyncFileReader::Result& result) {
+                if (result.error != 0) {
+                    run.failures++;
+                    return;
+                }
+                run.bytes += result.size;
+                if (!checkContent(i, result.data, result.size, sizes[i])) {
+                    run.mismatches++;
+                }
+            });
+        }
+        reader.wait();
+        run.ms = elapsedMs(start);
+
+        AsyncFileReader::Stats stats = reader.getStats();
+        printRun(mode == 1 ? "io_uring" : "pread", run, paths.size(), stats.submitCalls, stats.fixedBufferReads);
+        ok &= run.failures == 1 && run.mismatches == 0 && run.bytes == totalBytes;
+        ok &= stats.requests == paths.size() && stats.completed == paths.size() && stats.failed == 1 && stats.bytesRead == totalBytes;
+    }
+
+    // 部分读取：每个文件的后半部分，回调中再请求前半部分（大小为 0 表示读到末尾，只取两字节以上的文件）
+    {
+        AsyncFileReader reader;
+        size_t mismatches = 0;
+        size_t callbacks = 0;
+        size_t expectedCallbacks = 0;
+        for (size_t i = 1; i < fileCount; ++i) {
+            size_t half = sizes[i] / 2;
+            if (half == 0) {
+                continue;
+            }
+            expectedCallbacks += 2;
+            reader.read(paths[i], half, sizes[i] - half, [&, i, half](const AsyncFileReader::Result& result) {
+                callbacks++;
+                for (size_t j = 0; j < result.size; ++j) {
+                    mismatches += result.data[j] != expectedByte(i, half + j);
+                }
+                mismatches += result.size != sizes[i] - half;
+                reader.read(paths[i], 0, half, [&, i, half](const AsyncFileReader::Result& first) {
+                    callbacks++;
+                    mismatches += !checkContent(i, first.data, first.size, half);
+                });
+            });
+        }
+        reader.wait();
+        ok &= mismatches == 0 && callbacks == expectedCallbacks;
+    }
+
+    for (size_t i = 0; i < fileCount; ++i) {
+        std::filesystem::remove(paths[i], error);
+    }
+    std::printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
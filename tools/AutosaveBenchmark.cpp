@@ -0,0 +1,248 @@
+// 自动保存基准
+// 生成节点数可配置的场景（结构与 SceneFileBenchmark 相同），测量首次完整保存时每次 capture
+// 在调用线程上的最大耗时；之后做若干轮编辑（移动、改名、添加和删除节点），每轮 capture 后
+// 等待写入，报告日志大小和压缩次数。最后从日志恢复，恢复的场景序列化后应与原场景相同；
+// 截断最后一次提交的日志应恢复到提交之前的状态；写入失败后应自动重试
+//
+// 用法：AutosaveBenchmark [--nodes 1000000] [--rounds 20] [--edits 100] [--file 路径]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "scene/LightComponent.h"
+#include "scene/MeshComponent.h"
+#include "scene/Node.h"
+#include "scene/Scene.h"
+#include "scene/SceneAutosave.h"
+#include "scene/SceneFile.h"
+
+using namespace Kazia;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void buildScene(Scene& scene, size_t nodeCount) {
+    Node* group = nullptr;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        if (i % 100 == 0) {
+            auto groupNode = std::make_unique<Node>("Group " + std::to_string(i / 100));
+            group = groupNode.get();
+            group->setPosition({static_cast<float>(i % 1000), 0.0f, static_cast<float>(i / 1000)});
+            LightComponent* light = group->addComponent<LightComponent>();
+            light->setLightType(LightManager::Type::POINT);
+            light->setRadius(5.0f + static_cast<float>(i % 7));
+            scene.addNode(std::move(groupNode));
+            continue;
+        }
+        auto node = std::make_unique<Node>("Node " + std::to_string(i));
+        node->setPosition({0.1f * static_cast<float>(i % 100), 0.5f, 0.0f});
+        MeshComponent* mesh = node->addComponent<MeshComponent>();
+        mesh->setMeshPath("assets/meshes/prop" + std::to_string(i % 16) + ".glb");
+        group->addChild(std::move(node));
+    }
+}
+
+// 把所有修改交给后台线程，返回 capture 的次数
+size_t captureAll(SceneAutosave& autosave) {
+    size_t count = 0;
+    do {
+        autosave.capture();
+        count++;
+    } while (autosave.hasPendingChanges());
+    return count;
+}
+
+// 随机选一个组下的一个子节点，没有时返回 nullptr
+Node* pickNode(Scene& scene, std::mt19937& random) {
+    Node* root = scene.getRootNode();
+    if (root->getChildCount() == 0) {
+        return nullptr;
+    }
+    Node* group = root->getChild(random() % root->getChildCount());
+    if (group->getChildCount() == 0) {
+        return group;
+    }
+    return group->getChild(random() % group->getChildCount());
+}
+
+void editScene(Scene& scene, size_t edits, std::mt19937& random) {
+    Node* root = scene.getRootNode();
+    for (size_t i = 0; i < edits; ++i) {
+        Node* node = pickNode(scene, random);
+        if (!node) {
+            return;
+        }
+        switch (random() % 8) {
+        case 0:
+            node->setName("Renamed " + std::to_string(random()));
+            break;
+        case 1: {
+            // 移到另一个组下
+            Node* group = root->getChild(random() % root->getChildCount());
+            if (node->getParent() != root && group != node->getParent()) {
+                node->setParent(group);
+            }
+            break;
+        }
+        case 2:
+            node->addChild(std::make_unique<Node>("Added " + std::to_string(i)));
+            break;
+        case 3:
+            if (node->getParent() != root) {
+                node->getParent()->removeChild(node);
+            }
+            break;
+        default:
+            node->setPosition({static_cast<float>(random() % 100), 1.0f, 2.0f});
+            break;
+        }
+    }
+}
+
+// 写入失败后不需要新的修改也会重试：日志所在的目录先被同名文件占住，移除后应写入成功
+bool testRetry(const std::string& path) {
+    std::filesystem::path blocker = std::filesystem::path(path).parent_path() / "kazia_autosave_retry";
+    std::error_code error;
+    std::filesystem::remove_all(blocker, error);
+    std::fclose(std::fopen(blocker.string().c_str(), "wb"));
+
+    Scene scene("Retry");
+    buildScene(scene, 1000);
+    SceneAutosave::Options options;
+    options.retryDelayMs = 10;
+    SceneAutosave autosave(scene, (blocker / "scene.kjournal").string(), options);
+    captureAll(autosave);
+    bool ok = !autosave.flush() && autosave.getStats().failedWrites > 0;
+
+    // 首次保存只复制有节点的分块：ID 在进程内共享，其余分块属于其他场景
+    std::vector<uint32_t> chunks;
+    scene.getRootNode()->traverse([](Node* node, void* userData) {
+        static_cast<std::vector<uint32_t>*>(userData)->push_back(node->getId() >> Node::CHANGE_CHUNK_SHIFT);
+    }, &chunks);
+    std::sort(chunks.begin(), chunks.end());
+    size_t usedChunks = static_cast<size_t>(std::unique(chunks.begin(), chunks.end()) - chunks.begin());
+    ok &= autosave.getStats().capturedChunks <= usedChunks;
+
+    std::filesystem::remove(blocker, error);
+    auto start = Clock::now();
+    while (!autosave.flush() && elapsedMs(start) < 5000.0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    SceneAutosave::Stats stats = autosave.getStats();
+    std::printf("retry        %zu failed writes  committed after %.0f ms\n", stats.failedWrites, elapsedMs(start));
+    ok &= stats.commits > 0;
+
+    Scene recovered;
+    ok &= SceneAutosave::recover((blocker / "scene.kjournal").string(), recovered);
+    ok &= SceneFile::serialize(recovered) == SceneFile::serialize(scene);
+    std::filesystem::remove_all(blocker, error);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t nodeCount = 1000000;
+    size_t rounds = 20;
+    size_t edits = 100;
+    std::string path = (std::filesystem::temp_directory_path() / "kazia_autosave_benchmark.kjournal").string();
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--nodes") == 0) {
+            nodeCount = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--rounds") == 0) {
+            rounds = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--edits") == 0) {
+            edits = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--file") == 0) {
+            path = argv[i + 1];
+        } else {
+            std::fprintf(stderr, "usage: AutosaveBenchmark [--nodes N] [--rounds N] [--edits N] [--file PATH]\n");
+            return 2;
+        }
+    }
+
+    auto start = Clock::now();
+    Scene scene("Autosave");
+    buildScene(scene, nodeCount);
+    std::printf("%zu nodes  build %.0f ms\n", nodeCount, elapsedMs(start));
+
+    bool ok = true;
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    std::mt19937 random(7);
+    std::vector<uint8_t> previous;
+    {
+        SceneAutosave autosave(scene, path);
+
+        start = Clock::now();
+        size_t captures = captureAll(autosave);
+        double captureMs = elapsedMs(start);
+        autosave.flush();
+        SceneAutosave::Stats stats = autosave.getStats();
+        std::printf("full save    %zu captures  %.1f ms total  max %.2f ms per capture  written after %.1f ms\n", captures,
+                    captureMs, stats.maxCaptureMs, elapsedMs(start));
+        std::printf("journal      %.1f MB\n", stats.journalBytes / 1048576.0);
+
+        for (size_t round = 0; round < rounds; ++round) {
+            editScene(scene, edits, random);
+            size_t compactions = autosave.getStats().compactions;
+            start = Clock::now();
+            captures = captureAll(autosave);
+            double ms = elapsedMs(start);
+            autosave.flush();
+            stats = autosave.getStats();
+            std::printf("round %2zu     %zu captures  %6.2f ms  journal %.1f MB  live %.1f MB%s\n", round, captures, ms,
+                        stats.journalBytes / 1048576.0, stats.liveBytes / 1048576.0,
+                        stats.compactions > compactions ? "  (compacted)" : "");
+        }
+
+        // 最后只改一个节点，修改在一次提交中写入
+        previous = SceneFile::serialize(scene);
+        scene.getRootNode()->getChild(0)->setName("Last edit");
+        captureAll(autosave);
+        autosave.flush();
+
+        stats = autosave.getStats();
+        std::printf("max capture  %.2f ms  commits %zu  compactions %zu  written %.1f MB  failed %zu\n", stats.maxCaptureMs,
+                    stats.commits, stats.compactions, stats.writtenBytes / 1048576.0, stats.failedWrites);
+        ok &= stats.failedWrites == 0;
+    }
+
+    start = Clock::now();
+    Scene recovered;
+    ok &= SceneAutosave::recover(path, recovered);
+    std::printf("recover      %8.1f ms\n", elapsedMs(start));
+    ok &= SceneFile::serialize(recovered) == SceneFile::serialize(scene);
+
+    // 截断最后一次提交：如果它没有触发压缩，应恢复到修改之前的状态
+    uintmax_t size = std::filesystem::file_size(path, error);
+    std::filesystem::resize_file(path, size - 4, error);
+    Scene truncated;
+    if (SceneAutosave::recover(path, truncated)) {
+        std::vector<uint8_t> truncatedData = SceneFile::serialize(truncated);
+        ok &= truncatedData == previous;
+    } else {
+        std::printf("last commit was compacted, truncated journal has no commit\n");
+    }
+
+    std::filesystem::remove(path, error);
+
+    ok &= testRetry(path);
+
+    std::printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+// 分簇剔除基准
+// 把大型网格（起伏的地形网格和高细分球体）划分为分簇，报告分簇数量、平均大小和划分耗时；
+// 再从若干相机位置执行分簇剔除，报告提交的三角形比例和剔除耗时，
+// 并逐三角形检查剔除是保守的（视锥体内且正对相机的三角形都必须保留）
+//
+// 用法：ClusterBenchmark [--size 512] [--max-triangles 128]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "core/MeshData.h"
+#include "core/Meshlet.h"
+
+using namespace Kazia;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// 起伏的地形网格，XZ 平面上 [-size/2, size/2]，三角形朝上
+MeshData buildTerrain(int size) {
+    MeshData mesh;
+    float half = size * 0.5f;
+    for (int z = 0; z <= size; ++z) {
+        for (int x = 0; x <= size; ++x) {
+            float height = 2.0f * std::sin(x * 0.05f) * std::cos(z * 0.07f);
+            mesh.positions.emplace_back(x - half, height, z - half);
+        }
+    }
+    for (int z = 0; z < size; ++z) {
+        for (int x = 0; x < size; ++x) {
+            uint32_t a = z * (size + 1) + x;
+            uint32_t c = a + size + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, c, a + 1, a + 1, c, c + 1});
+        }
+    }
+    return mesh;
+}
+
+// UV 球体，三角形朝外
+MeshData buildSphere(int rings, int segments, float radius) {
+    MeshData mesh;
+    const float pi = 3.14159265358979323846f;
+    for (int r = 0; r <= rings; ++r) {
+        float phi = pi * r / rings;
+        for (int s = 0; s <= segments; ++s) {
+            float theta = 2.0f * pi * s / segments;
+            mesh.positions.emplace_back(radius * std::sin(phi) * std::cos(theta), radius * std::cos(phi),
+                                        radius * std::sin(phi) * std::sin(theta));
+        }
+    }
+    for (int r = 0; r < rings; ++r) {
+        for (int s = 0; s < segments; ++s) {
+            uint32_t a = r * (segments + 1) + s;
+            uint32_t b = a + segments + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, a + 1, b, a + 1, b + 1, b});
+        }
+    }
+    return mesh;
+}
+
+struct View {
+    const char* label;
+    math::float3 eye;
+    math::float3 target;
+};
+
+// 三角形的任意部分可能在视锥体内且正对相机
+bool triangleVisible(const math::float3& a, const math::float3& b, const math::float3& c,
+                     const math::frustum& frustum, const math::float3& eye) {
+    math::float3 normal = math::cross(b - a, c - a);
+    if (math::dot(normal, a - eye) >= 0.0f) {
+        return false;
+    }
+    for (const math::float4& p : frustum.planes) {
+        auto distance = [&p](const math::float3& v) { return p.x * v.x + p.y * v.y + p.z * v.z + p.w; };
+        if (distance(a) < 0.0f && distance(b) < 0.0f && distance(c) < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool run(const char* label, const MeshData& mesh, const MeshletSet::Options& options, const View* views, size_t viewCount) {
+    auto buildStart = Clock::now();
+    MeshletSet set = MeshletSet::build(mesh.positions.data(), mesh.positions.size(), mesh.indices.data(), mesh.indices.size(), options);
+    double buildMs = elapsedMs(buildStart);
+
+    size_t totalVertices = 0;
+    size_t cones = 0;
+    for (const Meshlet& meshlet : set.meshlets) {
+        totalVertices += meshlet.vertexCount;
+        cones += meshlet.coneCutoff < 1.0f ? 1 : 0;
+    }
+    size_t triangleCount = mesh.getTriangleCount();
+    std::printf("%-8s triangles %8zu  meshlets %6zu  avg triangles %.1f  avg vertices %.1f  cones %.0f%%  build %.1f ms\n",
+                label, triangleCount, set.meshlets.size(), static_cast<double>(triangleCount) / set.meshlets.size(),
+                static_cast<double>(totalVertices) / set.meshlets.size(), 100.0 * cones / set.meshlets.size(), buildMs);
+
+    bool ok = set.indices.size() == mesh.indices.size();
+    math::mat4f projection = math::perspective(60.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    for (size_t v = 0; v < viewCount; ++v) {
+        const View& view = views[v];
+        math::mat4f viewProjection = math::multiply(projection, math::lookAt(view.eye, view.target, {0.0f, 1.0f, 0.0f}));
+        math::frustum frustum = math::frustum::fromMatrix(viewProjection);
+
+        // 分簇剔除
+        auto cullStart = Clock::now();
+        std::vector<bool> visible(set.meshlets.size());
+        size_t submitted = 0;
+        size_t frustumOnly = 0;
+        for (size_t m = 0; m < set.meshlets.size(); ++m) {
+            const Meshlet& meshlet = set.meshlets[m];
+            visible[m] = MeshletCuller::isVisible(meshlet, frustum, view.eye, true);
+            submitted += visible[m] ? meshlet.triangleCount : 0;
+            frustumOnly += frustum.intersectsSphere(meshlet.center, meshlet.radius) ? meshlet.triangleCount : 0;
+        }
+        double cullMs = elapsedMs(cullStart);
+
+        // 保守性检查
+        size_t missing = 0;
+        size_t needed = 0;
+        for (size_t m = 0; m < set.meshlets.size(); ++m) {
+            const Meshlet& meshlet = set.meshlets[m];
+            for (uint32_t t = 0; t < meshlet.triangleCount; ++t) {
+                const uint32_t* triangle = &set.indices[meshlet.indexOffset + t * 3];
+                if (triangleVisible(mesh.positions[triangle[0]], mesh.positions[triangle[1]], mesh.positions[triangle[2]], frustum, view.eye)) {
+                    needed++;
+                    missing += visible[m] ? 0 : 1;
+                }
+            }
+        }
+        ok &= missing == 0;
+        std::printf("  %-10s submitted %5.1f%% (frustum only %5.1f%%, needed %5.1f%%)  cull %.3f ms  %s\n",
+                    view.label, 100.0 * submitted / triangleCount, 100.0 * frustumOnly / triangleCount,
+                    100.0 * needed / triangleCount, cullMs, missing == 0 ? "ok" : "MISSING TRIANGLES");
+    }
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int size = 512;
+    MeshletSet::Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--size") == 0) {
+            size = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--max-triangles") == 0) {
+            options.maxTriangles = static_cast<uint32_t>(std::atoi(argv[i + 1]));
+        } else {
+            std::fprintf(stderr, "usage: ClusterBenchmark [--size N] [--max-triangles N]\n");
+            return 2;
+        }
+    }
+    if (size < 8 || options.maxTriangles == 0) {
+        std::fprintf(stderr, "usage: ClusterBenchmark [--size N] [--max-triangles N]\n");
+        return 2;
+    }
+
+    float half = size * 0.5f;
+    const View terrainViews[] = {
+        {"overview", {0.0f, half, half * 1.5f}, {0.0f, 0.0f, 0.0f}},
+        {"ground", {-half * 0.8f, 4.0f, 0.0f}, {0.0f, 2.0f, -half * 0.2f}},
+        {"close", {0.0f, 6.0f, 0.0f}, {10.0f, 0.0f, 10.0f}}
+    };
+    const View sphereViews[] = {
+        {"outside", {0.0f, 0.0f, 30.0f}, {0.0f, 0.0f, 0.0f}},
+        {"near", {0.0f, 0.0f, 11.0f}, {0.0f, 0.0f, 0.0f}}
+    };
+
+    bool ok = true;
+    ok &= run("terrain", buildTerrain(size), options, terrainViews, 3);
+    ok &= run("sphere", buildSphere(size / 2, size, 10.0f), options, sphereViews, 2);
+    return ok ? 0 : 1;
+}
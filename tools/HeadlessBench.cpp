@@ -0,0 +1,519 @@
+// 无窗口渲染基准
+// 使用离屏交换链初始化渲染器（默认 noop 后端），构建程序化场景（立方体、导入的球体网格或共享的程序化几何体）并渲染 N 帧，
+// 报告 CPU 帧时间、场景同步时间、绘制数量、点光源数量、LOD 后的三角形数和网格占用的显存，可选输出最后一帧的图像（PPM）
+//
+// 用法：HeadlessBench [--nodes 10000] [--frames 300] [--width 1280] [--height 720]
+//                     [--backend noop|opengl|vulkan|default] [--moving 0.05] [--lights 0]
+//                     [--light-budget 0] [--mesh cube|sphere] [--lod-cache 目录] [--optimize 1]
+//                     [--vertex-format float|half|snorm] [--clusters 16384] [--stream 目录] [--stream-budget 512]
+//                     [--primitive cube|uvsphere|icosphere|cylinder|cone|torus|plane|mixed] [--dump frame.ppm]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/MeshData.h"
+#include "core/MeshLod.h"
+#include "core/MeshStream.h"
+#include "core/PrimitiveGenerator.h"
+#include "core/VertexFormat.h"
+#include "render/FilamentRenderer.h"
+#include "render/RenderSnapshot.h"
+#include "scene/Node.h"
+#include "scene/Scene.h"
+
+using namespace Kazia;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+struct Options {
+    size_t nodeCount = 10000;
+    int frameCount = 300;
+    int width = 1280;
+    int height = 720;
+    RenderBackend backend = RenderBackend::Noop;
+    float movingFraction = 0.05f;
+    size_t lightCount = 0;
+    uint32_t lightBudget = 0;
+    bool sphereMesh = false;
+    std::string lodCacheDirectory;
+    bool optimizeMeshes = true;
+    VertexFormat vertexFormat = VertexFormat::Float;
+    uint32_t clusterMinTriangles = 16384;   // 达到该三角形数的网格划分分簇，0 表示不划分
+    std::string streamDirectory;            // 非空时球体写入该目录的流式文件，按需分级载入
+    size_t streamBudgetMb = 512;
+    std::vector<PrimitiveDesc> primitives;  // 非空时节点按顺序轮流使用这些程序化几何体
+    std::string dumpPath;
+};
+
+bool parseBackend(const char* name, RenderBackend& backend) {
+    if (std::strcmp(name, "noop") == 0) {
+        backend = RenderBackend::Noop;
+    } else if (std::strcmp(name, "opengl") == 0) {
+        backend = RenderBackend::OpenGL;
+    } else if (std::strcmp(name, "vulkan") == 0) {
+        backend = RenderBackend::Vulkan;
+    } else if (std::strcmp(name, "default") == 0) {
+        backend = RenderBackend::Default;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parsePrimitives(const char* name, std::vector<PrimitiveDesc>& primitives) {
+    const std::pair<const char*, PrimitiveDesc> known[] = {
+        {"cube", PrimitiveDesc::cube(1.0f)},
+        {"uvsphere", PrimitiveDesc::uvSphere(0.5f, 32, 16)},
+        {"icosphere", PrimitiveDesc::icoSphere(0.5f, 3)},
+        {"cylinder", PrimitiveDesc::cylinder(0.5f, 1.0f, 32)},
+        {"cone", PrimitiveDesc::cone(0.5f, 1.0f, 32)},
+        {"torus", PrimitiveDesc::torus(0.35f, 0.15f, 48, 24)},
+        {"plane", PrimitiveDesc::plane(1.0f, 8)}
+    };
+    primitives.clear();
+    for (const auto& item : known) {
+        if (std::strcmp(name, "mixed") == 0 || std::strcmp(name, item.first) == 0) {
+            primitives.push_back(item.second);
+        }
+    }
+    return !primitives.empty();
+}
+
+bool parseVertexFormat(const char* name, VertexFormat& format) {
+    if (std::strcmp(name, "float") == 0) {
+        format = VertexFormat::Float;
+    } else if (std::strcmp(name, "half") == 0) {
+        format = VertexFormat::CompactHalf;
+    } else if (std::strcmp(name, "snorm") == 0) {
+        format = VertexFormat::CompactSnorm;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            return false;
+        }
+
+        if (std::strcmp(arg, "--nodes") == 0) {
+            options.nodeCount = static_cast<size_t>(std::strtoull(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--frames") == 0) {
+            options.frameCount = std::atoi(value);
+        } else if (std::strcmp(arg, "--width") == 0) {
+            options.width = std::atoi(value);
+        } else if (std::strcmp(arg, "--height") == 0) {
+            options.height = std::atoi(value);
+        } else if (std::strcmp(arg, "--backend") == 0) {
+            if (!parseBackend(value, options.backend)) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--moving") == 0) {
+            options.movingFraction = static_cast<float>(std::atof(value));
+        } else if (std::strcmp(arg, "--lights") == 0) {
+            options.lightCount = static_cast<size_t>(std::strtoull(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--light-budget") == 0) {
+            options.lightBudget = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--mesh") == 0) {
+            if (std::strcmp(value, "sphere") == 0) {
+                options.sphereMesh = true;
+            } else if (std::strcmp(value, "cube") != 0) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--lod-cache") == 0) {
+            options.lodCacheDirectory = value;
+        } else if (std::strcmp(arg, "--optimize") == 0) {
+            options.optimizeMeshes = std::atoi(value) != 0;
+        } else if (std::strcmp(arg, "--primitive") == 0) {
+            if (!parsePrimitives(value, options.primitives)) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--vertex-format") == 0) {
+            if (!parseVertexFormat(value, options.vertexFormat)) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--clusters") == 0) {
+            options.clusterMinTriangles = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--stream") == 0) {
+            options.streamDirectory = value;
+        } else if (std::strcmp(arg, "--stream-budget") == 0) {
+            options.streamBudgetMb = static_cast<size_t>(std::strtoull(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--dump") == 0) {
+            options.dumpPath = value;
+        } else {
+            return false;
+        }
+        ++i;
+    }
+    return options.frameCount > 0 && options.width > 0 && options.height > 0;
+}
+
+// 统计量：平均值、中位数、95 分位、最大值
+struct Summary {
+    double average = 0.0;
+    double median = 0.0;
+    double p95 = 0.0;
+    double max = 0.0;
+};
+
+Summary summarize(std::vector<double> samples) {
+    Summary summary;
+    if (samples.empty()) {
+        return summary;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double total = 0.0;
+    for (double sample : samples) {
+        total += sample;
+    }
+    summary.average = total / static_cast<double>(samples.size());
+    summary.median = samples[samples.size() / 2];
+    summary.p95 = samples[std::min(samples.size() - 1, samples.size() * 95 / 100)];
+    summary.max = samples.back();
+    return summary;
+}
+
+void printSummary(const char* label, const Summary& summary, const char* unit) {
+    std::printf("%-14s avg %9.3f  median %9.3f  p95 %9.3f  max %9.3f %s\n",
+                label, summary.average, summary.median, summary.p95, summary.max, unit);
+}
+
+// 细分的 UV 球体（带法线和 UV），所有节点共享，用于观察 LOD 和顶点格式的效果
+MeshData buildSphere(int rings, int segments, float radius) {
+    MeshData mesh;
+    const float pi = 3.14159265358979323846f;
+    for (int r = 0; r <= rings; ++r) {
+        float phi = pi * r / rings;
+        for (int s = 0; s <= segments; ++s) {
+            float theta = 2.0f * pi * s / segments;
+            math::float3 normal(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+            mesh.positions.push_back(normal * radius);
+            mesh.normals.push_back(normal);
+            mesh.uvs.emplace_back(static_cast<float>(s) / segments, static_cast<float>(r) / rings);
+        }
+    }
+
+    for (int r = 0; r < rings; ++r) {
+        for (int s = 0; s < segments; ++s) {
+            uint32_t a = r * (segments + 1) + s;
+            uint32_t b = a + segments + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+    return mesh;
+}
+
+// 写出 PPM，读回的像素以左下角为原点，写出时上下翻转
+bool writePpm(const std::string& path, const std::vector<uint8_t>& rgba, int width, int height) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<uint8_t> row(static_cast<size_t>(width) * 3);
+    for (int y = height - 1; y >= 0; --y) {
+        const uint8_t* src = rgba.data() + static_cast<size_t>(y) * width * 4;
+        for (int x = 0; x < width; ++x) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        std::fwrite(row.data(), 1, row.size(), file);
+    }
+    std::fclose(file);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: HeadlessBench [--nodes N] [--frames N] [--width W] [--height H] "
+                             "[--backend noop|opengl|vulkan|default] [--moving F] [--lights N] [--light-budget N] "
+                             "[--mesh cube|sphere] [--lod-cache dir] [--optimize 0|1] [--vertex-format float|half|snorm] "
+                             "[--clusters N] [--stream dir] [--stream-budget MB] "
+                             "[--primitive cube|uvsphere|icosphere|cylinder|cone|torus|plane|mixed] [--dump file.ppm]\n");
+        return 2;
+    }
+
+    std::unique_ptr<IRenderer> renderer = createFilamentRenderer();
+    if (!renderer->initializeHeadless(options.width, options.height, options.backend)) {
+        std::fprintf(stderr, "failed to initialize headless renderer\n");
+        return 1;
+    }
+
+    // 程序化场景：立方体排成三维网格，每 100 个节点一组
+    Scene scene("HeadlessBench");
+    std::vector<Node*> nodes;
+    nodes.reserve(options.nodeCount);
+    int side = std::max(1, static_cast<int>(std::ceil(std::cbrt(static_cast<double>(options.nodeCount)))));
+    float spacing = 2.0f;
+    float offset = 0.5f * spacing * (side - 1);
+    Node* group = nullptr;
+    for (size_t i = 0; i < options.nodeCount; ++i) {
+        if (i % 100 == 0) {
+            auto groupNode = std::make_unique<Node>("Group");
+            group = groupNode.get();
+            scene.addNode(std::move(groupNode));
+        }
+
+        int x = static_cast<int>(i % side);
+        int y = static_cast<int>((i / side) % side);
+        int z = static_cast<int>(i / (static_cast<size_t>(side) * side));
+        auto node = std::make_unique<Node>("Cube");
+        node->setPosition({x * spacing - offset, y * spacing - offset, -z * spacing});
+        nodes.push_back(node.get());
+        group->addChild(std::move(node));
+    }
+    scene.update();
+
+    // 导入网格的 LOD 链缓存，重复运行时跳过简化
+    std::unique_ptr<MeshLodCache> lodCache;
+    if (!options.lodCacheDirectory.empty()) {
+        lodCache = std::make_unique<MeshLodCache>(options.lodCacheDirectory);
+        renderer->getContext()->lodCache = lodCache.get();
+    }
+    renderer->getContext()->optimizeMeshes = options.optimizeMeshes;
+    renderer->getContext()->vertexFormat = options.vertexFormat;
+    renderer->getContext()->clusterMinTriangles = options.clusterMinTriangles;
+
+    auto setupStart = Clock::now();
+    MeshData sphere;
+    if (options.sphereMesh) {
+        sphere = buildSphere(64, 128, 0.5f);
+    }
+    
+    // 流式网格：球体的 LOD 链写入流式文件，节点只持有最粗一级，更精细的级别在预算内按需载入
+    std::unique_ptr<MeshStreamCache> streamCache;
+    std::string streamPath;
+    if (options.sphereMesh && !options.streamDirectory.empty()) {
+        streamCache = std::make_unique<MeshStreamCache>(options.streamDirectory);
+        streamPath = streamCache->getOrBuild(sphere, MeshLodChain::Options(), lodCache.get());
+        if (streamPath.empty()) {
+            std::fprintf(stderr, "failed to write stream file to %s\n", options.streamDirectory.c_str());
+            return 1;
+        }
+        renderer->getContext()->streamingSystem->getStreamer()->setBudget(options.streamBudgetMb << 20);
+    }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        Node* node = nodes[i];
+        if (!streamPath.empty()) {
+            renderer->addNodeStreamedMesh(node, streamPath);
+        } else if (options.sphereMesh) {
+            renderer->addNodeMesh(node, sphere);
+        } else if (!options.primitives.empty()) {
+            renderer->addNodePrimitive(node, options.primitives[i % options.primitives.size()]);
+        } else {
+            renderer->addNodeMesh(node);
+        }
+    }
+    
+    // 点光源均匀散布在立方体网格中
+    if (options.lightCount > 0) {
+        renderer->getContext()->lightSystem->setLightBudget(options.lightBudget);
+        renderer->addDirectionalLight({0.5f, -1.0f, 0.5f}, {1.0f, 1.0f, 1.0f}, 100000.0f);
+    }
+    for (size_t i = 0; i < options.lightCount; ++i) {
+        float u = static_cast<float>((i * 2654435761u) % 1000) / 1000.0f;
+        float v = static_cast<float>((i * 40503u) % 1000) / 1000.0f;
+        float w = static_cast<float>((i * 9973u) % 1000) / 1000.0f;
+        math::float3 position((u - 0.5f) * 2.0f * offset, (v - 0.5f) * 2.0f * offset, -w * 2.0f * offset);
+        renderer->addPointLight(position, {1.0f, 0.9f, 0.8f}, 10000.0f, 4.0f * spacing);
+    }
+    double setupMs = elapsedMs(setupStart, Clock::now());
+
+    renderer->setCameraProjection(60.0f, static_cast<float>(options.width) / options.height, 0.1f, 10000.0f);
+
+    RenderSnapshot snapshot;
+    snapshot.width = options.width;
+    snapshot.height = options.height;
+    snapshot.fov = 60.0f;
+    snapshot.nearPlane = 0.1f;
+    snapshot.farPlane = 10000.0f;
+    snapshot.cameraPosition = {0.0f, 0.0f, offset * 2.0f + 10.0f};
+
+    size_t movingCount = std::min(nodes.size(), static_cast<size_t>(nodes.size() * options.movingFraction));
+    const int warmupFrames = std::min(10, options.frameCount / 10);
+
+    std::vector<double> frameTimes;
+    std::vector<double> updateTimes;
+    std::vector<double> syncTimes;
+    std::vector<double> cullTimes;
+    std::vector<double> drawCounts;
+    std::vector<double> lightTimes;
+    std::vector<double> lightCounts;
+    std::vector<double> activeLightCounts;
+    std::vector<double> lodTimes;
+    std::vector<double> lodTriangleFractions;
+    std::vector<double> clusterTimes;
+    std::vector<double> clusterTriangleFractions;
+    std::vector<double> clusterUploads;
+    std::vector<double> streamTimes;
+    std::vector<double> streamWaiting;
+    std::vector<double> streamResidentMb;
+    size_t streamLoads = 0;
+    size_t streamEvictions = 0;
+    std::vector<uint8_t> pixels;
+    int skippedFrames = 0;
+
+    auto runStart = Clock::now();
+    for (int frame = 0; frame < options.frameCount; ++frame) {
+        // 移动一部分节点
+        auto frameStart = Clock::now();
+        float phase = frame * 0.05f;
+        for (size_t i = 0; i < movingCount; ++i) {
+            Node* node = nodes[(i * 7919 + frame) % nodes.size()];
+            math::float3 position = node->getPosition();
+            position.y += 0.1f * std::sin(phase + static_cast<float>(i));
+            node->setPosition(position);
+        }
+        scene.update();
+        auto updateEnd = Clock::now();
+
+        // 与编辑器相同的路径：采集变化的变换，通过快照同步到渲染器
+        snapshot.transforms.clear();
+        snapshot.captureChangedTransforms(scene.getChangedNodes());
+        snapshot.sequence = static_cast<uint64_t>(frame) + 1;
+        renderer->applySnapshot(snapshot);
+
+        if (frame == options.frameCount - 1 && !options.dumpPath.empty()) {
+            renderer->requestFrameCapture(&pixels);
+        }
+
+        if (renderer->beginFrame()) {
+            renderer->render();
+            renderer->endFrame();
+        } else {
+            skippedFrames++;
+        }
+        auto frameEnd = Clock::now();
+
+        if (frame >= warmupFrames) {
+            const FrameStats& stats = renderer->getFrameStats();
+            frameTimes.push_back(elapsedMs(frameStart, frameEnd));
+            updateTimes.push_back(elapsedMs(frameStart, updateEnd));
+            syncTimes.push_back(stats.syncTimeMs);
+            cullTimes.push_back(stats.cullTimeMs);
+            drawCounts.push_back(static_cast<double>(stats.visibleCount));
+            lightTimes.push_back(stats.lightTimeMs);
+            lightCounts.push_back(static_cast<double>(stats.visibleLightCount));
+            activeLightCounts.push_back(static_cast<double>(stats.activeLightCount));
+            lodTimes.push_back(stats.lodTimeMs);
+            if (stats.lodFullTriangleCount > 0) {
+                lodTriangleFractions.push_back(100.0 * static_cast<double>(stats.lodTriangleCount) / stats.lodFullTriangleCount);
+            }
+            clusterTimes.push_back(stats.clusterTimeMs);
+            clusterUploads.push_back(static_cast<double>(stats.clusterUploadCount));
+            if (stats.clusterFullTriangleCount > 0) {
+                clusterTriangleFractions.push_back(100.0 * static_cast<double>(stats.clusterTriangleCount) / stats.clusterFullTriangleCount);
+            }
+            streamTimes.push_back(stats.streamTimeMs);
+            streamWaiting.push_back(static_cast<double>(stats.streamWaitingCount));
+            streamResidentMb.push_back(static_cast<double>(stats.streamResidentBytes) / (1 << 20));
+            streamLoads += stats.streamLoadCount;
+            streamEvictions += stats.streamEvictionCount;
+        }
+    }
+
+    // 等待后端完成，读回的像素在此之后可用
+    auto flushStart = Clock::now();
+    renderer->flush();
+    double flushMs = elapsedMs(flushStart, Clock::now());
+    double totalMs = elapsedMs(runStart, Clock::now());
+
+    const char* backendNames[] = {"default", "opengl", "vulkan", "noop"};
+    std::printf("backend %s  %dx%d  nodes %zu  moving %zu/frame  frames %d (warmup %d, skipped %d)\n",
+                backendNames[static_cast<int>(options.backend)], options.width, options.height,
+                nodes.size(), movingCount, options.frameCount, warmupFrames, skippedFrames);
+    std::printf("setup %.2f ms  total %.2f ms  final flush %.2f ms\n", setupMs, totalMs, flushMs);
+    const GeometryRegistry::Stats& geometryStats = renderer->getContext()->geometryRegistry->getStats();
+    std::printf("geometry uploads %zu  reuses %zu  uploaded %zu bytes  saved %zu bytes\n",
+                geometryStats.uploads, geometryStats.reuses, geometryStats.uploadedBytes, geometryStats.savedBytes);
+    printSummary("cpu frame", summarize(frameTimes), "ms");
+    printSummary("scene update", summarize(updateTimes), "ms");
+    printSummary("sync", summarize(syncTimes), "ms");
+    printSummary("cull", summarize(cullTimes), "ms");
+    printSummary("draws", summarize(drawCounts), "renderables");
+    if (options.lightCount > 0) {
+        printSummary("lights", summarize(lightTimes), "ms");
+        printSummary("visible lights", summarize(lightCounts), "point lights");
+        printSummary("active lights", summarize(activeLightCounts), "point lights");
+    }
+
+    if (options.sphereMesh) {
+        // 导入时优化的统计，几何体按原始网格内容登记
+        GeometryRegistry::Key sphereKey = GeometryRegistry::makeContentKey(
+            sphere.positions.data(), sphere.positions.size() * sizeof(math::float3),
+            sphere.indices.data(), sphere.indices.size() * sizeof(uint32_t),
+            static_cast<uint32_t>(options.vertexFormat));
+        const GeometryRegistry::Geometry* geometry = renderer->getContext()->geometryRegistry->find(sphereKey);
+        if (geometry) {
+            const MeshOptimizer::Report& report = geometry->optimization;
+            uint32_t stride = getVertexStride(options.vertexFormat, true, true);
+            std::printf("mesh %s  vertices %zu -> %zu  ACMR %.3f -> %.3f  ATVR %.3f -> %.3f  %s indices  %zu bytes\n",
+                        options.optimizeMeshes ? "optimized" : "as authored",
+                        report.vertexCountBefore, report.vertexCountAfter, report.acmrBefore, report.acmrAfter,
+                        report.atvrBefore, report.atvrAfter, report.shortIndices ? "16-bit" : "32-bit", geometry->byteSize);
+            std::printf("vertices %u bytes each  %zu bytes total\n", stride, static_cast<size_t>(stride) * geometry->vertexCount);
+        }
+        printSummary("lod", summarize(lodTimes), "ms");
+        printSummary("lod triangles", summarize(lodTriangleFractions), "% of full");
+        if (!clusterTriangleFractions.empty()) {
+            if (geometry && !geometry->clusters.empty()) {
+                std::printf("clusters %zu per mesh  %zu triangles each on average\n", geometry->clusters.meshlets.size(),
+                            geometry->clusters.indices.size() / 3 / geometry->clusters.meshlets.size());
+            }
+            printSummary("clusters", summarize(clusterTimes), "ms");
+            printSummary("cluster tris", summarize(clusterTriangleFractions), "% of level 0");
+            printSummary("cluster upload", summarize(clusterUploads), "buffers");
+        }
+        if (streamCache) {
+            std::printf("stream file %s  budget %zu MB  loads %zu  evictions %zu\n", streamPath.c_str(),
+                        options.streamBudgetMb, streamLoads, streamEvictions);
+            printSummary("stream", summarize(streamTimes), "ms");
+            printSummary("stream waiting", summarize(streamWaiting), "renderables");
+            printSummary("stream resident", summarize(streamResidentMb), "MB");
+        }
+        if (lodCache) {
+            const MeshLodCache::Stats& cacheStats = lodCache->getStats();
+            std::printf("lod cache %s  hits %zu  misses %zu\n", lodCache->getDirectory().c_str(), cacheStats.hits, cacheStats.misses);
+        }
+    }
+
+    int result = 0;
+    if (!options.dumpPath.empty()) {
+        if (options.backend == RenderBackend::Noop || pixels.empty()) {
+            std::fprintf(stderr, "frame dump is not available with the noop backend\n");
+            result = 1;
+        } else if (!writePpm(options.dumpPath, pixels, options.width, options.height)) {
+            std::fprintf(stderr, "failed to write %s\n", options.dumpPath.c_str());
+            result = 1;
+        } else {
+            std::printf("frame written to %s\n", options.dumpPath.c_str());
+        }
+    }
+
+    renderer->shutdown();
+    return result;
+}
@@ -0,0 +1,200 @@
+// LOD 生成基准
+// 对程序化网格（细分球体、带噪声的网格面片）生成 LOD 链，报告生成耗时、各级三角形数和误差，
+// 检查磁盘缓存的往返结果，并模拟由大量实例组成的装配体在不同相机距离下实际绘制的三角形比例
+//
+// 用法：LodBenchmark [--rings 256] [--instances 10000] [--height 1080] [--fov 60] [--cache 目录]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "core/MeshData.h"
+#include "core/MeshLod.h"
+
+using namespace Kazia;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Options {
+    int rings = 256;
+    size_t instanceCount = 10000;
+    float viewportHeight = 1080.0f;
+    float fov = 60.0f;
+    std::string cacheDirectory;
+};
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            return false;
+        }
+
+        if (std::strcmp(arg, "--rings") == 0) {
+            options.rings = std::atoi(value);
+        } else if (std::strcmp(arg, "--instances") == 0) {
+            options.instanceCount = static_cast<size_t>(std::strtoull(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--height") == 0) {
+            options.viewportHeight = static_cast<float>(std::atof(value));
+        } else if (std::strcmp(arg, "--fov") == 0) {
+            options.fov = static_cast<float>(std::atof(value));
+        } else if (std::strcmp(arg, "--cache") == 0) {
+            options.cacheDirectory = value;
+        } else {
+            return false;
+        }
+        ++i;
+    }
+    return options.rings >= 4 && options.viewportHeight > 0.0f && options.fov > 0.0f;
+}
+
+// UV 球体，接缝处的顶点重复（与导入的网格一样存在 UV 接缝）
+MeshData buildSphere(int rings, int segments, float radius) {
+    MeshData mesh;
+    const float pi = 3.14159265358979323846f;
+    for (int r = 0; r <= rings; ++r) {
+        float phi = pi * r / rings;
+        for (int s = 0; s <= segments; ++s) {
+            float theta = 2.0f * pi * s / segments;
+            math::float3 normal(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+            mesh.positions.push_back(normal * radius);
+            mesh.normals.push_back(normal);
+        }
+    }
+
+    for (int r = 0; r < rings; ++r) {
+        for (int s = 0; s < segments; ++s) {
+            uint32_t a = r * (segments + 1) + s;
+            uint32_t b = a + segments + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+    return mesh;
+}
+
+// 带噪声起伏的开放网格面片，有边界
+MeshData buildTerrain(int size, float extent) {
+    MeshData mesh;
+    for (int y = 0; y <= size; ++y) {
+        for (int x = 0; x <= size; ++x) {
+            float u = static_cast<float>(x) / size;
+            float v = static_cast<float>(y) / size;
+            float height = 0.05f * std::sin(u * 12.0f) * std::cos(v * 9.0f) + 0.01f * std::sin(u * 57.0f + v * 31.0f);
+            mesh.positions.emplace_back((u - 0.5f) * extent, height * extent, (v - 0.5f) * extent);
+        }
+    }
+
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            uint32_t a = y * (size + 1) + x;
+            uint32_t b = a + size + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+    return mesh;
+}
+
+void printChain(const char* label, const MeshData& mesh, const MeshLodChain& chain, double buildMs) {
+    std::printf("%s: %zu vertices, %zu triangles, built in %.2f ms\n",
+                label, mesh.getVertexCount(), mesh.getTriangleCount(), buildMs);
+    for (size_t i = 0; i < chain.getLevelCount(); ++i) {
+        std::printf("  lod %zu  triangles %8zu (%5.1f%%)  error %.5f\n", i, chain.getTriangleCount(i),
+                    100.0 * chain.getTriangleCount(i) / std::max<size_t>(1, mesh.getTriangleCount()),
+                    chain.levels[i].error);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: LodBenchmark [--rings N] [--instances N] [--height H] [--fov DEG] [--cache dir]\n");
+        return 2;
+    }
+
+    MeshLodChain::Options lodOptions;
+
+    MeshData sphere = buildSphere(options.rings, options.rings * 2, 1.0f);
+    auto buildStart = Clock::now();
+    MeshLodChain sphereChain = MeshLodChain::build(sphere, lodOptions);
+    printChain("sphere", sphere, sphereChain, elapsedMs(buildStart));
+
+    MeshData terrain = buildTerrain(options.rings, 10.0f);
+    buildStart = Clock::now();
+    MeshLodChain terrainChain = MeshLodChain::build(terrain, lodOptions);
+    printChain("terrain", terrain, terrainChain, elapsedMs(buildStart));
+
+    // 缓存往返：第一次生成并写入，第二次读取，结果应完全一致
+    int result = 0;
+    std::string cacheDirectory = options.cacheDirectory;
+    if (cacheDirectory.empty()) {
+        cacheDirectory = (std::filesystem::temp_directory_path() / "kazia_lod_benchmark").string();
+        std::filesystem::remove_all(cacheDirectory);
+    }
+    MeshLodCache cache(cacheDirectory);
+    bool firstHit = false;
+    bool secondHit = false;
+    auto missStart = Clock::now();
+    MeshLodChain first = cache.getOrBuild(sphere, lodOptions, &firstHit);
+    double missMs = elapsedMs(missStart);
+    auto hitStart = Clock::now();
+    MeshLodChain second = cache.getOrBuild(sphere, lodOptions, &secondHit);
+    double hitMs = elapsedMs(hitStart);
+    bool identical = first.indices == second.indices && first.levels.size() == second.levels.size();
+    std::printf("cache %s: first %s %.2f ms, second %s %.2f ms, %s\n", cacheDirectory.c_str(),
+                firstHit ? "hit" : "miss", missMs, secondHit ? "hit" : "miss", hitMs,
+                identical ? "identical" : "MISMATCH");
+    if (!secondHit || !identical) {
+        result = 1;
+    }
+
+    // 装配体：球体实例排成正方形阵列，相机沿视线方向后退
+    LodSelector selector;
+    int side = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(options.instanceCount)))));
+    float spacing = 3.0f;
+    float halfExtent = 0.5f * spacing * (side - 1);
+    std::vector<uint32_t> levels(options.instanceCount, 0);
+    size_t fullTriangles = sphere.getTriangleCount() * options.instanceCount;
+
+    std::printf("assembly: %zu instances, %zu triangles at full resolution\n", options.instanceCount, fullTriangles);
+    const float distances[] = {1.0f, 10.0f, 100.0f, 1000.0f};
+    for (float cameraDistance : distances) {
+        math::float3 camera(0.0f, 2.0f, halfExtent + cameraDistance);
+        size_t triangles = 0;
+        size_t levelHistogram[8] = {};
+        auto selectStart = Clock::now();
+        for (size_t i = 0; i < options.instanceCount; ++i) {
+            math::float3 center((static_cast<int>(i % side)) * spacing - halfExtent, 0.0f,
+                                (static_cast<int>(i / side)) * spacing - halfExtent);
+            float distance = std::max(0.0f, math::length(center - camera) - 1.0f);
+            float pixelsPerUnit = LodSelector::pixelsPerUnit(distance, options.fov, options.viewportHeight);
+            levels[i] = selector.select(sphereChain.levels.data(), sphereChain.levels.size(), pixelsPerUnit, levels[i]);
+            triangles += sphereChain.getTriangleCount(levels[i]);
+            levelHistogram[std::min<uint32_t>(levels[i], 7)]++;
+        }
+        double selectMs = elapsedMs(selectStart);
+
+        std::printf("  distance %6.0f  triangles %11zu (%5.1f%%)  select %.3f ms  levels",
+                    cameraDistance, triangles, 100.0 * triangles / std::max<size_t>(1, fullTriangles), selectMs);
+        for (size_t level = 0; level < sphereChain.getLevelCount(); ++level) {
+            std::printf(" %zu", levelHistogram[level]);
+        }
+        std::printf("\n");
+    }
+
+    return result;
+}
@@ -0,0 +1,171 @@
+// 网格优化基准
+// 对几种典型的导入网格（按行生成的球体、带噪声的网格面片、未焊接且乱序的三角形汤）执行导入时优化，
+// 报告优化前后的顶点数、ACMR/ATVR、索引类型和耗时，并检查优化后的三角形集合与原网格一致
+//
+// 用法：MeshOptimizerBenchmark [--rings 256] [--cache 16]
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "core/MeshData.h"
+#include "core/MeshOptimizer.h"
+
+using namespace Kazia;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// UV 球体，按行生成，接缝处的顶点重复
+MeshData buildSphere(int rings, int segments) {
+    MeshData mesh;
+    const float pi = 3.14159265358979323846f;
+    for (int r = 0; r <= rings; ++r) {
+        float phi = pi * r / rings;
+        for (int s = 0; s <= segments; ++s) {
+            float theta = 2.0f * pi * s / segments;
+            math::float3 normal(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+            mesh.positions.push_back(normal);
+            mesh.normals.push_back(normal);
+        }
+    }
+
+    for (int r = 0; r < rings; ++r) {
+        for (int s = 0; s < segments; ++s) {
+            uint32_t a = r * (segments + 1) + s;
+            uint32_t b = a + segments + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+    return mesh;
+}
+
+// 带噪声起伏的网格面片
+MeshData buildTerrain(int size) {
+    MeshData mesh;
+    for (int y = 0; y <= size; ++y) {
+        for (int x = 0; x <= size; ++x) {
+            float u = static_cast<float>(x) / size;
+            float v = static_cast<float>(y) / size;
+            mesh.positions.emplace_back(u, 0.05f * std::sin(u * 12.0f) * std::cos(v * 9.0f), v);
+        }
+    }
+
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            uint32_t a = y * (size + 1) + x;
+            uint32_t b = a + size + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+    return mesh;
+}
+
+// 三角形汤：每个三角形独立的三个顶点，三角形顺序打乱（常见于未经处理的导出文件）
+MeshData buildSoup(const MeshData& source) {
+    std::vector<size_t> order(source.getTriangleCount());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::mt19937 random(1234);
+    std::shuffle(order.begin(), order.end(), random);
+
+    MeshData mesh;
+    for (size_t triangle : order) {
+        for (int c = 0; c < 3; ++c) {
+            uint32_t index = source.indices[triangle * 3 + c];
+            mesh.indices.push_back(static_cast<uint32_t>(mesh.positions.size()));
+            mesh.positions.push_back(source.positions[index]);
+            if (!source.normals.empty()) {
+                mesh.normals.push_back(source.normals[index]);
+            }
+        }
+    }
+    return mesh;
+}
+
+// 三角形按位置排序后比较，忽略顶点编号、三角形顺序和三角形内的起始顶点
+using TriangleKey = std::array<float, 9>;
+
+std::vector<TriangleKey> collectTriangles(const MeshData& mesh) {
+    std::vector<TriangleKey> triangles;
+    for (size_t t = 0; t < mesh.getTriangleCount(); ++t) {
+        const uint32_t* corners = &mesh.indices[t * 3];
+        int first = 0;
+        for (int c = 1; c < 3; ++c) {
+            const math::float3& p = mesh.positions[corners[c]];
+            const math::float3& q = mesh.positions[corners[first]];
+            if (std::tie(p.x, p.y, p.z) < std::tie(q.x, q.y, q.z)) {
+                first = c;
+            }
+        }
+        TriangleKey key;
+        for (int c = 0; c < 3; ++c) {
+            const math::float3& p = mesh.positions[corners[(first + c) % 3]];
+            key[c * 3] = p.x;
+            key[c * 3 + 1] = p.y;
+            key[c * 3 + 2] = p.z;
+        }
+        triangles.push_back(key);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+bool run(const char* label, MeshData mesh, const MeshOptimizer::Options& options) {
+    std::vector<TriangleKey> before = collectTriangles(mesh);
+
+    auto start = Clock::now();
+    MeshOptimizer::Report report = MeshOptimizer::optimize(mesh, options);
+    double optimizeMs = elapsedMs(start);
+
+    bool identical = collectTriangles(mesh) == before;
+    std::printf("%-8s triangles %8zu  vertices %8zu -> %8zu  ACMR %.3f -> %.3f  ATVR %.3f -> %.3f  %s indices  %.2f ms  %s\n",
+                label, mesh.getTriangleCount(), report.vertexCountBefore, report.vertexCountAfter,
+                report.acmrBefore, report.acmrAfter, report.atvrBefore, report.atvrAfter,
+                report.shortIndices ? "16-bit" : "32-bit", optimizeMs, identical ? "ok" : "MISMATCH");
+    return identical;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int rings = 256;
+    MeshOptimizer::Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--rings") == 0) {
+            rings = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--cache") == 0) {
+            options.cacheSize = static_cast<uint32_t>(std::atoi(argv[i + 1]));
+        } else {
+            std::fprintf(stderr, "usage: MeshOptimizerBenchmark [--rings N] [--cache N]\n");
+            return 2;
+        }
+    }
+    if (rings < 4 || options.cacheSize == 0) {
+        std::fprintf(stderr, "usage: MeshOptimizerBenchmark [--rings N] [--cache N]\n");
+        return 2;
+    }
+
+    MeshData sphere = buildSphere(rings, rings * 2);
+    MeshData terrain = buildTerrain(rings);
+
+    bool ok = true;
+    ok &= run("sphere", sphere, options);
+    ok &= run("terrain", terrain, options);
+    ok &= run("soup", buildSoup(sphere), options);
+    ok &= run("small", buildSphere(16, 32), options);
+    return ok ? 0 : 1;
+}
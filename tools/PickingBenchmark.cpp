@@ -0,0 +1,265 @@
+// 拾取性能基准
+// 构建 1k 到 1M 个节点的场景（所有节点共享同一个三角形 BVH），测量场景 BVH 构建、
+// 增量调整和单次拾取的耗时，并在较小规模下与逐节点暴力检测比对结果
+//
+// 用法：PickingBenchmark [最大节点数，默认 1000000]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "core/ScreenProjection.h"
+#include "core/TriangleBVH.h"
+#include "editor/PickingManager.h"
+#include "scene/MeshComponent.h"
+#include "scene/Node.h"
+#include "scene/Scene.h"
+
+using namespace Kazia;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// 生成 UV 球体网格
+std::shared_ptr<TriangleBVH> buildSphere(int rings, int segments, float radius) {
+    std::vector<math::float3> positions;
+    std::vector<uint32_t> indices;
+    const float pi = 3.14159265358979323846f;
+
+    for (int r = 0; r <= rings; ++r) {
+        float phi = pi * r / rings;
+        for (int s = 0; s <= segments; ++s) {
+            float theta = 2.0f * pi * s / segments;
+            positions.emplace_back(radius * std::sin(phi) * std::cos(theta), radius * std::cos(phi),
+                                   radius * std::sin(phi) * std::sin(theta));
+        }
+    }
+
+    for (int r = 0; r < rings; ++r) {
+        for (int s = 0; s < segments; ++s) {
+            uint32_t a = r * (segments + 1) + s;
+            uint32_t b = a + segments + 1;
+            indices.insert(indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+
+    auto bvh = std::make_shared<TriangleBVH>();
+    bvh->build(positions, indices);
+    return bvh;
+}
+
+// 暴力框选：逐节点标量投影，用于校验
+size_t selectLinear(const math::mat4f& viewProjection, const std::vector<Node*>& nodes, int width, int height,
+                    int x0, int y0, int x1, int y1) {
+    float ndcX0 = 2.0f * x0 / width - 1.0f;
+    float ndcX1 = 2.0f * (x1 + 1) / width - 1.0f;
+    float ndcY0 = 1.0f - 2.0f * (y1 + 1) / height;
+    float ndcY1 = 1.0f - 2.0f * y0 / height;
+    math::frustum viewFrustum = math::frustum::fromMatrix(viewProjection);
+
+    size_t count = 0;
+    for (Node* node : nodes) {
+        ScreenRect rect;
+        projectAabbsScalar(viewProjection, &node->getWorldBounds(), 1, &rect);
+        if (rect.overlaps(ndcX0, ndcY0, ndcX1, ndcY1) &&
+            viewFrustum.classify(node->getWorldBounds()) != math::frustum::Result::OUTSIDE) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// 暴力检测：逐节点测试精确交点，用于校验
+Node* pickLinear(PickingManager& picking, Node* root, const math::float3& origin, const math::float3& direction, float& closest) {
+    Node* picked = nullptr;
+    std::vector<Node*> stack = {root};
+    while (!stack.empty()) {
+        Node* node = stack.back();
+        stack.pop_back();
+
+        math::float3 intersection;
+        if (picking.intersectRayWithMesh(origin, direction, node, intersection)) {
+            float distance = math::length(intersection - origin);
+            if (distance < closest) {
+                closest = distance;
+                picked = node;
+            }
+        }
+
+        for (size_t i = 0; i < node->getChildCount(); ++i) {
+            stack.push_back(node->getChild(i));
+        }
+    }
+    return picked;
+}
+
+void runBenchmark(size_t nodeCount, const std::shared_ptr<TriangleBVH>& sphere, std::mt19937& rng) {
+    Engine engine;
+    Scene scene("Benchmark");
+
+    // 节点分布在立方体网格中，每 64 个节点挂在同一个分组节点下
+    int side = static_cast<int>(std::ceil(std::cbrt(static_cast<double>(nodeCount))));
+    const float spacing = 3.0f;
+    std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+    std::uniform_real_distribution<float> angle(-180.0f, 180.0f);
+
+    auto buildStart = Clock::now();
+    std::vector<Node*> nodes;
+    nodes.reserve(nodeCount);
+    Node* group = nullptr;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        if (i % 64 == 0) {
+            auto groupNode = std::make_unique<Node>("Group");
+            group = groupNode.get();
+            scene.addNode(std::move(groupNode));
+        }
+
+        auto node = std::make_unique<Node>("Sphere");
+        int x = static_cast<int>(i % side);
+        int y = static_cast<int>((i / side) % side);
+        int z = static_cast<int>(i / (static_cast<size_t>(side) * side));
+        node->setPosition({x * spacing + jitter(rng), y * spacing + jitter(rng), z * spacing + jitter(rng)});
+        node->setRotation({angle(rng), angle(rng), angle(rng)});
+        node->addComponent<MeshComponent>()->setTriangleBVH(sphere);
+
+        nodes.push_back(node.get());
+        group->addChild(std::move(node));
+    }
+    scene.update();
+    double sceneMs = elapsedMs(buildStart);
+
+    PickingManager picking(&engine, &scene, nullptr);
+
+    auto indexStart = Clock::now();
+    picking.updateSpatialIndex();
+    double indexMs = elapsedMs(indexStart);
+
+    // 射线从场景外指向随机节点附近
+    float extent = side * spacing;
+    math::float3 eye(-extent * 0.5f, extent * 1.5f, -extent * 0.5f);
+    std::uniform_int_distribution<size_t> pickNode(0, nodeCount - 1);
+    const int rayCount = 2000;
+    std::vector<math::float3> directions;
+    directions.reserve(rayCount);
+    for (int i = 0; i < rayCount; ++i) {
+        math::float3 target = nodes[pickNode(rng)]->getPosition() + math::float3(jitter(rng), jitter(rng), jitter(rng));
+        directions.push_back(math::normalize(target - eye));
+    }
+
+    int hits = 0;
+    uint64_t visited = 0;
+    uint64_t candidates = 0;
+    auto pickStart = Clock::now();
+    for (const math::float3& direction : directions) {
+        PickingManager::PickResult result;
+        if (picking.raycast(eye, direction, result)) {
+            hits++;
+        }
+        visited += picking.getLastPickStats().bvhNodesVisited;
+        candidates += picking.getLastPickStats().candidates;
+    }
+    double pickUs = elapsedMs(pickStart) * 1000.0 / rayCount;
+
+    // 小规模时与暴力检测比对，同时给出暴力检测耗时
+    int mismatches = 0;
+    double linearUs = 0.0;
+    if (nodeCount <= 10000) {
+        const int checkCount = 100;
+        auto linearStart = Clock::now();
+        for (int i = 0; i < checkCount; ++i) {
+            float closest = std::numeric_limits<float>::max();
+            Node* expected = pickLinear(picking, scene.getRootNode(), eye, directions[i], closest);
+
+            PickingManager::PickResult result;
+            picking.raycast(eye, directions[i], result);
+            if (result.node != expected && std::fabs(result.distance - closest) > 1e-3f) {
+                mismatches++;
+            }
+        }
+        linearUs = elapsedMs(linearStart) * 1000.0 / checkCount;
+    }
+
+    // 框选：相机看向场景中心，分别框选屏幕中央四分之一和整个屏幕
+    const int screenWidth = 1920;
+    const int screenHeight = 1080;
+    math::float3 center(extent * 0.5f, extent * 0.5f, extent * 0.5f);
+    math::mat4f view = math::lookAt(eye, center, {0.0f, 1.0f, 0.0f});
+    math::mat4f projection = math::perspective(60.0f, static_cast<float>(screenWidth) / screenHeight, 0.1f, extent * 4.0f);
+    picking.setScreenSize(screenWidth, screenHeight);
+    picking.setCameraMatrices(view, projection);
+
+    struct RectCase {
+        const char* name;
+        int x0, y0, x1, y1;
+    };
+    const RectCase rectCases[] = {
+        {"quarter", screenWidth / 4, screenHeight / 4, screenWidth * 3 / 4 - 1, screenHeight * 3 / 4 - 1},
+        {"full", 0, 0, screenWidth - 1, screenHeight - 1},
+    };
+
+    std::vector<Node*> selected;
+    for (const RectCase& rectCase : rectCases) {
+        auto rectStart = Clock::now();
+        picking.pickObjectsInRect(rectCase.x0, rectCase.y0, rectCase.x1, rectCase.y1, selected);
+        double rectMs = elapsedMs(rectStart);
+
+        std::printf("          box %-7s | %8zu selected in %7.2f ms (candidates %zu)", rectCase.name, selected.size(), rectMs,
+                    static_cast<size_t>(picking.getLastPickStats().candidates));
+        if (nodeCount <= 100000) {
+            size_t expected = selectLinear(math::multiply(projection, view), nodes, screenWidth, screenHeight,
+                                           rectCase.x0, rectCase.y0, rectCase.x1, rectCase.y1);
+            std::printf(" | linear %zu", expected);
+        }
+        std::printf("\n");
+    }
+
+    // 移动 1% 的节点，测量增量调整
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+    size_t moveCount = std::max<size_t>(1, nodeCount / 100);
+    for (size_t i = 0; i < moveCount; ++i) {
+        Node* node = nodes[pickNode(rng)];
+        node->setPosition(node->getPosition() + math::float3(offset(rng), offset(rng), offset(rng)));
+    }
+    scene.update();
+    auto refitStart = Clock::now();
+    picking.updateSpatialIndex();
+    double refitMs = elapsedMs(refitStart);
+
+    std::printf("%9zu nodes %11zu tris | scene %9.1f ms | index %8.2f ms (height %2d) | refit 1%% %7.2f ms | "
+                "pick %7.2f us (hits %4d/%d, visited %5.1f, candidates %4.1f)",
+                nodeCount, nodeCount * sphere->getTriangleCount(), sceneMs, indexMs, picking.getSceneBvh().getHeight(),
+                refitMs, pickUs, hits, rayCount, static_cast<double>(visited) / rayCount,
+                static_cast<double>(candidates) / rayCount);
+    if (nodeCount <= 10000) {
+        std::printf(" | linear %9.1f us, mismatches %d", linearUs, mismatches);
+    }
+    std::printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t maxNodes = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : 1000000;
+
+    // 32x32 的球体约 2k 个三角形，1k 个节点即超过 100 万三角形
+    std::shared_ptr<TriangleBVH> sphere = buildSphere(32, 32, 1.0f);
+    std::printf("mesh: %zu triangles, %zu BVH nodes, depth %u, %zu bytes\n", sphere->getTriangleCount(),
+                sphere->getNodeCount(), sphere->getDepth(), sphere->getMemoryUsage());
+
+    std::mt19937 rng(12345);
+    for (size_t nodeCount = 1000; nodeCount <= maxNodes; nodeCount *= 10) {
+        runBenchmark(nodeCount, sphere, rng);
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+// 程序化几何体基准
+// 生成各类型的几何体，报告顶点数、索引数和生成耗时，并检查索引范围、法线长度、三角形朝向和包围盒
+//
+// 用法：PrimitiveBenchmark [--segments 64] [--iterations 100]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "core/PrimitiveGenerator.h"
+
+using namespace Kazia;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// 检查生成结果，返回发现的问题数
+size_t validate(const PrimitiveDesc& desc, const std::vector<PrimitiveVertex>& vertices, const std::vector<uint32_t>& indices) {
+    size_t problems = 0;
+    math::aabb bounds = PrimitiveGenerator::getBounds(desc);
+    const float epsilon = 1e-4f * std::max(1.0f, desc.size);
+    for (const PrimitiveVertex& vertex : vertices) {
+        if (std::fabs(math::length(vertex.normal) - 1.0f) > 1e-3f) {
+            problems++;
+        }
+        const math::float3& p = vertex.position;
+        if (p.x < bounds.min.x - epsilon || p.y < bounds.min.y - epsilon || p.z < bounds.min.z - epsilon ||
+            p.x > bounds.max.x + epsilon || p.y > bounds.max.y + epsilon || p.z > bounds.max.z + epsilon) {
+            problems++;
+        }
+    }
+
+    // 三角形的几何法线应与顶点法线同向（逆时针朝外），且不应退化
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        uint32_t a = indices[i];
+        uint32_t b = indices[i + 1];
+        uint32_t c = indices[i + 2];
+        if (a >= vertices.size() || b >= vertices.size() || c >= vertices.size()) {
+            problems++;
+            continue;
+        }
+        math::float3 faceNormal = math::cross(vertices[b].position - vertices[a].position, vertices[c].position - vertices[a].position);
+        math::float3 vertexNormal = vertices[a].normal + vertices[b].normal + vertices[c].normal;
+        if (math::length(faceNormal) <= 0.0f || math::dot(faceNormal, vertexNormal) <= 0.0f) {
+            problems++;
+        }
+    }
+    return problems;
+}
+
+bool run(const PrimitiveDesc& desc, int iterations) {
+    PrimitiveGenerator::Counts counts = PrimitiveGenerator::count(desc);
+    std::vector<PrimitiveVertex> vertices(counts.vertexCount);
+    std::vector<uint32_t> indices(counts.indexCount);
+
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        PrimitiveGenerator::generate(desc, vertices.data(), indices.data());
+    }
+    double generateMs = elapsedMs(start) / iterations;
+
+    size_t problems = validate(desc, vertices, indices);
+    std::printf("%-10s vertices %7u  indices %8u  %8.3f ms  %.1f Mverts/s  %s\n",
+                PrimitiveGenerator::getName(desc.type), counts.vertexCount, counts.indexCount, generateMs,
+                counts.vertexCount / (generateMs * 1000.0), problems == 0 ? "ok" : "INVALID");
+    if (problems != 0) {
+        std::printf("           %zu problems\n", problems);
+    }
+    return problems == 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint32_t segments = 64;
+    int iterations = 100;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--segments") == 0) {
+            segments = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--iterations") == 0) {
+            iterations = std::atoi(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "usage: PrimitiveBenchmark [--segments N] [--iterations N]\n");
+            return 2;
+        }
+    }
+    if (segments < 3 || iterations <= 0) {
+        std::fprintf(stderr, "usage: PrimitiveBenchmark [--segments N] [--iterations N]\n");
+        return 2;
+    }
+
+    const PrimitiveDesc descs[] = {
+        PrimitiveDesc::cube(1.0f),
+        PrimitiveDesc::uvSphere(0.5f, segments, segments / 2),
+        PrimitiveDesc::icoSphere(0.5f, 4),
+        PrimitiveDesc::cylinder(0.5f, 1.0f, segments),
+        PrimitiveDesc::cone(0.5f, 1.0f, segments),
+        PrimitiveDesc::torus(0.5f, 0.2f, segments, segments / 2),
+        PrimitiveDesc::plane(1.0f, segments)
+    };
+
+    bool ok = true;
+    for (const PrimitiveDesc& desc : descs) {
+        ok &= run(desc, iterations);
+    }
+    return ok ? 0 : 1;
+}
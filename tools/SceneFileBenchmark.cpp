@@ -0,0 +1,151 @@
+// 场景文件基准
+// 生成节点数可配置的场景（每 100 个节点一组，组内节点带网格组件，每组一个光源），
+// 测量序列化写入、打开（映射和校验）、实例化为 Scene 和导出 JSON 的耗时；
+// 打开前丢弃文件的页缓存。实例化的场景再次序列化后应与文件逐字节相同
+//
+// 用法：SceneFileBenchmark [--nodes 1000000] [--file 路径] [--json 路径]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "scene/CameraComponent.h"
+#include "scene/LightComponent.h"
+#include "scene/MeshComponent.h"
+#include "scene/Node.h"
+#include "scene/Scene.h"
+#include "scene/SceneFile.h"
+
+using namespace Kazia;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// 丢弃文件的页缓存
+void dropCache(const std::string& path) {
+#if defined(__linux__)
+    ::sync();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+#else
+    (void)path;
+#endif
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t nodeCount = 1000000;
+    std::string path = (std::filesystem::temp_directory_path() / "kazia_scene_benchmark.kscene").string();
+    std::string jsonPath;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--nodes") == 0) {
+            nodeCount = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--file") == 0) {
+            path = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--json") == 0) {
+            jsonPath = argv[i + 1];
+        } else {
+            std::fprintf(stderr, "usage: SceneFileBenchmark [--nodes N] [--file PATH] [--json PATH]\n");
+            return 2;
+        }
+    }
+
+    auto start = Clock::now();
+    Scene scene("Benchmark");
+    Node* group = nullptr;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        float x = static_cast<float>(i % 1000);
+        float z = static_cast<float>(i / 1000);
+        if (i % 100 == 0) {
+            auto groupNode = std::make_unique<Node>("Group " + std::to_string(i / 100));
+            group = groupNode.get();
+            group->setPosition({x, 0.0f, z});
+            LightComponent* light = group->addComponent<LightComponent>();
+            light->setLightType(LightManager::Type::POINT);
+            light->setColor({1.0f, 0.9f, 0.8f});
+            light->setRadius(5.0f + static_cast<float>(i % 7));
+            light->setStatic(i % 200 == 0);
+            scene.addNode(std::move(groupNode));
+            continue;
+        }
+        auto node = std::make_unique<Node>("Node \"" + std::to_string(i) + "\"");
+        node->setPosition({0.1f * static_cast<float>(i % 100), 0.5f, 0.0f});
+        node->setRotation({0.0f, 0.01f * static_cast<float>(i % 628), 0.0f});
+        node->setScale({1.0f, 1.0f + 0.001f * static_cast<float>(i % 50), 1.0f});
+        MeshComponent* mesh = node->addComponent<MeshComponent>();
+        mesh->setMeshPath("assets/meshes/prop" + std::to_string(i % 16) + ".glb");
+        mesh->setBounds(math::aabb({-0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, 0.5f}));
+        if (i == 1) {
+            node->addComponent<CameraComponent>()->setFOV(60.0f);
+        }
+        group->addChild(std::move(node));
+    }
+    scene.update();
+    std::printf("%zu nodes  build %.0f ms\n", nodeCount, elapsedMs(start));
+
+    bool ok = true;
+
+    start = Clock::now();
+    ok &= SceneFile::write(path, scene);
+    double writeMs = elapsedMs(start);
+    std::error_code error;
+    std::printf("write        %8.1f ms  %.1f MB\n", writeMs, std::filesystem::file_size(path, error) / 1048576.0);
+
+    dropCache(path);
+    start = Clock::now();
+    SceneFile file;
+    ok &= file.open(path);
+    double openMs = elapsedMs(start);
+    std::printf("open         %8.1f ms  (map, fix up, validate; page cache dropped)\n", openMs);
+    ok &= file.getNodeCount() == nodeCount;
+
+    start = Clock::now();
+    Scene loaded;
+    size_t created = file.instantiate(loaded);
+    double instantiateMs = elapsedMs(start);
+    std::printf("instantiate  %8.1f ms  %zu nodes\n", instantiateMs, created);
+    std::printf("open + instantiate %.1f ms\n", openMs + instantiateMs);
+    ok &= created == nodeCount;
+
+    // 往返：实例化的场景再次序列化应与文件完全相同
+    start = Clock::now();
+    std::vector<uint8_t> original = SceneFile::serialize(scene);
+    std::vector<uint8_t> roundTrip = SceneFile::serialize(loaded);
+    std::printf("serialize    %8.1f ms  (x2)\n", elapsedMs(start));
+    ok &= original == roundTrip;
+
+    if (!jsonPath.empty()) {
+        start = Clock::now();
+        ok &= file.exportJson(jsonPath);
+        std::printf("export json  %8.1f ms  %.1f MB\n", elapsedMs(start), std::filesystem::file_size(jsonPath, error) / 1048576.0);
+    }
+
+    // 截断的文件必须被拒绝
+    SceneFile truncated;
+    original.resize(original.size() / 2);
+    ok &= !truncated.openBuffer(original);
+
+    file.close();
+    std::filesystem::remove(path, error);
+    std::printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
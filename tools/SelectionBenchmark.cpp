@@ -0,0 +1,121 @@
+// 选择集性能基准
+// 在 50 万个节点的场景上测量逐个选择、全选、反选、批量取消选择和读取选择列表的耗时；
+// 最后删除全部节点再重新创建，检查节点 ID 不复用且位图不随 ID 增长
+//
+// 用法：SelectionBenchmark [节点数，默认 500000]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "scene/Node.h"
+#include "scene/Scene.h"
+#include "scene/SelectionManager.h"
+
+using namespace Kazia;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t nodeCount = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : 500000;
+
+    // 每 100 个节点一组
+    Scene scene("Benchmark");
+    std::vector<Node*> nodes;
+    nodes.reserve(nodeCount);
+    Node* group = nullptr;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        if (i % 100 == 0) {
+            auto groupNode = std::make_unique<Node>("Group");
+            group = groupNode.get();
+            nodes.push_back(group);
+            scene.addNode(std::move(groupNode));
+            continue;
+        }
+        auto node = std::make_unique<Node>("Node");
+        nodes.push_back(node.get());
+        group->addChild(std::move(node));
+    }
+
+    SelectionManager selection;
+    bool ok = true;
+
+    auto start = Clock::now();
+    for (Node* node : nodes) {
+        selection.selectNode(node);
+    }
+    std::printf("select one by one   %8.2f ms (%zu selected)\n", elapsedMs(start), selection.getSelectionCount());
+    ok = ok && selection.getSelectionCount() == nodes.size();
+
+    // 取消选择一半
+    std::vector<Node*> half;
+    for (size_t i = 0; i < nodes.size(); i += 2) {
+        half.push_back(nodes[i]);
+    }
+    start = Clock::now();
+    selection.deselectNodes(half);
+    std::printf("deselect half       %8.2f ms (%zu selected)\n", elapsedMs(start), selection.getSelectionCount());
+
+    start = Clock::now();
+    size_t listed = selection.getSelectedNodes().size();
+    std::printf("list after deselect %8.2f ms (%zu listed)\n", elapsedMs(start), listed);
+    ok = ok && listed == nodes.size() - half.size() && !selection.isNodeSelected(nodes[0]) && selection.isNodeSelected(nodes[1]);
+
+    start = Clock::now();
+    selection.invertSelection(scene.getRootNode());
+    std::printf("invert selection    %8.2f ms (%zu selected)\n", elapsedMs(start), selection.getSelectionCount());
+    ok = ok && selection.getSelectionCount() == half.size() && selection.isNodeSelected(nodes[0]) && !selection.isNodeSelected(nodes[1]);
+
+    start = Clock::now();
+    selection.selectAll(scene.getRootNode());
+    std::printf("select all          %8.2f ms (%zu selected)\n", elapsedMs(start), selection.getSelectionCount());
+    ok = ok && selection.getSelectionCount() == nodes.size();
+
+    start = Clock::now();
+    selection.deselectAll();
+    std::printf("deselect all        %8.2f ms (%zu selected)\n", elapsedMs(start), selection.getSelectionCount());
+    ok = ok && selection.getSelectionCount() == 0 && selection.getSelectedNodes().empty();
+
+    // 删除全部节点后重新创建：ID 不复用，删除前仍被选中的节点不会让新节点显示为已选中；
+    // 位图只为含有选中节点的页分配内存，不随创建过的节点总数增长
+    uint32_t maxId = 0;
+    for (Node* node : nodes) {
+        maxId = std::max(maxId, node->getId());
+    }
+    selection.selectNode(nodes.back());
+    Node* root = scene.getRootNode();
+    while (root->getChildCount() > 0) {
+        root->removeChild(root->getChild(root->getChildCount() - 1));
+    }
+    selection.deselectAll();
+    size_t baseMemory = selection.getMemorySize();
+    uint32_t minNewId = UINT32_MAX;
+    size_t maxMemory = 0;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        auto node = std::make_unique<Node>("Recreated");
+        minNewId = std::min(minNewId, node->getId());
+        ok = ok && !selection.isNodeSelected(node.get());
+        selection.selectNode(node.get());
+        selection.deselectNode(node.get());
+        maxMemory = std::max(maxMemory, selection.getMemorySize());
+        scene.addNode(std::move(node));
+    }
+    std::printf("recreate            min id %u (max old id %u)  selection memory +%.1f KB\n", minNewId, maxId,
+                (maxMemory - baseMemory) / 1024.0);
+    ok = ok && minNewId > maxId && selection.getSelectionCount() == 0 && maxMemory - baseMemory < 64 * 1024;
+
+    std::printf("%s\n", ok ? "consistent" : "INCONSISTENT");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,305 @@
+// 网格流式载入基准
+// 生成一个带 LOD 链的流式网格文件并复制为多个独立资产，布置在网格状的场地上；相机沿场地飞行，
+// 每帧为视锥体内的网格按投影误差选择级别、按投影半径请求数据，统计 I/O 吞吐、淘汰次数、驻留字节和
+// 显示级别达到目标的比例，并逐帧检查驻留字节不超过预算、调用方持有的数据与驻留统计一致；
+// 最后检查索引越界的文件无法打开
+//
+// 每帧按 --frame-time 补足时间，模拟渲染占用的帧时间，I/O 线程在帧之间完成读取
+//
+// 用法：StreamingBenchmark [--meshes 256] [--budget 96] [--frames 600] [--frame-time 8] [--io-threads 1] [--directory 目录]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/MeshData.h"
+#include "core/MeshLod.h"
+#include "core/MeshStream.h"
+#include "core/MeshStreamer.h"
+
+using namespace Kazia;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// 带法线和 UV 的 UV 球体
+MeshData buildSphere(int rings, int segments, float radius) {
+    MeshData mesh;
+    const float pi = 3.14159265358979323846f;
+    for (int r = 0; r <= rings; ++r) {
+        float phi = pi * r / rings;
+        for (int s = 0; s <= segments; ++s) {
+            float theta = 2.0f * pi * s / segments;
+            math::float3 normal(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+            mesh.positions.push_back(normal * radius);
+            mesh.normals.push_back(normal);
+            mesh.uvs.emplace_back(static_cast<float>(s) / segments, static_cast<float>(r) / rings);
+        }
+    }
+    for (int r = 0; r < rings; ++r) {
+        for (int s = 0; s < segments; ++s) {
+            uint32_t a = r * (segments + 1) + s;
+            uint32_t b = a + segments + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, a + 1, b, a + 1, b + 1, b});
+        }
+    }
+    return mesh;
+}
+
+// 调用方持有的一个网格：已交出的各级数据
+struct Instance {
+    MeshStreamer::MeshHandle handle;
+    math::float3 center;
+    std::vector<size_t> heldBytes;      // 0 表示未持有
+    uint32_t displayedLevel = 0;
+};
+
+size_t getMeshBytes(const MeshData& mesh) {
+    return mesh.positions.size() * sizeof(math::float3) + mesh.normals.size() * sizeof(math::float3) +
+           mesh.uvs.size() * sizeof(math::float2) + mesh.indices.size() * sizeof(uint32_t);
+}
+
+// 离目标级别最近的已持有级别，距离相同时取更精细的
+uint32_t pickDisplayedLevel(const Instance& instance, uint32_t desiredLevel) {
+    uint32_t best = static_cast<uint32_t>(instance.heldBytes.size() - 1);
+    uint32_t bestDistance = ~0u;
+    for (uint32_t level = 0; level < instance.heldBytes.size(); ++level) {
+        uint32_t distance = level > desiredLevel ? level - desiredLevel : desiredLevel - level;
+        if (instance.heldBytes[level] > 0 && distance < bestDistance) {
+            best = level;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t meshCount = 256;
+    size_t budgetMb = 96;
+    int frameCount = 600;
+    double frameTimeMs = 8.0;
+    uint32_t ioThreads = 1;
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "kazia_streaming_benchmark";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--meshes") == 0) {
+            meshCount = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--budget") == 0) {
+            budgetMb = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--frames") == 0) {
+            frameCount = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--frame-time") == 0) {
+            frameTimeMs = std::atof(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--io-threads") == 0) {
+            ioThreads = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--directory") == 0) {
+            directory = argv[i + 1];
+        } else {
+            std::fprintf(stderr, "usage: StreamingBenchmark [--meshes N] [--budget MB] [--frames N] [--frame-time MS] [--io-threads N] [--directory DIR]\n");
+            return 2;
+        }
+    }
+    if (meshCount == 0 || frameCount <= 0) {
+        std::fprintf(stderr, "usage: StreamingBenchmark [--meshes N] [--budget MB] [--frames N] [--frame-time MS] [--io-threads N] [--directory DIR]\n");
+        return 2;
+    }
+
+    // 生成一次流式文件，复制为各个资产
+    auto setupStart = Clock::now();
+    MeshData source = buildSphere(96, 192, 1.0f);
+    MeshLodChain::Options lodOptions;
+    MeshLodChain chain = MeshLodChain::build(source, lodOptions);
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    std::string sourcePath = (directory / "source.kstm").string();
+    if (!MeshStreamFile::write(sourcePath, source, chain)) {
+        std::fprintf(stderr, "failed to write %s\n", sourcePath.c_str());
+        return 1;
+    }
+    std::vector<std::string> paths(meshCount);
+    for (size_t i = 0; i < meshCount; ++i) {
+        paths[i] = (directory / ("mesh" + std::to_string(i) + ".kstm")).string();
+        std::filesystem::copy_file(sourcePath, paths[i], std::filesystem::copy_options::overwrite_existing, error);
+    }
+
+    MeshStreamer::Options streamerOptions;
+    streamerOptions.budgetBytes = budgetMb << 20;
+    streamerOptions.ioThreads = ioThreads;
+    MeshStreamer streamer(streamerOptions);
+
+    // 场地为正方形网格，间距 4
+    size_t side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(meshCount))));
+    std::vector<Instance> instances(meshCount);
+    size_t totalBytes = 0;
+    for (size_t i = 0; i < meshCount; ++i) {
+        MeshData coarsest;
+        Instance& instance = instances[i];
+        instance.handle = streamer.addMesh(paths[i], coarsest);
+        if (!instance.handle.isValid()) {
+            std::fprintf(stderr, "failed to open %s\n", paths[i].c_str());
+            return 1;
+        }
+        const MeshStreamFile* file = streamer.getFile(instance.handle);
+        instance.center = math::float3(static_cast<float>(i % side) * 4.0f, 0.0f, static_cast<float>(i / side) * 4.0f);
+        instance.heldBytes.assign(file->getLevelCount(), 0);
+        instance.heldBytes.back() = getMeshBytes(coarsest);
+        instance.displayedLevel = static_cast<uint32_t>(file->getLevelCount() - 1);
+        for (const MeshStreamFile::Level& level : file->getLevels()) {
+            totalBytes += static_cast<size_t>(level.dataSize);
+        }
+    }
+    const MeshStreamFile::Level& finest = streamer.getFile(instances[0].handle)->getLevels()[0];
+    std::printf("%zu meshes  %u levels  level 0: %u vertices %u triangles  all levels %.1f MB  budget %zu MB  setup %.0f ms\n",
+                meshCount, static_cast<unsigned>(instances[0].heldBytes.size()), finest.vertexCount, finest.indexCount / 3,
+                totalBytes / 1048576.0, budgetMb, elapsedMs(setupStart));
+
+    // 相机在场地上方沿对角线往返飞行
+    const float fov = 45.0f;
+    const float viewportHeight = 1080.0f;
+    float extent = static_cast<float>(side) * 4.0f;
+    math::mat4f projection = math::perspective(fov, 16.0f / 9.0f, 0.1f, 200.0f);
+    float pixelsAtUnitDistance = LodSelector::pixelsPerUnit(1.0f, fov, viewportHeight);
+    LodSelector selector;
+
+    bool ok = true;
+    std::vector<double> updateTimes;
+    std::vector<MeshStreamer::Event> events;
+    std::vector<MeshLodLevel> levels;
+    for (const MeshStreamFile::Level& level : streamer.getFile(instances[0].handle)->getLevels()) {
+        MeshLodLevel lod;
+        lod.error = level.error;
+        levels.push_back(lod);
+    }
+    size_t visibleSamples = 0;
+    size_t satisfiedSamples = 0;
+    size_t maxResident = 0;
+    auto runStart = Clock::now();
+    for (int frame = 0; frame < frameCount; ++frame) {
+        auto frameStart = Clock::now();
+        float t = 0.5f - 0.5f * std::cos(6.2831853f * frame / frameCount);
+        math::float3 eye(t * extent, 2.5f, t * extent - 6.0f);
+        math::float3 target = eye + math::float3(1.0f, -0.2f, 1.0f);
+        math::frustum frustum = math::frustum::fromMatrix(math::multiply(projection, math::lookAt(eye, target, {0.0f, 1.0f, 0.0f})));
+
+        auto updateStart = Clock::now();
+        std::vector<uint32_t> desiredLevels(meshCount, 0);
+        for (size_t i = 0; i < meshCount; ++i) {
+            Instance& instance = instances[i];
+            if (!frustum.intersectsSphere(instance.center, 1.0f)) {
+                continue;
+            }
+            float distance = std::max(math::length(instance.center - eye) - 1.0f, 1e-3f);
+            float pixelsPerUnit = pixelsAtUnitDistance / distance;
+            uint32_t level = selector.select(levels.data(), levels.size(), pixelsPerUnit, instance.displayedLevel);
+            desiredLevels[i] = level;
+            streamer.request(instance.handle, level, pixelsPerUnit);
+
+            visibleSamples++;
+            satisfiedSamples += instance.displayedLevel == level ? 1 : 0;
+        }
+
+        events.clear();
+        streamer.update(events);
+        for (MeshStreamer::Event& event : events) {
+            // 网格按顺序登记且没有移除，槽位下标即为实例下标
+            Instance& instance = instances[event.mesh.index];
+            if (event.type == MeshStreamer::Event::Type::Loaded) {
+                ok &= instance.heldBytes[event.level] == 0;
+                instance.heldBytes[event.level] = getMeshBytes(event.data);
+            } else {
+                ok &= instance.heldBytes[event.level] > 0;
+                instance.heldBytes[event.level] = 0;
+            }
+        }
+        for (size_t i = 0; i < meshCount; ++i) {
+            instances[i].displayedLevel = pickDisplayedLevel(instances[i], desiredLevels[i]);
+        }
+        updateTimes.push_back(elapsedMs(updateStart));
+
+        // 调用方持有的字节数必须与驻留统计一致，驻留和在途的总和不超过预算
+        const MeshStreamer::Stats& stats = streamer.getStats();
+        size_t held = 0;
+        for (const Instance& instance : instances) {
+            for (size_t bytes : instance.heldBytes) {
+                held += bytes;
+            }
+        }
+        if (held != stats.residentBytes) {
+            std::fprintf(stderr, "frame %d: held %zu bytes, streamer reports %zu\n", frame, held, stats.residentBytes);
+            ok = false;
+        }
+        if (stats.residentBytes + stats.inflightBytes > std::max(streamerOptions.budgetBytes, stats.pinnedBytes)) {
+            std::fprintf(stderr, "frame %d: %zu bytes resident or in flight exceed the budget\n", frame,
+                         stats.residentBytes + stats.inflightBytes);
+            ok = false;
+        }
+        maxResident = std::max(maxResident, stats.residentBytes);
+
+        double remainingMs = frameTimeMs - elapsedMs(frameStart);
+        if (remainingMs > 0.0) {
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(remainingMs));
+        }
+    }
+    double runMs = elapsedMs(runStart);
+
+    std::sort(updateTimes.begin(), updateTimes.end());
+    double averageMs = 0.0;
+    for (double time : updateTimes) {
+        averageMs += time;
+    }
+    averageMs /= static_cast<double>(updateTimes.size());
+    const MeshStreamer::Stats& stats = streamer.getStats();
+    std::printf("frames %d  run %.0f ms  update avg %.3f ms  p95 %.3f ms  max %.3f ms\n", frameCount, runMs, averageMs,
+                updateTimes[updateTimes.size() * 95 / 100], updateTimes.back());
+    std::printf("loads %zu  evictions %zu  failed %zu  read %.1f MB (%.0f MB/s)  peak resident %.1f MB (pinned %.1f MB)\n",
+                stats.loads, stats.evictions, stats.failedReads, stats.bytesRead / 1048576.0,
+                stats.bytesRead / 1048576.0 / (runMs / 1000.0), maxResident / 1048576.0, stats.pinnedBytes / 1048576.0);
+    std::printf("visible meshes at their target level %.1f%%\n",
+                visibleSamples > 0 ? 100.0 * satisfiedSamples / visibleSamples : 100.0);
+
+    // 全部移除后，等在途的读取结束，驻留统计应归零
+    for (const Instance& instance : instances) {
+        streamer.removeMesh(instance.handle);
+    }
+    for (int i = 0; i < 1000 && streamer.getStats().inflightBytes > 0; ++i) {
+        events.clear();
+        streamer.update(events);
+        ok &= events.empty();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ok &= stats.residentBytes == 0 && stats.pinnedBytes == 0 && stats.inflightBytes == 0;
+
+    // 把最精细一级的最后一个索引改为越界，打开时应被拒绝
+    {
+        MeshStreamFile file;
+        ok &= file.open(sourcePath);
+        const MeshStreamFile::Level level = file.getLevels()[0];
+        file.close();
+        std::fstream stream(sourcePath, std::ios::binary | std::ios::in | std::ios::out);
+        stream.seekp(static_cast<std::streamoff>(level.dataOffset + level.dataSize - sizeof(uint32_t)));
+        stream.write(reinterpret_cast<const char*>(&level.vertexCount), sizeof(level.vertexCount));
+        stream.close();
+        ok &= !file.open(sourcePath);
+    }
+
+    for (const std::string& path : paths) {
+        std::filesystem::remove(path, error);
+    }
+    std::filesystem::remove(sourcePath, error);
+    std::printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,274 @@
+// 撤销历史基准
+// 在节点数可配置的场景上执行大量变换命令（每 1000 条穿插一条创建节点命令），内存中的历史按命令数和
+// 字节数限制，超出的部分写到磁盘日志；报告每条命令的耗时、内存占用的峰值、磁盘日志的大小，
+// 然后全部撤销，所有节点应回到初始的变换，创建的节点应全部移除。
+// 最后模拟 Gizmo 拖动和数值框的连续编辑，检查命令合并的条数和合并时没有堆分配
+//
+// 用法：UndoHistoryBenchmark [--nodes 1000] [--commands 1000000] [--max-count 100] [--max-bytes 65536] [--file 路径]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "editor/CommandManager.h"
+#include "editor/CreateNodeCommand.h"
+#include "editor/TransformCommand.h"
+#include "scene/Node.h"
+#include "scene/Scene.h"
+
+using namespace Kazia;
+
+// 统计堆分配次数
+static size_t s_allocations = 0;
+
+void* operator new(size_t size) {
+    s_allocations++;
+    if (void* pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+bool sameFloat3(const math::float3& a, const math::float3& b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+// 按 Gizmo 的方式移动节点：命令在栈上构造
+bool moveNode(CommandManager& manager, Node* node, float dx) {
+    math::float3 position = node->getPosition();
+    return manager.executeCommand(TransformCommand(node, position, {position.x + dx, position.y, position.z}, node->getRotation(),
+                                                   node->getRotation(), node->getScale(), node->getScale()));
+}
+
+// 拖动和数值框编辑的合并，返回检查是否通过
+bool testMerge(const std::vector<Node*>& nodes) {
+    bool ok = true;
+    CommandManager::Options options;
+    options.mergeWindowMs = 50;
+    CommandManager manager(options);
+    Node* a = nodes[0];
+    Node* b = nodes[1 % nodes.size()];
+    math::float3 startA = a->getPosition();
+    math::float3 startB = b->getPosition();
+
+    // 单选拖动：第一次移动分配一条命令，之后的移动全部合并且不分配内存
+    manager.beginMergeSession();
+    ok &= moveNode(manager, a, 0.1f);
+    size_t allocations = s_allocations;
+    auto start = Clock::now();
+    for (int i = 0; i < 100000; ++i) {
+        ok &= moveNode(manager, a, 0.1f);
+    }
+    double mergeMs = elapsedMs(start);
+    size_t mergeAllocations = s_allocations - allocations;
+    manager.endMergeSession();
+    std::printf("drag         100000 moves  %.3f us per merged move  %zu allocations  %zu undo entries\n", mergeMs * 0.01,
+                mergeAllocations, manager.getUndoStackSize());
+    ok &= mergeAllocations == 0 && manager.getUndoStackSize() == 1;
+
+    // 多选拖动：每个节点一条
+    manager.beginMergeSession();
+    for (int i = 0; i < 1000; ++i) {
+        ok &= moveNode(manager, a, 1.0f);
+        ok &= moveNode(manager, b, 1.0f);
+    }
+    manager.endMergeSession();
+    ok &= manager.getUndoStackSize() == 3;
+
+    // 数值框：时间窗口内的连续编辑合并，不与拖动的命令合并；间隔超过窗口后另起一条
+    for (int i = 0; i < 10; ++i) {
+        ok &= moveNode(manager, a, 0.5f);
+    }
+    ok &= manager.getUndoStackSize() == 4;
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    ok &= moveNode(manager, a, 0.5f);
+    ok &= manager.getUndoStackSize() == 5;
+
+    // 持续的编辑：窗口从第一条算起不随合并顺延，间隔小于窗口的连续编辑仍然每隔一个窗口另起一条
+    for (int i = 0; i < 8; ++i) {
+        ok &= moveNode(manager, a, 0.5f);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    size_t streamEntries = manager.getUndoStackSize() - 5;
+    ok &= streamEntries >= 2;
+
+    // 撤销后不再合并
+    size_t entries = manager.getUndoStackSize();
+    ok &= manager.undo();
+    ok &= moveNode(manager, a, 0.5f);
+    ok &= manager.getUndoStackSize() == entries && !manager.canRedo();
+
+    while (manager.undo()) {
+    }
+    ok &= sameFloat3(a->getPosition(), startA) && sameFloat3(b->getPosition(), startB);
+    return ok;
+}
+
+// 写到磁盘的命令按 ID 和 UUID 找回节点：ID 指向另一个节点时拒绝还原
+bool testResolve(Scene& scene, const std::vector<Node*>& nodes) {
+    bool ok = true;
+    Node* a = nodes[0];
+    Node* b = nodes[1 % nodes.size()];
+    uint32_t otherId = b->getId();
+    std::vector<uint8_t> data;
+
+    TransformCommand transform(a, a->getPosition(), a->getPosition(), a->getRotation(), a->getRotation(), a->getScale(), a->getScale());
+    transform.serialize(data);
+    ok &= TransformCommand::deserialize(scene, data.data(), data.size()) != nullptr;
+    std::memcpy(data.data(), &otherId, sizeof(otherId));
+    ok &= a == b || TransformCommand::deserialize(scene, data.data(), data.size()) == nullptr;
+
+    CreateNodeCommand create(&scene, a, "Resolve");
+    ok &= create.execute();
+    create.serialize(data);
+    ok &= CreateNodeCommand::deserialize(scene, data.data(), data.size()) != nullptr;
+    std::memcpy(data.data(), &otherId, sizeof(otherId));
+    ok &= a == b || CreateNodeCommand::deserialize(scene, data.data(), data.size()) == nullptr;
+    ok &= create.undo();
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t nodeCount = 1000;
+    size_t commandCount = 1000000;
+    CommandManager::Options options;
+    options.maxCount = 100;
+    options.maxBytes = 65536;
+    options.spillPath = (std::filesystem::temp_directory_path() / "kazia_undo_benchmark.kundo").string();
+    options.mergeWindowMs = 0;      // 每条命令单独计入历史，合并另外检查
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--nodes") == 0) {
+            nodeCount = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--commands") == 0) {
+            commandCount = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--max-count") == 0) {
+            options.maxCount = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--max-bytes") == 0) {
+            options.maxBytes = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--file") == 0) {
+            options.spillPath = argv[i + 1];
+        } else {
+            std::fprintf(stderr, "usage: UndoHistoryBenchmark [--nodes N] [--commands N] [--max-count N] [--max-bytes N] [--file PATH]\n");
+            return 2;
+        }
+    }
+    // 不写磁盘时撤销不到最初的状态，这里的检查都不成立
+    if (options.spillPath.empty()) {
+        std::fprintf(stderr, "--file must not be empty\n");
+        return 2;
+    }
+    nodeCount = std::max<size_t>(nodeCount, 1);
+
+    Scene scene("Undo");
+    std::vector<Node*> nodes;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        auto node = std::make_unique<Node>("Node " + std::to_string(i));
+        node->setPosition({static_cast<float>(i), 0.0f, 0.0f});
+        nodes.push_back(node.get());
+        scene.addNode(std::move(node));
+    }
+
+    bool ok = true;
+    {
+        CommandManager manager(options);
+        manager.registerCommandType(CommandType::Transform, [&scene](const uint8_t* data, size_t size) {
+            return TransformCommand::deserialize(scene, data, size);
+        });
+        manager.registerCommandType(CommandType::CreateNode, [&scene](const uint8_t* data, size_t size) {
+            return CreateNodeCommand::deserialize(scene, data, size);
+        });
+
+        // 拖动式的编辑：每次把一个节点移动一小步
+        std::mt19937 random(7);
+        size_t maxMemory = 0;
+        size_t executed = 0;
+        auto start = Clock::now();
+        for (size_t i = 0; i < commandCount; ++i) {
+            std::unique_ptr<ICommand> command;
+            if (i % 1000 == 999) {
+                command = std::make_unique<CreateNodeCommand>(&scene, nodes[random() % nodes.size()], "Created " + std::to_string(i));
+            } else {
+                Node* node = nodes[random() % nodes.size()];
+                math::float3 position = node->getPosition();
+                math::float3 moved = {position.x + 0.25f * static_cast<float>(random() % 3), position.y, position.z + 0.5f};
+                command = std::make_unique<TransformCommand>(node, position, moved, node->getRotation(), node->getRotation(),
+                                                             node->getScale(), node->getScale());
+            }
+            executed += manager.executeCommand(std::move(command)) ? 1 : 0;
+            maxMemory = std::max(maxMemory, manager.getMemorySize());
+        }
+        double executeMs = elapsedMs(start);
+        std::printf("%zu commands  execute %.1f ms  (%.3f us per command)\n", executed, executeMs, executeMs * 1000.0 / executed);
+        std::printf("memory       peak %.1f KB  now %.1f KB  (max count %zu, max bytes %zu)\n", maxMemory / 1024.0,
+                    manager.getMemorySize() / 1024.0, options.maxCount, options.maxBytes);
+        std::printf("spilled      %zu commands  %.1f MB on disk  %.1f bytes per command\n", manager.getSpilledCount(),
+                    manager.getSpilledBytes() / 1048576.0,
+                    manager.getSpilledCount() > 0 ? static_cast<double>(manager.getSpilledBytes()) / manager.getSpilledCount() : 0.0);
+        ok &= manager.getUndoStackSize() == executed;
+
+        // 往回撤销一段再重做：读回的命令挤掉最远的可以重做的命令，最多能重做内存中保留的条数
+        size_t undoCount = std::min<size_t>(500, executed);
+        for (size_t i = 0; i < undoCount; ++i) {
+            ok &= manager.undo();
+        }
+        size_t redone = 0;
+        while (manager.redo()) {
+            redone++;
+        }
+        std::printf("undo %zu, redo %zu\n", undoCount, redone);
+        ok &= redone >= 1 && redone <= std::min(undoCount, options.maxCount);
+        ok &= manager.getUndoStackSize() == executed - undoCount + redone;
+        size_t remaining = manager.getUndoStackSize();
+
+        // 全部撤销
+        start = Clock::now();
+        size_t undone = 0;
+        while (manager.undo()) {
+            undone++;
+            maxMemory = std::max(maxMemory, manager.getMemorySize());
+        }
+        double undoMs = elapsedMs(start);
+        std::printf("undo all     %zu commands  %.1f ms  peak memory %.1f KB\n", undone, undoMs, maxMemory / 1024.0);
+        ok &= undone == remaining;
+        ok &= !manager.canUndo() && manager.getSpilledBytes() == 0;
+    }
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        ok &= sameFloat3(nodes[i]->getPosition(), {static_cast<float>(i), 0.0f, 0.0f});
+        ok &= nodes[i]->getChildCount() == 0;
+    }
+    ok &= scene.getRootNode()->getChildCount() == nodeCount;
+
+    ok &= testMerge(nodes);
+    ok &= testResolve(scene, nodes);
+
+    std::printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
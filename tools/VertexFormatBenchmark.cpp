@@ -0,0 +1,157 @@
+// 顶点格式基准
+// 把带法线和 UV 的网格分别按各顶点格式打包，报告每顶点字节数、总字节数、打包耗时，
+// 以及解码后（按 GPU 归一化属性的规则）位置、法线和 UV 的最大误差
+//
+// 用法：VertexFormatBenchmark [--rings 256] [--radius 1]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "core/MeshData.h"
+#include "core/VertexFormat.h"
+
+using namespace Kazia;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// UV 球体，按行生成
+MeshData buildSphere(int rings, int segments, float radius) {
+    MeshData mesh;
+    const float pi = 3.14159265358979323846f;
+    for (int r = 0; r <= rings; ++r) {
+        float phi = pi * r / rings;
+        for (int s = 0; s <= segments; ++s) {
+            float theta = 2.0f * pi * s / segments;
+            math::float3 normal(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+            mesh.positions.push_back(normal * radius);
+            mesh.normals.push_back(normal);
+            mesh.uvs.emplace_back(static_cast<float>(s) / segments, static_cast<float>(r) / rings);
+        }
+    }
+
+    for (int r = 0; r < rings; ++r) {
+        for (int s = 0; s < segments; ++s) {
+            uint32_t a = r * (segments + 1) + s;
+            uint32_t b = a + segments + 1;
+            mesh.indices.insert(mesh.indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+    return mesh;
+}
+
+// 按 GPU 的 snorm 规则解码（-128 / -32768 钳制到 -1）
+float decodeSnorm(int value, float maximum) {
+    return std::max(static_cast<float>(value) / maximum, -1.0f);
+}
+
+template<typename T>
+T readValue(const uint8_t* source, size_t index) {
+    T value;
+    std::memcpy(&value, source + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+// 四元数旋转 +Z 得到法线
+math::float3 normalFromQuaternion(float x, float y, float z, float w) {
+    return {2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y)};
+}
+
+struct Errors {
+    float position = 0.0f;   // 最大位置误差（网格局部单位）
+    float normal = 0.0f;     // 最大法线夹角（度）
+    float uv = 0.0f;         // 最大 UV 误差
+};
+
+Errors measure(const MeshData& mesh, const PackedVertices& packed) {
+    Errors errors;
+    bool compact = packed.format != VertexFormat::Float;
+    for (size_t i = 0; i < mesh.positions.size(); ++i) {
+        const uint8_t* vertex = packed.data.data() + i * packed.stride;
+
+        math::float3 position;
+        const uint8_t* p = vertex + packed.positionOffset;
+        switch (packed.format) {
+            case VertexFormat::Float:
+                position = {readValue<float>(p, 0), readValue<float>(p, 1), readValue<float>(p, 2)};
+                break;
+            case VertexFormat::CompactHalf:
+                position = {halfToFloat(readValue<uint16_t>(p, 0)), halfToFloat(readValue<uint16_t>(p, 1)),
+                            halfToFloat(readValue<uint16_t>(p, 2))};
+                break;
+            case VertexFormat::CompactSnorm:
+                position = math::float3(decodeSnorm(readValue<int16_t>(p, 0), 32767.0f), decodeSnorm(readValue<int16_t>(p, 1), 32767.0f),
+                                        decodeSnorm(readValue<int16_t>(p, 2), 32767.0f)) * packed.dequantizeScale + packed.dequantizeOffset;
+                break;
+        }
+        errors.position = std::max(errors.position, math::length(position - mesh.positions[i]));
+
+        if (packed.hasTangents) {
+            const uint8_t* t = vertex + packed.tangentOffset;
+            float q[4];
+            for (int c = 0; c < 4; ++c) {
+                q[c] = compact ? decodeSnorm(readValue<int8_t>(t, c), 127.0f) : readValue<float>(t, c);
+            }
+            float length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+            math::float3 normal = normalFromQuaternion(q[0] / length, q[1] / length, q[2] / length, q[3] / length);
+            float cosine = std::clamp(math::dot(math::normalize(normal), mesh.normals[i]), -1.0f, 1.0f);
+            errors.normal = std::max(errors.normal, std::acos(cosine) * 57.29578f);
+        }
+
+        if (packed.hasUvs) {
+            const uint8_t* u = vertex + packed.uvOffset;
+            math::float2 uv = compact ? math::float2(halfToFloat(readValue<uint16_t>(u, 0)), halfToFloat(readValue<uint16_t>(u, 1)))
+                                      : math::float2(readValue<float>(u, 0), readValue<float>(u, 1));
+            errors.uv = std::max(errors.uv, std::max(std::fabs(uv.x - mesh.uvs[i].x), std::fabs(uv.y - mesh.uvs[i].y)));
+        }
+    }
+    return errors;
+}
+
+void run(const char* label, const MeshData& mesh, VertexFormat format) {
+    auto start = Clock::now();
+    PackedVertices packed = packVertices(mesh, format);
+    double packMs = elapsedMs(start);
+
+    Errors errors = measure(mesh, packed);
+    std::printf("%-7s stride %2u  %10zu bytes  pack %7.2f ms  position error %.2e  normal error %.3f deg  uv error %.2e\n",
+                label, packed.stride, packed.data.size(), packMs, errors.position, errors.normal, errors.uv);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int rings = 256;
+    float radius = 1.0f;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--rings") == 0) {
+            rings = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--radius") == 0) {
+            radius = static_cast<float>(std::atof(argv[i + 1]));
+        } else {
+            std::fprintf(stderr, "usage: VertexFormatBenchmark [--rings N] [--radius R]\n");
+            return 2;
+        }
+    }
+    if (rings < 4 || radius <= 0.0f) {
+        std::fprintf(stderr, "usage: VertexFormatBenchmark [--rings N] [--radius R]\n");
+        return 2;
+    }
+
+    MeshData sphere = buildSphere(rings, rings * 2, radius);
+    std::printf("sphere  vertices %zu  radius %g\n", sphere.positions.size(), radius);
+    run("float", sphere, VertexFormat::Float);
+    run("half", sphere, VertexFormat::CompactHalf);
+    run("snorm", sphere, VertexFormat::CompactSnorm);
+    return 0;
+}